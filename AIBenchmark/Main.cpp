@@ -0,0 +1,778 @@
+/*
+Checks and times the parts of the AI that don't need a window - navigation
+and the like - against simple brute force versions of the same thing.
+
+Usage: AIBenchmark [iterations]
+NavigationMesh is loaded from test.navmesh. Its grid triangle lookup is
+checked against testing every triangle in turn, the way the lookup used to
+work, for random points over the mesh and beyond its edges, and for every
+vertex and shared edge midpoint, which are the points most likely to fall
+between grid cells. The lookups are then repeated iterations times (100 by
+default), and the fastest pass of each is reported in milliseconds.
+
+Its paths are checked between random points on the mesh. A path has to be
+found exactly when both ends are on the same island of triangles, has to
+start and end where it was asked to, and every part of it has to stay on
+triangles of that island. Ends off the mesh, both ends in one triangle, and
+ends on shared edges are all covered.
+
+NavigationGrid's path cache is checked on Map.txt against a second copy of
+the grid whose cache is cleared before every search. Random pairs of cells
+are asked for again and again while cells are walled off and opened up, and
+every path has to match the uncached one, including when a wall opening up
+far away gives a shorter route. Once the cache is full, a path that keeps
+being asked for has to stay cached while others are evicted.
+
+VisibilityGrid is checked by casting rays through a world of static walls
+and moving spheres, boxes and rotated boxes, some of them switched off and
+some hanging over the edge of the grid, and comparing each result with
+GameWorld::Raycast, which tests every object. Random rays, rays aimed at
+objects, and view cones are all cast, and the cones' rays have to be spread
+evenly across them. The objects then move, and the grid is rebuilt and
+checked again, a few times over, so occluders that move are covered too.
+
+CompiledBehaviourTree is checked against the BehaviourSequence, Selector,
+Parallel and Action classes, by building random trees both ways and running
+a few agents through each for a number of ticks. The actions give random,
+but repeatable, results, so the two versions have to call the same actions
+in the same order with the same states, and finish on the same ticks, both
+when their nodes pick up where they left off on a later tick, and when
+agents are reset part way through a run.
+
+Build with optimisations on, or the numbers won't mean much.
+*/
+#include "NavigationMesh.h"
+#include "NavigationGrid.h"
+#include "VisibilityGrid.h"
+#include "GameWorld.h"
+#include "GameObject.h"
+#include "AABBVolume.h"
+#include "OBBVolume.h"
+#include "SphereVolume.h"
+#include "Maths.h"
+#include "BehaviourAction.h"
+#include "BehaviourSequence.h"
+#include "BehaviourSelector.h"
+#include "BehaviourParallel.h"
+#include "CompiledBehaviourTree.h"
+
+using namespace NCL;
+using namespace Maths;
+using namespace CSC8503;
+
+namespace {
+	const int		DEFAULT_ITERATIONS	= 100;
+
+	const size_t	NAV_POINT_COUNT		= 20000;
+	const size_t	NAV_PATH_COUNT		= 2000;
+	const float		NAV_MARGIN			= 10.0f;	//how far past the mesh's edges random points can land
+	const float		NAV_PATH_STEP		= 0.1f;		//how far apart path segments are sampled
+	const float		NAV_END_TOLERANCE	= 1e-3f;
+
+	const int		GRID_STEPS			= 4000;
+	const int		GRID_PAIRS			= 64;		//start and goal cells that get asked for again and again
+	const float		GRID_EDIT_CHANCE	= 0.1f;
+	const int		GRID_LRU_QUERIES	= 10000;	//enough to fill the cache up and keep it full for a while
+	const int		GRID_LRU_REPEAT		= 100;
+
+	const float		SIGHT_AREA			= 128.0f;	//the grid covers -SIGHT_AREA to SIGHT_AREA on X and Z
+	const float		SIGHT_CELL_SIZE		= 16.0f;
+	const size_t	SIGHT_WALL_COUNT	= 300;
+	const size_t	SIGHT_MOVER_COUNT	= 300;
+	const size_t	SIGHT_RAY_COUNT		= 5000;
+	const size_t	SIGHT_CONE_COUNT	= 200;
+	const int		SIGHT_CONE_RAYS		= 9;
+	const float		SIGHT_CONE_ANGLE	= 45.0f;	//half angle, in degrees
+	const int		SIGHT_FRAMES		= 4;
+	const float		SIGHT_TOLERANCE		= 1e-4f;
+
+	const size_t	TREE_COUNT			= 500;
+	const int		TREE_AGENTS			= 4;
+	const int		TREE_TICKS			= 40;
+	const int		TREE_MAX_DEPTH		= 4;
+	const int		TREE_MAX_CHILDREN	= 4;
+	const int		TREE_MAX_ACTIONS	= 256;	//TREE_MAX_CHILDREN to the power of TREE_MAX_DEPTH, as many as a tree can have
+	const float		TREE_RESET_CHANCE	= 0.05f;	//of an agent being reset part way through a tick's run
+
+	using Clock = std::chrono::high_resolution_clock;
+
+	//Opens up the mesh's triangles, so they can be checked against
+	class TestNavigationMesh : public NavigationMesh {
+	public:
+		TestNavigationMesh(const std::string& filename) : NavigationMesh(filename) {
+		}
+
+		int GetTriCount() const {
+			return (int)allTris.size();
+		}
+		Vector3 GetVertex(int tri, int corner) const {
+			return allVerts[allTris[tri].indices[corner]];
+		}
+		int GetNeighbour(int tri, int edge) const {
+			return allTris[tri].neighbours[edge];
+		}
+
+		int FindTri(const Vector3& pos) const {
+			const NavTri* t = GetTriForPosition(pos);
+			return t ? (int)(t - allTris.data()) : -1;
+		}
+
+		//Every triangle is tested, keeping the same one the grid lookup should
+		int FindTriLinear(const Vector3& pos) const {
+			int		best		= -1;
+			float	bestHeight	= FLT_MAX;
+			for (int i = 0; i < (int)allTris.size(); ++i) {
+				if (!PointInTriXZ(allTris[i], pos)) {
+					continue;
+				}
+				float height = abs(allTris[i].triPlane.DistanceFromPlane(pos));
+				if (height < bestHeight) {
+					best		= i;
+					bestHeight	= height;
+				}
+			}
+			return best;
+		}
+
+		bool OnTriXZ(int tri, const Vector3& pos) const {
+			return PointInTriXZ(allTris[tri], pos);
+		}
+	};
+
+	//Labels each triangle with the island of triangles it can reach through its neighbours
+	std::vector<int> FindIslands(const TestNavigationMesh& mesh) {
+		std::vector<int> islands(mesh.GetTriCount(), -1);
+		int islandCount = 0;
+		for (int first = 0; first < mesh.GetTriCount(); ++first) {
+			if (islands[first] != -1) {
+				continue;
+			}
+			std::vector<int> open = { first };
+			islands[first] = islandCount;
+			while (!open.empty()) {
+				int t = open.back();
+				open.pop_back();
+				for (int e = 0; e < 3; ++e) {
+					int n = mesh.GetNeighbour(t, e);
+					if (n != -1 && islands[n] == -1) {
+						islands[n] = islandCount;
+						open.emplace_back(n);
+					}
+				}
+			}
+			islandCount++;
+		}
+		return islands;
+	}
+
+	Vector3 RandomPointOnTri(const TestNavigationMesh& mesh, int tri, std::mt19937& generator) {
+		std::uniform_real_distribution<float> weight(0.0f, 1.0f);
+		float u = weight(generator);
+		float v = weight(generator);
+		if (u + v > 1.0f) {
+			u = 1.0f - u;
+			v = 1.0f - v;
+		}
+		Vector3 a = mesh.GetVertex(tri, 0);
+		return a + (mesh.GetVertex(tri, 1) - a) * u + (mesh.GetVertex(tri, 2) - a) * v;
+	}
+
+	void GetMeshBounds(const TestNavigationMesh& mesh, Vector3& outMin, Vector3& outMax) {
+		outMin = outMax = mesh.GetVertex(0, 0);
+		for (int t = 0; t < mesh.GetTriCount(); ++t) {
+			for (int c = 0; c < 3; ++c) {
+				Vector3 v = mesh.GetVertex(t, c);
+				outMin = Vector3(std::min(outMin.x, v.x), std::min(outMin.y, v.y), std::min(outMin.z, v.z));
+				outMax = Vector3(std::max(outMax.x, v.x), std::max(outMax.y, v.y), std::max(outMax.z, v.z));
+			}
+		}
+	}
+
+	bool CheckNavMeshLookup(const TestNavigationMesh& mesh, int iterations) {
+		Vector3 meshMin, meshMax;
+		GetMeshBounds(mesh, meshMin, meshMax);
+
+		std::mt19937 generator(8503);
+		std::uniform_real_distribution<float> x(meshMin.x - NAV_MARGIN, meshMax.x + NAV_MARGIN);
+		std::uniform_real_distribution<float> y(meshMin.y, meshMax.y);
+		std::uniform_real_distribution<float> z(meshMin.z - NAV_MARGIN, meshMax.z + NAV_MARGIN);
+
+		std::vector<Vector3> points;
+		for (size_t i = 0; i < NAV_POINT_COUNT; ++i) {
+			points.emplace_back(x(generator), y(generator), z(generator));
+		}
+		for (int t = 0; t < mesh.GetTriCount(); ++t) {
+			for (int c = 0; c < 3; ++c) {
+				points.emplace_back(mesh.GetVertex(t, c));
+				points.emplace_back((mesh.GetVertex(t, c) + mesh.GetVertex(t, (c + 1) % 3)) * 0.5f);
+			}
+		}
+
+		size_t onMesh		= 0;
+		size_t mismatches	= 0;
+		for (const Vector3& p : points) {
+			int expected = mesh.FindTriLinear(p);
+			mismatches	+= mesh.FindTri(p) != expected;
+			onMesh		+= expected != -1;
+		}
+
+		float ms		= FLT_MAX;
+		float linearMS	= FLT_MAX;
+		for (int pass = 0; pass < std::max(1, iterations / 10); ++pass) {
+			int gridSum		= 0;
+			int linearSum	= 0;
+			auto start = Clock::now();
+			for (const Vector3& p : points) {
+				linearSum += mesh.FindTriLinear(p);
+			}
+			linearMS = std::min(linearMS, std::chrono::duration<float, std::milli>(Clock::now() - start).count());
+
+			start = Clock::now();
+			for (const Vector3& p : points) {
+				gridSum += mesh.FindTri(p);
+			}
+			ms = std::min(ms, std::chrono::duration<float, std::milli>(Clock::now() - start).count());
+
+			mismatches += gridSum != linearSum;	//also keeps either loop from being optimised away
+		}
+		bool passed = mismatches == 0 && onMesh > 0;
+		std::cout << "Navmesh lookup\t" << points.size() << "\t" << onMesh << "\t" << mismatches << "\t" << linearMS << "\t" << ms << "\t"
+			<< (linearMS / ms) << "x" << (passed ? "" : "\tFAILED") << "\n";
+		return passed;
+	}
+
+	//Every sample along the path has to be on a triangle of the island it started on
+	size_t CheckPathStaysOnIsland(const TestNavigationMesh& mesh, const std::vector<int>& islands, int island, const std::vector<Vector3>& waypoints) {
+		size_t mismatches = 0;
+		for (size_t i = 0; i + 1 < waypoints.size(); ++i) {
+			Vector3 step	= waypoints[i + 1] - waypoints[i];
+			step.y			= 0.0f;
+			int samples		= std::max(1, (int)std::ceil(step.Length() / NAV_PATH_STEP));
+			for (int s = 0; s <= samples; ++s) {
+				Vector3 p = waypoints[i] + step * ((float)s / samples);
+				bool onIsland = false;
+				for (int t = 0; t < mesh.GetTriCount() && !onIsland; ++t) {
+					onIsland = islands[t] == island && mesh.OnTriXZ(t, p);
+				}
+				mismatches += !onIsland;
+			}
+		}
+		return mismatches;
+	}
+
+	/*
+	Returns whether a path was found, and how many ways it went wrong. A found
+	path has to start and end at the right places, and stay on the island.
+	*/
+	bool CheckPath(TestNavigationMesh& mesh, const std::vector<int>& islands, const Vector3& from, const Vector3& to, size_t& mismatches) {
+		NavigationPath path;
+		bool found = mesh.FindPath(from, to, path);
+
+		std::vector<Vector3> waypoints;
+		Vector3 waypoint;
+		while (path.PopWaypoint(waypoint)) {
+			waypoints.emplace_back(waypoint);
+		}
+		int fromTri	= mesh.FindTri(from);
+		int toTri	= mesh.FindTri(to);
+		bool reachable = fromTri != -1 && toTri != -1 && islands[fromTri] == islands[toTri];
+
+		if (found != reachable || found == waypoints.empty()) {
+			mismatches++;
+			return found;
+		}
+		if (!found) {
+			return false;
+		}
+		mismatches += (waypoints.front() - from).Length() > NAV_END_TOLERANCE;
+		mismatches += (waypoints.back() - to).Length() > NAV_END_TOLERANCE;
+		//Within one triangle there's nothing to go round
+		mismatches += fromTri == toTri && waypoints.size() > 2;
+		mismatches += CheckPathStaysOnIsland(mesh, islands, islands[fromTri], waypoints);
+		return true;
+	}
+
+	bool CheckNavMeshPaths(TestNavigationMesh& mesh) {
+		std::vector<int> islands	= FindIslands(mesh);
+		int islandCount				= *std::max_element(islands.begin(), islands.end()) + 1;
+
+		Vector3 meshMin, meshMax;
+		GetMeshBounds(mesh, meshMin, meshMax);
+
+		std::mt19937 generator(8503);
+		std::uniform_int_distribution<int> tri(0, mesh.GetTriCount() - 1);
+		std::uniform_int_distribution<int> edge(0, 2);
+
+		size_t found		= 0;
+		size_t mismatches	= 0;
+		size_t paths		= 0;
+		auto Check = [&](const Vector3& from, const Vector3& to) {
+			found += CheckPath(mesh, islands, from, to, mismatches);
+			paths++;
+		};
+		for (size_t i = 0; i < NAV_PATH_COUNT; ++i) {
+			Check(RandomPointOnTri(mesh, tri(generator), generator), RandomPointOnTri(mesh, tri(generator), generator));
+		}
+		//Both ends in the same triangle
+		for (int t = 0; t < mesh.GetTriCount(); ++t) {
+			Check(RandomPointOnTri(mesh, t, generator), RandomPointOnTri(mesh, t, generator));
+		}
+		//Ends right on the edges triangles share with their neighbours
+		for (size_t i = 0; i < NAV_PATH_COUNT / 10; ++i) {
+			int a = tri(generator);
+			int e = edge(generator);
+			if (mesh.GetNeighbour(a, e) == -1) {
+				continue;
+			}
+			Vector3 onEdge = (mesh.GetVertex(a, e) + mesh.GetVertex(a, (e + 1) % 3)) * 0.5f;
+			Check(onEdge, RandomPointOnTri(mesh, tri(generator), generator));
+			Check(RandomPointOnTri(mesh, tri(generator), generator), onEdge);
+		}
+		//Ends off the mesh can't be reached, or started from
+		Vector3 offMesh = meshMax + Vector3(NAV_MARGIN, 0, NAV_MARGIN);
+		for (int t = 0; t < mesh.GetTriCount(); ++t) {
+			Check(offMesh, RandomPointOnTri(mesh, t, generator));
+			Check(RandomPointOnTri(mesh, t, generator), offMesh);
+		}
+		Check(offMesh, offMesh);
+
+		bool passed = mismatches == 0 && found > 0 && found < paths;
+		std::cout << "Navmesh paths\t" << paths << "\t" << found << "\t" << islandCount << "\t" << mismatches
+			<< (passed ? "" : "\tFAILED") << "\n";
+		return passed;
+	}
+	std::vector<Vector3> GetGridPath(NavigationGrid& grid, const Vector3& from, const Vector3& to, bool& outFound) {
+		NavigationPath path;
+		outFound = grid.FindPath(from, to, path);
+		std::vector<Vector3> waypoints;
+		Vector3 waypoint;
+		while (path.PopWaypoint(waypoint)) {
+			waypoints.emplace_back(waypoint);
+		}
+		return waypoints;
+	}
+
+	Vector3 GetCellCentre(const NavigationGrid& grid, int x, int y) {
+		float half = grid.GetNodeSize() * 0.5f;
+		return Vector3(x * grid.GetNodeSize() + half, 0, y * grid.GetNodeSize() + half);
+	}
+
+	/*
+	The reference grid is given the same edits, but has its cache cleared
+	before every search, so it always gives the answer a fresh search would.
+	*/
+	bool CheckNavGridCache() {
+		NavigationGrid grid("Map.txt", Vector3());
+		NavigationGrid reference("Map.txt", Vector3());
+
+		std::mt19937 generator(8503);
+		std::uniform_int_distribution<int>		x(0, grid.GetGridWidth() - 1);
+		std::uniform_int_distribution<int>		y(0, grid.GetGridHeight() - 1);
+		std::uniform_int_distribution<int>		pair(0, GRID_PAIRS - 1);
+		std::uniform_real_distribution<float>	chance(0.0f, 1.0f);
+
+		std::vector<std::pair<Vector3, Vector3>> pairs;
+		for (int i = 0; i < GRID_PAIRS; ++i) {
+			pairs.push_back({ GetCellCentre(grid, x(generator), y(generator)), GetCellCentre(grid, x(generator), y(generator)) });
+		}
+		std::vector<size_t>	lastLengths(GRID_PAIRS, 0);		//0 if not found
+		std::vector<char>	openedSince(GRID_PAIRS, 0);
+
+		size_t mismatches	= 0;
+		size_t shorter		= 0;	//paths a wall opening up gave a shorter route to
+		size_t rerouted		= 0;	//paths a new wall changed
+		for (int step = 0; step < GRID_STEPS; ++step) {
+			if (chance(generator) < GRID_EDIT_CHANCE) {
+				int cellX = x(generator);
+				int cellY = y(generator);
+				bool opening = grid.GetNodeType(cellX, cellY) == 'x';
+				grid.SetNodeType(cellX, cellY, opening ? '.' : 'x');
+				reference.SetNodeType(cellX, cellY, opening ? '.' : 'x');
+				if (opening) {
+					std::fill(openedSince.begin(), openedSince.end(), 1);
+				}
+				continue;
+			}
+			int p = pair(generator);
+			bool found			= false;
+			bool expectedFound	= false;
+			reference.ClearPathCache();
+			std::vector<Vector3> path		= GetGridPath(grid, pairs[p].first, pairs[p].second, found);
+			std::vector<Vector3> expected	= GetGridPath(reference, pairs[p].first, pairs[p].second, expectedFound);
+			mismatches += found != expectedFound || path != expected;
+
+			size_t length = expectedFound ? expected.size() : 0;
+			if (lastLengths[p] && length && length != lastLengths[p]) {
+				shorter		+= openedSince[p] && length < lastLengths[p];
+				rerouted	+= length > lastLengths[p];
+			}
+			lastLengths[p] = length;
+			openedSince[p] = 0;
+		}
+		PathCacheStats stats = grid.GetPathCacheStats();
+
+		//Once the cache is full, a path asked for every so often has to stay in it
+		grid.ClearPathCache();
+		grid.ResetPathCacheStats();
+		Vector3 kept = GetCellCentre(grid, 1, 1);
+		bool found = false;
+		GetGridPath(grid, kept, GetCellCentre(grid, grid.GetGridWidth() - 2, grid.GetGridHeight() - 2), found);
+		size_t keptMisses = 0;
+		for (int i = 0; i < GRID_LRU_QUERIES; ++i) {
+			GetGridPath(grid, GetCellCentre(grid, x(generator), y(generator)), GetCellCentre(grid, x(generator), y(generator)), found);
+			if (i % GRID_LRU_REPEAT == 0) {
+				int misses = grid.GetPathCacheStats().misses;
+				GetGridPath(grid, kept, GetCellCentre(grid, grid.GetGridWidth() - 2, grid.GetGridHeight() - 2), found);
+				keptMisses += grid.GetPathCacheStats().misses != misses;
+			}
+		}
+		int evictions = grid.GetPathCacheStats().evictions;
+		mismatches += keptMisses;
+
+		bool passed = mismatches == 0 && stats.hits > 0 && stats.invalidations > 0 && shorter > 0 && rerouted > 0 && evictions > 0;
+		std::cout << "Grid path cache\t" << stats.hits << "\t" << stats.misses << "\t" << stats.invalidations << "\t" << rerouted << "\t"
+			<< shorter << "\t" << evictions << "\t" << mismatches << (passed ? "" : "\tFAILED") << "\n";
+		return passed;
+	}
+
+	//Opens up the queries, so each one can be repeated against the world
+	class TestVisibilityGrid : public VisibilityGrid {
+	public:
+		TestVisibilityGrid(Vector2 worldMin, Vector2 worldSize, float cellSize) : VisibilityGrid(worldMin, worldSize, cellSize) {
+		}
+		const SightQuery& GetQuery(int index) const {
+			return queries[index];
+		}
+	};
+
+	GameObject* MakeSightObject(GameWorld& world, std::mt19937& generator, bool isStatic) {
+		std::uniform_real_distribution<float>	position(-SIGHT_AREA * 1.2f, SIGHT_AREA * 1.2f);
+		std::uniform_real_distribution<float>	size(0.5f, 8.0f);
+		std::uniform_real_distribution<float>	angle(0.0f, 360.0f);
+		std::uniform_int_distribution<int>		shape(0, 2);
+
+		GameObject* o = new GameObject();
+		Vector3 halfSize(size(generator), size(generator), size(generator));
+		switch (isStatic ? 0 : shape(generator)) {
+			case 0: o->SetBoundingVolume(new AABBVolume(halfSize)); break;
+			case 1: o->SetBoundingVolume(new SphereVolume(halfSize.x)); break;
+			case 2: o->SetBoundingVolume(new OBBVolume(halfSize));
+				o->GetTransform().SetOrientation(Quaternion::EulerAnglesToQuaternion(angle(generator), angle(generator), angle(generator)));
+				break;
+		}
+		o->GetTransform().SetPosition(Vector3(position(generator), position(generator) * 0.05f, position(generator)));
+		o->UpdateBroadphaseAABB();
+		if (isStatic) {
+			world.AddStaticObject(o);
+		}
+		else {
+			world.AddGameObject(o);
+		}
+		return o;
+	}
+
+	//The same ray cast against every object in the world, cut off at the query's range
+	SightResult BruteForceSight(const GameWorld& world, const SightQuery& query) {
+		Ray ray(query.from, query.direction);
+		RayCollision collision;
+		if (world.Raycast(ray, collision, true, (GameObject*)query.ignore) && collision.rayDistance < query.maxDistance) {
+			return { (GameObject*)collision.node, collision.rayDistance };
+		}
+		return { nullptr, query.maxDistance };
+	}
+
+	//Two objects the same distance along the ray are both right
+	bool SameSight(const SightResult& a, const SightResult& b) {
+		if (!a.hitObject || !b.hitObject) {
+			return a.hitObject == b.hitObject;
+		}
+		return std::abs(a.distance - b.distance) <= SIGHT_TOLERANCE * std::max(1.0f, a.distance);
+	}
+
+	//The rays of a cone have to go from one edge of it to the other in even steps, all level with forward
+	size_t CheckCone(const TestVisibilityGrid& grid, int firstRay, const Vector3& forward) {
+		size_t mismatches = 0;
+		float step = (2.0f * SIGHT_CONE_ANGLE) / (SIGHT_CONE_RAYS - 1);
+		for (int i = 0; i < SIGHT_CONE_RAYS; ++i) {
+			const Vector3& dir = grid.GetQuery(firstRay + i).direction;
+			float expected	= -SIGHT_CONE_ANGLE + step * i;
+			float actual	= Maths::RadiansToDegrees(std::atan2(forward.x * dir.z - forward.z * dir.x, forward.x * dir.x + forward.z * dir.z));
+			mismatches += std::abs(actual + expected) > 1e-2f;	//positive angles turn from +Z towards +X
+			mismatches += std::abs(dir.y) > SIGHT_TOLERANCE;
+		}
+		return mismatches;
+	}
+
+	bool CheckVisibilityGrid(int iterations) {
+		GameWorld world;
+		std::mt19937 generator(8503);
+		for (size_t i = 0; i < SIGHT_WALL_COUNT; ++i) {
+			MakeSightObject(world, generator, true);
+		}
+		world.BuildStaticObjects();
+		std::vector<GameObject*> movers;
+		for (size_t i = 0; i < SIGHT_MOVER_COUNT; ++i) {
+			movers.emplace_back(MakeSightObject(world, generator, false));
+		}
+
+		std::uniform_real_distribution<float>	position(-SIGHT_AREA * 1.2f, SIGHT_AREA * 1.2f);
+		std::uniform_real_distribution<float>	direction(-1.0f, 1.0f);
+		std::uniform_real_distribution<float>	range(5.0f, SIGHT_AREA * 2.0f);
+		std::uniform_real_distribution<float>	move(-10.0f, 10.0f);
+		std::uniform_real_distribution<float>	chance(0.0f, 1.0f);
+		std::uniform_int_distribution<size_t>	mover(0, SIGHT_MOVER_COUNT - 1);
+
+		TestVisibilityGrid grid(Vector2(-SIGHT_AREA, -SIGHT_AREA), Vector2(SIGHT_AREA * 2.0f, SIGHT_AREA * 2.0f), SIGHT_CELL_SIZE);
+
+		size_t queries		= 0;
+		size_t hits			= 0;
+		size_t mismatches	= 0;
+		float ms			= FLT_MAX;
+		float bruteMS		= FLT_MAX;
+		for (int frame = 0; frame < SIGHT_FRAMES; ++frame) {
+			//Everything that moves is a different occluder each frame
+			for (GameObject* o : movers) {
+				o->GetTransform().SetPosition(o->GetTransform().GetPosition() + Vector3(move(generator), 0, move(generator)));
+				o->SetActive(chance(generator) > 0.1f);
+				o->UpdateBroadphaseAABB();
+			}
+			grid.Rebuild(world);
+			grid.ClearQueries();
+
+			for (size_t i = 0; i < SIGHT_RAY_COUNT; ++i) {
+				Vector3 from(position(generator), 0.0f, position(generator));
+				Vector3 dir(direction(generator), direction(generator) * 0.1f, direction(generator));
+				grid.AddRay(from, dir, range(generator), movers[mover(generator)]);
+			}
+			for (size_t i = 0; i < SIGHT_RAY_COUNT / 10; ++i) {
+				Vector3 from(position(generator), 0.0f, position(generator));
+				grid.AddTargetRay(from, *movers[mover(generator)], movers[mover(generator)]);
+			}
+			std::vector<std::pair<int, Vector3>> cones;
+			for (size_t i = 0; i < SIGHT_CONE_COUNT; ++i) {
+				Vector3 from(position(generator), 0.0f, position(generator));
+				Vector3 forward = Vector3(direction(generator), 0.0f, direction(generator)).Normalised();
+				cones.push_back({ grid.AddCone(from, forward, SIGHT_CONE_ANGLE, range(generator), SIGHT_CONE_RAYS, movers[mover(generator)]), forward });
+			}
+
+			std::vector<SightResult> expected;
+			for (int pass = 0; pass < std::max(1, iterations / 10); ++pass) {
+				expected.clear();
+				auto start = Clock::now();
+				for (int i = 0; i < (int)grid.GetQueryCount(); ++i) {
+					expected.emplace_back(BruteForceSight(world, grid.GetQuery(i)));
+				}
+				bruteMS = std::min(bruteMS, std::chrono::duration<float, std::milli>(Clock::now() - start).count());
+
+				start = Clock::now();
+				grid.Execute();
+				ms = std::min(ms, std::chrono::duration<float, std::milli>(Clock::now() - start).count());
+			}
+			for (int i = 0; i < (int)grid.GetQueryCount(); ++i) {
+				mismatches	+= !SameSight(grid.GetResult(i), expected[i]);
+				hits		+= expected[i].hitObject != nullptr;
+			}
+			for (const auto& [firstRay, forward] : cones) {
+				mismatches += CheckCone(grid, firstRay, forward);
+			}
+			queries += grid.GetQueryCount();
+		}
+		world.ClearAndErase();
+
+		bool passed = mismatches == 0 && hits > 0 && hits < queries;
+		std::cout << "Sight lines\t" << queries << "\t" << hits << "\t" << mismatches << "\t" << bruteMS << "\t" << ms << "\t"
+			<< (bruteMS / ms) << "x" << (passed ? "" : "\tFAILED") << "\n";
+		return passed;
+	}
+	/*
+	Stands in for an agent. Each action's result depends only on the agent's
+	seed, the action, how many times it has been called, and the state it was
+	handed, so two agents with the same seed given the same calls give the same
+	answers. Every call is logged, so the calls themselves can be compared.
+	*/
+	struct TreeAgent {
+		uint32_t				seed = 0;
+		std::vector<uint32_t>	calls;
+		std::vector<std::tuple<int, BehaviourState, BehaviourState>> log;	//action, state handed in, result
+
+		BehaviourState Act(int action, BehaviourState state) {
+			uint32_t h = seed ^ (action * 0x9E3779B9u) ^ (calls[action]++ * 0x85EBCA6Bu) ^ ((uint32_t)state * 0xC2B2AE35u);
+			h ^= h >> 16;
+			h *= 0x7FEB352Du;
+			h ^= h >> 15;
+			BehaviourState result = (h % 10) < 4 ? Ongoing : ((h % 10) < 8 ? Success : Failure);
+			log.emplace_back(action, state, result);
+			return result;
+		}
+	};
+
+	//Compiled trees take plain function pointers, so each action index gets its own
+	template<int action>
+	BehaviourState TreeAction(TreeAgent& agent, float dt, BehaviourState state) {
+		return agent.Act(action, state);
+	}
+
+	template<int... actions>
+	std::vector<CompiledBehaviourTree<TreeAgent>::ActionFunc> MakeTreeActions(std::integer_sequence<int, actions...>) {
+		return { &TreeAction<actions>... };
+	}
+
+	struct TreeShape {
+		CompiledNodeType		type;
+		int						action;
+		std::vector<TreeShape>	children;
+	};
+
+	TreeShape MakeTreeShape(std::mt19937& generator, int depth, int& actionCount) {
+		std::uniform_int_distribution<int>		type(1, 3);
+		std::uniform_int_distribution<int>		children(1, TREE_MAX_CHILDREN);
+		std::uniform_real_distribution<float>	chance(0.0f, 1.0f);
+
+		if (depth > 0 && (depth == TREE_MAX_DEPTH || chance(generator) < 0.5f)) {
+			return { CompiledNodeType::Action, actionCount++, {} };
+		}
+		TreeShape shape = { (CompiledNodeType)type(generator), -1, {} };
+		int childCount = children(generator);
+		for (int i = 0; i < childCount; ++i) {
+			shape.children.emplace_back(MakeTreeShape(generator, depth + 1, actionCount));
+		}
+		return shape;
+	}
+
+	BehaviourNode* BuildNodeTree(const TreeShape& shape, TreeAgent& agent) {
+		if (shape.type == CompiledNodeType::Action) {
+			int action = shape.action;
+			return new BehaviourAction("Action", [&agent, action](float dt, BehaviourState state) {
+				return agent.Act(action, state);
+			});
+		}
+		BehaviourNodeWithChildren* node = nullptr;
+		switch (shape.type) {
+			case CompiledNodeType::Sequence:	node = new BehaviourSequence("Sequence");	break;
+			case CompiledNodeType::Selector:	node = new BehaviourSelector("Selector");	break;
+			default:							node = new BehaviourParallel("Parallel");	break;
+		}
+		for (const TreeShape& child : shape.children) {
+			node->AddChild(BuildNodeTree(child, agent));
+		}
+		return node;
+	}
+
+	void BuildCompiledTree(const TreeShape& shape, BehaviourTreeBuilder<TreeAgent>& builder,
+		const std::vector<CompiledBehaviourTree<TreeAgent>::ActionFunc>& actions) {
+		switch (shape.type) {
+			case CompiledNodeType::Action:		builder.AddAction("Action", actions[shape.action]); return;
+			case CompiledNodeType::Sequence:	builder.BeginSequence("Sequence");	break;
+			case CompiledNodeType::Selector:	builder.BeginSelector("Selector");	break;
+			case CompiledNodeType::Parallel:	builder.BeginParallel("Parallel");	break;
+		}
+		for (const TreeShape& child : shape.children) {
+			BuildCompiledTree(child, builder, actions);
+		}
+		builder.End();
+	}
+
+	/*
+	Half the trees run their agents one at a time through Update, so the
+	results can be compared as well, and half all at once through UpdateAll.
+	*/
+	bool CheckBehaviourTrees() {
+		const std::vector<CompiledBehaviourTree<TreeAgent>::ActionFunc> actions = MakeTreeActions(std::make_integer_sequence<int, TREE_MAX_ACTIONS>());
+
+		std::mt19937 generator(8503);
+		std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+
+		size_t calls		= 0;
+		size_t resumed		= 0;
+		size_t resets		= 0;
+		size_t mismatches	= 0;
+		for (size_t t = 0; t < TREE_COUNT; ++t) {
+			int actionCount = 0;
+			TreeShape shape = MakeTreeShape(generator, 0, actionCount);
+
+			BehaviourTreeBuilder<TreeAgent> builder;
+			BuildCompiledTree(shape, builder, actions);
+			CompiledBehaviourTree<TreeAgent> tree = builder.Build();
+
+			std::vector<TreeAgent>	nodeAgents(TREE_AGENTS);
+			std::vector<TreeAgent>	treeAgents(TREE_AGENTS);
+			std::vector<TreeAgent*>	treeAgentPointers;
+			std::vector<std::unique_ptr<BehaviourNode>> roots;
+			for (int a = 0; a < TREE_AGENTS; ++a) {
+				nodeAgents[a].seed	= treeAgents[a].seed	= (uint32_t)generator();
+				nodeAgents[a].calls	= treeAgents[a].calls	= std::vector<uint32_t>(actionCount, 0);
+				roots.emplace_back(BuildNodeTree(shape, nodeAgents[a]));
+				treeAgentPointers.emplace_back(&treeAgents[a]);
+			}
+			std::vector<uint8_t> states(tree.GetNodeCount() * TREE_AGENTS, (uint8_t)Initialise);
+			auto AgentState = [&](int a) {
+				return std::span<uint8_t>(states).subspan(a * tree.GetNodeCount(), tree.GetNodeCount());
+			};
+
+			bool oneAtATime = t % 2 == 0;
+			for (int tick = 0; tick < TREE_TICKS; ++tick) {
+				for (int a = 0; a < TREE_AGENTS; ++a) {
+					if (tick > 0 && chance(generator) < TREE_RESET_CHANCE) {
+						roots[a]->Reset();
+						tree.Reset(AgentState(a));
+						resets++;
+					}
+					BehaviourState expected = roots[a]->Execute(1.0f);
+					if (expected == Success || expected == Failure) {
+						roots[a]->Reset();
+					}
+					if (oneAtATime) {
+						mismatches += tree.Update(treeAgents[a], AgentState(a), 1.0f) != expected;
+					}
+				}
+				if (!oneAtATime) {
+					tree.UpdateAll(treeAgentPointers, states, 1.0f);
+				}
+			}
+			for (int a = 0; a < TREE_AGENTS; ++a) {
+				mismatches += nodeAgents[a].log != treeAgents[a].log;
+				calls += nodeAgents[a].log.size();
+				for (const auto& [action, state, result] : nodeAgents[a].log) {
+					resumed += state == Ongoing;
+				}
+			}
+		}
+		bool passed = mismatches == 0 && resumed > 0 && resets > 0;
+		std::cout << "Behaviour trees\t" << TREE_COUNT << "\t" << calls << "\t" << resumed << "\t" << resets << "\t" << mismatches
+			<< (passed ? "" : "\tFAILED") << "\n";
+		return passed;
+	}
+}
+
+int main(int argc, char** argv) {
+	int iterations = DEFAULT_ITERATIONS;
+	if (argc == 2) {
+		iterations = std::max(1, atoi(argv[1]));
+	}
+
+	int failures = 0;
+	auto run = [&](bool passed) {
+		if (!passed) {
+			failures++;
+		}
+	};
+
+	TestNavigationMesh navMesh("test.navmesh");
+
+	std::cout << "Test\tPoints\tOn mesh\tMismatches\tLinear ms\tGrid ms\tSpeedup\n";
+	run(CheckNavMeshLookup(navMesh, iterations));
+
+	std::cout << "\nTest\tPaths\tFound\tIslands\tMismatches\n";
+	run(CheckNavMeshPaths(navMesh));
+
+	std::cout << "\nTest\tHits\tMisses\tInvalidations\tLonger after walls\tShorter after openings\tEvictions\tMismatches\n";
+	run(CheckNavGridCache());
+
+	std::cout << "\nTest\tQueries\tHits\tMismatches\tBrute force ms\tGrid ms\tSpeedup\n";
+	run(CheckVisibilityGrid(iterations));
+
+	std::cout << "\nTest\tTrees\tAction calls\tResumed calls\tResets\tMismatches\n";
+	run(CheckBehaviourTrees());
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,326 @@
+/*
+Offline cooking of text source assets into the binary formats the game loads.
+Cooked files are written next to their source, so the runtime picks them up
+automatically, and falls back to the text version if they're missing or stale.
+
+Usage: AssetCooker [file ...]
+With no arguments, every navigation file in the data directory, every mesh
+in the mesh directory and every image in the texture directory is cooked.
+Textures are block compressed, unless -rgba is given first.
+
+Usage: AssetCooker -benchmark
+Times loading every mesh in the mesh directory from text and from its cooked
+version, cooking any that need it first, and checks the two give the same mesh.
+
+Usage: AssetCooker -checktextures
+Cooks every image in the texture directory, then reads each one back and
+decodes its blocks on the CPU, reporting how far they are from the source
+image, how much smaller they are, and how long each takes to load. A red/green
+checker block is encoded and decoded first, as a test of the BC1 encoder.
+*/
+#include "Assets.h"
+#include "NavigationGrid.h"
+#include "NavigationMesh.h"
+#include "NavigationData.h"
+#include "MshLoader.h"
+#include "MeshData.h"
+#include "TextureLoader.h"
+#include "TextureData.h"
+#include "BlockCompression.h"
+#include "Mesh.h"
+#include "Vector4i.h"
+
+using namespace NCL;
+using namespace CSC8503;
+using namespace Rendering;
+
+namespace {
+	const int BENCHMARK_RUNS = 5;
+
+	class CookerMesh : public Mesh {
+	public:
+		void UploadToGPU(Rendering::RendererBase* renderer) override {}
+	};
+
+	bool CookNavigationFile(const std::string& filename) {
+		std::string cookedFile = Assets::DATADIR + filename + NavigationData::CookedExtension;
+		std::string extension  = std::filesystem::path(filename).extension().string();
+
+		bool cooked = false;
+		if (extension == ".navmesh") {
+			cooked = NavigationMesh::Cook(filename, cookedFile);
+		}
+		else if (extension == ".txt") {
+			cooked = NavigationGrid::Cook(filename, cookedFile);
+		}
+		else {
+			std::cout << "Don't know how to cook " << filename << "\n";
+			return false;
+		}
+		std::cout << (cooked ? "Cooked " : "Failed to cook ") << filename << " -> " << cookedFile << "\n";
+		return cooked;
+	}
+
+	bool CookMeshFile(const std::string& filename) {
+		std::string cookedFile = Assets::MESHDIR + filename + CookedData::CookedExtension;
+
+		bool cooked = MshLoader::Cook(filename, cookedFile);
+		std::cout << (cooked ? "Cooked " : "Failed to cook ") << filename << " -> " << cookedFile << "\n";
+		return cooked;
+	}
+
+	bool CookTextureFile(const std::string& filename, bool compress) {
+		std::string cookedFile = Assets::TEXTUREDIR + filename + CookedData::CookedExtension;
+
+		bool cooked = TextureLoader::Cook(filename, cookedFile, compress);
+		std::cout << (cooked ? "Cooked " : "Failed to cook ") << filename << " -> " << cookedFile << "\n";
+		return cooked;
+	}
+
+	bool IsImage(const std::string& filename) {
+		std::string extension = std::filesystem::path(filename).extension().string();
+		return extension == ".png" || extension == ".jpg" || extension == ".tga" || extension == ".bmp";
+	}
+
+	bool CookFile(const std::string& filename, bool compressTextures) {
+		if (std::filesystem::path(filename).extension() == ".msh") {
+			return CookMeshFile(filename);
+		}
+		if (IsImage(filename)) {
+			return CookTextureFile(filename, compressTextures);
+		}
+		return CookNavigationFile(filename);
+	}
+
+	std::vector<std::string> FilesWithExtensions(const std::string& directory, const std::vector<std::string>& extensions) {
+		std::vector<std::string> files;
+		for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+			std::string extension = entry.path().extension().string();
+			if (entry.is_regular_file() && std::find(extensions.begin(), extensions.end(), extension) != extensions.end()) {
+				files.emplace_back(entry.path().filename().string());
+			}
+		}
+		std::sort(files.begin(), files.end());
+		return files;
+	}
+
+	template<typename T>
+	bool SameData(const std::vector<T>& a, const std::vector<T>& b) {
+		return a.size() == b.size() && (a.empty() || memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+	}
+
+	bool SameMesh(const Mesh& a, const Mesh& b) {
+		return	SameData(a.GetPositionData(),		b.GetPositionData()) &&
+				SameData(a.GetColourData(),			b.GetColourData()) &&
+				SameData(a.GetTextureCoordData(),	b.GetTextureCoordData()) &&
+				SameData(a.GetNormalData(),			b.GetNormalData()) &&
+				SameData(a.GetTangentData(),		b.GetTangentData()) &&
+				SameData(a.GetSkinWeightData(),		b.GetSkinWeightData()) &&
+				SameData(a.GetSkinIndexData(),		b.GetSkinIndexData()) &&
+				SameData(a.GetIndexData(),			b.GetIndexData()) &&
+				SameData(a.GetJointParents(),		b.GetJointParents()) &&
+				SameData(a.GetBindPose(),			b.GetBindPose()) &&
+				SameData(a.GetInverseBindPose(),	b.GetInverseBindPose()) &&
+				a.GetSubMeshCount() == b.GetSubMeshCount() &&
+				a.GetJointCount()	== b.GetJointCount() &&
+				a.GetBoundsMin()	== b.GetBoundsMin() &&
+				a.GetBoundsMax()	== b.GetBoundsMax();
+	}
+
+	//The best of a few runs, in milliseconds, so that the first run's disk reads don't count
+	double TimeLoad(const std::function<bool(Mesh&)>& load) {
+		double best = DBL_MAX;
+		for (int i = 0; i < BENCHMARK_RUNS; ++i) {
+			CookerMesh mesh;
+			auto start = std::chrono::high_resolution_clock::now();
+			load(mesh);
+			auto end = std::chrono::high_resolution_clock::now();
+			best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+		}
+		return best;
+	}
+
+	int BenchmarkMeshes() {
+		int failures = 0;
+		double totalText	= 0.0;
+		double totalCooked	= 0.0;
+
+		std::cout << "Mesh\tVertices\tText ms\tCooked ms\tSpeedup\n";
+		for (const std::string& f : FilesWithExtensions(Assets::MESHDIR, { ".msh" })) {
+			std::string sourceFile = Assets::MESHDIR + f;
+			std::string cookedFile = sourceFile + CookedData::CookedExtension;
+			if (!CookedData::CookedFileIsCurrent(sourceFile, cookedFile) && !MshLoader::Cook(f, cookedFile)) {
+				std::cout << "Failed to cook " << f << "\n";
+				failures++;
+				continue;
+			}
+			CookerMesh textMesh;
+			CookerMesh cookedMesh;
+			if (!MshLoader::LoadText(sourceFile, textMesh) || !MshLoader::LoadCooked(cookedFile, cookedMesh) || !SameMesh(textMesh, cookedMesh)) {
+				std::cout << "Cooked " << f << " doesn't match its text version!\n";
+				failures++;
+				continue;
+			}
+			double textTime		= TimeLoad([&](Mesh& m) { return MshLoader::LoadText(sourceFile, m); });
+			double cookedTime	= TimeLoad([&](Mesh& m) { return MshLoader::LoadCooked(cookedFile, m); });
+			totalText	+= textTime;
+			totalCooked += cookedTime;
+
+			std::cout << f << "\t" << textMesh.GetVertexCount() << "\t" << textTime << "\t" << cookedTime << "\t" << (textTime / cookedTime) << "x\n";
+		}
+		std::cout << "Total\t\t" << totalText << "\t" << totalCooked << "\t" << (totalText / totalCooked) << "x\n";
+		return failures == 0 ? 0 : 1;
+	}
+
+	const char* FormatName(TextureData::Format format) {
+		switch (format) {
+			case TextureData::BC1:	return "BC1";
+			case TextureData::BC3:	return "BC3";
+			default:				return "RGBA8";
+		}
+	}
+
+	//Root mean square difference over every channel of every texel
+	double ImageError(const std::vector<char>& a, const std::vector<char>& b) {
+		double sum = 0.0;
+		for (size_t i = 0; i < a.size(); ++i) {
+			double d = (double)(uint8_t)a[i] - (double)(uint8_t)b[i];
+			sum += d * d;
+		}
+		return a.empty() ? 0.0 : std::sqrt(sum / a.size());
+	}
+
+	//The same as loading a texture that hasn't been cooked does
+	bool LoadUncooked(const std::string& filename, TextureData::MipChain& chain) {
+		char* data		= nullptr;
+		int width		= 0;
+		int height		= 0;
+		int channels	= 0;
+		int flags		= 0;
+		if (!TextureLoader::LoadTexture(filename, data, width, height, channels, flags) || channels != 4) {
+			return false;
+		}
+		TextureLoader::BuildMipChain(data, width, height, TextureData::RGBA8, chain);
+		TextureLoader::DeleteTextureData(data);
+		return true;
+	}
+
+	double TimeTextureLoad(const std::function<bool()>& load) {
+		double best = DBL_MAX;
+		for (int i = 0; i < BENCHMARK_RUNS; ++i) {
+			auto start = std::chrono::high_resolution_clock::now();
+			load();
+			auto end = std::chrono::high_resolution_clock::now();
+			best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+		}
+		return best;
+	}
+
+	/*
+	A red/green checker's colours lie along (1,-1,0), at right angles to
+	(1,1,1), which is where a careless search for the block's line ends up
+	deciding every texel is the same colour, and decodes it as a flat brown.
+	*/
+	bool CheckCheckerBlock() {
+		std::vector<char> source(16 * 4);
+		for (int t = 0; t < 16; ++t) {
+			bool red = (t % 4 + t / 4) % 2 == 0;
+			source[t * 4]		= (char)(red ? 255 : 0);
+			source[t * 4 + 1]	= (char)(red ? 0 : 255);
+			source[t * 4 + 2]	= 0;
+			source[t * 4 + 3]	= (char)255;
+		}
+		uint8_t block[8];
+		std::vector<char> decoded(source.size());
+		BlockCompression::EncodeBC1Block((const uint8_t*)source.data(), block);
+		BlockCompression::DecodeBC1Block(block, (uint8_t*)decoded.data());
+
+		double error = ImageError(source, decoded);
+		std::cout << "Red/green checker\tBC1\t1\t" << error << "\n";
+		return error < 1.0;
+	}
+
+	/*
+	The uncooked time is what loading a texture costs without a cooked file:
+	decoding the image and building its RGBA8 mips. The error is only for the
+	top level, against the source image, as that's what's seen up close.
+	*/
+	int CheckTextures() {
+		int failures = 0;
+		std::cout << "Texture\tFormat\tLevels\tRMS error\tRGBA8 KB\tCooked KB\tUncooked ms\tCooked ms\n";
+		if (!CheckCheckerBlock()) {
+			std::cout << "A red/green checker block doesn't survive BC1!\n";
+			failures++;
+		}
+		for (const std::string& f : FilesWithExtensions(Assets::TEXTUREDIR, { ".png", ".jpg", ".tga", ".bmp" })) {
+			std::string cookedFile = Assets::TEXTUREDIR + f + CookedData::CookedExtension;
+			if (!TextureLoader::Cook(f, cookedFile, true)) {
+				std::cout << "Failed to cook " << f << "\n";
+				failures++;
+				continue;
+			}
+			TextureData::MipChain source;
+			TextureData::MipChain cooked;
+			if (!LoadUncooked(f, source) || !TextureLoader::LoadCooked(cookedFile, cooked)) {
+				std::cout << "Couldn't read back cooked " << f << "!\n";
+				failures++;
+				continue;
+			}
+			if (source.levels.size() != cooked.levels.size() || source.width != cooked.width || source.height != cooked.height) {
+				std::cout << "Cooked " << f << " doesn't have the same levels as its source!\n";
+				failures++;
+				continue;
+			}
+			std::vector<char> decoded(TextureData::LevelSize(TextureData::RGBA8, cooked.width, cooked.height));
+			if (TextureData::IsCompressed(cooked.format)) {
+				BlockCompression::Decompress(cooked.GetLevelData(0), cooked.width, cooked.height, cooked.format, decoded.data());
+			}
+			else {
+				memcpy(decoded.data(), cooked.GetLevelData(0), decoded.size());
+			}
+			std::vector<char> original(source.GetLevelData(0), source.GetLevelData(0) + source.levels[0].size);
+
+			TextureData::MipChain scratch;
+			double uncookedTime	= TimeTextureLoad([&]() { return LoadUncooked(f, scratch); });
+			double cookedTime	= TimeTextureLoad([&]() { return TextureLoader::LoadCooked(cookedFile, scratch); });
+
+			std::cout << f << "\t" << FormatName(cooked.format) << "\t" << cooked.levels.size() << "\t" << ImageError(original, decoded) << "\t"
+				<< (source.data.size() / 1024) << "\t" << (cooked.data.size() / 1024) << "\t" << uncookedTime << "\t" << cookedTime << "\n";
+		}
+		return failures == 0 ? 0 : 1;
+	}
+}
+
+int main(int argc, char** argv) {
+	if (argc == 2 && std::string(argv[1]) == "-benchmark") {
+		return BenchmarkMeshes();
+	}
+	if (argc == 2 && std::string(argv[1]) == "-checktextures") {
+		return CheckTextures();
+	}
+	bool compressTextures = true;
+	std::vector<std::string> files;
+	for (int i = 1; i < argc; ++i) {
+		if (std::string(argv[i]) == "-rgba") {
+			compressTextures = false;
+			continue;
+		}
+		files.emplace_back(argv[i]);
+	}
+	if (files.empty()) {
+		files = FilesWithExtensions(Assets::DATADIR, { ".navmesh", ".txt" });
+		for (const std::string& f : FilesWithExtensions(Assets::MESHDIR, { ".msh" })) {
+			files.emplace_back(f);
+		}
+		for (const std::string& f : FilesWithExtensions(Assets::TEXTUREDIR, { ".png", ".jpg", ".tga", ".bmp" })) {
+			files.emplace_back(f);
+		}
+	}
+	int failures = 0;
+	for (const std::string& f : files) {
+		if (!CookFile(f, compressTextures)) {
+			failures++;
+		}
+	}
+	return failures == 0 ? 0 : 1;
+}
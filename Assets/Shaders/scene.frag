@@ -1,8 +1,11 @@
 #version 400 core
 
-uniform vec4 		objectColour;
 uniform sampler2D 	mainTex;
-uniform sampler2DShadow shadowTex;
+uniform sampler2DArrayShadow shadowTex;
+
+const int SHADOW_CASCADES = 3;
+uniform mat4	shadowMatrices[SHADOW_CASCADES];	//nearest cascade first
+uniform float	cascadeDepths[SHADOW_CASCADES];		//how far from the camera each cascade reaches
 
 uniform vec3	lightPos;
 uniform float	lightRadius;
@@ -16,7 +19,7 @@ in Vertex
 {
 	vec4 colour;
 	vec2 texCoord;
-	vec4 shadowProj;
+	float viewDepth;
 	vec3 normal;
 	vec3 worldPos;
 } IN;
@@ -25,10 +28,14 @@ out vec4 fragColor;
 
 void main(void)
 {
-	float shadow = 1.0; // New !
+	float shadow = 0.5; //past the last cascade counts as lit
 	
-	if( IN . shadowProj . w > 0.0) { // New !
-		shadow = textureProj ( shadowTex , IN . shadowProj ) * 0.5f;
+	for (int i = 0; i < SHADOW_CASCADES; ++i) {
+		if (IN.viewDepth < cascadeDepths[i]) {
+			vec4 shadowProj = shadowMatrices[i] * vec4(IN.worldPos, 1.0);
+			shadow = texture(shadowTex, vec4(shadowProj.xy, i, shadowProj.z)) * 0.5f;
+			break;
+		}
 	}
 
 	vec3  incident = normalize ( lightPos - IN.worldPos );
@@ -1,16 +1,15 @@
 #version 400 core
 
-uniform mat4 modelMatrix 	= mat4(1.0f);
 uniform mat4 viewMatrix 	= mat4(1.0f);
 uniform mat4 projMatrix 	= mat4(1.0f);
-uniform mat4 shadowMatrix 	= mat4(1.0f);
 
 layout(location = 0) in vec3 position;
 layout(location = 1) in vec4 colour;
 layout(location = 2) in vec2 texCoord;
 layout(location = 3) in vec3 normal;
 
-uniform vec4 		objectColour = vec4(1,1,1,1);
+layout(location = 7) in mat4 modelMatrix;	//per instance
+layout(location = 11) in vec4 objectColour;	//per instance
 
 uniform bool hasVertexColours = false;
 
@@ -18,7 +17,7 @@ out Vertex
 {
 	vec4 colour;
 	vec2 texCoord;
-	vec4 shadowProj;
+	float viewDepth;
 	vec3 normal;
 	vec3 worldPos;
 } OUT;
@@ -28,8 +27,10 @@ void main(void)
 	mat4 mvp 		  = (projMatrix * viewMatrix * modelMatrix);
 	mat3 normalMatrix = transpose ( inverse ( mat3 ( modelMatrix )));
 
-	OUT.shadowProj 	=  shadowMatrix * vec4 ( position,1);
-	OUT.worldPos 	= ( modelMatrix * vec4 ( position ,1)). xyz ;
+	vec4 worldPos	= ( modelMatrix * vec4 ( position ,1));
+
+	OUT.viewDepth	= -(viewMatrix * worldPos).z;
+	OUT.worldPos 	= worldPos. xyz ;
 	OUT.normal 		= normalize ( normalMatrix * normalize ( normal ));
 	
 	OUT.texCoord	= texCoord;
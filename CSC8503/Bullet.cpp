@@ -1,14 +1,11 @@
-#include "bullet.h"
+#include "Bullet.h"
 #include "NetworkPlayer.h"
 #include "NetworkedGame.h"
+#include "NetworkObject.h"
 
 using namespace NCL;
 using namespace CSC8503;
 
-int bullet::bulletID = 100;
-std::vector<bullet*> bullet::bulletList;
-std::vector<bullet*> bullet::bulletsDiscard;
-
 bullet::bullet(NetworkPlayer* owner)
 {
 	this->owner = owner;
@@ -36,8 +33,86 @@ bullet::~bullet() {
 
 void bullet::DestroySelf()
 {
-	owner->getGame()->SeverSendBulletDelPckt(bulletID);
-	owner->getGame()->RemoveObjectFromWorld(this, false);
+	owner->getGame()->DespawnBullet(this);
+}
+
+void BulletPool::Clear() {
+	bullets.clear();
+	generations.clear();
+	nextSlot = 0;
+}
+
+void BulletPool::Add(bullet* b) {
+	assert(bullets.size() < Capacity);
+	b->poolSlot = (int)bullets.size();
+	b->SetActive(false);
+	bullets.push_back(b);
+	generations.push_back(0);
+}
+
+bullet* BulletPool::Activate() {
+	if (bullets.empty()) {
+		return nullptr;
+	}
+	for (size_t i = 0; i < bullets.size(); ++i) {
+		bullet* b = bullets[nextSlot];
+		nextSlot = (nextSlot + 1) % bullets.size();
+		if (!b->IsActive()) {
+			Activate(b, generations[b->poolSlot] + 1);
+			return b;
+		}
+	}
+	//Slots are taken in turn, so the one after the newest bullet holds the oldest
+	bullet* oldest = bullets[nextSlot];
+	nextSlot = (nextSlot + 1) % bullets.size();
+	oldest->DestroySelf();
+	Activate(oldest, generations[oldest->poolSlot] + 1);
+	return oldest;
+}
+
+bullet* BulletPool::Activate(int networkID) {
+	int slot = (networkID - FirstNetworkID) & (Capacity - 1);
+	if (!IsBulletID(networkID) || slot >= (int)bullets.size()) {
+		return nullptr;
+	}
+	//If the slot's still active, its deactivation was missed, and the old bullet's long gone
+	Activate(bullets[slot], (networkID - FirstNetworkID) >> SlotBits);
+	return bullets[slot];
+}
+
+void BulletPool::Activate(bullet* b, int generation) {
+	generations[b->poolSlot] = generation & GenerationMask;
+	b->SetActive(true);
+	b->GetNetworkObject()->Reset(MakeNetworkID(b->poolSlot, generation));
+}
+
+void BulletPool::Deactivate(bullet* b) {
+	b->SetActive(false);
+	if (PhysicsObject* p = b->GetPhysicsObject()) {
+		p->SetLinearVelocity(Vector3());
+		p->SetAngularVelocity(Vector3());
+		p->ClearForces();
+	}
+}
+
+bullet* BulletPool::Find(int networkID) const {
+	int slot = (networkID - FirstNetworkID) & (Capacity - 1);
+	if (!IsBulletID(networkID) || slot >= (int)bullets.size()) {
+		return nullptr;
+	}
+	bullet* b = bullets[slot];
+	if (!b->IsActive() || generations[slot] != (((networkID - FirstNetworkID) >> SlotBits) & GenerationMask)) {
+		return nullptr;
+	}
+	return b;
+}
+
+void BulletPool::Update() {
+	for (bullet* b : bullets) {
+		if (b->IsActive() && b->GetPhysicsObject()->GetLinearVelocity().Length() <= 0.5f) {
+			b->DestroySelf();
+		}
+	}
 }
 
 void Item::OnCollisionBegin(GameObject* otherObject)
@@ -12,26 +12,6 @@ namespace NCL {
 			static constexpr float FireForce = 40000;
 			static constexpr float inverseMass = 1.0 / 10.0;
 
-			static std::vector<bullet*> bulletList;
-			static std::vector<bullet*> bulletsDiscard;
-			static int bulletID;
-
-			static void UpdateBulletList(){
-				for (auto i = bulletList.begin(); i != bulletList.end();)
-				{
-					if ((*i)->GetPhysicsObject()->GetLinearVelocity().Length() <= 0.5f)
-					{
-						bullet* temp = *i;
-						bulletsDiscard.push_back(temp);
-						i = bulletList.erase(i);
-						temp->DestroySelf();
-					}
-					else {
-						++i;
-					}
-				}
-			}
-
 			void OnCollisionBegin(GameObject* otherObject) override;
 			void setOwner(NetworkPlayer* owner) { this->owner = owner; }
 
@@ -42,9 +22,63 @@ namespace NCL {
 			~bullet();
 
 		protected:
+			friend class BulletPool;
 			NetworkPlayer* owner;
+			int poolSlot = -1;
 		};
 
+		/*
+		A fixed number of bullets, made along with the level and left in the
+		world for as long as it lasts. Firing activates a free bullet, which is
+		deactivated again once it slows down, so nothing is allocated, added to
+		the world or removed from it while playing.
+
+		A slot's generation goes up every time it's reused, and both are packed
+		into the bullet's network ID, so packets about a bullet that has since
+		been recycled don't match the bullet now in its slot. Clients use the
+		slot the server's ID names, so they stay in step without a lookup.
+		*/
+		class BulletPool {
+		public:
+			//Players can only fire every couple of seconds, so this is far more than are ever in flight
+			static const int Capacity		= 64;
+			static const int FirstNetworkID	= 1 << 16;
+
+			//Forgets the bullets, which go along with the rest of the world when it's cleared
+			void Clear();
+			//Takes a bullet made for the level, which should already be in the world
+			void Add(bullet* b);
+
+			//Server side - takes slots in turn, so each is reused as rarely as it can be.
+			//If every bullet's in use, the oldest is destroyed to make room.
+			bullet* Activate();
+			//Client side - uses the slot and generation in an ID from the server
+			bullet* Activate(int networkID);
+			void	Deactivate(bullet* b);
+
+			bullet* Find(int networkID) const;
+
+			//Calls DestroySelf on every active bullet that's slowed right down
+			void Update();
+
+			static bool IsBulletID(int networkID) {
+				return networkID >= FirstNetworkID;
+			}
+
+		protected:
+			static const int SlotBits		= 6;
+			static const int GenerationMask = (1 << 12) - 1;
+			static_assert(Capacity == 1 << SlotBits);
+
+			static int	MakeNetworkID(int slot, int generation) {
+				return FirstNetworkID + (((generation & GenerationMask) << SlotBits) | slot);
+			}
+			void		Activate(bullet* b, int generation);
+
+			std::vector<bullet*>	bullets;
+			std::vector<int>		generations;
+			int						nextSlot = 0;
+		};
 		
 		class Item : public GameObject
 		{
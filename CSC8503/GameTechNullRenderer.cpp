@@ -0,0 +1,49 @@
+#include "GameTechNullRenderer.h"
+#include "Debug.h"
+#include "MshLoader.h"
+using namespace NCL;
+using namespace Rendering;
+using namespace CSC8503;
+
+GameTechNullRenderer::GameTechNullRenderer(GameWorld& world) : RendererBase(*Window::GetWindow()), gameWorld(world) {
+	jobs = nullptr;
+	hostWindow.SetRenderer(this);
+}
+
+GameTechNullRenderer::~GameTechNullRenderer() {
+}
+
+void GameTechNullRenderer::OnWindowResize(int w, int h) {
+	windowSize = Vector2i(w, h);
+}
+
+Mesh* GameTechNullRenderer::LoadMesh(const std::string& name) {
+	NullMesh* mesh = new NullMesh();
+	MshLoader::LoadMesh(name, *mesh);
+	mesh->SetPrimitiveType(GeometryPrimitive::Triangles);
+	mesh->UploadToGPU();
+	return mesh;
+}
+
+Mesh* GameTechNullRenderer::CreateMesh() {
+	return new NullMesh();
+}
+
+//Nothing ever samples a texture here, so there's no need to decode the file
+Texture* GameTechNullRenderer::LoadTexture(const std::string& name) {
+	return new NullTexture();
+}
+
+Texture* GameTechNullRenderer::CreateTexture(const TextureData::MipChain& chain) {
+	return new NullTexture(chain.width, chain.height);
+}
+
+Shader* GameTechNullRenderer::LoadShader(const std::string& vertex, const std::string& fragment) {
+	return new NullShader(vertex, fragment);
+}
+
+//The debug lines and text are still gathered and cleared each frame, so they don't build up
+void GameTechNullRenderer::ExtractFrame() {
+	extractor.Extract(gameWorld, jobs);
+	Debug::Flush();
+}
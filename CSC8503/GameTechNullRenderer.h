@@ -0,0 +1,75 @@
+#pragma once
+#include "RendererBase.h"
+#include "Mesh.h"
+#include "Texture.h"
+#include "TextureData.h"
+#include "Shader.h"
+
+#include "GameWorld.h"
+#include "FramePacket.h"
+
+namespace NCL {
+	namespace CSC8503 {
+		//Keeps its vertex data on the CPU, and never uploads it anywhere
+		class NullMesh : public Mesh {
+		public:
+			NullMesh() {}
+			~NullMesh() {}
+
+			void UploadToGPU(Rendering::RendererBase* renderer = nullptr) override {
+				ValidateMeshData();
+			}
+		};
+
+		class NullTexture : public Texture {
+		public:
+			NullTexture(int width = 0, int height = 0) {
+				dimensions = Vector2i(width, height);
+			}
+			~NullTexture() {}
+		};
+
+		class NullShader : public Shader {
+		public:
+			NullShader(const std::string& vertex, const std::string& fragment) : Shader(vertex, fragment) {}
+			~NullShader() {}
+
+			void ReloadShader() override {}
+		};
+
+		/*
+		Stands in for GameTechRenderer on machines with no graphics API, with
+		the same functions for the game to call. Meshes are still loaded, so
+		everything that reads their vertices or bounds works as it usually
+		would, and frames are still extracted from the world, but nothing is
+		ever drawn.
+		*/
+		class GameTechNullRenderer : public RendererBase {
+		public:
+			GameTechNullRenderer(GameWorld& world);
+			~GameTechNullRenderer();
+
+			Mesh*		LoadMesh(const std::string& name);
+			Mesh*		CreateMesh();
+			Texture*	LoadTexture(const std::string& name);
+			Texture*	CreateTexture(const TextureData::MipChain& chain);
+			Shader*		LoadShader(const std::string& vertex, const std::string& fragment);
+
+			void ExtractFrame();
+			void SetJobSystem(JobSystem* j) {
+				jobs = j;
+			}
+
+		protected:
+			void OnWindowResize(int w, int h)	override;
+			void BeginFrame()	override {}
+			void RenderFrame()	override {}
+			void EndFrame()		override {}
+			void SwapBuffers()	override {}
+
+			GameWorld&		gameWorld;
+			RenderExtractor	extractor;
+			JobSystem*		jobs;
+		};
+	}
+}
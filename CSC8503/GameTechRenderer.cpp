@@ -1,6 +1,7 @@
 #include "GameTechRenderer.h"
 #include "GameObject.h"
 #include "RenderObject.h"
+#include "JobSystem.h"
 #include "Camera.h"
 #include "TextureLoader.h"
 #include "MshLoader.h"
@@ -8,10 +9,34 @@ using namespace NCL;
 using namespace Rendering;
 using namespace CSC8503;
 
-#define SHADOWSIZE 4096
+#define SHADOWSIZE 2048
+
+const float MAX_SHADOW_DISTANCE		= 250.0f;	//nothing further from the camera than this gets shadowed
+const float CASCADE_SPLIT_BLEND		= 0.75f;	//0 spaces the cascades evenly, 1 logarithmically
+const float SHADOW_CASTER_DISTANCE	= 200.0f;	//how far towards the light casters are looked for past a cascade's slice
 
 Matrix4 biasMatrix = Matrix4::Translation(Vector3(0.5f, 0.5f, 0.5f)) * Matrix4::Scale(Vector3(0.5f, 0.5f, 0.5f));
 
+//The instanced attributes sit just past the ones a mesh can have, matching the layout locations in scene.vert and shadow.vert
+const GLuint INSTANCE_MATRIX_SLOT	= VertexAttribute::MAX_ATTRIBUTES;
+const GLuint INSTANCE_COLOUR_SLOT	= INSTANCE_MATRIX_SLOT + 4;
+const GLuint INSTANCE_BINDING		= VertexAttribute::MAX_ATTRIBUTES;
+
+//The shader storage bindings used by cullObjects.comp
+const GLuint CULL_OBJECT_BINDING	= 0;
+const GLuint CULL_COMMAND_BINDING	= 1;
+const GLuint CULL_INSTANCE_BINDING	= 2;
+
+//Makes sure a buffer can hold at least size bytes. Growing it loses what's in it, so returns whether it did
+static bool ReserveBuffer(GLuint buffer, size_t& capacity, size_t size) {
+	if (size <= capacity) {
+		return false;
+	}
+	capacity = std::max(size, capacity * 2);
+	glNamedBufferData(buffer, capacity, nullptr, GL_DYNAMIC_DRAW);
+	return true;
+}
+
 GameTechRenderer::GameTechRenderer(GameWorld& world) : OGLRenderer(*Window::GetWindow()), gameWorld(world)	{
 	glEnable(GL_DEPTH_TEST);
 
@@ -19,23 +44,29 @@ GameTechRenderer::GameTechRenderer(GameWorld& world) : OGLRenderer(*Window::GetW
 	shadowShader = new OGLShader("shadow.vert", "shadow.frag");
 
 	glGenTextures(1, &shadowTex);
-	glBindTexture(GL_TEXTURE_2D, shadowTex);
-	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, shadowTex);
+	glTexParameterf(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameterf(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT,
-			     SHADOWSIZE, SHADOWSIZE, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT,
+			     SHADOWSIZE, SHADOWSIZE, SHADOW_CASCADES, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
 	
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_R_TO_TEXTURE);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_R_TO_TEXTURE);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
 
 	glGenFramebuffers(1, &shadowFBO);
 	glBindFramebuffer(GL_FRAMEBUFFER, shadowFBO);
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,GL_TEXTURE_2D, shadowTex, 0);
+	glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadowTex, 0, 0);
 	glDrawBuffer(GL_NONE);
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
+	for (ShadowCascade& cascade : shadowCascades) {
+		cascade.instanceStart		= 0;
+		cascade.staticCullVersion	= ~0ull;
+	}
+	staticBoundsVersion = ~0ull;
+
 	glClearColor(1, 1, 1, 1);
 
 	//Set up the light properties
@@ -52,23 +83,63 @@ GameTechRenderer::GameTechRenderer(GameWorld& world) : OGLRenderer(*Window::GetW
 
 	LoadSkybox();
 
+	//Each line is a DebugLineEntry, which holds both of its vertices
+	lineBuffer = new OGLStreamBuffer(1000 * sizeof(Debug::DebugLineEntry));
+
 	glGenVertexArrays(1, &lineVAO);
+	glBindVertexArray(lineVAO);
+	glVertexAttribFormat(0, 3, GL_FLOAT, false, offsetof(Debug::DebugLineEntry, start));
+	glVertexAttribBinding(0, 0);
+	glVertexAttribFormat(1, 4, GL_FLOAT, false, offsetof(Debug::DebugLineEntry, colourA));
+	glVertexAttribBinding(1, 0);
+	glEnableVertexAttribArray(0);
+	glEnableVertexAttribArray(1);
+
+	textBuffer = new OGLStreamBuffer(10000 * sizeof(SimpleFont::InterleavedTextVertex));
+
 	glGenVertexArrays(1, &textVAO);
+	glBindVertexArray(textVAO);
+	glVertexAttribFormat(0, 2, GL_FLOAT, false, offsetof(SimpleFont::InterleavedTextVertex, pos));
+	glVertexAttribBinding(0, 0);
+	glVertexAttribFormat(1, 4, GL_FLOAT, false, offsetof(SimpleFont::InterleavedTextVertex, colour));
+	glVertexAttribBinding(1, 0);
+	glVertexAttribFormat(2, 2, GL_FLOAT, false, offsetof(SimpleFont::InterleavedTextVertex, texCoord));
+	glVertexAttribBinding(2, 0);
+	glEnableVertexAttribArray(0);
+	glEnableVertexAttribArray(1);
+	glEnableVertexAttribArray(2);
+	glBindVertexArray(0);
+
+	instanceBuffer = new OGLStreamBuffer(1000 * sizeof(InstanceData));
+	cameraInstanceStart = 0;
 
-	glGenBuffers(1, &lineVertVBO);
-	glGenBuffers(1, &textVertVBO);
-	glGenBuffers(1, &textColourVBO);
-	glGenBuffers(1, &textTexVBO);
+	cullShader			= nullptr;
+	objectBuffer		= 0;
+	commandBuffer		= 0;
+	visibleBuffer		= 0;
+	objectBufferSize	= 0;
+	commandBufferSize	= 0;
+	visibleBufferSize	= 0;
+	gpuDrivenDraws		= false;
 
 	Debug::CreateDebugFont("PressStart2P.fnt", *LoadTexture("PressStart2P.png"));
 
-	SetDebugStringBufferSizes(10000);
-	SetDebugLineBufferSizes(1000);
+	frameCount	= 0;
+	jobs		= nullptr;
 }
 
 GameTechRenderer::~GameTechRenderer()	{
 	glDeleteTextures(1, &shadowTex);
 	glDeleteFramebuffers(1, &shadowFBO);
+	glDeleteVertexArrays(1, &lineVAO);
+	glDeleteVertexArrays(1, &textVAO);
+	delete lineBuffer;
+	delete textBuffer;
+	delete instanceBuffer;
+	delete cullShader;
+	glDeleteBuffers(1, &objectBuffer);
+	glDeleteBuffers(1, &commandBuffer);
+	glDeleteBuffers(1, &visibleBuffer);
 }
 
 void GameTechRenderer::LoadSkybox() {
@@ -115,10 +186,16 @@ void GameTechRenderer::RenderFrame() {
 	glEnable(GL_CULL_FACE);
 	glClearColor(1, 1, 1, 1);
 	BuildObjectList();
+	CullObjectList();
 	SortObjectList();
+	BuildInstanceData();
+	if (gpuDrivenDraws) {
+		UpdateIndirectDraws();
+	}
 	RenderShadowMap();
 	RenderSkybox();
 	RenderCamera();
+	instanceBuffer->End();
 	glDisable(GL_CULL_FACE); //Todo - text indices are going the wrong way...
 	glDisable(GL_BLEND);
 	glDisable(GL_DEPTH_TEST);
@@ -130,51 +207,242 @@ void GameTechRenderer::RenderFrame() {
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
 
+void GameTechRenderer::ExtractFrame() {
+	extractor.Extract(gameWorld, jobs);
+	Debug::Flush();
+}
+
 void GameTechRenderer::BuildObjectList() {
-	activeObjects.clear();
-
-	gameWorld.OperateOnContents(
-		[&](GameObject* o) {
-			if (o->IsActive()) {
-				const RenderObject* g = o->GetRenderObject();
-				if (g) {
-					activeObjects.emplace_back(g);
-				}
+	objectBounds.Clear();
+	for (const RenderItem& item : extractor.GetFrontPacket().items) {
+		objectBounds.AddBox(item.boundsCentre, item.boundsHalf);
+	}
+}
+
+void GameTechRenderer::CullObjectList() {
+	const FramePacket& packet = extractor.GetFrontPacket();
+
+	if (packet.staticVersion != staticBoundsVersion) {
+		staticBounds.Clear();
+		for (const RenderItem& item : packet.staticItems) {
+			staticBounds.AddBox(item.boundsCentre, item.boundsHalf);
+		}
+		staticBoundsVersion = packet.staticVersion;
+	}
+
+	Matrix4 viewMatrix = packet.camera.BuildViewMatrix();
+	Matrix4 projMatrix = packet.camera.BuildProjectionMatrix(hostWindow.GetScreenAspect());
+	Frustum cameraFrustum = Frustum::FromViewProjMatrix(projMatrix * viewMatrix);
+
+	//Anything the GPU driven path can draw is left for the cull shader to deal with
+	cameraObjects.clear();
+	objectBounds.Cull(cameraFrustum, cullIndices);
+	for (int i : cullIndices) {
+		if (!gpuDrivenDraws || !IndirectDrawLayout::CanDraw(packet.items[i])) {
+			cameraObjects.emplace_back(&packet.items[i]);
+		}
+	}
+	staticBounds.Cull(cameraFrustum, cullIndices);
+	for (int i : cullIndices) {
+		if (!gpuDrivenDraws || !IndirectDrawLayout::CanDraw(packet.staticItems[i])) {
+			cameraObjects.emplace_back(&packet.staticItems[i]);
+		}
+	}
+
+	FitShadowCascades();
+
+	for (ShadowCascade& cascade : shadowCascades) {
+		Frustum lightFrustum = Frustum::FromViewProjMatrix(cascade.cullViewProj);
+
+		if (cascade.staticCullVersion != packet.staticVersion ||
+			memcmp(&cascade.staticCullMatrix, &cascade.cullViewProj, sizeof(Matrix4)) != 0) {
+			staticBounds.Cull(lightFrustum, cascade.staticCasters);
+			cascade.staticCullMatrix	= cascade.cullViewProj;
+			cascade.staticCullVersion	= packet.staticVersion;
+		}
+		cascade.casters.clear();
+		for (int i : cascade.staticCasters) {
+			cascade.casters.emplace_back(&packet.staticItems[i]);
+		}
+		objectBounds.Cull(lightFrustum, cullIndices);
+		for (int i : cullIndices) {
+			cascade.casters.emplace_back(&packet.items[i]);
+		}
+	}
+}
+
+/*
+The camera's view, out to MAX_SHADOW_DISTANCE, is split into a slice per
+cascade, spaced somewhere between evenly and logarithmically so that the
+nearer cascades get more of the shadow map's detail. Each cascade's light
+projection is fitted around a sphere bounding its slice, rather than the
+slice itself, so that it stays the same size as the camera turns, and is
+snapped to whole shadow map texels so that shadow edges don't crawl as the
+camera moves. That makes the projection larger than the slice, though, so
+casters are found with a second projection fitted tightly around the
+slice's corners, which about halves how many get drawn. Neither changes
+while the camera is still, which lets the static caster lists be kept.
+*/
+void GameTechRenderer::FitShadowCascades() {
+	const PerspectiveCamera& camera = extractor.GetFrontPacket().camera;
+
+	Matrix4 viewMatrix	= camera.BuildViewMatrix();
+	float aspect		= hostWindow.GetScreenAspect();
+	float nearPlane		= camera.GetNearPlane();
+	float farPlane		= std::min(camera.GetFarPlane(), MAX_SHADOW_DISTANCE);
+
+	//The light is treated as directional for shadowing, pointing at the middle of the arena
+	Vector3 lightDir		= (Vector3(0, 0, 0) - lightPosition).Normalised();
+	float texelsPerUnit		= SHADOWSIZE * 0.5f;	//in clip space, which is 2 units across
+
+	float sliceNear = nearPlane;
+	for (int c = 0; c < SHADOW_CASCADES; ++c) {
+		float t			= (c + 1) / (float)SHADOW_CASCADES;
+		float logSplit	= nearPlane * std::pow(farPlane / nearPlane, t);
+		float evenSplit	= nearPlane + (farPlane - nearPlane) * t;
+		float sliceFar	= CASCADE_SPLIT_BLEND * logSplit + (1.0f - CASCADE_SPLIT_BLEND) * evenSplit;
+
+		Matrix4 sliceToWorld = (Matrix4::Perspective(sliceNear, sliceFar, aspect, camera.GetFieldOfVision()) * viewMatrix).Inverse();
+
+		Vector3 corners[8];
+		Vector3 centre;
+		for (int i = 0; i < 8; ++i) {
+			Vector4 p = sliceToWorld * Vector4((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : -1.0f, 1.0f);
+			corners[i] = Vector3(p.x, p.y, p.z) / p.w;
+			centre += corners[i];
+		}
+		centre = centre / 8.0f;
+
+		float radius = 0.0f;
+		for (const Vector3& p : corners) {
+			radius = std::max(radius, (p - centre).Length());
+		}
+		radius = std::ceil(radius);
+
+		Matrix4 lightView = Matrix4::BuildViewMatrix(centre - lightDir * (radius + SHADOW_CASTER_DISTANCE), centre, Vector3(0, 1, 0));
+		Matrix4 lightProj = Matrix4::Orthographic(-radius, radius, -radius, radius, 0.0f, 2.0f * radius + SHADOW_CASTER_DISTANCE);
+
+		//Shift the projection so that the world origin always lands on a texel corner
+		Vector4 origin = lightProj * lightView * Vector4(0, 0, 0, 1);
+		lightProj.array[3][0] += (std::round(origin.x * texelsPerUnit) - origin.x * texelsPerUnit) / texelsPerUnit;
+		lightProj.array[3][1] += (std::round(origin.y * texelsPerUnit) - origin.y * texelsPerUnit) / texelsPerUnit;
+
+		Vector3 lightMin = lightView * corners[0];
+		Vector3 lightMax = lightMin;
+		for (const Vector3& p : corners) {
+			Vector3 lightPos = lightView * p;
+			for (int axis = 0; axis < 3; ++axis) {
+				lightMin[axis] = std::min(lightMin[axis], lightPos[axis]);
+				lightMax[axis] = std::max(lightMax[axis], lightPos[axis]);
 			}
 		}
-	);
+
+		ShadowCascade& cascade	= shadowCascades[c];
+		cascade.cullViewProj	= Matrix4::Orthographic(lightMin.x, lightMax.x, lightMin.y, lightMax.y, 0.0f, -lightMin.z) * lightView;
+		cascade.viewProj		= lightProj * lightView;
+		cascade.shadowMatrix	= biasMatrix * cascade.viewProj;
+		cascade.farDepth		= sliceFar;
+
+		sliceNear = sliceFar;
+	}
 }
 
 void GameTechRenderer::SortObjectList() {
+	Vector3 camPos = extractor.GetFrontPacket().camera.GetPosition();
+
+	cameraQueue.Clear();
+	for (const RenderItem* o : cameraObjects) {
+		Vector3 offset = o->modelMatrix.GetPositionVector() - camPos;
+		cameraQueue.Add(o, Vector3::Dot(offset, offset));
+	}
+	cameraQueue.Sort();
+}
+
+/*
+Everything drawn this frame gets its model matrix and colour written out in
+draw order, so that a run of objects sharing the same state can be drawn in
+one go. The shadow cascades only care about meshes, so their casters are
+grouped by mesh alone.
+*/
+void GameTechRenderer::BuildInstanceData() {
+	const std::vector<RenderCommand>& commands = cameraQueue.GetCommands();
+	size_t instanceCount = commands.size();
+
+	for (ShadowCascade& cascade : shadowCascades) {
+		std::sort(cascade.casters.begin(), cascade.casters.end(),
+			[](const RenderItem* a, const RenderItem* b) {
+				return a->mesh < b->mesh;
+			}
+		);
+		instanceCount += cascade.casters.size();
+	}
+
+	InstanceData* instances = (InstanceData*)instanceBuffer->Begin(instanceCount * sizeof(InstanceData));
+	size_t written = 0;
+	for (ShadowCascade& cascade : shadowCascades) {
+		cascade.instanceStart = written;
+		for (const RenderItem* o : cascade.casters) {
+			instances[written++] = { o->modelMatrix, o->colour };
+		}
+	}
+	cameraInstanceStart = written;
+	for (const RenderCommand& command : commands) {
+		instances[written++] = { command.object->modelMatrix, command.object->colour };
+	}
+	instanceBuffer->Flush();
+}
+
+void GameTechRenderer::BindInstances(size_t firstInstance) {
+	BindInstanceBuffer(instanceBuffer->GetBufferID(), instanceBuffer->GetOffset() + firstInstance * sizeof(InstanceData));
+}
+
+void GameTechRenderer::BindInstanceBuffer(GLuint buffer, size_t offset) {
+	for (GLuint i = 0; i < 4; ++i) {
+		glEnableVertexAttribArray(INSTANCE_MATRIX_SLOT + i);
+		glVertexAttribFormat(INSTANCE_MATRIX_SLOT + i, 4, GL_FLOAT, false, offsetof(InstanceData, modelMatrix) + i * sizeof(Vector4));
+		glVertexAttribBinding(INSTANCE_MATRIX_SLOT + i, INSTANCE_BINDING);
+	}
+	glEnableVertexAttribArray(INSTANCE_COLOUR_SLOT);
+	glVertexAttribFormat(INSTANCE_COLOUR_SLOT, 4, GL_FLOAT, false, offsetof(InstanceData, colour));
+	glVertexAttribBinding(INSTANCE_COLOUR_SLOT, INSTANCE_BINDING);
 
+	glVertexBindingDivisor(INSTANCE_BINDING, 1);
+	glBindVertexBuffer(INSTANCE_BINDING, buffer, offset, sizeof(InstanceData));
 }
 
 void GameTechRenderer::RenderShadowMap() {
 	glBindFramebuffer(GL_FRAMEBUFFER, shadowFBO);
-	glClear(GL_DEPTH_BUFFER_BIT);
 	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
 	glViewport(0, 0, SHADOWSIZE, SHADOWSIZE);
 
 	glCullFace(GL_FRONT);
 
 	BindShader(*shadowShader);
-	int mvpLocation = glGetUniformLocation(shadowShader->GetProgramID(), "mvpMatrix");
-
-	Matrix4 shadowViewMatrix = Matrix4::BuildViewMatrix(lightPosition, Vector3(0, 0, 0), Vector3(0,1,0));
-	Matrix4 shadowProjMatrix = Matrix4::Perspective(100.0f, 500.0f, 1, 45.0f);
-
-	Matrix4 mvMatrix = shadowProjMatrix * shadowViewMatrix;
-
-	shadowMatrix = biasMatrix * mvMatrix; //we'll use this one later on
-
-	for (const auto&i : activeObjects) {
-		Matrix4 modelMatrix = (*i).GetTransform()->GetMatrix();
-		Matrix4 mvpMatrix	= mvMatrix * modelMatrix;
-		glUniformMatrix4fv(mvpLocation, 1, false, (float*)&mvpMatrix);
-		BindMesh((OGLMesh&)*(*i).GetMesh());
-		size_t layerCount = (*i).GetMesh()->GetSubMeshCount();
-		for (size_t i = 0; i < layerCount; ++i) {
-			DrawBoundMesh((uint32_t)i);
+	int viewProjLocation = glGetUniformLocation(shadowShader->GetProgramID(), "viewProjMatrix");
+
+	for (int c = 0; c < SHADOW_CASCADES; ++c) {
+		const ShadowCascade& cascade = shadowCascades[c];
+
+		glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadowTex, 0, c);
+		glClear(GL_DEPTH_BUFFER_BIT);
+		glUniformMatrix4fv(viewProjLocation, 1, false, (float*)&cascade.viewProj);
+
+		//The casters are sorted by mesh, so each run of the same mesh is one draw
+		const vector<const RenderItem*>& casters = cascade.casters;
+		size_t runStart = 0;
+		while (runStart < casters.size()) {
+			const Mesh* mesh = casters[runStart]->mesh;
+			size_t runEnd = runStart + 1;
+			while (runEnd < casters.size() && casters[runEnd]->mesh == mesh) {
+				runEnd++;
+			}
+			BindMesh((OGLMesh&)*mesh);
+			BindInstances(cascade.instanceStart + runStart);
+			size_t layerCount = mesh->GetSubMeshCount();
+			for (size_t i = 0; i < layerCount; ++i) {
+				DrawBoundMesh((uint32_t)i, (uint32_t)(runEnd - runStart));
+			}
+			runStart = runEnd;
 		}
 	}
 
@@ -190,8 +458,8 @@ void GameTechRenderer::RenderSkybox() {
 	glDisable(GL_BLEND);
 	glDisable(GL_DEPTH_TEST);
 
-	Matrix4 viewMatrix = gameWorld.GetMainCamera().BuildViewMatrix();
-	Matrix4 projMatrix = gameWorld.GetMainCamera().BuildProjectionMatrix(hostWindow.GetScreenAspect());
+	Matrix4 viewMatrix = extractor.GetFrontPacket().camera.BuildViewMatrix();
+	Matrix4 projMatrix = extractor.GetFrontPacket().camera.BuildProjectionMatrix(hostWindow.GetScreenAspect());
 
 	BindShader(*skyboxShader);
 
@@ -214,87 +482,252 @@ void GameTechRenderer::RenderSkybox() {
 	glEnable(GL_DEPTH_TEST);
 }
 
-void GameTechRenderer::RenderCamera() {
-	Matrix4 viewMatrix = gameWorld.GetMainCamera().BuildViewMatrix();
-	Matrix4 projMatrix = gameWorld.GetMainCamera().BuildProjectionMatrix(hostWindow.GetScreenAspect());
+GameTechRenderer::ShaderUniforms& GameTechRenderer::GetShaderUniforms(const OGLShader& shader) {
+	auto i = shaderUniforms.find(shader.GetProgramID());
+	if (i != shaderUniforms.end()) {
+		return i->second;
+	}
+	GLuint program = shader.GetProgramID();
+	ShaderUniforms u;
+	u.projLocation			= glGetUniformLocation(program, "projMatrix");
+	u.viewLocation			= glGetUniformLocation(program, "viewMatrix");
+	u.shadowMatricesLocation	= glGetUniformLocation(program, "shadowMatrices");
+	u.cascadeDepthsLocation		= glGetUniformLocation(program, "cascadeDepths");
+	u.hasVColLocation		= glGetUniformLocation(program, "hasVertexColours");
+	u.hasTexLocation		= glGetUniformLocation(program, "hasTexture");
+
+	u.lightPosLocation		= glGetUniformLocation(program, "lightPos");
+	u.lightColourLocation	= glGetUniformLocation(program, "lightColour");
+	u.lightRadiusLocation	= glGetUniformLocation(program, "lightRadius");
+
+	u.cameraLocation		= glGetUniformLocation(program, "cameraPos");
+	u.shadowTexLocation		= glGetUniformLocation(program, "shadowTex");
+	u.mainTexLocation		= glGetUniformLocation(program, "mainTex");
+	u.lastFrameSet			= -1;
+
+	return shaderUniforms.insert({ program, u }).first->second;
+}
+
+GameTechRenderer::ShaderUniforms& GameTechRenderer::BindSceneShader(const OGLShader& shader) {
+	BindShader(shader);
+	ShaderUniforms& uniforms = GetShaderUniforms(shader);
+
+	if (uniforms.lastFrameSet != frameCount) {
+		glUniform3fv(uniforms.cameraLocation, 1, &sceneValues.cameraPos.x);
 
-	OGLShader* activeShader = nullptr;
-	int projLocation	= 0;
-	int viewLocation	= 0;
-	int modelLocation	= 0;
-	int colourLocation  = 0;
-	int hasVColLocation = 0;
-	int hasTexLocation  = 0;
-	int shadowLocation  = 0;
+		glUniformMatrix4fv(uniforms.projLocation, 1, false, (float*)&sceneValues.projMatrix);
+		glUniformMatrix4fv(uniforms.viewLocation, 1, false, (float*)&sceneValues.viewMatrix);
+		glUniformMatrix4fv(uniforms.shadowMatricesLocation, SHADOW_CASCADES, false, (float*)sceneValues.shadowMatrices);
+		glUniform1fv(uniforms.cascadeDepthsLocation, SHADOW_CASCADES, sceneValues.cascadeDepths);
 
-	int lightPosLocation	= 0;
-	int lightColourLocation = 0;
-	int lightRadiusLocation = 0;
+		glUniform3fv(uniforms.lightPosLocation		, 1, (float*)&lightPosition);
+		glUniform4fv(uniforms.lightColourLocation	, 1, (float*)&lightColour);
+		glUniform1f(uniforms.lightRadiusLocation	, lightRadius);
 
-	int cameraLocation = 0;
+		glUniform1i(uniforms.shadowTexLocation, 1);
+		glUniform1i(uniforms.mainTexLocation, 0);
+
+		uniforms.lastFrameSet = frameCount;
+	}
+	return uniforms;
+}
+
+void GameTechRenderer::RenderCamera() {
+	const PerspectiveCamera& camera = extractor.GetFrontPacket().camera;
+
+	sceneValues.viewMatrix	= camera.BuildViewMatrix();
+	sceneValues.projMatrix	= camera.BuildProjectionMatrix(hostWindow.GetScreenAspect());
+	sceneValues.cameraPos	= camera.GetPosition();
+	for (int c = 0; c < SHADOW_CASCADES; ++c) {
+		sceneValues.shadowMatrices[c]	= shadowCascades[c].shadowMatrix;
+		sceneValues.cascadeDepths[c]	= shadowCascades[c].farDepth;
+	}
+
+	frameCount++;
+
+	ShaderUniforms* uniforms = nullptr;
 
 	//TODO - PUT IN FUNCTION
 	glActiveTexture(GL_TEXTURE0 + 1);
-	glBindTexture(GL_TEXTURE_2D, shadowTex);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, shadowTex);
+	glActiveTexture(GL_TEXTURE0);
 
-	for (const auto&i : activeObjects) {
-		OGLShader* shader = (OGLShader*)(*i).GetShader();
-		BindShader(*shader);
+	//Only opaque objects are drawn this way, so they go before the queue's transparent ones
+	if (gpuDrivenDraws) {
+		RenderIndirectDraws();
+	}
+
+	//The queue has already worked out which binds each draw actually needs, and
+	//any following commands that need nothing binding are drawn as instances
+	const vector<RenderCommand>& commands = cameraQueue.GetCommands();
+	size_t runStart = 0;
+	while (runStart < commands.size()) {
+		const RenderCommand& command = commands[runStart];
+		const RenderItem& o = *command.object;
 
-		if ((*i).GetDefaultTexture()) {
-			BindTextureToShader(*(OGLTexture*)(*i).GetDefaultTexture(), "mainTex", 0);
+		if (command.changes & RenderQueue::ShaderChange) {
+			uniforms = &BindSceneShader(*(OGLShader*)o.shader);
 		}
 
-		if (activeShader != shader) {
-			projLocation	= glGetUniformLocation(shader->GetProgramID(), "projMatrix");
-			viewLocation	= glGetUniformLocation(shader->GetProgramID(), "viewMatrix");
-			modelLocation	= glGetUniformLocation(shader->GetProgramID(), "modelMatrix");
-			shadowLocation  = glGetUniformLocation(shader->GetProgramID(), "shadowMatrix");
-			colourLocation  = glGetUniformLocation(shader->GetProgramID(), "objectColour");
-			hasVColLocation = glGetUniformLocation(shader->GetProgramID(), "hasVertexColours");
-			hasTexLocation  = glGetUniformLocation(shader->GetProgramID(), "hasTexture");
+		if (command.changes & (RenderQueue::TextureChange | RenderQueue::ShaderChange)) {
+			if (o.texture) {
+				glBindTexture(GL_TEXTURE_2D, ((OGLTexture*)o.texture)->GetObjectID());
+			}
+			glUniform1i(uniforms->hasTexLocation, o.texture ? 1 : 0);
+		}
 
-			lightPosLocation	= glGetUniformLocation(shader->GetProgramID(), "lightPos");
-			lightColourLocation = glGetUniformLocation(shader->GetProgramID(), "lightColour");
-			lightRadiusLocation = glGetUniformLocation(shader->GetProgramID(), "lightRadius");
+		if (command.changes & RenderQueue::MeshChange) {
+			BindMesh((OGLMesh&)*o.mesh);
+		}
+		if (command.changes & (RenderQueue::MeshChange | RenderQueue::ShaderChange)) {
+			glUniform1i(uniforms->hasVColLocation, !o.mesh->GetColourData().empty());
+		}
 
-			cameraLocation = glGetUniformLocation(shader->GetProgramID(), "cameraPos");
+		size_t runEnd = runStart + 1;
+		while (runEnd < commands.size() && commands[runEnd].changes == 0) {
+			runEnd++;
+		}
+		BindInstances(cameraInstanceStart + runStart);
 
-			Vector3 camPos = gameWorld.GetMainCamera().GetPosition();
-			glUniform3fv(cameraLocation, 1, &camPos.x);
+		size_t layerCount = o.mesh->GetSubMeshCount();
+		for (size_t i = 0; i < layerCount; ++i) {
+			DrawBoundMesh((uint32_t)i, (uint32_t)(runEnd - runStart));
+		}
+		runStart = runEnd;
+	}
+}
 
-			glUniformMatrix4fv(projLocation, 1, false, (float*)&projMatrix);
-			glUniformMatrix4fv(viewLocation, 1, false, (float*)&viewMatrix);
+void GameTechRenderer::SetGPUDrivenDraws(bool state) {
+	gpuDrivenDraws = state && CreateIndirectResources();
+}
 
-			glUniform3fv(lightPosLocation	, 1, (float*)&lightPosition);
-			glUniform4fv(lightColourLocation, 1, (float*)&lightColour);
-			glUniform1f(lightRadiusLocation , lightRadius);
+/*
+The indirect path needs compute shaders and storage buffers to cull, multi
+draw indirect to draw, and DSA to fill its buffers - all core by 4.5, but the
+renderer only insists on 4.3, so the extensions are checked for too. Nothing
+is created until the path is first turned on.
+*/
+bool GameTechRenderer::CreateIndirectResources() {
+	if (cullShader) {
+		return true;
+	}
+	bool supported = GLAD_GL_VERSION_4_5 || (
+		(GLAD_GL_VERSION_4_3 || (GLAD_GL_ARB_compute_shader && GLAD_GL_ARB_shader_storage_buffer_object && GLAD_GL_ARB_multi_draw_indirect))
+		&& GLAD_GL_ARB_direct_state_access);
 
-			int shadowTexLocation = glGetUniformLocation(shader->GetProgramID(), "shadowTex");
-			glUniform1i(shadowTexLocation, 1);
+	if (!supported) {
+		std::cout << __FUNCTION__ << " Device can't do GPU driven draws, leaving them off!\n";
+		return false;
+	}
+	cullShader = new OGLComputeShader("cullObjects.comp");
+	glCreateBuffers(1, &objectBuffer);
+	glCreateBuffers(1, &commandBuffer);
+	glCreateBuffers(1, &visibleBuffer);
+	return true;
+}
 
-			activeShader = shader;
+/*
+Brings the GPU's copy of the object slots up to date, uploading only the ones
+the layout says have changed, and resets the draw commands' instance counts.
+The cull shader then fills in the counts and the visible instances; it's
+dispatched before the shadow map is drawn, so it has time to finish before
+the camera's draws need what it wrote.
+*/
+void GameTechRenderer::UpdateIndirectDraws() {
+	const FramePacket& packet = extractor.GetFrontPacket();
+	indirectLayout.Update(packet);
+
+	const vector<IndirectDrawLayout::ObjectRecord>& objects		= indirectLayout.GetObjects();
+	const vector<IndirectDrawLayout::DrawCommand>&	commands	= indirectLayout.GetCommands();
+
+	size_t objectBytes	= objects.size() * sizeof(IndirectDrawLayout::ObjectRecord);
+	size_t commandBytes	= commands.size() * sizeof(IndirectDrawLayout::DrawCommand);
+
+	if (ReserveBuffer(objectBuffer, objectBufferSize, objectBytes)) {
+		glNamedBufferSubData(objectBuffer, 0, objectBytes, objects.data());
+	}
+	else {
+		for (const auto& [first, count] : indirectLayout.GetDirtyRanges()) {
+			glNamedBufferSubData(objectBuffer, first * sizeof(IndirectDrawLayout::ObjectRecord), count * sizeof(IndirectDrawLayout::ObjectRecord), &objects[first]);
 		}
+	}
+	ReserveBuffer(commandBuffer, commandBufferSize, commandBytes);
+	glNamedBufferSubData(commandBuffer, 0, commandBytes, commands.data());
+
+	if (indirectLayout.GetInstanceCapacity() == 0) {
+		return;
+	}
+	ReserveBuffer(visibleBuffer, visibleBufferSize, indirectLayout.GetInstanceCapacity() * sizeof(InstanceData));
 
-		Matrix4 modelMatrix = (*i).GetTransform()->GetMatrix();
-		glUniformMatrix4fv(modelLocation, 1, false, (float*)&modelMatrix);			
-		
-		Matrix4 fullShadowMat = shadowMatrix * modelMatrix;
-		glUniformMatrix4fv(shadowLocation, 1, false, (float*)&fullShadowMat);
+	Matrix4 viewMatrix = packet.camera.BuildViewMatrix();
+	Matrix4 projMatrix = packet.camera.BuildProjectionMatrix(hostWindow.GetScreenAspect());
+	Frustum cameraFrustum = Frustum::FromViewProjMatrix(projMatrix * viewMatrix);
 
-		Vector4 colour = i->GetColour();
-		glUniform4fv(colourLocation, 1, &colour.x);
+	Vector4 planes[6];
+	for (int p = 0; p < 6; ++p) {
+		const Plane& plane = cameraFrustum.GetPlane(p);
+		planes[p] = Vector4(plane.GetNormal(), plane.GetDistance());
+	}
 
-		glUniform1i(hasVColLocation, !(*i).GetMesh()->GetColourData().empty());
+	cullShader->Bind();
+	glUniform4fv(glGetUniformLocation(cullShader->GetProgramID(), "frustumPlanes"), 6, (float*)planes);
+	glUniform1ui(glGetUniformLocation(cullShader->GetProgramID(), "objectCount"), (GLuint)objects.size());
 
-		glUniform1i(hasTexLocation, (OGLTexture*)(*i).GetDefaultTexture() ? 1:0);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CULL_OBJECT_BINDING	, objectBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CULL_COMMAND_BINDING	, commandBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CULL_INSTANCE_BINDING	, visibleBuffer);
 
-		BindMesh((OGLMesh&)*(*i).GetMesh());
-		size_t layerCount = (*i).GetMesh()->GetSubMeshCount();
-		for (size_t i = 0; i < layerCount; ++i) {
-			DrawBoundMesh((uint32_t)i);
+	GLuint groupSize = cullShader->GetThreadGroupSize().x;
+	cullShader->Execute(((GLuint)objects.size() + groupSize - 1) / groupSize);
+
+	//The draws read what the cull wrote as their indirect commands and instanced attributes
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+	cullShader->Unbind();
+}
+
+/*
+Each group is a single multi draw call, with a command per sub mesh. The
+commands' base instances point the instanced attributes at the group's own
+part of the visible instances, and their counts are however many the cull
+found, which may well be none.
+*/
+void GameTechRenderer::RenderIndirectDraws() {
+	if (indirectLayout.GetInstanceCapacity() == 0) {
+		return;
+	}
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+
+	const vector<IndirectDrawLayout::DrawGroup>& groups = indirectLayout.GetGroups();
+	ShaderUniforms* uniforms	= nullptr;
+	const Shader*	lastShader	= nullptr;
+	const Texture*	lastTexture	= nullptr;
+
+	for (uint32_t g : indirectLayout.GetGroupOrder()) {
+		const IndirectDrawLayout::DrawGroup& group = groups[g];
+		if (group.objectCount == 0) {
+			continue;
 		}
+		bool shaderChange = !uniforms || group.shader != lastShader;
+		if (shaderChange) {
+			uniforms	= &BindSceneShader(*(OGLShader*)group.shader);
+			lastShader	= group.shader;
+		}
+		if (shaderChange || group.texture != lastTexture) {
+			if (group.texture) {
+				glBindTexture(GL_TEXTURE_2D, ((OGLTexture*)group.texture)->GetObjectID());
+			}
+			glUniform1i(uniforms->hasTexLocation, group.texture ? 1 : 0);
+			lastTexture = group.texture;
+		}
+		BindMesh((OGLMesh&)*group.mesh);
+		glUniform1i(uniforms->hasVColLocation, !group.mesh->GetColourData().empty());
+		BindInstanceBuffer(visibleBuffer, 0);
+
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+			(const void*)(group.firstCommand * sizeof(IndirectDrawLayout::DrawCommand)),
+			group.commandCount, 0);
 	}
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
 }
 
 Mesh* GameTechRenderer::LoadMesh(const std::string& name) {
@@ -305,14 +738,18 @@ Mesh* GameTechRenderer::LoadMesh(const std::string& name) {
 	return mesh;
 }
 
+Mesh* GameTechRenderer::CreateMesh() {
+	return new OGLMesh();
+}
+
 void GameTechRenderer::NewRenderLines() {
 	const std::vector<Debug::DebugLineEntry>& lines = Debug::GetDebugLines();
 	if (lines.empty()) {
 		return;
 	}
 
-	Matrix4 viewMatrix = gameWorld.GetMainCamera().BuildViewMatrix();
-	Matrix4 projMatrix = gameWorld.GetMainCamera().BuildProjectionMatrix(hostWindow.GetScreenAspect());
+	Matrix4 viewMatrix = extractor.GetFrontPacket().camera.BuildViewMatrix();
+	Matrix4 projMatrix = extractor.GetFrontPacket().camera.BuildProjectionMatrix(hostWindow.GetScreenAspect());
 	
 	Matrix4 viewProj  = projMatrix * viewMatrix;
 
@@ -323,19 +760,16 @@ void GameTechRenderer::NewRenderLines() {
 
 	glUniformMatrix4fv(matSlot, 1, false, (float*)viewProj.array);
 
-	debugLineData.clear();
-
-	size_t frameLineCount = lines.size() * 2;
-
-	SetDebugLineBufferSizes(frameLineCount);
-
-	glBindBuffer(GL_ARRAY_BUFFER, lineVertVBO);
-	glBufferSubData(GL_ARRAY_BUFFER, 0, lines.size() * sizeof(Debug::DebugLineEntry), lines.data());
-	
+	size_t lineBytes = lines.size() * sizeof(Debug::DebugLineEntry);
+	memcpy(lineBuffer->Begin(lineBytes), lines.data(), lineBytes);
+	lineBuffer->Flush();
 
 	glBindVertexArray(lineVAO);
-	glDrawArrays(GL_LINES, 0, (GLsizei)frameLineCount);
+	glBindVertexBuffer(0, lineBuffer->GetBufferID(), lineBuffer->GetOffset(), sizeof(Debug::DebugLineEntry) / 2);
+	glDrawArrays(GL_LINES, 0, (GLsizei)lines.size() * 2);
 	glBindVertexArray(0);
+
+	lineBuffer->End();
 }
 
 void GameTechRenderer::NewRenderText() {
@@ -364,104 +798,35 @@ void GameTechRenderer::NewRenderText() {
 	GLuint texSlot = glGetUniformLocation(debugShader->GetProgramID(), "useTexture");
 	glUniform1i(texSlot, 1);
 
-	debugTextPos.clear();
-	debugTextColours.clear();
-	debugTextUVs.clear();
-
-	int frameVertCount = 0;
+	int maxVertCount = 0;
 	for (const auto& s : strings) {
-		frameVertCount += Debug::GetDebugFont()->GetVertexCountForString(s.data);
+		maxVertCount += Debug::GetDebugFont()->GetVertexCountForString(s.data);
 	}
-	SetDebugStringBufferSizes(frameVertCount);
+	SimpleFont::InterleavedTextVertex* verts = (SimpleFont::InterleavedTextVertex*)textBuffer->Begin(maxVertCount * sizeof(SimpleFont::InterleavedTextVertex));
 
+	int frameVertCount = 0;
 	for (const auto& s : strings) {
 		float size = 20.0f;
-		Debug::GetDebugFont()->BuildVerticesForString(s.data, s.position, s.colour, size, debugTextPos, debugTextUVs, debugTextColours);
+		frameVertCount += Debug::GetDebugFont()->BuildVerticesForString(s.data, s.position, s.colour, size, verts + frameVertCount);
 	}
-
-	glBindBuffer(GL_ARRAY_BUFFER, textVertVBO);
-	glBufferSubData(GL_ARRAY_BUFFER, 0, frameVertCount * sizeof(Vector3), debugTextPos.data());
-	glBindBuffer(GL_ARRAY_BUFFER, textColourVBO);
-	glBufferSubData(GL_ARRAY_BUFFER, 0, frameVertCount * sizeof(Vector4), debugTextColours.data());
-	glBindBuffer(GL_ARRAY_BUFFER, textTexVBO);
-	glBufferSubData(GL_ARRAY_BUFFER, 0, frameVertCount * sizeof(Vector2), debugTextUVs.data());
+	textBuffer->Flush();
 
 	glBindVertexArray(textVAO);
+	glBindVertexBuffer(0, textBuffer->GetBufferID(), textBuffer->GetOffset(), sizeof(SimpleFont::InterleavedTextVertex));
 	glDrawArrays(GL_TRIANGLES, 0, frameVertCount);
 	glBindVertexArray(0);
+
+	textBuffer->End();
 }
  
 Texture* GameTechRenderer::LoadTexture(const std::string& name) {
 	return OGLTexture::TextureFromFile(name).release();
 }
 
-Shader* GameTechRenderer::LoadShader(const std::string& vertex, const std::string& fragment) {
-	return new OGLShader(vertex, fragment);
+Texture* GameTechRenderer::CreateTexture(const TextureData::MipChain& chain) {
+	return OGLTexture::TextureFromMipChain(chain).release();
 }
 
-void GameTechRenderer::SetDebugStringBufferSizes(size_t newVertCount) {
-	if (newVertCount > textCount) {
-		textCount = newVertCount;
-
-		glBindBuffer(GL_ARRAY_BUFFER, textVertVBO);
-		glBufferData(GL_ARRAY_BUFFER, textCount * sizeof(Vector3), nullptr, GL_DYNAMIC_DRAW);
-
-		glBindBuffer(GL_ARRAY_BUFFER, textColourVBO);
-		glBufferData(GL_ARRAY_BUFFER, textCount * sizeof(Vector4), nullptr, GL_DYNAMIC_DRAW);
-
-		glBindBuffer(GL_ARRAY_BUFFER, textTexVBO);
-		glBufferData(GL_ARRAY_BUFFER, textCount * sizeof(Vector2), nullptr, GL_DYNAMIC_DRAW);
-
-		debugTextPos.reserve(textCount);
-		debugTextColours.reserve(textCount);
-		debugTextUVs.reserve(textCount);
-
-		glBindVertexArray(textVAO);
-
-		glVertexAttribFormat(0, 3, GL_FLOAT, false, 0);
-		glVertexAttribBinding(0, 0);
-		glBindVertexBuffer(0, textVertVBO, 0, sizeof(Vector3));
-
-		glVertexAttribFormat(1, 4, GL_FLOAT, false, 0);
-		glVertexAttribBinding(1, 1);
-		glBindVertexBuffer(1, textColourVBO, 0, sizeof(Vector4));
-
-		glVertexAttribFormat(2, 2, GL_FLOAT, false, 0);
-		glVertexAttribBinding(2, 2);
-		glBindVertexBuffer(2, textTexVBO, 0, sizeof(Vector2));
-
-		glEnableVertexAttribArray(0);
-		glEnableVertexAttribArray(1);
-		glEnableVertexAttribArray(2);
-
-		glBindVertexArray(0);
-	}
+Shader* GameTechRenderer::LoadShader(const std::string& vertex, const std::string& fragment) {
+	return new OGLShader(vertex, fragment);
 }
-
-void GameTechRenderer::SetDebugLineBufferSizes(size_t newVertCount) {
-	if (newVertCount > lineCount) {
-		lineCount = newVertCount;
-
-		glBindBuffer(GL_ARRAY_BUFFER, lineVertVBO);
-		glBufferData(GL_ARRAY_BUFFER, lineCount * sizeof(Debug::DebugLineEntry), nullptr, GL_DYNAMIC_DRAW);
-
-		debugLineData.reserve(lineCount);
-
-		glBindVertexArray(lineVAO);
-
-		int realStride = sizeof(Debug::DebugLineEntry) / 2;
-
-		glVertexAttribFormat(0, 3, GL_FLOAT, false, offsetof(Debug::DebugLineEntry, start));
-		glVertexAttribBinding(0, 0);
-		glBindVertexBuffer(0, lineVertVBO, 0, realStride);
-
-		glVertexAttribFormat(1, 4, GL_FLOAT, false, offsetof(Debug::DebugLineEntry, colourA));
-		glVertexAttribBinding(1, 0);
-		glBindVertexBuffer(1, lineVertVBO, sizeof(Vector4), realStride);
-
-		glEnableVertexAttribArray(0);
-		glEnableVertexAttribArray(1);
-
-		glBindVertexArray(0);
-	}
-}
\ No newline at end of file
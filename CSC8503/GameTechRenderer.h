@@ -3,24 +3,47 @@
 #include "OGLShader.h"
 #include "OGLTexture.h"
 #include "OGLMesh.h"
+#include "OGLStreamBuffer.h"
+#include "OGLComputeShader.h"
 
 #include "GameWorld.h"
+#include "FrustumCuller.h"
+#include "RenderQueue.h"
+#include "FramePacket.h"
+#include "IndirectDrawLayout.h"
 
 namespace NCL {
 	class Maths::Vector3;
 	class Maths::Vector4;
 	namespace CSC8503 {
-		class RenderObject;
-
 		class GameTechRenderer : public OGLRenderer	{
 		public:
 			GameTechRenderer(GameWorld& world);
 			~GameTechRenderer();
 
 			Mesh*		LoadMesh(const std::string& name);
+			//An empty mesh for this API, for the caller to fill in and upload
+			Mesh*		CreateMesh();
 			Texture*	LoadTexture(const std::string& name);
+			//A texture made from every one of its already loaded mip levels
+			Texture*	CreateTexture(const TextureData::MipChain& chain);
 			Shader*		LoadShader(const std::string& vertex, const std::string& fragment);
 
+			//Copies what's needed to draw the world into the next frame packet - call once the simulation
+			//step is done, along with the debug lines and text every thread has drawn during it.
+			//Everything after this only reads the packet, never the world's objects
+			void ExtractFrame();
+			void SetJobSystem(JobSystem* j) {
+				jobs = j;
+			}
+
+			//Opaque objects are culled by a compute shader and drawn with one indirect draw per group.
+			//Stays off if the context can't do compute, multi draw indirect and DSA buffers
+			void SetGPUDrivenDraws(bool state);
+			bool GetGPUDrivenDraws() const {
+				return gpuDrivenDraws;
+			}
+
 		protected:
 			void NewRenderLines();
 			void NewRenderText();
@@ -32,17 +55,103 @@ namespace NCL {
 			GameWorld&	gameWorld;
 
 			void BuildObjectList();
+			void CullObjectList();
+			void FitShadowCascades();
 			void SortObjectList();
+			void BuildInstanceData();
 			void RenderShadowMap();
 			void RenderCamera(); 
+			bool CreateIndirectResources();
+			void UpdateIndirectDraws();
+			void RenderIndirectDraws();
 			void RenderSkybox();
 
 			void LoadSkybox();
 
-			void SetDebugStringBufferSizes(size_t newVertCount);
-			void SetDebugLineBufferSizes(size_t newVertCount);
-
-			vector<const RenderObject*> activeObjects;
+			//Uniform locations are looked up once per shader program, rather than every time it's bound
+			struct ShaderUniforms {
+				int projLocation;
+				int viewLocation;
+				int shadowMatricesLocation;
+				int cascadeDepthsLocation;
+				int hasVColLocation;
+				int hasTexLocation;
+				int lightPosLocation;
+				int lightColourLocation;
+				int lightRadiusLocation;
+				int cameraLocation;
+				int shadowTexLocation;
+				int mainTexLocation;
+				int lastFrameSet;	//per frame values only need setting once per program
+			};
+			ShaderUniforms& GetShaderUniforms(const OGLShader& shader);
+			//Binds a shader for drawing the scene, setting its per frame values if it's the first time this frame
+			ShaderUniforms& BindSceneShader(const OGLShader& shader);
+
+			//Per object values, read by the vertex shaders as instanced attributes
+			struct InstanceData {
+				Matrix4 modelMatrix;
+				Vector4 colour;
+			};
+			//Points the bound mesh's instanced attributes at this frame's instances, starting from the given one
+			void BindInstances(size_t firstInstance);
+			void BindInstanceBuffer(GLuint buffer, size_t offset);
+
+			RenderExtractor	extractor;
+			JobSystem*		jobs;
+
+			FrustumCuller	objectBounds;		//one box per item in the front frame packet
+			FrustumCuller	staticBounds;		//one box per static item, only rebuilt when they change
+			uint64_t		staticBoundsVersion;
+			vector<int>		cullIndices;
+			vector<const RenderItem*> cameraObjects;	//visible to the main camera
+
+			static const int SHADOW_CASCADES = 3;	//must match scene.frag
+
+			//Values every scene shader gets, set once per frame by RenderCamera
+			struct SceneValues {
+				Matrix4	viewMatrix;
+				Matrix4	projMatrix;
+				Vector3	cameraPos;
+				Matrix4	shadowMatrices[SHADOW_CASCADES];
+				float	cascadeDepths[SHADOW_CASCADES];
+			};
+			SceneValues		sceneValues;
+
+			//One slice of the camera's view, with its own layer of the shadow map fitted around it
+			struct ShadowCascade {
+				Matrix4		viewProj;
+				Matrix4		shadowMatrix;	//viewProj, mapped into texture space for the scene shaders
+				Matrix4		cullViewProj;	//fitted tightly around the slice, for finding casters
+				float		farDepth;		//how far from the camera the cascade reaches
+
+				vector<const RenderItem*>	casters;	//sorted by mesh
+				size_t						instanceStart;
+
+				//static casters only need culling again if the cascade or the statics change
+				vector<int>	staticCasters;
+				Matrix4		staticCullMatrix;
+				uint64_t	staticCullVersion;
+			};
+			ShadowCascade	shadowCascades[SHADOW_CASCADES];
+
+			RenderQueue	cameraQueue;
+			std::unordered_map<GLuint, ShaderUniforms> shaderUniforms;
+			int			frameCount;
+
+			OGLStreamBuffer*	instanceBuffer;	//each cascade's instances, followed by the camera's
+			size_t				cameraInstanceStart;
+
+			//GPU driven drawing things
+			bool				gpuDrivenDraws;
+			IndirectDrawLayout	indirectLayout;
+			OGLComputeShader*	cullShader;			//these are only created the first time the path is turned on
+			GLuint				objectBuffer;		//an IndirectDrawLayout::ObjectRecord per slot
+			GLuint				commandBuffer;		//IndirectDrawLayout::DrawCommands, counted up by the cull
+			GLuint				visibleBuffer;		//InstanceData for every visible object, written by the cull
+			size_t				objectBufferSize;
+			size_t				commandBufferSize;
+			size_t				visibleBufferSize;
 
 			OGLShader*  debugShader;
 			OGLShader*  skyboxShader;
@@ -51,30 +160,19 @@ namespace NCL {
 
 			//shadow mapping things
 			OGLShader*	shadowShader;
-			GLuint		shadowTex;
+			GLuint		shadowTex;		//array texture, one layer per cascade
 			GLuint		shadowFBO;
-			Matrix4     shadowMatrix;
 
 			Vector4		lightColour;
 			float		lightRadius;
 			Vector3		lightPosition;
 
 			//Debug data storage things
-			vector<Vector3> debugLineData;
-
-			vector<Vector3> debugTextPos;
-			vector<Vector4> debugTextColours;
-			vector<Vector2> debugTextUVs;
-
-			GLuint lineVAO;
-			GLuint lineVertVBO;
-			size_t lineCount;
+			GLuint				lineVAO;
+			OGLStreamBuffer*	lineBuffer;
 
-			GLuint textVAO;
-			GLuint textVertVBO;
-			GLuint textColourVBO;
-			GLuint textTexVBO;
-			size_t textCount;
+			GLuint				textVAO;
+			OGLStreamBuffer*	textBuffer;	//interleaved SimpleFont vertices
 		};
 	}
 }
@@ -22,6 +22,7 @@ GameTechVulkanRenderer::GameTechVulkanRenderer(GameWorld& world) : VulkanRendere
 	majorVersion = 1;
 	minorVersion = 3;
 	autoBeginDynamicRendering = false;
+	jobs = nullptr;
 }
 
 GameTechVulkanRenderer::~GameTechVulkanRenderer() {
@@ -273,10 +274,11 @@ void GameTechVulkanRenderer::RenderFrame() {
 	frameData.lightColour	= Vector4(0.8f, 0.8f, 0.5f, 1.0f);
 	frameData.lightRadius	= 1000.0f;
 	frameData.lightPosition = Vector3(-100.0f, 60.0f, -100.0f);
-	frameData.cameraPos		= gameWorld.GetMainCamera().GetPosition();
+	const PerspectiveCamera& camera = extractor.GetFrontPacket().camera;
+	frameData.cameraPos		= camera.GetPosition();
 
-	frameData.viewMatrix	= gameWorld.GetMainCamera().BuildViewMatrix();
-	frameData.projMatrix	= gameWorld.GetMainCamera().BuildProjectionMatrix(hostWindow.GetScreenAspect());
+	frameData.viewMatrix	= camera.BuildViewMatrix();
+	frameData.projMatrix	= camera.BuildProjectionMatrix(hostWindow.GetScreenAspect());
 	frameData.orthoMatrix	= Matrix4::Orthographic(0.0, 100.0f, 100, 0, -1.0f, 1.0f);
 	frameData.shadowMatrix  =	Matrix4::Perspective(50.0f, 500.0f, 1, 45.0f) * 
 								Matrix4::BuildViewMatrix(frameData.lightPosition, Vector3(0, 0, 0), Vector3(0, 1, 0));
@@ -342,46 +344,49 @@ void GameTechVulkanRenderer::RenderFrame() {
 	currentFrame = &allFrames[currentFrameIndex];
 }
 
+void GameTechVulkanRenderer::ExtractFrame() {
+	extractor.Extract(gameWorld, jobs);
+	Debug::Flush();
+}
+
+/*
+Objects are written out grouped by mesh, so that RenderSceneObjects can draw
+each group as instances reading consecutive object states. Textures are looked
+up per object state, so they don't need to split a group.
+*/
 void GameTechVulkanRenderer::UpdateObjectList() {
 	activeObjects.clear();
 
-	int objectCount = 0;
+	const FramePacket& packet = extractor.GetFrontPacket();
+	for (const RenderItem& item : packet.items) {
+		activeObjects.emplace_back(&item);
+	}
+	for (const RenderItem& item : packet.staticItems) {
+		activeObjects.emplace_back(&item);
+	}
 
-	gameWorld.OperateOnContents(
-		[&](GameObject* o) {
-			if (o->IsActive()) {
-				objectCount++;
-			}
+	std::sort(activeObjects.begin(), activeObjects.end(),
+		[](const RenderItem* a, const RenderItem* b) {
+			return a->mesh < b->mesh;
 		}
 	);
 
 	VulkanMesh* pipeMesh = nullptr;
-	int at = 0;
-	gameWorld.OperateOnContents(
-		[&](GameObject* o) {
-			if (o->IsActive()) {
-				RenderObject* g = o->GetRenderObject();
-				if (g) {
-					activeObjects.emplace_back(g);
-
-					ObjectState state;
-					state.modelMatrix = g->GetTransform()->GetMatrix();
-					state.colour = g->GetColour();
-					state.index[0] = 0;
-					if (g->GetMesh()) {
-						pipeMesh = (VulkanMesh*)g->GetMesh();
-					}
-					if (g->GetDefaultTexture()) {
-						VulkanTexture* t = (VulkanTexture*)g->GetDefaultTexture();
-						state.index[0] = t->GetAssetID();
-					}
-					currentFrame->WriteData<ObjectState>(state);
-					currentFrame->debugLinesOffset += sizeof(ObjectState);
-					at++;
-				}
-			}
+	for (const RenderItem* g : activeObjects) {
+		ObjectState state;
+		state.modelMatrix = g->modelMatrix;
+		state.colour = g->colour;
+		state.index[0] = 0;
+		if (g->mesh) {
+			pipeMesh = (VulkanMesh*)g->mesh;
 		}
-	);
+		if (g->texture) {
+			VulkanTexture* t = (VulkanTexture*)g->texture;
+			state.index[0] = t->GetAssetID();
+		}
+		currentFrame->WriteData<ObjectState>(state);
+		currentFrame->debugLinesOffset += sizeof(ObjectState);
+	}
 	if (pipeMesh && !scenePipeline.pipeline) {
 		BuildScenePipelines(pipeMesh);
 	}
@@ -407,17 +412,16 @@ void GameTechVulkanRenderer::UpdateDebugData() {
 	currentFrame->WriteData((void*)lines.data(), (size_t)currentFrame->lineVertCount * lineStride);
 
 	currentFrame->debugTextOffset = currentFrame->bytesWritten;
-	std::vector< NCL::Rendering::SimpleFont::InterleavedTextVertex> verts;
 
+	//Written straight into the frame's GPU visible memory
+	currentFrame->textVertCount = 0;
 	for (const auto& s : strings) {
 		float size = 20.0f;
-		Debug::GetDebugFont()->BuildInterleavedVerticesForString(s.data, s.position, s.colour, size, verts);
-		//can now copy to GPU visible mem
-		size_t count = verts.size() * textStride;
-		memcpy(currentFrame->data, verts.data(), count);
+		int written = Debug::GetDebugFont()->BuildVerticesForString(s.data, s.position, s.colour, size, (SimpleFont::InterleavedTextVertex*)currentFrame->data);
+		size_t count = written * textStride;
 		currentFrame->data += count;
 		currentFrame->bytesWritten += count;
-		verts.clear();
+		currentFrame->textVertCount += written;
 	}
 }
 
@@ -431,29 +435,17 @@ void GameTechVulkanRenderer::RenderSceneObjects(VulkanPipeline& pipe, vk::Comman
 	cmds.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, *pipe.layout, 0, 1, &*currentFrame->dataDescriptor, 0, nullptr);
 	cmds.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, *pipe.layout, 1, 1, &*objectTextxureDescriptor, 0, nullptr);
 
-	VulkanMesh* activeMesh = (VulkanMesh*)activeObjects[0]->GetMesh();
-	int count = 1;
+	//activeObjects is sorted by mesh, so each run of the same mesh is one draw
 	int startingIndex = 0;
-
-	for (int i = 1; i < activeObjects.size(); ++i) {
-		VulkanMesh* objectMesh = (VulkanMesh*)activeObjects[i]->GetMesh();
-		int increment = 1;
-		//The new mesh is different than previous meshes, flush out the old list
-		if (activeMesh != objectMesh) {
-			cmds.pushConstants(*pipe.layout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(uint32_t), (void*)&startingIndex);
-			DrawMesh(cmds, *activeMesh, count);
-			activeMesh = objectMesh;
-			count = 1;
-			startingIndex = i;
-			increment = 0;
-		}
-		if (i == activeObjects.size()-1) {
-			cmds.pushConstants(*pipe.layout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(uint32_t), (void*)&startingIndex);
-			DrawMesh(cmds, *objectMesh, count);
-		}
-		else {
-			count += increment;
+	while (startingIndex < activeObjects.size()) {
+		VulkanMesh* activeMesh = (VulkanMesh*)activeObjects[startingIndex]->mesh;
+		int count = 1;
+		while (startingIndex + count < activeObjects.size() && activeObjects[startingIndex + count]->mesh == activeMesh) {
+			count++;
 		}
+		cmds.pushConstants(*pipe.layout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(uint32_t), (void*)&startingIndex);
+		DrawMesh(cmds, *activeMesh, count);
+		startingIndex += count;
 	}
 }
 
@@ -518,6 +510,10 @@ Mesh* GameTechVulkanRenderer::LoadMesh(const string& name) {
 	return newMesh;
 }
 
+Mesh* GameTechVulkanRenderer::CreateMesh() {
+	return new VulkanMesh();
+}
+
 Texture* GameTechVulkanRenderer::LoadTexture(const string& name) {
 	VulkanTexture* t = TextureBuilder(GetDevice(), GetMemoryAllocator())
 		.WithPool(GetCommandPool(CommandBuffer::Graphics))
@@ -3,6 +3,7 @@
 #include "VulkanRenderer.h"
 #include "VulkanMesh.h"
 #include "GameWorld.h"
+#include "FramePacket.h"
 
 namespace NCL::Rendering {
 	class TextureBase;
@@ -16,9 +17,18 @@ namespace NCL::Rendering {
 		void		InitStructures();
 
 		Mesh*		LoadMesh(const string& name);
+		//An empty mesh for this API, for the caller to fill in and upload
+		Mesh*		CreateMesh();
 		Texture*	LoadTexture(const string& name);
 		Shader*		LoadShader(const string& vertex, const string& fragment);
 
+		//Copies what's needed to draw the world into the next frame packet, and gathers up the
+		//debug draws from every thread, once the simulation step is done
+		void ExtractFrame();
+		void SetJobSystem(JobSystem* j) {
+			jobs = j;
+		}
+
 	protected:
 		void SetupDevice(vk::PhysicalDeviceFeatures2& deviceFeatures) override;
 
@@ -109,7 +119,9 @@ namespace NCL::Rendering {
 		Vulkan::UniqueVulkanMesh GenerateQuad();
 
 		GameWorld& gameWorld;
-		vector<const RenderObject*> activeObjects;
+		RenderExtractor	extractor;
+		JobSystem*		jobs;
+		vector<const RenderItem*> activeObjects;
 		int currentFrameIndex;
 
 		VulkanPipeline	skyboxPipeline;
@@ -464,7 +464,12 @@ int tutorial_test() {
 	Window::DestroyGameWindow();
 }
 
-int Coursework()
+/*
+A frame limit of 0 keeps going until the game's over, or the window closes.
+Headless builds have no way to get through the menus, so go straight into a
+round as the server, which runs everything the game would while playing.
+*/
+int Coursework(int frameLimit = 0, bool printStats = false)
 {
 	//TestNetWorking();
 	Window* w = Window::CreateGameWindow("Crazy Goat!", 1920, 1080, false);
@@ -478,11 +483,16 @@ int Coursework()
 	w->ShowConsole(true);
 
 	NetworkedGame* g = new NetworkedGame();
+#ifdef USEHEADLESS
+	g->StartAsServer();
+	g->StartLevel();
+#endif
 
 	bool showConsole = false;
+	int frameCount = 0;
 
 	w->GetTimer().GetTimeDeltaSeconds();
-	while (w->UpdateWindow())
+	while (w->UpdateWindow() && (frameLimit == 0 || frameCount < frameLimit))
 	{
 		float dt = w->GetTimer().GetTimeDeltaSeconds();
 		if (dt > 0.1f) {
@@ -495,14 +505,32 @@ int Coursework()
 		}
 
 		g->UpdateGame(dt);
+		frameCount++;
 		if (g->isGameOver())break;
 	}
+	if (printStats) {
+		g->PrintMemoryStats();
+	}
+	delete g;
 	Window::DestroyGameWindow();
+	return 0;
 }
 
-int main()
+//Run with -frames N to stop after N frames, such as for automated runs, and
+//with -stats to print what the assets and memory pools used on the way out
+int main(int argc, char** argv)
 {
+	int frameLimit = 0;
+	bool printStats = false;
+	for (int i = 1; i < argc; ++i) {
+		if (std::string(argv[i]) == "-frames" && i + 1 < argc) {
+			frameLimit = std::stoi(argv[++i]);
+		}
+		else if (std::string(argv[i]) == "-stats") {
+			printStats = true;
+		}
+	}
 	//TestBehaviourTree();
-	Coursework();
+	Coursework(frameLimit, printStats);
 	//tutorial_test();
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "StateMachine.h"
 #include "StateTransition.h"
 #include "State.h"
+#include "VisibilityGrid.h"
 
 
 using namespace NCL;
@@ -148,18 +149,9 @@ void NetworkPlayer::GameTick(float dt)
 
 void NetworkPlayer::ExcuteBehavioursTree(float dt)
 {
-	if(rootSequence != nullptr)
+	if (behaviourTree != nullptr)
 	{
-		BehaviourState state = rootSequence->Execute(dt);
-		switch (state)
-		{
-		case Success:
-			rootSequence->Reset();
-			break;
-		case Failure:
-			rootSequence->Reset();
-			break;
-		}
+		behaviourTree->Update(*this, behaviourState, dt);
 	}
 }
 
@@ -287,24 +279,57 @@ bool NetworkPlayer::AIMove(Vector3 destination)
 	return false; //have not arrived the destination
 }
 
-NetworkPlayer* NetworkPlayer::AIvision()
+void NetworkPlayer::QueueVision(VisibilityGrid& grid, const vector<GameObject*>& players)
 {
 	Vector3 currentPos = transform.GetPosition();
-	Ray sightLine(currentPos, this->getPlayerForwardVector());
+	Vector3 forward = getPlayerForwardVector();
 
-	//Debug::DrawLine(currentPos, currentPos + getPlayerForwardVector() * 50, Debug::CYAN);
+	visionGrid = &grid;
+	visionFirstQuery = grid.AddCone(currentPos, forward, VisionHalfAngle, VisionRange, VisionConeRays, this);
+	visionQueryCount = VisionConeRays;
 
-	RayCollision closestCollision;
-	GameWorld* world = game->getGameWorld();
-	if (world->Raycast(sightLine, closestCollision, true))
+	// the cone samples can slip past a player, so also look straight at any that are in view
+	// - there are only ever a few players, so they're checked directly rather than searched for
+	float minCos = cos(Maths::DegreesToRadians(VisionHalfAngle));
+	for (GameObject* o : players)
 	{
-		GameObject* hitObject = (GameObject*)closestCollision.node;
-		if (dynamic_cast<NetworkPlayer*>(hitObject))
+		if (o == nullptr || o == this || !o->IsActive())
 		{
-			return (NetworkPlayer*)hitObject;
+			continue;
 		}
+		Vector3 offset = o->GetTransform().GetPosition() - currentPos;
+		float distance = offset.Length();
+		if (distance < 0.001f || distance > VisionRange || Vector3::Dot(offset / distance, forward) < minCos)
+		{
+			continue;
+		}
+		grid.AddTargetRay(currentPos, *o, this);
+		visionQueryCount++;
 	}
-	return nullptr;
+}
+
+NetworkPlayer* NetworkPlayer::AIvision()
+{
+	if (visionGrid == nullptr || visionFirstQuery < 0 ||
+		visionFirstQuery + visionQueryCount > (int)visionGrid->GetResults().size())
+	{
+		return nullptr; // nothing queued this tick
+	}
+	NetworkPlayer* closest = nullptr;
+	float closestDistance = FLT_MAX;
+	for (int i = visionFirstQuery; i < visionFirstQuery + visionQueryCount; ++i)
+	{
+		const SightResult& sight = visionGrid->GetResult(i);
+		if (sight.hitObject && sight.distance < closestDistance)
+		{
+			if (NetworkPlayer* player = dynamic_cast<NetworkPlayer*>(sight.hitObject))
+			{
+				closest = player;
+				closestDistance = sight.distance;
+			}
+		}
+	}
+	return closest;
 }
 
 void NetworkPlayer::UpdateVisualList(float dt)
@@ -402,78 +427,85 @@ void NetworkPlayer::UpdateTimer(float dt)
 
 void NetworkPlayer::CreateUndercoverAgent()
 {
-	BehaviourAction* patrol = new BehaviourAction("Patrol",
-		[&](float dt, BehaviourState state)->BehaviourState
+	behaviourTree = &GetUndercoverAgentTree();
+	behaviourState = behaviourTree->CreateState();
+}
+
+const CompiledBehaviourTree<NetworkPlayer>& NetworkPlayer::GetUndercoverAgentTree()
+{
+	static const CompiledBehaviourTree<NetworkPlayer> tree = []()
+	{
+		BehaviourTreeBuilder<NetworkPlayer> builder;
+		builder.BeginSequence("Root Sequence");
 		{
-			if (state == Initialise)
-			{
-				patrolIndex = 0;
-				state = Ongoing;
-			}
-			else if (state == Ongoing)
-			{
-				if (this->AIMoveTo(patrolPoints[patrolIndex], dt))
+			builder.BeginParallel("Patrol Routine");
+			builder.AddAction("Patrol",
+				[](NetworkPlayer& agent, float dt, BehaviourState state)->BehaviourState
 				{
-					patrolIndex++;
-					patrolIndex = patrolIndex % 4;
+					if (state == Initialise)
+					{
+						agent.patrolIndex = 0;
+						state = Ongoing;
+					}
+					else if (state == Ongoing)
+					{
+						if (agent.AIMoveTo(patrolPoints[agent.patrolIndex], dt))
+						{
+							agent.patrolIndex++;
+							agent.patrolIndex = agent.patrolIndex % 4;
+						}
+						if (agent.targetPlayer != nullptr)
+						{
+							return Success;
+						}
+					}
+					return state;
 				}
-				if (targetPlayer != nullptr)
+			);
+			builder.AddAction("Search Player",
+				[](NetworkPlayer& agent, float dt, BehaviourState state)->BehaviourState
 				{
-					return Success;
+					if (state == Initialise)
+					{
+						state = Ongoing;
+					}
+					else if (state == Ongoing)
+					{
+						agent.UpdateVisualList(dt);
+						if (agent.getVisualTarget() != nullptr)
+						{
+							if (agent.getVisualTarget()->GetPlayerNum() < 4)
+							{
+								agent.targetPlayer = agent.getVisualTarget();
+								return Success;
+							}
+						}
+					}
+					return state;
 				}
-			}
-			return state;
-		}
-	);
+			);
+			builder.End();
 
-	BehaviourAction* searchPlayer = new BehaviourAction("Search Player",
-		[&](float dt, BehaviourState state)->BehaviourState
-		{
-			if (state == Initialise)
-			{
-				state = Ongoing;
-			}
-			else if (state == Ongoing)
-			{
-				this->UpdateVisualList(dt);
-				if (this->getVisualTarget() != nullptr)
+			builder.BeginSelector("Chase Player");
+			builder.AddAction("Chase Target",
+				[](NetworkPlayer& agent, float dt, BehaviourState state)->BehaviourState
 				{
-					if (this->getVisualTarget()->GetPlayerNum() < 4)
+					if (state == Initialise)
 					{
-						targetPlayer = this->getVisualTarget();
-						return Success;
+						state = Ongoing;
 					}
+					else if (state == Ongoing)
+					{
+						Vector3 pos = agent.targetPlayer->GetTransform().GetPosition();
+						agent.AIMoveTo(pos, dt);
+					}
+					return state;
 				}
-			}
-			return state;
+			);
+			builder.End();
 		}
-	);
-
-	BehaviourAction* chaseTarget = new BehaviourAction("Chase Target",
-		[&](float dt, BehaviourState state)->BehaviourState
-		{
-			if (state == Initialise)
-			{
-				state = Ongoing;
-			}
-			else if (state == Ongoing)
-			{
-				Vector3 pos = targetPlayer->GetTransform().GetPosition();
-				AIMoveTo(pos, dt);
-			}
-			return state;
-		}
-	);
-
-	BehaviourParallel* parallel = new BehaviourParallel("Patrol Routine");
-	parallel->AddChild(patrol);
-	parallel->AddChild(searchPlayer);
-
-	BehaviourSelector* selector = new BehaviourSelector("Chase Player");
-	selector->AddChild(chaseTarget);
-
-	rootSequence = new BehaviourSequence("Root Sequence");
-	rootSequence->AddChild(parallel);
-	rootSequence->AddChild(selector);
+		builder.End();
+		return builder.Build();
+	}();
+	return tree;
 }
-
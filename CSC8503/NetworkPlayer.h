@@ -2,11 +2,7 @@
 #include "GameObject.h"
 #include "GameClient.h"
 
-#include "BehaviourNode.h"
-#include "BehaviourParallel.h"
-#include "BehaviourSelector.h"
-#include "BehaviourSequence.h"
-#include "BehaviourAction.h"
+#include "CompiledBehaviourTree.h"
 
 #include <queue>
 
@@ -16,6 +12,7 @@ namespace NCL {
 	namespace CSC8503 {
 		class NetworkedGame;
 		class StateMachine;
+		class VisibilityGrid;
 
 		enum ScoreType {
 			bulletHitAI  = 3,
@@ -30,6 +27,10 @@ namespace NCL {
 			static constexpr float SprintCDT = 4.0f;
 			static constexpr float FireCDT = 2.0f;
 
+			static constexpr float VisionRange = 200.0f;
+			static constexpr float VisionHalfAngle = 30.0f;
+			static constexpr int VisionConeRays = 5;
+
 			//static NetworkPlayer* createAngryGoose(NetworkedGame* game, int num);
 
 			NetworkPlayer(NetworkedGame* game, int num);
@@ -54,6 +55,7 @@ namespace NCL {
 			bool AIMoveTo(Vector3 destination, float dt);
 			bool AIMove(Vector3 destination);
 
+			void QueueVision(VisibilityGrid& grid, const vector<GameObject*>& players);
 			NetworkPlayer* AIvision();
 			void UpdateVisualList(float dt);
 			NetworkPlayer* getVisualTarget();
@@ -86,6 +88,7 @@ namespace NCL {
 			void UpdateTimer(float dt);
 
 			void CreateUndercoverAgent();
+			static const CompiledBehaviourTree<NetworkPlayer>& GetUndercoverAgentTree();
 
 			NetworkedGame* game;
 			int playerNum;
@@ -106,7 +109,13 @@ namespace NCL {
 			StateMachine* stateMachine = nullptr;
 			vector<std::pair<NetworkPlayer*, float>>  viualList;
 
-			BehaviourSequence* rootSequence;
+			VisibilityGrid* visionGrid = nullptr;
+			int visionFirstQuery = -1;
+			int visionQueryCount = 0;
+
+			// shared tree for this kind of AI, plus where this agent is up to in it
+			const CompiledBehaviourTree<NetworkPlayer>* behaviourTree = nullptr;
+			vector<uint8_t> behaviourState;
 			NetworkPlayer* targetPlayer = nullptr;
 		};
 	}
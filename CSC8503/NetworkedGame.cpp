@@ -15,6 +15,7 @@
 #include "OrientationConstraint.h"
 #include "StateGameObject.h"
 #include "Bullet.h"
+#include "VisibilityGrid.h"
 
 #include "StateMachine.h"
 #include "State.h"
@@ -50,12 +51,15 @@ NetworkedGame::NetworkedGame()	{
 	{
 		PlayersList.push_back(-1);
 	}
+
+	visibility = new VisibilityGrid(Vector2(-256, -256), Vector2(512, 512), 16.0f);
 }
 
 NetworkedGame::~NetworkedGame()	{
 	delete thisServer;
 	delete thisClient;
 	delete MenuSystem;
+	delete visibility;
 }
 
 bool NetworkedGame::StartAsServer() {
@@ -168,6 +172,10 @@ void NetworkedGame::UpdateGame(float dt) {
 		if (thisServer) { physics->Update(dt); }
 	}
 
+	//Nothing's iterating over the world now, so anything removed this frame can go
+	world->CommitRemovals();
+	UpdateAssets();
+	renderer->ExtractFrame();
 	renderer->Render();
 	Debug::UpdateRenderables(dt);
 }
@@ -201,9 +209,12 @@ int NetworkedGame::GetClientPlayerNum(int peerID)
 
 void NetworkedGame::InitWorld()
 {
+	bullets.Clear();
 	world->ClearAndErase();
 	physics->Clear();
 
+	MemoryArena::Scope levelScope(world->GetLevelArena());
+
 	InitDefaultFloor();
 	InitMapWall();
 
@@ -215,6 +226,7 @@ void NetworkedGame::InitWorld()
 	SpawnPlayer();
 	SpawnAI();
 	SpawnItem();
+	AddBulletsToPool();
 }
 
 void NetworkedGame::UpdateAsServer(float dt) {
@@ -309,7 +321,9 @@ void NetworkedGame::UpdateGamePlayerInput(float dt)
 				thePlayer->GameTick(dt);
 			}
 		}
-		bullet::UpdateBulletList();
+		bullets.Update();
+
+		UpdateAIVision();
 
 		for (auto i : geese)
 		{
@@ -323,6 +337,19 @@ void NetworkedGame::UpdateGamePlayerInput(float dt)
 	treasure->GetTransform().SetOrientation(Quaternion::EulerAnglesToQuaternion(0, yaw, 0));
 }
 
+// every AI's sight lines are answered in one batch, before any of them act on what they saw
+void NetworkedGame::UpdateAIVision()
+{
+	visibility->Rebuild(*world);
+	visibility->ClearQueries();
+	for (auto i : geese)
+	{
+		i->QueueVision(*visibility, serverPlayers);
+	}
+	undercoverAgent->QueueVision(*visibility, serverPlayers);
+	visibility->Execute();
+}
+
 void NetworkedGame::UpdateScoreTable()
 {
 	if (!isServer()) { return; }
@@ -344,7 +371,7 @@ void NetworkedGame::BroadcastSnapshot(bool deltaFrame) {
 
 	for (auto i = first; i != last; ++i) {
 		NetworkObject* o = (*i)->GetNetworkObject();
-		if (!o) {
+		if (!o || !(*i)->IsActive()) {
 			continue;
 		}
 		//TODO - you'll need some way of determining
@@ -479,24 +506,24 @@ bool NetworkedGame::clientProcessRp(RoundStatePacket* rp)
 
 bool NetworkedGame::clientProcessFp(FullPacket* fp)
 {
-	auto itr = networkObjects.find(fp->objectID);
-	if (itr == networkObjects.end()) {
+	NetworkObject* o = FindNetworkObject(fp->objectID);
+	if (!o) {
 		std::cout << "Client Num" << GetClientPlayerNum() << "can't find netObject" << std::endl;
 		return false;
 	}
-	itr->second->ReadPacket(*fp);
+	o->ReadPacket(*fp);
 	if (fp->fullState.stateID > GlobalStateID) { GlobalStateID = fp->fullState.stateID; }
 	return true;
 }
 
 bool NetworkedGame::clientProcessDp(DeltaPacket* dp)
 {
-	auto itr = networkObjects.find(dp->objectID);
-	if (itr == networkObjects.end()) {
+	NetworkObject* o = FindNetworkObject(dp->objectID);
+	if (!o) {
 		std::cout << "Client Num" << GetClientPlayerNum() << "can't find netObject" << std::endl;
 		return false;
 	}
-	itr->second->ReadPacket(*dp);
+	o->ReadPacket(*dp);
 	return true;
 }
 
@@ -525,12 +552,9 @@ bool NetworkedGame::clientProcessBp(BulletStatePacket* Bp)
 	}
 	else if (Bp->bulletInfo[1] == 0)
 	{
-		auto i = networkObjects.find(Bp->bulletID);
-		if (i != networkObjects.end())
+		if (bullet* b = bullets.Find(Bp->bulletID))
 		{
-			GameObject* bulletPtr = i->second->getGameObjectPtr();
-			//bullet::bulletsDiscard.push_back((bullet*)bulletPtr);
-			RemoveObjectFromWorld(bulletPtr, true);
+			bullets.Deactivate(b);
 		}
 	}
 	return false;
@@ -569,7 +593,7 @@ GameObject* NetworkedGame::AddNetPlayerToWorld(const Vector3& position, int play
 	character->GetPhysicsObject()->InitCubeInertia();
 
 	world->AddGameObject(character);
-	networkObjects.insert(std::pair<int, NetworkObject*>(playerNum, character->GetNetworkObject()));
+	networkObjects[playerNum] = character->GetWorldHandle();
 
 	Vector4 colour;
 	switch (playerNum)
@@ -609,7 +633,7 @@ void NetworkedGame::AddNetOBBCube()
 		
 		GameObject* obb = AddOBBCubeToWorld(pos, Vector3(1, 1, 1));
 		obb->SetNetworkObject(new NetworkObject(*obb, 500 + i));
-		networkObjects.insert(std::pair<int, NetworkObject*>(500 + i, obb->GetNetworkObject()));
+		networkObjects[500 + i] = obb->GetWorldHandle();
 	}
 }
 
@@ -681,7 +705,7 @@ void NetworkedGame::SpawnAI()
 		goose->GetPhysicsObject()->InitCubeInertia();
 		goose->GetRenderObject()->SetColour(Vector4(0.588, 0.3, 0.08, 1));
 		world->AddGameObject(goose);
-		networkObjects.insert(std::pair<int, NetworkObject*>(num, goose->GetNetworkObject()));
+		networkObjects[num] = goose->GetWorldHandle();
 	}
 
 	undercoverAgent = new NetworkPlayer(this, 8, 2);
@@ -702,7 +726,7 @@ void NetworkedGame::SpawnAI()
 	undercoverAgent->GetPhysicsObject()->InitCubeInertia();
 	undercoverAgent->GetRenderObject()->SetColour(Vector4(0.588, 0.3, 0.08, 1));
 	world->AddGameObject(undercoverAgent);
-	networkObjects.insert(std::pair<int, NetworkObject*>(8, undercoverAgent->GetNetworkObject()));
+	networkObjects[8] = undercoverAgent->GetWorldHandle();
 }
 
 void NetworkedGame::SpawnItem()
@@ -786,25 +810,46 @@ void NetworkedGame::SpawnItem()
 	world->AddGameObject(treasure);
 }
 
-void NetworkedGame::SpawnBullet(NetworkPlayer* o, Vector3 firePos, Vector3 fireDir)
+void NetworkedGame::AddBulletsToPool()
 {
-	bullet* newbullet = new bullet(o);
-	bullet::bulletList.push_back(newbullet);
-
 	float radius = 1.0f;
 	Vector3 sphereSize = Vector3(radius, radius, radius);
-	SphereVolume* volume = new SphereVolume(radius);
-	newbullet->SetBoundingVolume((CollisionVolume*)volume);
 
-	newbullet->GetTransform()
-		.SetScale(sphereSize)
-		.SetPosition(firePos);
+	for (int i = 0; i < BulletPool::Capacity; ++i)
+	{
+		bullet* newbullet = new bullet();
+
+		SphereVolume* volume = new SphereVolume(radius);
+		newbullet->SetBoundingVolume((CollisionVolume*)volume);
+		newbullet->GetTransform().SetScale(sphereSize);
+
+		newbullet->SetRenderObject(new RenderObject(&newbullet->GetTransform(), sphereMesh, basicTex, basicShader));
+		//Clients just put bullets where the server says they are
+		if (isServer())
+		{
+			newbullet->SetPhysicsObject(new PhysicsObject(&newbullet->GetTransform(), newbullet->GetBoundingVolume()));
+			newbullet->GetPhysicsObject()->SetInverseMass(bullet::inverseMass);
+			newbullet->GetPhysicsObject()->InitSphereInertia();
+		}
+		newbullet->SetNetworkObject(new NetworkObject(*newbullet, -1));
 
-	newbullet->SetRenderObject(new RenderObject(&newbullet->GetTransform(), sphereMesh, basicTex, basicShader));
-	newbullet->SetPhysicsObject(new PhysicsObject(&newbullet->GetTransform(), newbullet->GetBoundingVolume()));
+		world->AddGameObject(newbullet);
+		bullets.Add(newbullet);
+	}
+}
+
+void NetworkedGame::SpawnBullet(NetworkPlayer* o, Vector3 firePos, Vector3 fireDir)
+{
+	bullet* newbullet = bullets.Activate();
+	if (!newbullet)
+	{
+		return;
+	}
+	newbullet->setOwner(o);
 
-	newbullet->GetPhysicsObject()->SetInverseMass(bullet::inverseMass);
-	newbullet->GetPhysicsObject()->InitSphereInertia();
+	newbullet->GetTransform()
+		.SetPosition(firePos)
+		.SetOrientation(Quaternion());
 
 	int playerNum = o->GetPlayerNum();
 	Vector4 colour;
@@ -825,11 +870,7 @@ void NetworkedGame::SpawnBullet(NetworkPlayer* o, Vector3 firePos, Vector3 fireD
 	}
 	newbullet->GetRenderObject()->SetColour(colour);
 
-	int bulletID = ++bullet::bulletID;
-	newbullet->SetNetworkObject(new NetworkObject(*newbullet, bulletID));
-
-	world->AddGameObject(newbullet);
-	networkObjects.insert(std::pair<int, NetworkObject*>(bulletID, newbullet->GetNetworkObject()));
+	int bulletID = newbullet->GetNetworkObject()->getNetWorkID();
 
 	Vector3 force = fireDir * bullet::FireForce;
 	newbullet->GetPhysicsObject()->AddForce(force);
@@ -842,6 +883,12 @@ void NetworkedGame::SpawnBullet(NetworkPlayer* o, Vector3 firePos, Vector3 fireD
 	thisServer->SendGlobalPacket(bulletP);
 }
 
+void NetworkedGame::DespawnBullet(bullet* b)
+{
+	SeverSendBulletDelPckt(b->GetNetworkObject()->getNetWorkID());
+	bullets.Deactivate(b);
+}
+
 void NetworkedGame::SeverSendBulletDelPckt(int bulletID)
 {
 	if (thisServer)
@@ -856,18 +903,12 @@ void NetworkedGame::SeverSendBulletDelPckt(int bulletID)
 
 void NetworkedGame::ClientSpawnBullet(int playNum, int bulletID)
 {
-	bullet* newbullet = new bullet();
-
-	float radius = 1.0f;
-	Vector3 sphereSize = Vector3(radius, radius, radius);
-	SphereVolume* volume = new SphereVolume(radius);
-	newbullet->SetBoundingVolume((CollisionVolume*)volume);
-
-	newbullet->GetTransform()
-		.SetScale(sphereSize)
-		.SetPosition(Vector3(0, -100, 0));
-
-	newbullet->SetRenderObject(new RenderObject(&newbullet->GetTransform(), sphereMesh, basicTex, basicShader));
+	bullet* newbullet = bullets.Activate(bulletID);
+	if (!newbullet)
+	{
+		return;
+	}
+	newbullet->GetTransform().SetPosition(Vector3(0, -100, 0));
 
 	Vector4 colour;
 	switch (playNum)
@@ -886,11 +927,18 @@ void NetworkedGame::ClientSpawnBullet(int playNum, int bulletID)
 		break;
 	}
 	newbullet->GetRenderObject()->SetColour(colour);
+}
 
-	newbullet->SetNetworkObject(new NetworkObject(*newbullet, bulletID));
-
-	world->AddGameObject(newbullet);
-	networkObjects.insert(std::pair<int, NetworkObject*>(bulletID, newbullet->GetNetworkObject()));
+NetworkObject* NetworkedGame::FindNetworkObject(int networkID)
+{
+	if (BulletPool::IsBulletID(networkID))
+	{
+		bullet* b = bullets.Find(networkID);
+		return b ? b->GetNetworkObject() : nullptr;
+	}
+	auto itr = networkObjects.find(networkID);
+	GameObject* o = itr == networkObjects.end() ? nullptr : world->GetGameObject(itr->second);
+	return o ? o->GetNetworkObject() : nullptr;
 }
 
 void NetworkedGame::RemoveObjectFromWorld(GameObject* o, bool andDelete)
@@ -2,6 +2,7 @@
 #include "TutorialGame.h"
 #include "NetworkBase.h"
 #include "PushdownState.h"
+#include "Bullet.h"
 
 namespace NCL {
 	namespace CSC8503 {
@@ -16,6 +17,7 @@ namespace NCL {
 		class PlayerStatePacket;
 		class BulletStatePacket;
 		class Item;
+		class VisibilityGrid;
 
 		enum PlayInputBtns {
 			Up,
@@ -40,6 +42,7 @@ namespace NCL {
 			void SpawnAI();
 			void SpawnItem();
 			void SpawnBullet(NetworkPlayer* o, Vector3 firePos, Vector3 fireDir);
+			void DespawnBullet(bullet* b);
 			void SeverSendBulletDelPckt(int bulletID);
 			void ClientSpawnBullet(int playNum, int bulletID);
 
@@ -81,6 +84,7 @@ namespace NCL {
 			void ServerUpdatePlayerList();
 
 			void UpdateGamePlayerInput(float dt);
+			void UpdateAIVision();
 			void UpdateScoreTable();
 
 			void BroadcastSnapshot(bool deltaFrame);
@@ -101,6 +105,9 @@ namespace NCL {
 
 			GameObject* AddNetPlayerToWorld(const Vector3& position, int playerNum);
 			void AddNetOBBCube();
+			void AddBulletsToPool();
+
+			NetworkObject* FindNetworkObject(int networkID);
 
 			std::map<int, int> stateIDs;  
 			int GlobalStateID;
@@ -110,7 +117,8 @@ namespace NCL {
 			float timeToNextPacket;
 			int packetsToSnapshot;
 
-			std::map<int, NetworkObject*> networkObjects;
+			std::map<int, GameObjectHandle> networkObjects;
+			BulletPool bullets;
 
 			std::vector<int> PlayersList;
 			std::vector<GameObject*> serverPlayers;
@@ -119,6 +127,8 @@ namespace NCL {
 			std::vector<NetworkPlayer*> geese;
 			NetworkPlayer* undercoverAgent;
 
+			VisibilityGrid* visibility;
+
 			PushdownMachine* MenuSystem;
 			bool isRoundstart;
 			bool isGameover;
@@ -14,15 +14,31 @@
 using namespace NCL;
 using namespace CSC8503;
 
+const float ASSET_UPLOAD_BUDGET_MS = 2.0f;	//time each frame spent getting streamed assets onto the GPU
+
 TutorialGame::TutorialGame() : controller(*Window::GetWindow()->GetKeyboard(), *Window::GetWindow()->GetMouse()) {
 	world		= new GameWorld();
-#ifdef USEVULKAN
+#ifdef USEHEADLESS
+	renderer	= new GameTechNullRenderer(*world);
+#elif defined(USEVULKAN)
 	renderer	= new GameTechVulkanRenderer(*world);
 	renderer->Init();
 	renderer->InitStructures();
 #else 
 	renderer = new GameTechRenderer(*world);
 #endif
+	jobs		= new JobSystem();
+	renderer->SetJobSystem(jobs);
+
+	assets = new AssetManager(*renderer,
+		[this]() { return renderer->CreateMesh(); },
+#ifdef USEVULKAN
+		nullptr,
+#else
+		[this](const TextureData::MipChain& chain) { return renderer->CreateTexture(chain); },
+#endif
+		[this](const std::string& vertex, const std::string& fragment) { return renderer->LoadShader(vertex, fragment); }
+	);
 
 	physics		= new PhysicsSystem(*world);
 
@@ -51,41 +67,69 @@ Each of the little demo scenarios used in the game uses the same 2 meshes,
 and the same texture and shader. There's no need to ever load in anything else
 for this module, even in the coursework, but you can add it if you like!
 
+Everything goes through the asset manager, so asking for something twice
+only loads it once. The basic shapes are loaded up front, as the level is
+built from them. The coursework meshes and the texture stream in while the
+game runs, with the cube standing in for any mesh that isn't ready yet.
+Shaders still have to be loaded here, as they're compiled through the
+renderer's context.
+
 */
 void TutorialGame::InitialiseAssets() {
-	cubeMesh	= renderer->LoadMesh("cube.msh");
-	sphereMesh	= renderer->LoadMesh("sphere.msh");
-	charMesh	= renderer->LoadMesh("goat.msh");
-	enemyMesh	= renderer->LoadMesh("Keeper.msh");
-	gooseMesh   = renderer->LoadMesh("goose.msh");
-	coinMesh    = renderer->LoadMesh("coin.msh");
-	bonusMesh	= renderer->LoadMesh("apple.msh");
-	capsuleMesh = renderer->LoadMesh("capsule.msh"); 
+	cubeMesh	= assets->LoadMesh("Cube.msh");
+	sphereMesh	= assets->LoadMesh("Sphere.msh");
+	capsuleMesh = assets->LoadMesh("Capsule.msh");
+
+	assets->SetPlaceholderMesh(cubeMesh);
+	charMesh	= assets->RequestMesh("Goat.msh");
+	enemyMesh	= assets->RequestMesh("Keeper.msh");
+	gooseMesh   = assets->RequestMesh("goose.msh");
+	coinMesh    = assets->RequestMesh("coin.msh");
+	bonusMesh	= assets->RequestMesh("apple.msh");
 
+#ifdef USEVULKAN
 	basicTex	= renderer->LoadTexture("checkerboard.png");
-	basicShader = renderer->LoadShader("scene.vert", "scene.frag");
+#else
+	//A single white texel, so anything drawn before its texture arrives still has one to sample
+	const char white[4] = { (char)255, (char)255, (char)255, (char)255 };
+	TextureData::MipChain placeholder;
+	TextureLoader::BuildMipChain(white, 1, 1, TextureData::RGBA8, placeholder);
+	placeholderTex = renderer->CreateTexture(placeholder);
+
+	assets->SetPlaceholderTexture(placeholderTex);
+	basicTex	= assets->RequestTexture("checkerboard.png");
+#endif
+	basicShader = assets->LoadShader("scene.vert", "scene.frag");
 
 	InitCamera();
 	//InitWorld();
 }
 
 TutorialGame::~TutorialGame()	{
-	delete cubeMesh;
-	delete sphereMesh;
-	delete charMesh;
-	delete enemyMesh;
-	delete bonusMesh;
+	delete assets;
+	delete placeholderTex;
+
+	for (Mesh* m : staticBatchMeshes) {
+		delete m;
+	}
 
-	delete basicTex;
-	delete basicShader;
+#ifdef USEVULKAN
+	delete basicTex.Get();
+#endif
 
 	delete physics;
 	delete renderer;
+	delete jobs;
 	delete world;
 
 	delete grid;
 }
 
+void TutorialGame::PrintMemoryStats() const {
+	assets->PrintStats();
+	MemoryPool::PrintStats();
+}
+
 void TutorialGame::UpdateGame(float dt) {
 	if (!inSelectionMode) {
 		world->GetMainCamera().UpdateCamera(dt);
@@ -150,10 +194,23 @@ void TutorialGame::UpdateGame(float dt) {
 	renderer->Update(dt);
 	physics->Update(dt);
 
+	//Nothing's iterating over the world now, so anything removed this frame can go
+	world->CommitRemovals();
+	UpdateAssets();
+	renderer->ExtractFrame();
 	renderer->Render();
 	Debug::UpdateRenderables(dt);
 }
 
+void TutorialGame::UpdateAssets() {
+	assets->FinishLoads(ASSET_UPLOAD_BUDGET_MS);
+
+	AssetManager::Progress progress = assets->GetProgress();
+	if (!progress.IsDone()) {
+		Debug::Print("Loading " + std::to_string(progress.ready + progress.failed) + "/" + std::to_string(progress.requested), Vector2(5, 90), Debug::WHITE);
+	}
+}
+
 void TutorialGame::UpdateKeys() {
 	if (Window::GetKeyboard()->KeyPressed(KeyCodes::F1)) {
 		InitWorld(); //We can reset the simulation at any time with F1
@@ -164,6 +221,12 @@ void TutorialGame::UpdateKeys() {
 		InitCamera(); //F2 will reset the camera to a specific default place
 	}
 
+#if !defined(USEVULKAN) && !defined(USEHEADLESS)
+	if (Window::GetKeyboard()->KeyPressed(KeyCodes::F3)) {
+		renderer->SetGPUDrivenDraws(!renderer->GetGPUDrivenDraws()); //Toggle culling and drawing opaque objects on the GPU
+	}
+#endif
+
 	if (Window::GetKeyboard()->KeyPressed(KeyCodes::G)) {
 		useGravity = !useGravity; //Toggle gravity!
 		physics->UseGravity(useGravity);
@@ -319,6 +382,8 @@ void TutorialGame::InitWorld() {
 	world->ClearAndErase();
 	physics->Clear();
 
+	MemoryArena::Scope levelScope(world->GetLevelArena());
+
 	InitMixedGridWorld(15, 15, 3.5f, 3.5f);
 
 	InitGameExamples();
@@ -373,7 +438,8 @@ GameObject* TutorialGame::AddWallToWorld(const Vector3& position, const Vector3&
 	
 	wall->GetRenderObject()->SetColour(Debug::BLACK);
 
-	world->AddGameObject(wall);
+	//Walls never move, so they live in the world's static grid rather than its object list
+	world->AddStaticObject(wall);
 
 	return wall;
 }
@@ -546,17 +612,72 @@ void TutorialGame::InitDefaultFloor() {
 
 void TutorialGame::InitMapWall()
 {
-	AddWallToWorld(Vector3(0, 0, -201), Vector3(200, 5, 2));
-	AddWallToWorld(Vector3(0, 0,  201), Vector3(200, 5, 2));
-	AddWallToWorld(Vector3( 201, 0, 0), Vector3(2, 5, 200));
-	AddWallToWorld(Vector3(-201, 0, 0), Vector3(2, 5, 200));
+	StaticBatcher batcher;
+
+	AddWallToBatch(batcher, AddWallToWorld(Vector3(0, 0, -201), Vector3(200, 5, 2)));
+	AddWallToBatch(batcher, AddWallToWorld(Vector3(0, 0,  201), Vector3(200, 5, 2)));
+	AddWallToBatch(batcher, AddWallToWorld(Vector3( 201, 0, 0), Vector3(2, 5, 200)));
+	AddWallToBatch(batcher, AddWallToWorld(Vector3(-201, 0, 0), Vector3(2, 5, 200)));
 
-	Map* newMap = new Map("Map.txt", Vector2(200, 200), 6);
+	Map* newMap = new Map(*grid, Vector2(200, 200), 6);
 	for (const auto &i : newMap->wallList)
 	{
-		AddWallToWorld(i.pos, i.halfsize);
+		AddWallToBatch(batcher, AddWallToWorld(i.pos, i.halfsize));
 	}
 	delete newMap;
+
+	world->BuildStaticObjects();
+	AddStaticBatchesToWorld(batcher);
+}
+
+/*
+A wall the batcher can't merge - such as one whose mesh is still streaming in -
+would still collide but never be drawn, so it gets a render only copy in the
+world's object list instead, which picks the mesh up whenever it's ready.
+*/
+void TutorialGame::AddWallToBatch(StaticBatcher& batcher, GameObject* wall)
+{
+	const RenderObject* source = wall->GetRenderObject();
+	if (batcher.Add(source)) {
+		return;
+	}
+	GameObject* standIn = new GameObject("UnbatchedWall");
+	standIn->GetTransform()
+		.SetScale(wall->GetTransform().GetScale())
+		.SetOrientation(wall->GetTransform().GetOrientation())
+		.SetPosition(wall->GetTransform().GetPosition());
+
+	standIn->SetRenderObject(new RenderObject(&standIn->GetTransform(), source->GetMeshHandle(), source->GetTextureHandle(), source->GetShaderHandle()));
+	standIn->GetRenderObject()->SetColour(source->GetColour());
+
+	world->AddGameObject(standIn);
+}
+
+/*
+The walls' own render objects are never drawn, as they aren't in the world's
+object list - each batch of them gets a render only object in their place.
+*/
+void TutorialGame::AddStaticBatchesToWorld(const StaticBatcher& batcher)
+{
+	for (Mesh* m : staticBatchMeshes) {
+		delete m;
+	}
+	staticBatchMeshes.clear();
+
+	for (const StaticBatch& b : batcher.GetBatches())
+	{
+		Mesh* mesh = renderer->CreateMesh();
+		StaticBatcher::BuildMesh(b, *mesh);
+		mesh->UploadToGPU(renderer);
+		staticBatchMeshes.emplace_back(mesh);
+
+		GameObject* batch = new GameObject("StaticBatch");
+		batch->SetRenderObject(new RenderObject(&batch->GetTransform(), mesh, b.texture, b.shader));
+		batch->GetRenderObject()->SetColour(b.colour);
+		batch->GetRenderObject()->SetStatic(true);
+
+		world->AddGameObject(batch);
+	}
 }
 
 void TutorialGame::InitGameExamples() {
@@ -690,19 +811,19 @@ void TutorialGame::MoveSelectedObject() {
 	}
 }
 
-Map::Map(const std::string& filename, Vector2 halfMapSize, int wHeight)
+Map::Map(const NavigationGrid& grid, Vector2 halfMapSize, int wHeight)
 {
-	std::ifstream infile(Assets::DATADIR + filename);
-
-	infile >> nodeSize;
-	infile >> gridWidth;
-	infile >> gridHeight;
+	//The navigation grid has already loaded Map.txt, so reuse its node types
+	nodeSize = grid.GetNodeSize();
+	gridWidth = grid.GetGridWidth();
+	gridHeight = grid.GetGridHeight();
 	nodes.clear();
-	for (int i = 0; i < gridWidth * gridHeight; ++i)
+	for (int y = 0; y < gridHeight; ++y)
 	{
-		char node;
-		infile >> node;
-		nodes.push_back(node);
+		for (int x = 0; x < gridWidth; ++x)
+		{
+			nodes.push_back((char)grid.GetNodeType(x, y));
+		}
 	}
 
 	Vector3 TopLeftPoint = Vector3(-halfMapSize.x, 0, -halfMapSize.y);
@@ -1,16 +1,23 @@
 #include "../NCLCoreClasses/KeyboardMouseController.h"
 
 #pragma once
+#ifdef USEHEADLESS
+#include "GameTechNullRenderer.h"
+#else
 #include "GameTechRenderer.h"
 #ifdef USEVULKAN
 #include "GameTechVulkanRenderer.h"
 #endif
+#endif
 #include "PhysicsSystem.h"
+#include "JobSystem.h"
 
 #include "NavigationGrid.h"
 #include "NavigationMesh.h"
 
 #include "StateGameObject.h"
+#include "StaticBatcher.h"
+#include "AssetManager.h"
 
 namespace NCL {
 	namespace CSC8503 {
@@ -21,7 +28,7 @@ namespace NCL {
 
 		class Map {
 		public:
-			Map(const std::string& filename, Vector2 halfMapSize, int wallHeight);
+			Map(const NavigationGrid& grid, Vector2 halfMapSize, int wallHeight);
 
 			vector<Wall> wallList;
 		protected:
@@ -41,8 +48,12 @@ namespace NCL {
 			bool findPathToDestination(Vector3 startrPos, Vector3 Destination, vector<Vector3>& pathNodes);
 			GameWorld* getGameWorld() const { return world; }
 
+			//Asset and memory pool usage, such as for checking nothing's leaking
+			void PrintMemoryStats() const;
+
 		protected:
 			void InitialiseAssets();
+			void UpdateAssets();
 
 			void InitCamera();
 			void UpdateKeys();
@@ -62,6 +73,8 @@ namespace NCL {
 
 			void InitDefaultFloor();
 			void InitMapWall();
+			void AddWallToBatch(StaticBatcher& batcher, GameObject* wall);
+			void AddStaticBatchesToWorld(const StaticBatcher& batcher);
 
 			bool SelectObject();
 			void MoveSelectedObject();
@@ -82,13 +95,17 @@ namespace NCL {
 
 			StateGameObject* AddStateObjectToWorld(const Vector3& position);
 
-#ifdef USEVULKAN
+#ifdef USEHEADLESS
+			GameTechNullRenderer*	renderer;
+#elif defined(USEVULKAN)
 			GameTechVulkanRenderer*	renderer;
 #else
 			GameTechRenderer* renderer;
 #endif
 			PhysicsSystem*		physics;
 			GameWorld*			world;
+			JobSystem*			jobs;
+			AssetManager*		assets;
 
 			KeyboardMouseController controller;
 
@@ -99,19 +116,22 @@ namespace NCL {
 
 			GameObject* selectionObject = nullptr;
 
-			Mesh*	capsuleMesh = nullptr;
-			Mesh*	cubeMesh	= nullptr;
-			Mesh*	sphereMesh	= nullptr;
+			MeshHandle	capsuleMesh;
+			MeshHandle	cubeMesh;
+			MeshHandle	sphereMesh;
+
+			TextureHandle	basicTex;
+			Texture*		placeholderTex = nullptr;	//stands in for any texture still streaming in
+			ShaderHandle	basicShader;
 
-			Texture*	basicTex	= nullptr;
-			Shader*		basicShader = nullptr;
+			//Coursework Meshes, streamed in by assets
+			MeshHandle	charMesh;
+			MeshHandle	enemyMesh;
+			MeshHandle	bonusMesh;
+			MeshHandle	gooseMesh;
+			MeshHandle	coinMesh;
 
-			//Coursework Meshes
-			Mesh*	charMesh	= nullptr;
-			Mesh*	enemyMesh	= nullptr;
-			Mesh*	bonusMesh	= nullptr;
-			Mesh*   gooseMesh   = nullptr;
-			Mesh*   coinMesh    = nullptr;
+			vector<Mesh*> staticBatchMeshes;	//merged level geometry, rebuilt along with the walls
 
 			//Coursework Additional functionality	
 			GameObject* lockedObject	= nullptr;
@@ -4,16 +4,13 @@
 
 namespace NCL {
 	using namespace NCL::Maths;
-	class AABBVolume : CollisionVolume
+	class AABBVolume : public CollisionVolume
 	{
 	public:
 		AABBVolume(const Vector3& halfDims) {
 			type		= VolumeType::AABB;
 			halfSizes	= halfDims;
 		}
-		~AABBVolume() {
-
-		}
 
 		Vector3 GetHalfDimensions() const {
 			return halfSizes;
@@ -0,0 +1,75 @@
+#pragma once
+
+namespace NCL {
+	namespace Rendering {
+		class Mesh;
+		class Texture;
+		class Shader;
+	}
+	using namespace NCL::Rendering;
+
+	namespace CSC8503 {
+		//Where an asset loaded by an AssetManager will end up
+		template<typename T>
+		struct AssetSlot {
+			std::string			name;
+			T*					asset		= nullptr;
+			T*					placeholder	= nullptr;
+			std::atomic<bool>	ready		= false;	//set once the asset can be used, after which asset never changes
+			std::atomic<bool>	failed		= false;
+
+			//Filled in before ready is set
+			size_t				bytes		= 0;	//the CPU side data the asset holds
+			float				loadMS		= 0.0f;	//reading and decoding, plus getting it onto the GPU
+		};
+
+		/*
+		Refers to an asset that might not have finished loading yet, and gives
+		back a placeholder in its place until it has. Handles to the same slot
+		are what the AssetManager counts as references to its asset.
+
+		A handle can also just wrap an asset that's already loaded, so that
+		anything taking handles can still be given plain pointers. These aren't
+		counted, and whoever made the asset still has to delete it.
+		*/
+		template<typename T>
+		class AssetHandle {
+		public:
+			AssetHandle(T* asset = nullptr) {
+				direct = asset;
+			}
+			AssetHandle(const std::shared_ptr<AssetSlot<T>>& s) {
+				direct	= nullptr;
+				slot	= s;
+			}
+
+			T* Get() const {
+				if (!slot) {
+					return direct;
+				}
+				return slot->ready.load(std::memory_order_acquire) ? slot->asset : slot->placeholder;
+			}
+
+			bool IsReady() const {
+				return !slot || slot->ready.load(std::memory_order_acquire);
+			}
+
+			bool HasFailed() const {
+				return slot && slot->failed.load(std::memory_order_acquire);
+			}
+
+			//Handles are the same if they'll always give back the same asset
+			bool operator==(const AssetHandle& other) const {
+				return slot ? slot == other.slot : (!other.slot && direct == other.direct);
+			}
+
+		protected:
+			T*								direct;
+			std::shared_ptr<AssetSlot<T>>	slot;
+		};
+
+		using MeshHandle	= AssetHandle<Mesh>;
+		using TextureHandle	= AssetHandle<Texture>;
+		using ShaderHandle	= AssetHandle<Shader>;
+	}
+}
@@ -0,0 +1,360 @@
+#include "AssetManager.h"
+#include "MshLoader.h"
+#include "TextureLoader.h"
+#include "Mesh.h"
+#include "Texture.h"
+#include "Shader.h"
+#include "Vector4i.h"
+
+#include <chrono>
+#include <filesystem>
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	using Clock = std::chrono::high_resolution_clock;
+
+	float MillisecondsSince(Clock::time_point start) {
+		return std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+	}
+
+	template<typename T>
+	size_t DataSize(const std::vector<T>& v) {
+		return v.size() * sizeof(T);
+	}
+
+	size_t MeshDataSize(const Mesh& m) {
+		return	DataSize(m.GetPositionData())		+ DataSize(m.GetColourData()) +
+				DataSize(m.GetTextureCoordData())	+ DataSize(m.GetNormalData()) +
+				DataSize(m.GetTangentData())		+ DataSize(m.GetSkinWeightData()) +
+				DataSize(m.GetSkinIndexData())		+ DataSize(m.GetIndexData()) +
+				DataSize(m.GetBindPose())			+ DataSize(m.GetInverseBindPose());
+	}
+
+	void PrintTypeStats(const char* type, const AssetManager::TypeStats& s) {
+		std::cout << type << "\t" << s.held << "\t" << (s.bytes / 1024) << "\t" << s.requests << "\t" << s.hits << "\t" << s.evicted << "\t" << s.loadMS << "\n";
+	}
+}
+
+AssetManager::AssetManager(RendererBase& r, const MeshFactory& meshes, const TextureFactory& textures, const ShaderFactory& shaders, unsigned int threadCount) : renderer(r) {
+	meshFactory		= meshes;
+	textureFactory	= textures;
+	shaderFactory	= shaders;
+	shuttingDown	= false;
+	requestedCount	= 0;
+	readyCount		= 0;
+	failedCount		= 0;
+
+	for (unsigned int i = 0; i < std::max(threadCount, 1u); ++i) {
+		loaders.emplace_back([this] { LoaderLoop(); });
+	}
+}
+
+AssetManager::~AssetManager() {
+	{
+		std::unique_lock<std::mutex> lock(requestMutex);
+		shuttingDown = true;
+	}
+	requestWaiting.notify_all();
+	for (std::thread& t : loaders) {
+		t.join();
+	}
+	//Anything still waiting to be finished never made it into a slot, and frees its own data
+	loaded.clear();
+
+	for (auto& [key, slot] : meshes) {
+		delete slot->asset;
+		slot->asset = nullptr;
+	}
+	for (auto& [key, slot] : textures) {
+		delete slot->asset;
+		slot->asset = nullptr;
+	}
+	for (auto& [key, slot] : shaders) {
+		delete slot->asset;
+		slot->asset = nullptr;
+	}
+}
+
+//So that different spellings of the same file, like "./Cube.msh" and "Cube.msh", find the same asset
+std::string AssetManager::NormalisePath(const std::string& path) {
+	return std::filesystem::path(path).lexically_normal().generic_string();
+}
+
+template<typename T>
+std::shared_ptr<AssetSlot<T>> AssetManager::FindSlot(SlotMap<T>& slots, TypeStats& stats, const std::string& key) {
+	stats.requests++;
+	auto i = slots.find(key);
+	if (i == slots.end()) {
+		return nullptr;
+	}
+	stats.hits++;
+	return i->second;
+}
+
+/*
+The mesh object itself is made here, on the calling thread, as some renderers
+can only make theirs on the thread that owns the graphics context. Filling it
+in doesn't touch the graphics API, so can happen anywhere.
+*/
+MeshHandle AssetManager::RequestMesh(const std::string& name) {
+	std::string key = NormalisePath(name);
+	if (auto found = FindSlot(meshes, meshStats, key)) {
+		return MeshHandle(found);
+	}
+	auto slot = std::make_shared<AssetSlot<Mesh>>();
+	slot->name			= key;
+	slot->asset			= meshFactory();
+	slot->placeholder	= placeholderMesh.Get();
+	meshes.insert({ key, slot });
+	requestedCount++;
+
+	AddRequest([this, slot] {
+		auto start = Clock::now();
+		if (!MshLoader::LoadMesh(slot->name, *slot->asset)) {
+			std::cout << __FUNCTION__ << " Failed to load " << slot->name << "\n";
+			slot->failed = true;
+			failedCount++;
+			return;
+		}
+		slot->asset->SetDebugName(slot->name);
+		slot->bytes		= MeshDataSize(*slot->asset);
+		slot->loadMS	= MillisecondsSince(start);
+
+		AddLoaded([this, slot] {
+			auto start = Clock::now();
+			slot->asset->UploadToGPU(&renderer);
+			slot->loadMS += MillisecondsSince(start);
+			meshStats.loadMS += slot->loadMS;
+			slot->ready = true;
+			readyCount++;
+		});
+	});
+	return MeshHandle(slot);
+}
+
+MeshHandle AssetManager::LoadMesh(const std::string& name) {
+	std::string key = NormalisePath(name);
+	if (auto found = FindSlot(meshes, meshStats, key)) {
+		return MeshHandle(found);
+	}
+	auto start = Clock::now();
+
+	auto slot = std::make_shared<AssetSlot<Mesh>>();
+	slot->name			= key;
+	slot->asset			= meshFactory();
+	slot->placeholder	= placeholderMesh.Get();
+	meshes.insert({ key, slot });
+	requestedCount++;
+
+	if (!MshLoader::LoadMesh(key, *slot->asset)) {
+		std::cout << __FUNCTION__ << " Failed to load " << key << "\n";
+		slot->failed = true;
+		failedCount++;
+		return MeshHandle(slot);
+	}
+	slot->asset->SetDebugName(key);
+	slot->asset->UploadToGPU(&renderer);
+	slot->bytes		= MeshDataSize(*slot->asset);
+	slot->loadMS	= MillisecondsSince(start);
+	meshStats.loadMS += slot->loadMS;
+	slot->ready = true;
+	readyCount++;
+	return MeshHandle(slot);
+}
+
+TextureHandle AssetManager::RequestTexture(const std::string& name) {
+	std::string key = NormalisePath(name);
+	if (auto found = FindSlot(textures, textureStats, key)) {
+		return TextureHandle(found);
+	}
+	auto slot = std::make_shared<AssetSlot<Texture>>();
+	slot->name			= key;
+	slot->placeholder	= placeholderTexture.Get();
+	textures.insert({ key, slot });
+	requestedCount++;
+
+	if (!textureFactory) {
+		std::cout << __FUNCTION__ << " Can't make textures for this renderer, so can't load " << key << "\n";
+		slot->failed = true;
+		failedCount++;
+		return TextureHandle(slot);
+	}
+
+	AddRequest([this, slot] {
+		auto start = Clock::now();
+		auto chain = std::make_shared<TextureData::MipChain>();
+		if (!TextureLoader::LoadMipChain(slot->name, *chain)) {
+			std::cout << __FUNCTION__ << " Failed to load " << slot->name << "\n";
+			slot->failed = true;
+			failedCount++;
+			return;
+		}
+		slot->bytes		= chain->data.size();
+		slot->loadMS	= MillisecondsSince(start);
+
+		AddLoaded([this, slot, chain] {
+			auto start = Clock::now();
+			slot->asset = textureFactory(*chain);
+			slot->loadMS += MillisecondsSince(start);
+			textureStats.loadMS += slot->loadMS;
+			slot->ready = true;
+			readyCount++;
+		});
+	});
+	return TextureHandle(slot);
+}
+
+//The same file can be used in more than one shader, so both stages make up the key
+ShaderHandle AssetManager::LoadShader(const std::string& vertex, const std::string& fragment) {
+	std::string key = NormalisePath(vertex) + "|" + NormalisePath(fragment);
+	if (auto found = FindSlot(shaders, shaderStats, key)) {
+		return ShaderHandle(found);
+	}
+	auto start = Clock::now();
+
+	auto slot = std::make_shared<AssetSlot<Shader>>();
+	slot->name	= key;
+	slot->asset	= shaderFactory(NormalisePath(vertex), NormalisePath(fragment));
+	slot->loadMS = MillisecondsSince(start);
+	shaders.insert({ key, slot });
+	shaderStats.loadMS += slot->loadMS;
+	requestedCount++;
+
+	slot->ready = true;
+	readyCount++;
+	return ShaderHandle(slot);
+}
+
+/*
+The manager's own copy of the slot is the only one left once every handle has
+gone. Anything still being loaded has a copy held by its loading work, so
+can't be evicted until it's finished.
+*/
+template<typename T>
+bool AssetManager::EvictSlot(SlotMap<T>& slots, TypeStats& stats, const std::string& key) {
+	auto i = slots.find(key);
+	if (i == slots.end() || i->second.use_count() > 1) {
+		return false;
+	}
+	delete i->second->asset;
+	i->second->asset = nullptr;
+	slots.erase(i);
+	stats.evicted++;
+	return true;
+}
+
+template<typename T>
+size_t AssetManager::EvictUnusedSlots(SlotMap<T>& slots, TypeStats& stats) {
+	size_t count = 0;
+	for (auto i = slots.begin(); i != slots.end(); ) {
+		if (i->second.use_count() > 1) {
+			++i;
+			continue;
+		}
+		delete i->second->asset;
+		i->second->asset = nullptr;
+		i = slots.erase(i);
+		stats.evicted++;
+		count++;
+	}
+	return count;
+}
+
+bool AssetManager::EvictMesh(const std::string& name) {
+	return EvictSlot(meshes, meshStats, NormalisePath(name));
+}
+
+bool AssetManager::EvictTexture(const std::string& name) {
+	return EvictSlot(textures, textureStats, NormalisePath(name));
+}
+
+bool AssetManager::EvictShader(const std::string& vertex, const std::string& fragment) {
+	return EvictSlot(shaders, shaderStats, NormalisePath(vertex) + "|" + NormalisePath(fragment));
+}
+
+size_t AssetManager::EvictUnused() {
+	return	EvictUnusedSlots(meshes, meshStats) +
+			EvictUnusedSlots(textures, textureStats) +
+			EvictUnusedSlots(shaders, shaderStats);
+}
+
+void AssetManager::FinishLoads(float budgetMS) {
+	auto start = Clock::now();
+	while (true) {
+		std::function<void()> finish;
+		{
+			std::unique_lock<std::mutex> lock(loadedMutex);
+			if (loaded.empty()) {
+				return;
+			}
+			finish = std::move(loaded.front());
+			loaded.pop_front();
+		}
+		finish();
+
+		if (MillisecondsSince(start) >= budgetMS) {
+			return;
+		}
+	}
+}
+
+AssetManager::Progress AssetManager::GetProgress() const {
+	return { requestedCount, readyCount, failedCount };
+}
+
+//Only assets that are ready count towards the memory in use
+AssetManager::Stats AssetManager::GetStats() const {
+	Stats s = { meshStats, textureStats, shaderStats };
+
+	auto countHeld = [](const auto& slots, TypeStats& stats) {
+		for (const auto& [key, slot] : slots) {
+			if (slot->ready.load(std::memory_order_acquire)) {
+				stats.held++;
+				stats.bytes += slot->bytes;
+			}
+		}
+	};
+	countHeld(meshes,	s.meshes);
+	countHeld(textures, s.textures);
+	countHeld(shaders,	s.shaders);
+	return s;
+}
+
+void AssetManager::PrintStats() const {
+	Stats s = GetStats();
+	std::cout << "Assets\tHeld\tKB\tRequests\tHits\tEvicted\tLoad ms\n";
+	PrintTypeStats("Meshes",	s.meshes);
+	PrintTypeStats("Textures",	s.textures);
+	PrintTypeStats("Shaders",	s.shaders);
+}
+
+void AssetManager::LoaderLoop() {
+	while (true) {
+		std::function<void()> request;
+		{
+			std::unique_lock<std::mutex> lock(requestMutex);
+			requestWaiting.wait(lock, [this] { return shuttingDown || !requests.empty(); });
+			if (shuttingDown) {
+				return;
+			}
+			request = std::move(requests.front());
+			requests.pop_front();
+		}
+		request();
+	}
+}
+
+void AssetManager::AddRequest(std::function<void()> request) {
+	{
+		std::unique_lock<std::mutex> lock(requestMutex);
+		requests.emplace_back(std::move(request));
+	}
+	requestWaiting.notify_one();
+}
+
+void AssetManager::AddLoaded(std::function<void()> finish) {
+	std::unique_lock<std::mutex> lock(loadedMutex);
+	loaded.emplace_back(std::move(finish));
+}
@@ -0,0 +1,155 @@
+#pragma once
+#include "AssetHandle.h"
+#include "TextureData.h"
+
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+
+namespace NCL {
+	namespace Rendering {
+		class RendererBase;
+	}
+	namespace CSC8503 {
+		/*
+		Loads meshes, textures and shaders, and keeps track of everything it's
+		loaded, so asking for the same asset twice gives back the same one.
+		Assets are found by their normalised file path, along with anything
+		else that changes how they're loaded, such as a shader's other stages.
+
+		Meshes and textures can be streamed in the background, so the game can
+		start before everything has loaded. A request hands back a handle
+		straight away, which gives the placeholder until the asset's ready.
+		Files are read and decoded by a small pool of loading threads, which
+		also build the mips of any texture that hasn't been cooked. Getting
+		an asset onto the GPU has to happen on the render thread, so loaded
+		assets wait for FinishLoads, which does as many as it can in the time
+		it's given each frame.
+
+		The manager owns everything it loads. An asset is only deleted once no
+		handles to it are left, either when it's evicted or along with the
+		manager itself.
+		*/
+		class AssetManager {
+		public:
+			//Makes an empty mesh, or a texture from all of its mip levels, for the renderer in use
+			typedef std::function<Mesh*()> MeshFactory;
+			typedef std::function<Texture*(const TextureData::MipChain& chain)> TextureFactory;
+			typedef std::function<Shader*(const std::string& vertex, const std::string& fragment)> ShaderFactory;
+
+			struct Progress {
+				size_t requested;
+				size_t ready;
+				size_t failed;
+
+				bool IsDone() const {
+					return ready + failed == requested;
+				}
+			};
+
+			struct TypeStats {
+				size_t	held		= 0;	//assets loaded and not yet evicted
+				size_t	bytes		= 0;	//the CPU side data they hold
+				size_t	requests	= 0;	//every time one's been asked for
+				size_t	hits		= 0;	//requests given an asset that was already there
+				size_t	evicted		= 0;
+				float	loadMS		= 0.0f;	//total time spent loading, across every thread
+			};
+
+			struct Stats {
+				TypeStats meshes;
+				TypeStats textures;
+				TypeStats shaders;
+			};
+
+			//If there's no texture factory, textures can't be requested
+			AssetManager(RendererBase& renderer, const MeshFactory& meshFactory, const TextureFactory& textureFactory, const ShaderFactory& shaderFactory, unsigned int threadCount = 2);
+			~AssetManager();
+
+			AssetManager(const AssetManager&) = delete;
+			AssetManager& operator=(const AssetManager&) = delete;
+
+			//Placeholders are used by any request made after they're set
+			void SetPlaceholderMesh(const MeshHandle& m) {
+				placeholderMesh = m;
+			}
+			void SetPlaceholderTexture(const TextureHandle& t) {
+				placeholderTexture = t;
+			}
+
+			//Streamed in the background
+			MeshHandle		RequestMesh(const std::string& name);
+			TextureHandle	RequestTexture(const std::string& name);
+
+			//Loaded straight away, unless it's already being streamed in
+			MeshHandle		LoadMesh(const std::string& name);
+			ShaderHandle	LoadShader(const std::string& vertex, const std::string& fragment);
+
+			/*
+			Deletes an asset, as long as nothing has a handle to it, and returns
+			whether it was evicted. Renderers can hold on to what they drew last,
+			so only evict between levels, rather than mid game.
+			*/
+			bool EvictMesh(const std::string& name);
+			bool EvictTexture(const std::string& name);
+			bool EvictShader(const std::string& vertex, const std::string& fragment);
+
+			//Deletes every asset nothing has a handle to, and returns how many there were
+			size_t EvictUnused();
+
+			//Call from the render thread. Always finishes at least one loaded asset, if there are any
+			void FinishLoads(float budgetMS);
+
+			Progress	GetProgress() const;
+			Stats		GetStats() const;
+			void		PrintStats() const;
+
+			static std::string NormalisePath(const std::string& path);
+
+		protected:
+			template<typename T>
+			using SlotMap = std::unordered_map<std::string, std::shared_ptr<AssetSlot<T>>>;
+
+			template<typename T>
+			std::shared_ptr<AssetSlot<T>> FindSlot(SlotMap<T>& slots, TypeStats& stats, const std::string& key);
+
+			template<typename T>
+			bool	EvictSlot(SlotMap<T>& slots, TypeStats& stats, const std::string& key);
+			template<typename T>
+			size_t	EvictUnusedSlots(SlotMap<T>& slots, TypeStats& stats);
+
+			void LoaderLoop();
+			void AddRequest(std::function<void()> request);
+			void AddLoaded(std::function<void()> finish);
+
+			RendererBase&	renderer;
+			MeshFactory		meshFactory;
+			TextureFactory	textureFactory;
+			ShaderFactory	shaderFactory;
+
+			MeshHandle		placeholderMesh;
+			TextureHandle	placeholderTexture;
+
+			SlotMap<Mesh>		meshes;
+			SlotMap<Texture>	textures;
+			SlotMap<Shader>		shaders;
+
+			TypeStats	meshStats;
+			TypeStats	textureStats;
+			TypeStats	shaderStats;
+
+			std::vector<std::thread>			loaders;
+			std::mutex							requestMutex;
+			std::condition_variable				requestWaiting;
+			std::deque<std::function<void()>>	requests;		//guarded by requestMutex
+			bool								shuttingDown;	//guarded by requestMutex
+
+			std::mutex							loadedMutex;
+			std::deque<std::function<void()>>	loaded;			//guarded by loadedMutex
+
+			std::atomic<size_t>	requestedCount;
+			std::atomic<size_t>	readyCount;
+			std::atomic<size_t>	failedCount;
+		};
+	}
+}
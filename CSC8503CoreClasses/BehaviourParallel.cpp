@@ -1,2 +1 @@
-#include "D:/CppProject/CSC8503 2023/CSC8503CoreClasses/CMakeFiles/CSC8503CoreClasses.dir/Debug/cmake_pch.hxx"
 #include "BehaviourParallel.h"
@@ -10,9 +10,6 @@ namespace NCL {
             this->radius        = radius;
             this->type          = VolumeType::Capsule;
         };
-        ~CapsuleVolume() {
-
-        }
         float GetRadius() const {
             return radius;
         }
@@ -162,8 +162,7 @@ bool CollisionDetection::ObjectIntersection(GameObject* a, GameObject* b, Collis
 		return false;
 	}
 
-	collisionInfo.a = a;
-	collisionInfo.b = b;
+	collisionInfo.SetObjects(a, b);
 
 	Transform& transformA = a->GetTransform();
 	Transform& transformB = b->GetTransform();
@@ -189,8 +188,7 @@ bool CollisionDetection::ObjectIntersection(GameObject* a, GameObject* b, Collis
 		return AABBSphereIntersection((AABBVolume&)*volA, transformA, (SphereVolume&)*volB, transformB, collisionInfo);
 	}
 	if (volA->type == VolumeType::Sphere && volB->type == VolumeType::AABB) {
-		collisionInfo.a = b;
-		collisionInfo.b = a;
+		collisionInfo.SetObjects(b, a);
 		return AABBSphereIntersection((AABBVolume&)*volB, transformB, (SphereVolume&)*volA, transformA, collisionInfo);
 	}
 
@@ -199,8 +197,7 @@ bool CollisionDetection::ObjectIntersection(GameObject* a, GameObject* b, Collis
 		return AABBOBBIntersection((AABBVolume&)*volA, transformA, (OBBVolume&)*volB, transformB, collisionInfo);
 	}
 	if (volA->type == VolumeType::OBB && volB->type == VolumeType::AABB) {
-		collisionInfo.a = b;
-		collisionInfo.b = a;
+		collisionInfo.SetObjects(b, a);
 		return AABBOBBIntersection((AABBVolume&)*volB, transformB, (OBBVolume&)*volA, transformA, collisionInfo);
 	}
 	
@@ -210,8 +207,7 @@ bool CollisionDetection::ObjectIntersection(GameObject* a, GameObject* b, Collis
 		return OBBSphereIntersection((OBBVolume&)*volA, transformA, (SphereVolume&)*volB, transformB, collisionInfo);
 	}
 	if (volA->type == VolumeType::Sphere && volB->type == VolumeType::OBB) {
-		collisionInfo.a = b;
-		collisionInfo.b = a;
+		collisionInfo.SetObjects(b, a);
 		return OBBSphereIntersection((OBBVolume&)*volB, transformB, (SphereVolume&)*volA, transformA, collisionInfo);
 	}
 
@@ -221,8 +217,7 @@ bool CollisionDetection::ObjectIntersection(GameObject* a, GameObject* b, Collis
 		return SphereCapsuleIntersection((CapsuleVolume&)*volA, transformA, (SphereVolume&)*volB, transformB, collisionInfo);
 	}
 	if (volA->type == VolumeType::Sphere && volB->type == VolumeType::Capsule) {
-		collisionInfo.a = b;
-		collisionInfo.b = a;
+		collisionInfo.SetObjects(b, a);
 		return SphereCapsuleIntersection((CapsuleVolume&)*volB, transformB, (SphereVolume&)*volA, transformA, collisionInfo);
 	}
 
@@ -230,8 +225,7 @@ bool CollisionDetection::ObjectIntersection(GameObject* a, GameObject* b, Collis
 		return AABBCapsuleIntersection((CapsuleVolume&)*volA, transformA, (AABBVolume&)*volB, transformB, collisionInfo);
 	}
 	if (volB->type == VolumeType::Capsule && volA->type == VolumeType::AABB) {
-		collisionInfo.a = b;
-		collisionInfo.b = a;
+		collisionInfo.SetObjects(b, a);
 		return AABBCapsuleIntersection((CapsuleVolume&)*volB, transformB, (AABBVolume&)*volA, transformA, collisionInfo);
 	}
 
@@ -27,6 +27,9 @@ namespace NCL {
 		struct CollisionInfo {
 			GameObject* a;
 			GameObject* b;		
+			//Pairs are told apart by these, as a and b are only safe to use while they resolve
+			GameObjectHandle handleA;
+			GameObjectHandle handleB;
 			int		framesLeft;
 
 			ContactPoint point;
@@ -35,6 +38,13 @@ namespace NCL {
 
 			}
 
+			void SetObjects(GameObject* inA, GameObject* inB) {
+				a		= inA;
+				b		= inB;
+				handleA	= inA->GetWorldHandle();
+				handleB	= inB->GetWorldHandle();
+			}
+
 			void AddContactPoint(const Vector3& localA, const Vector3& localB, const Vector3& normal, float p) {
 				point.localA		= localA;
 				point.localB		= localB;
@@ -44,20 +54,14 @@ namespace NCL {
 
 			//Advanced collision detection / resolution
 			bool operator < (const CollisionInfo& other) const {
-				size_t otherHash = (size_t)other.a + ((size_t)other.b << 32);
-				size_t thisHash  = (size_t)a + ((size_t)b << 32);
-
-				if (thisHash < otherHash) {
-					return true;
+				if (handleA != other.handleA) {
+					return handleA < other.handleA;
 				}
-				return false;
+				return handleB < other.handleB;
 			}
 
 			bool operator ==(const CollisionInfo& other) const {
-				if (other.a == a && other.b == b) {
-					return true;
-				}
-				return false;
+				return other.handleA == handleA && other.handleB == handleB;
 			}
 		};
 
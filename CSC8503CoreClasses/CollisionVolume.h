@@ -1,4 +1,6 @@
 #pragma once
+#include "MemoryPool.h"
+
 namespace NCL {
 	enum class VolumeType {
 		AABB	= 1,
@@ -10,13 +12,21 @@ namespace NCL {
 		Invalid = 256
 	};
 
-	class CollisionVolume
+	class CollisionVolume : public PooledObject<CollisionVolume>
 	{
 	public:
 		CollisionVolume() {
 			type = VolumeType::Invalid;
 		}
-		~CollisionVolume() {}
+
+		//All of the volume types share one pool, so its slots fit the biggest of them.
+		//They've nothing to destroy, so can come from the level arena
+		static const size_t PoolSlotSize = 32;
+
+		static MemoryPool& GetPool() {
+			static MemoryPool pool("CollisionVolume", PoolSlotSize, MemoryPool::ArenaUse::WhenCurrent);
+			return pool;
+		}
 
 		VolumeType type;
 	};
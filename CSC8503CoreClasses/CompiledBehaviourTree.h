@@ -0,0 +1,179 @@
+#pragma once
+#include "BehaviourNode.h"
+#include <span>
+
+enum class CompiledNodeType : uint8_t {
+	Action,
+	Sequence,
+	Selector,
+	Parallel
+};
+
+struct CompiledBehaviourNode {
+	CompiledNodeType	type;
+	uint16_t			subtreeEnd;	//index just past this node's last descendant
+	uint16_t			action;		//index into the action table, for Action nodes
+};
+
+/*
+A behaviour tree flattened down into an array of nodes in depth first order,
+so a node's first child is always the next node along, and its next sibling
+is at its subtreeEnd. Once built the tree is never modified, and can be shared
+between every agent that runs it - all an agent needs to keep is one byte of
+state per node, which it passes in on each update.
+
+Actions are plain function pointers that get handed the agent, so captureless
+lambdas work fine. As nothing in the tree itself changes while running, many
+agents can be updated in one loop, or split across threads so long as the
+actions they run are safe to do so.
+
+The sequence, selector and parallel nodes give the same results as the
+BehaviourSequence, BehaviourSelector and BehaviourParallel classes.
+*/
+template<class T>
+class CompiledBehaviourTree {
+public:
+	typedef BehaviourState(*ActionFunc)(T& agent, float dt, BehaviourState state);
+
+	size_t GetNodeCount() const {
+		return nodes.size();
+	}
+
+	const std::string& GetNodeName(int index) const {
+		return names[index];
+	}
+
+	std::vector<uint8_t> CreateState() const {
+		return std::vector<uint8_t>(nodes.size(), (uint8_t)Initialise);
+	}
+
+	void Reset(std::span<uint8_t> state) const {
+		std::fill(state.begin(), state.end(), (uint8_t)Initialise);
+	}
+
+	BehaviourState Execute(T& agent, std::span<uint8_t> state, float dt) const {
+		return nodes.empty() ? Failure : ExecuteNode(0, agent, state.data(), dt);
+	}
+
+	//Runs the tree, starting it over again once it has finished
+	BehaviourState Update(T& agent, std::span<uint8_t> state, float dt) const {
+		BehaviourState result = Execute(agent, state, dt);
+		if (result == Success || result == Failure) {
+			Reset(state);
+		}
+		return result;
+	}
+
+	//Updates a batch of agents, whose states are packed one after another in allStates
+	void UpdateAll(std::span<T* const> agents, std::span<uint8_t> allStates, float dt) const {
+		size_t stride = nodes.size();
+		for (size_t i = 0; i < agents.size(); ++i) {
+			Update(*agents[i], allStates.subspan(i * stride, stride), dt);
+		}
+	}
+
+protected:
+	template<class> friend class BehaviourTreeBuilder;
+
+	BehaviourState ExecuteNode(int index, T& agent, uint8_t* state, float dt) const {
+		const CompiledBehaviourNode& node = nodes[index];
+		switch (node.type) {
+			case CompiledNodeType::Action: {
+				BehaviourState result = actions[node.action](agent, dt, (BehaviourState)state[index]);
+				state[index] = (uint8_t)result;
+				return result;
+			}
+			case CompiledNodeType::Sequence: {
+				for (int i = index + 1; i < node.subtreeEnd; i = nodes[i].subtreeEnd) {
+					BehaviourState result = ExecuteNode(i, agent, state, dt);
+					if (result == Failure || result == Ongoing) {
+						state[index] = (uint8_t)result;
+						return result;
+					}
+				}
+				return Success;
+			}
+			case CompiledNodeType::Selector: {
+				for (int i = index + 1; i < node.subtreeEnd; i = nodes[i].subtreeEnd) {
+					BehaviourState result = ExecuteNode(i, agent, state, dt);
+					if (result == Success || result == Ongoing) {
+						state[index] = (uint8_t)result;
+						return result;
+					}
+				}
+				return Failure;
+			}
+			case CompiledNodeType::Parallel: {
+				BehaviourState result = Success;
+				for (int i = index + 1; i < node.subtreeEnd; i = nodes[i].subtreeEnd) {
+					BehaviourState childResult = ExecuteNode(i, agent, state, dt);
+					if (childResult == Failure || childResult == Ongoing) {
+						result = Ongoing; //a failing child doesn't stop the others
+					}
+				}
+				state[index] = (uint8_t)result;
+				return result;
+			}
+		}
+		return Failure;
+	}
+
+	std::vector<CompiledBehaviourNode>	nodes;
+	std::vector<ActionFunc>				actions;
+	std::vector<std::string>			names;	//only for debugging, kept out of the way of the nodes
+};
+
+/*
+Builds up a CompiledBehaviourTree in the same shape the node classes would be
+put together in, with each Begin matched by an End:
+
+	builder.BeginSequence("Root Sequence");
+		builder.AddAction("Patrol", PatrolFunc);
+		builder.AddAction("Chase", ChaseFunc);
+	builder.End();
+*/
+template<class T>
+class BehaviourTreeBuilder {
+public:
+	typedef typename CompiledBehaviourTree<T>::ActionFunc ActionFunc;
+
+	void BeginSequence(const std::string& name) {
+		Begin(CompiledNodeType::Sequence, name);
+	}
+
+	void BeginSelector(const std::string& name) {
+		Begin(CompiledNodeType::Selector, name);
+	}
+
+	void BeginParallel(const std::string& name) {
+		Begin(CompiledNodeType::Parallel, name);
+	}
+
+	void End() {
+		int index = openNodes.back();
+		openNodes.pop_back();
+		tree.nodes[index].subtreeEnd = (uint16_t)tree.nodes.size();
+	}
+
+	void AddAction(const std::string& name, ActionFunc f) {
+		uint16_t index = (uint16_t)tree.nodes.size();
+		tree.nodes.push_back({ CompiledNodeType::Action, (uint16_t)(index + 1), (uint16_t)tree.actions.size() });
+		tree.actions.push_back(f);
+		tree.names.push_back(name);
+	}
+
+	CompiledBehaviourTree<T> Build() {
+		assert(openNodes.empty());
+		return std::move(tree);
+	}
+
+protected:
+	void Begin(CompiledNodeType type, const std::string& name) {
+		openNodes.push_back((int)tree.nodes.size());
+		tree.nodes.push_back({ type, 0, 0 });
+		tree.names.push_back(name);
+	}
+
+	CompiledBehaviourTree<T>	tree;
+	std::vector<int>			openNodes;
+};
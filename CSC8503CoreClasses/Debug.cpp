@@ -1,8 +1,44 @@
 #include "Debug.h"
 using namespace NCL;
 
+//Per thread limits - a frame drawing more than this is almost certainly a bug
+const size_t MAX_THREAD_LINES		= 1 << 16;
+const size_t MAX_THREAD_STRINGS		= 1024;
+const size_t MAX_THREAD_TEXT_BYTES	= 1 << 16;
+
+//Timed lines expire at the end of the bucket their time runs out in
+const double EXPIRY_BUCKET_LENGTH	= 1.0 / 20.0;
+
+struct Debug::ThreadBuffer {
+	struct StringEntry {
+		uint32_t	textStart;
+		uint32_t	textLength;
+		Vector2		position;
+		Vector4		colour;
+	};
+	std::vector<DebugLineEntry>	lines;
+	std::vector<StringEntry>	strings;
+	std::vector<char>			text;
+
+	int droppedLines	= 0;
+	int droppedStrings	= 0;
+
+	bool inUse = true;	//false once its thread has exited, guarded by threadBufferMutex
+};
+
+std::vector<std::unique_ptr<Debug::ThreadBuffer>>	Debug::threadBuffers;
+std::mutex											Debug::threadBufferMutex;
+
 std::vector<Debug::DebugStringEntry>	Debug::stringEntries;
+std::vector<char>						Debug::stringText;
 std::vector<Debug::DebugLineEntry>		Debug::lineEntries;
+size_t									Debug::frameLineCount = 0;
+
+std::map<int64_t, std::vector<Debug::DebugLineEntry>> Debug::timedLines;
+double	Debug::currentTime		= 0.0;
+
+int		Debug::droppedLines		= 0;
+int		Debug::droppedStrings	= 0;
 
 SimpleFont* Debug::debugFont = nullptr;
 
@@ -17,17 +53,65 @@ const Vector4 Debug::YELLOW		= Vector4(1, 1, 0, 1);
 const Vector4 Debug::MAGENTA	= Vector4(1, 0, 1, 1);
 const Vector4 Debug::CYAN		= Vector4(0, 1, 1, 1);
 
-void Debug::Print(const std::string& text, const Vector2& pos, const Vector4& colour) {
-	DebugStringEntry newEntry;
+/*
+A thread's buffer is handed back when the thread exits, and picked up by the
+next new thread to draw, so threads coming and going don't each leave a buffer
+behind. Anything the exited thread drew is still gathered by the next Flush.
+*/
+Debug::ThreadBuffer& Debug::GetThreadBuffer() {
+	struct Owner {
+		ThreadBuffer* buffer = nullptr;
+		~Owner() {
+			if (buffer) {
+				std::lock_guard<std::mutex> lock(threadBufferMutex);
+				buffer->inUse = false;
+			}
+		}
+	};
+	thread_local Owner owner;
+	if (!owner.buffer) {
+		std::lock_guard<std::mutex> lock(threadBufferMutex);
+		for (const auto& buffer : threadBuffers) {
+			if (!buffer->inUse) {
+				owner.buffer = buffer.get();
+				break;
+			}
+		}
+		if (!owner.buffer) {
+			threadBuffers.emplace_back(std::make_unique<ThreadBuffer>());
+			owner.buffer = threadBuffers.back().get();
+		}
+		owner.buffer->inUse = true;
+	}
+	return *owner.buffer;
+}
+
+void Debug::Print(std::string_view text, const Vector2& pos, const Vector4& colour) {
+	ThreadBuffer& buffer = GetThreadBuffer();
 
-	newEntry.data = text;
-	newEntry.position = pos;
-	newEntry.colour = colour;
+	if (buffer.strings.size() >= MAX_THREAD_STRINGS ||
+		buffer.text.size() + text.size() > MAX_THREAD_TEXT_BYTES) {
+		buffer.droppedStrings++;
+		return;
+	}
+	ThreadBuffer::StringEntry newEntry;
+
+	newEntry.textStart	= (uint32_t)buffer.text.size();
+	newEntry.textLength = (uint32_t)text.size();
+	newEntry.position	= pos;
+	newEntry.colour		= colour;
 
-	stringEntries.emplace_back(newEntry);
+	buffer.text.insert(buffer.text.end(), text.begin(), text.end());
+	buffer.strings.emplace_back(newEntry);
 }
 
 void Debug::DrawLine(const Vector3& startpoint, const Vector3& endpoint, const Vector4& colour, float time) {
+	ThreadBuffer& buffer = GetThreadBuffer();
+
+	if (buffer.lines.size() >= MAX_THREAD_LINES) {
+		buffer.droppedLines++;
+		return;
+	}
 	DebugLineEntry newEntry;
 
 	newEntry.start = startpoint;
@@ -36,7 +120,7 @@ void Debug::DrawLine(const Vector3& startpoint, const Vector3& endpoint, const V
 	newEntry.colourB = colour;
 	newEntry.time = time;
 
-	lineEntries.emplace_back(newEntry);
+	buffer.lines.emplace_back(newEntry);
 }
 
 void Debug::DrawAxisLines(const Matrix4& modelMatrix, float scaleBoost, float time) {
@@ -54,24 +138,71 @@ void Debug::DrawAxisLines(const Matrix4& modelMatrix, float scaleBoost, float ti
 	DrawLine(worldPos, worldPos + (fwd * scaleBoost), Debug::BLUE, time);
 }
 
-void Debug::UpdateRenderables(float dt) {
-	int trim = 0;
-	for (int i = 0; i < lineEntries.size(); ) {
-		DebugLineEntry* e = &lineEntries[i];
-		e->time -= dt;
-		if (e->time < 0) {
-			trim++;
-			lineEntries[i] = lineEntries[lineEntries.size() - trim];
+/*
+Lines with no time only last the frame, so go straight into lineEntries,
+while timed lines are kept in their expiry bucket and appended after them.
+Room for all of the text is made up front, so that stringText can't be
+reallocated out from under the entries pointing into it part way through.
+*/
+void Debug::Flush() {
+	std::lock_guard<std::mutex> lock(threadBufferMutex);	//a thread could be exiting
+	droppedLines	= 0;
+	droppedStrings	= 0;
+
+	lineEntries.resize(frameLineCount);
+
+	size_t textSize = stringText.size();
+	for (const auto& buffer : threadBuffers) {
+		textSize += buffer->text.size();
+	}
+	const char* oldText = stringText.data();
+	stringText.reserve(textSize);
+	if (stringText.data() != oldText) {	//only if flushed more than once in a frame
+		for (DebugStringEntry& e : stringEntries) {
+			e.data = std::string_view(stringText.data() + (e.data.data() - oldText), e.data.size());
 		}
-		else {
-			++i;
+	}
+
+	for (const auto& buffer : threadBuffers) {
+		for (const DebugLineEntry& line : buffer->lines) {
+			if (line.time > 0.0f) {
+				int64_t bucket = (int64_t)std::ceil((currentTime + line.time) / EXPIRY_BUCKET_LENGTH);
+				timedLines[bucket].emplace_back(line);
+			}
+			else {
+				lineEntries.emplace_back(line);
+			}
 		}
-		if (i + trim >= lineEntries.size()) {
-			break;
+		size_t textStart = stringText.size();
+		stringText.insert(stringText.end(), buffer->text.begin(), buffer->text.end());
+		for (const ThreadBuffer::StringEntry& e : buffer->strings) {
+			stringEntries.push_back({ std::string_view(stringText.data() + textStart + e.textStart, e.textLength), e.position, e.colour });
 		}
+		droppedLines	+= buffer->droppedLines;
+		droppedStrings	+= buffer->droppedStrings;
+
+		buffer->lines.clear();
+		buffer->strings.clear();
+		buffer->text.clear();
+		buffer->droppedLines	= 0;
+		buffer->droppedStrings	= 0;
+	}
+	frameLineCount = lineEntries.size();
+
+	for (const auto& [bucket, lines] : timedLines) {
+		lineEntries.insert(lineEntries.end(), lines.begin(), lines.end());
+	}
+}
+
+void Debug::UpdateRenderables(float dt) {
+	currentTime += dt;
+	while (!timedLines.empty() && timedLines.begin()->first * EXPIRY_BUCKET_LENGTH < currentTime) {
+		timedLines.erase(timedLines.begin());
 	}
-	lineEntries.resize(lineEntries.size() - trim);
+	lineEntries.clear();
+	frameLineCount = 0;
 	stringEntries.clear();
+	stringText.clear();
 }
 
 SimpleFont* Debug::GetDebugFont() {
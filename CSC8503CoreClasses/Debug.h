@@ -3,15 +3,27 @@
 #include "Vector4.h"
 #include "Matrix4.h"
 #include "SimpleFont.h"
+#include <mutex>
 
 namespace NCL {
 	using namespace NCL::Maths;
 	using namespace NCL::Rendering;
+	/*
+	Lines and text can be drawn from any thread. Each thread writes into a
+	buffer of its own, so drawing never takes a lock, and the buffers are
+	gathered into the lists the renderers read by Flush, once per frame.
+	A thread's buffer starts empty and grows as it's drawn into, up to a fixed
+	limit - anything past it is dropped and counted. Buffers keep their memory
+	between frames, and are reused by new threads once their own has exited.
+
+	Strings are copied into a per frame block of text, so a DebugStringEntry
+	only points at its text, which is valid until the next UpdateRenderables.
+	*/
 	class Debug
 	{
 	public:
 		struct DebugStringEntry {
-			std::string	data;
+			std::string_view	data;
 			Vector2 position;
 			Vector4 colour;
 		};
@@ -25,13 +37,20 @@ namespace NCL {
 			Vector4 colourB;
 		};
 
-		static void Print(const std::string& text, const Vector2& pos, const Vector4& colour = Vector4(1, 1, 1, 1));
+		static void Print(std::string_view text, const Vector2& pos, const Vector4& colour = Vector4(1, 1, 1, 1));
 		static void DrawLine(const Vector3& startpoint, const Vector3& endpoint, const Vector4& colour = Vector4(1, 1, 1, 1), float time = 0.0f);
 
 		static void DrawAxisLines(const Matrix4& modelMatrix, float scaleBoost = 1.0f, float time = 0.0f);
 
+		//Gathers what every thread has drawn since the last Flush. Call at a point no other thread is drawing
+		static void Flush();
+		//Expires timed lines, and clears out everything else drawn this frame
 		static void UpdateRenderables(float dt);
 
+		//How much was dropped by the last Flush, for going over a thread's limits
+		static int GetDroppedLineCount()	{ return droppedLines;	 }
+		static int GetDroppedStringCount()	{ return droppedStrings; }
+
 		static SimpleFont* GetDebugFont();
 
 		static void CreateDebugFont(const std::string& dataFile, Texture& tex);
@@ -55,8 +74,23 @@ namespace NCL {
 		Debug() {}
 		~Debug() {}
 
+		struct ThreadBuffer;
+		static ThreadBuffer& GetThreadBuffer();
+
+		static std::vector<std::unique_ptr<ThreadBuffer>>	threadBuffers;
+		static std::mutex									threadBufferMutex;	//only taken the first time a thread draws, and as it exits
+
 		static std::vector<DebugStringEntry>	stringEntries;
-		static std::vector<DebugLineEntry>		lineEntries;
+		static std::vector<char>				stringText;		//this frame's text, pointed to by stringEntries
+		static std::vector<DebugLineEntry>		lineEntries;	//this frame's lines, followed by every live timed line
+		static size_t							frameLineCount;
+
+		//Timed lines, bucketed by when they expire, so expiring them doesn't need to visit every line
+		static std::map<int64_t, std::vector<DebugLineEntry>> timedLines;
+		static double	currentTime;
+
+		static int		droppedLines;
+		static int		droppedStrings;
 
 		static SimpleFont* debugFont;
 		static Texture* fontTexture;
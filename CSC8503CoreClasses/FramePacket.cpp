@@ -0,0 +1,106 @@
+#include "FramePacket.h"
+#include "GameWorld.h"
+#include "GameObject.h"
+#include "RenderObject.h"
+#include "FrustumCuller.h"
+#include "JobSystem.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+const size_t EXTRACT_GRAIN_SIZE = 256;
+
+RenderExtractor::RenderExtractor() {
+	front				= 0;
+	frameCount			= 0;
+	staticVersion		= 0;
+	pendingStaticAssets	= 0;
+}
+
+RenderExtractor::~RenderExtractor() {
+}
+
+void RenderExtractor::CopyItem(const GameObject& g, RenderItem& item) {
+	const RenderObject& o = *g.GetRenderObject();
+	item.modelMatrix	= o.GetTransform()->GetMatrix();
+	item.colour			= o.GetColour();
+	item.mesh			= o.GetMesh();
+	item.texture		= o.GetDefaultTexture();
+	item.shader			= o.GetShader();
+	item.source			= g.GetWorldHandle();
+	FrustumCuller::TransformBox(item.modelMatrix, item.mesh->GetBoundsMin(), item.mesh->GetBoundsMax(), item.boundsCentre, item.boundsHalf);
+}
+
+size_t RenderExtractor::CountPendingStaticAssets() const {
+	size_t count = 0;
+	for (const GameObject* g : staticSources) {
+		const RenderObject& o = *g->GetRenderObject();
+		count += !o.GetMeshHandle().IsReady() + !o.GetTextureHandle().IsReady() + !o.GetShaderHandle().IsReady();
+	}
+	return count;
+}
+
+void RenderExtractor::Extract(GameWorld& world, JobSystem* jobs) {
+	FramePacket& packet = packets[1 - front];
+
+	sources.clear();
+	staticSources.clear();
+	world.OperateOnContents(
+		[&](GameObject* o) {
+			if (o->IsActive() && o->GetRenderObject()) {
+				if (o->GetRenderObject()->IsStatic()) {
+					staticSources.emplace_back(o);
+				}
+				else {
+					sources.emplace_back(o);
+				}
+			}
+		}
+	);
+	std::sort(staticSources.begin(), staticSources.end(),
+		[](const GameObject* a, const GameObject* b) { return a->GetWorldHandle() < b->GetWorldHandle(); }
+	);
+	bool staticsChanged = !std::equal(staticSources.begin(), staticSources.end(), lastStaticSources.begin(), lastStaticSources.end(),
+		[](const GameObject* o, GameObjectHandle h) { return o->GetWorldHandle() == h; }
+	);
+	if (staticsChanged) {
+		lastStaticSources.clear();
+		for (const GameObject* o : staticSources) {
+			lastStaticSources.emplace_back(o->GetWorldHandle());
+		}
+		staticVersion++;
+		pendingStaticAssets = CountPendingStaticAssets();
+	}
+	else if (pendingStaticAssets > 0) {
+		size_t stillPending = CountPendingStaticAssets();
+		if (stillPending < pendingStaticAssets) {
+			staticVersion++;	//so the items pick up whatever's arrived in place of its placeholder
+		}
+		pendingStaticAssets = stillPending;
+	}
+	if (packet.staticVersion != staticVersion) {
+		packet.staticItems.resize(staticSources.size());
+		for (size_t i = 0; i < staticSources.size(); ++i) {
+			CopyItem(*staticSources[i], packet.staticItems[i]);
+		}
+		packet.staticVersion = staticVersion;
+	}
+
+	packet.items.resize(sources.size());
+	packet.camera	= world.GetMainCamera();
+	packet.frameID	= frameCount++;
+
+	auto CopyItems = [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			CopyItem(*sources[i], packet.items[i]);
+		}
+	};
+	if (jobs) {
+		jobs->ParallelFor(sources.size(), EXTRACT_GRAIN_SIZE, CopyItems);
+	}
+	else {
+		CopyItems(0, sources.size());
+	}
+
+	front = 1 - front;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include "Camera.h"
+#include "GameObjectHandle.h"
+
+namespace NCL {
+	class JobSystem;
+	namespace Rendering {
+		class Mesh;
+		class Shader;
+		class Texture;
+	}
+	using namespace NCL::Rendering;
+	using namespace NCL::Maths;
+
+	namespace CSC8503 {
+		class GameWorld;
+		class GameObject;
+
+		//Everything the renderer needs to know about one object for a frame
+		struct RenderItem {
+			Matrix4		modelMatrix;
+			Vector4		colour;
+			Vector3		boundsCentre;	//world space AABB of the mesh
+			Vector3		boundsHalf;
+			Mesh*		mesh;
+			Texture*	texture;
+			Shader*		shader;
+			GameObjectHandle source;	//identifies the object from frame to frame, even if its memory's reused
+		};
+
+		struct FramePacket {
+			std::vector<RenderItem> items;
+			std::vector<RenderItem> staticItems;	//from static render objects, in the same order for the same staticVersion
+			PerspectiveCamera		camera;
+			uint64_t				frameID = 0;
+			uint64_t				staticVersion = 0;
+		};
+
+		/*
+		Copies the state of the world that rendering needs into a FramePacket, so
+		that the renderer never has to touch a live GameObject. There are two
+		packets: Extract fills the back one and then swaps it to the front, so a
+		renderer can still be submitting the front packet of frame N on one thread
+		while the simulation of frame N+1 runs on another - the only point the two
+		need to meet is the swap.
+
+		Finding the objects to draw is a quick walk over the world's list, while
+		the copying, which builds each object's matrix and bounds, is spread over
+		the job system if one is given.
+
+		Static render objects are kept apart from the rest. They're only copied
+		when the set of them changes, or when an asset one of them was waiting on
+		finishes loading, either of which bumps staticVersion, so anything a
+		renderer works out from them can be kept for as long as that stays the same.
+		*/
+		class RenderExtractor {
+		public:
+			RenderExtractor();
+			~RenderExtractor();
+
+			void Extract(GameWorld& world, JobSystem* jobs = nullptr);
+
+			const FramePacket& GetFrontPacket() const {
+				return packets[front];
+			}
+
+		protected:
+			static void CopyItem(const GameObject& o, RenderItem& item);
+			size_t CountPendingStaticAssets() const;
+
+			FramePacket packets[2];
+			int			front;
+			uint64_t	frameCount;
+
+			std::vector<const GameObject*>	sources;
+			std::vector<const GameObject*>	staticSources;		//sorted by handle, so the world's order doesn't matter
+			std::vector<GameObjectHandle>	lastStaticSources;
+			uint64_t	staticVersion;
+			size_t		pendingStaticAssets;	//still showing a placeholder in the last copy of the static items
+		};
+	}
+}
@@ -4,8 +4,21 @@
 #include "RenderObject.h"
 #include "NetworkObject.h"
 
+using namespace NCL;
 using namespace NCL::CSC8503;
 
+static_assert(sizeof(AABBVolume)	<= CollisionVolume::PoolSlotSize);
+static_assert(sizeof(OBBVolume)		<= CollisionVolume::PoolSlotSize);
+static_assert(sizeof(SphereVolume)	<= CollisionVolume::PoolSlotSize);
+static_assert(sizeof(CapsuleVolume)	<= CollisionVolume::PoolSlotSize);
+
+//These can come from the level arena, which is reset without running destructors
+static_assert(std::is_trivially_destructible_v<AABBVolume>);
+static_assert(std::is_trivially_destructible_v<OBBVolume>);
+static_assert(std::is_trivially_destructible_v<SphereVolume>);
+static_assert(std::is_trivially_destructible_v<CapsuleVolume>);
+static_assert(std::is_trivially_destructible_v<PhysicsObject>);
+
 GameObject::GameObject(const std::string& objectName)	{
 	name			= objectName;
 	worldID			= -1;
@@ -23,6 +36,11 @@ GameObject::~GameObject()	{
 	delete networkObject;
 }
 
+MemoryPool& GameObject::GetPool() {
+	static MemoryPool pool("GameObject", sizeof(GameObject));
+	return pool;
+}
+
 bool GameObject::GetBroadphaseAABB(Vector3&outSize) const {
 	if (!boundingVolume) {
 		return false;
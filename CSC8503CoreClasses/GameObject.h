@@ -1,6 +1,8 @@
 #pragma once
 #include "Transform.h"
 #include "CollisionVolume.h"
+#include "MemoryPool.h"
+#include "GameObjectHandle.h"
 
 using std::vector;
 
@@ -9,10 +11,12 @@ namespace NCL::CSC8503 {
 	class RenderObject;
 	class PhysicsObject;
 
-	class GameObject	{
+	class GameObject : public PooledObject<GameObject>	{
 	public:
 		GameObject(const std::string& name = "");
-		~GameObject();
+		virtual ~GameObject();
+
+		static MemoryPool& GetPool();
 
 		void SetBoundingVolume(CollisionVolume* vol) {
 			boundingVolume = vol;
@@ -26,6 +30,11 @@ namespace NCL::CSC8503 {
 			return isActive;
 		}
 
+		//Inactive objects stay in the world, but aren't simulated, drawn or sent over the network
+		void SetActive(bool state) {
+			isActive = state;
+		}
+
 		Transform& GetTransform() {
 			return transform;
 		}
@@ -78,6 +87,14 @@ namespace NCL::CSC8503 {
 			return worldID;
 		}
 
+		void SetWorldHandle(GameObjectHandle h) {
+			worldHandle = h;
+		}
+
+		GameObjectHandle GetWorldHandle() const {
+			return worldHandle;
+		}
+
 	protected:
 		Transform			transform;
 
@@ -90,6 +107,8 @@ namespace NCL::CSC8503 {
 		int			worldID;
 		std::string	name;
 
+		GameObjectHandle worldHandle;
+
 		Vector3 broadphaseAABB;
 	};
 }
@@ -0,0 +1,33 @@
+#pragma once
+
+namespace NCL::CSC8503 {
+	//Refers to an object in a GameWorld without keeping a pointer to it. Once the
+	//object's removed, its slot's generation moves on, and the handle stops resolving.
+	struct GameObjectHandle {
+		uint32_t index		= ~0u;
+		uint32_t generation	= 0;
+
+		bool IsValid() const {
+			return index != ~0u;
+		}
+
+		bool operator==(const GameObjectHandle& other) const {
+			return index == other.index && generation == other.generation;
+		}
+
+		bool operator!=(const GameObjectHandle& other) const {
+			return !(*this == other);
+		}
+
+		bool operator<(const GameObjectHandle& other) const {
+			return index != other.index ? index < other.index : generation < other.generation;
+		}
+	};
+}
+
+template <>
+struct std::hash<NCL::CSC8503::GameObjectHandle> {
+	size_t operator()(const NCL::CSC8503::GameObjectHandle& h) const {
+		return std::hash<uint64_t>()(((uint64_t)h.generation << 32) | h.index);
+	}
+};
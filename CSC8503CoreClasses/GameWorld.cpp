@@ -19,36 +19,129 @@ GameWorld::~GameWorld()	{
 }
 
 void GameWorld::Clear() {
+	CommitRemovals();
+	//Generations carry on from where they were, so old handles never resolve again
+	for (uint32_t i = 0; i < objectSlots.size(); ++i) {
+		if (objectSlots[i].object) {
+			objectSlots[i].generation++;
+			FreeObjectSlot(i);
+		}
+	}
 	gameObjects.clear();
 	constraints.clear();
+	constraintIndices.clear();
+	staticObjects.Clear();
 	worldIDCounter		= 0;
 	worldStateCounter	= 0;
 }
 
 void GameWorld::ClearAndErase() {
+	CommitRemovals();
 	for (auto& i : gameObjects) {
 		delete i;
 	}
 	for (auto& i : constraints) {
 		delete i;
 	}
+	staticObjects.Clear(true);
 	Clear();
+	levelArena.Reset();
 }
 
 void GameWorld::AddGameObject(GameObject* o) {
+	o->SetWorldHandle(AddObjectSlot(o, (uint32_t)gameObjects.size()));
 	gameObjects.emplace_back(o);
 	o->SetWorldID(worldIDCounter++);
 	worldStateCounter++;
 }
 
+/*
+Until CommitRemovals takes it out of the list, a removed object is made
+inactive, so that physics, raycasts and extraction all skip over it like
+it's already gone. If it isn't being deleted, it gets its old state back.
+*/
 void GameWorld::RemoveGameObject(GameObject* o, bool andDelete) {
-	gameObjects.erase(std::remove(gameObjects.begin(), gameObjects.end(), o), gameObjects.end());
-	if (andDelete) {
-		delete o;
+	GameObjectHandle h = o->GetWorldHandle();
+	if (GetGameObject(h) != o) {
+		return; //Already removed
 	}
+	assert(objectSlots[h.index].listIndex != NotListed && "Static objects can only be removed by clearing the world");
+	objectSlots[h.index].generation++;
+	pendingRemovals.push_back({ h.index, andDelete, o->IsActive() });
+	o->SetActive(false);
 	worldStateCounter++;
 }
 
+void GameWorld::CommitRemovals() {
+	for (const PendingRemoval& r : pendingRemovals) {
+		GameObject* o = objectSlots[r.slot].object;
+		uint32_t listIndex = objectSlots[r.slot].listIndex;
+
+		//Swap and pop - the object moved into the gap needs its slot telling where it's gone
+		GameObject* last = gameObjects.back();
+		gameObjects[listIndex] = last;
+		objectSlots[last->GetWorldHandle().index].listIndex = listIndex;
+		gameObjects.pop_back();
+
+		FreeObjectSlot(r.slot);
+		if (r.andDelete) {
+			delete o;
+		}
+		else {
+			o->SetActive(r.wasActive);
+		}
+	}
+	pendingRemovals.clear();
+}
+
+GameObject* GameWorld::GetGameObject(GameObjectHandle h) const {
+	if (h.index >= objectSlots.size() || objectSlots[h.index].generation != h.generation) {
+		return nullptr;
+	}
+	return objectSlots[h.index].object;
+}
+
+void GameWorld::AddStaticObject(GameObject* o) {
+	o->SetWorldHandle(AddObjectSlot(o, NotListed));
+	staticObjects.Add(o);
+	o->SetWorldID(worldIDCounter++);
+}
+
+GameObjectHandle GameWorld::AddObjectSlot(GameObject* o, uint32_t listIndex) {
+	if (freeObjectSlots.empty()) {
+		freeObjectSlots.push_back((uint32_t)objectSlots.size());
+		objectSlots.push_back({ nullptr, 0, NotListed });
+	}
+	uint32_t index = freeObjectSlots.back();
+	freeObjectSlots.pop_back();
+
+	ObjectSlot& s = objectSlots[index];
+	s.object	= o;
+	s.listIndex	= listIndex;
+	s.generation++;
+	return { index, s.generation };
+}
+
+void GameWorld::FreeObjectSlot(uint32_t index) {
+	ObjectSlot& s = objectSlots[index];
+	s.object	= nullptr;
+	s.listIndex	= NotListed;
+	freeObjectSlots.push_back(index);
+}
+
+void GameWorld::UpdateListIndices() {
+	for (uint32_t i = 0; i < gameObjects.size(); ++i) {
+		objectSlots[gameObjects[i]->GetWorldHandle().index].listIndex = i;
+	}
+	for (size_t i = 0; i < constraints.size(); ++i) {
+		constraintIndices[constraints[i]] = i;
+	}
+}
+
+void GameWorld::BuildStaticObjects() {
+	staticObjects.Build();
+}
+
 void GameWorld::GetObjectIterators(
 	GameObjectIterator& first,
 	GameObjectIterator& last) const {
@@ -76,31 +169,37 @@ void GameWorld::UpdateWorld(float dt) {
 	if (shuffleConstraints) {
 		std::shuffle(constraints.begin(), constraints.end(), e);
 	}
+
+	if (shuffleObjects || shuffleConstraints) {
+		UpdateListIndices();
+	}
 }
 
 bool GameWorld::Raycast(Ray& r, RayCollision& closestCollision, bool closestObject, GameObject* ignoreThis) const {
 	//The simplest raycast just goes through each object and sees if there's a collision
 	RayCollision collision;
 
-	for (auto& i : gameObjects) {
-		if (!i->GetBoundingVolume()) { //objects might not be collideable etc...
-			continue;
-		}
-		if (i == ignoreThis) {
-			continue;
-		}
-		RayCollision thisCollision;
-		if (CollisionDetection::RayIntersection(r, *i, thisCollision)) {
-				
-			if (!closestObject) {	
-				closestCollision		= collision;
-				closestCollision.node = i;
-				return true;
+	for (const std::vector<GameObject*>* list : { &gameObjects, &staticObjects.GetObjects() }) {
+		for (auto& i : *list) {
+			if (!i->GetBoundingVolume() || !i->IsActive()) { //objects might not be collideable etc...
+				continue;
 			}
-			else {
-				if (thisCollision.rayDistance < collision.rayDistance) {
-					thisCollision.node = i;
-					collision = thisCollision;
+			if (i == ignoreThis) {
+				continue;
+			}
+			RayCollision thisCollision;
+			if (CollisionDetection::RayIntersection(r, *i, thisCollision)) {
+				
+				if (!closestObject) {	
+					closestCollision		= collision;
+					closestCollision.node = i;
+					return true;
+				}
+				else {
+					if (thisCollision.rayDistance < collision.rayDistance) {
+						thisCollision.node = i;
+						collision = thisCollision;
+					}
 				}
 			}
 		}
@@ -119,11 +218,21 @@ Constraint Tutorial Stuff
 */
 
 void GameWorld::AddConstraint(Constraint* c) {
+	constraintIndices[c] = constraints.size();
 	constraints.emplace_back(c);
 }
 
 void GameWorld::RemoveConstraint(Constraint* c, bool andDelete) {
-	constraints.erase(std::remove(constraints.begin(), constraints.end(), c), constraints.end());
+	auto i = constraintIndices.find(c);
+	if (i == constraintIndices.end()) {
+		return;
+	}
+	Constraint* last = constraints.back();
+	constraints[i->second] = last;
+	constraintIndices[last] = i->second;
+	constraints.pop_back();
+	constraintIndices.erase(c);
+
 	if (andDelete) {
 		delete c;
 	}
@@ -4,6 +4,9 @@
 #include "Ray.h"
 #include "CollisionDetection.h"
 #include "QuadTree.h"
+#include "StaticCollisionGrid.h"
+#include "MemoryArena.h"
+#include "GameObjectHandle.h"
 namespace NCL {
 		class Camera;
 		using Maths::Ray;
@@ -20,10 +23,37 @@ namespace NCL {
 			~GameWorld();
 
 			void Clear();
+			//Deletes everything, and then resets the level arena
 			void ClearAndErase();
 
+			//Collision volumes and physics objects made while a MemoryArena::Scope for
+			//this is alive live until the next ClearAndErase, and are freed all at once
+			//by it, with no destructors to run. GameObjects, and the components that do
+			//own something, still come from their pools
+			MemoryArena& GetLevelArena() {
+				return levelArena;
+			}
+
 			void AddGameObject(GameObject* o);
+			//The object's handle stops resolving straight away, but it stays in the
+			//object list, inactive, and isn't deleted, until the next CommitRemovals,
+			//so it's safe to call while the world's being iterated over. Static
+			//objects can't be removed, other than by clearing the world
 			void RemoveGameObject(GameObject* o, bool andDelete = false);
+			//Call once a frame, when nothing is iterating over the world
+			void CommitRemovals();
+
+			//Returns nullptr if the object has been removed
+			GameObject* GetGameObject(GameObjectHandle h) const;
+
+			//Static objects are collided with and raycast against, but never updated or
+			//drawn - call BuildStaticObjects once they've all been added
+			void AddStaticObject(GameObject* o);
+			void BuildStaticObjects();
+
+			const StaticCollisionGrid& GetStaticObjects() const {
+				return staticObjects;
+			}
 
 			void AddConstraint(Constraint* c);
 			void RemoveConstraint(Constraint* c, bool andDelete = false);
@@ -59,8 +89,32 @@ namespace NCL {
 			}
 
 		protected:
+			GameObjectHandle	AddObjectSlot(GameObject* o, uint32_t listIndex);
+			void				FreeObjectSlot(uint32_t index);
+			void				UpdateListIndices();
+
+			struct ObjectSlot {
+				GameObject* object;
+				uint32_t	generation;	//odd while the slot's in use
+				uint32_t	listIndex;	//where the object is in gameObjects
+			};
+			static const uint32_t NotListed = ~0u;
+
+			struct PendingRemoval {
+				uint32_t	slot;
+				bool		andDelete;
+				bool		wasActive;
+			};
+
+			std::vector<ObjectSlot>		objectSlots;
+			std::vector<uint32_t>		freeObjectSlots;
+			std::vector<PendingRemoval>	pendingRemovals;
+
 			std::vector<GameObject*> gameObjects;
 			std::vector<Constraint*> constraints;
+			std::unordered_map<Constraint*, size_t> constraintIndices;
+			StaticCollisionGrid		 staticObjects;
+			MemoryArena				 levelArena;
 
 			PerspectiveCamera mainCamera;
 
@@ -0,0 +1,197 @@
+#include "IndirectDrawLayout.h"
+#include "FramePacket.h"
+#include "Frustum.h"
+#include "Mesh.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+IndirectDrawLayout::IndirectDrawLayout() {
+	instanceCapacity	= 0;
+	frameCount			= 0;
+}
+
+IndirectDrawLayout::~IndirectDrawLayout() {
+}
+
+bool IndirectDrawLayout::CanDraw(const RenderItem& item) {
+	return	item.colour.w >= 1.0f &&
+			item.mesh->GetIndexCount() > 0 &&
+			item.mesh->GetPrimitiveType() == GeometryPrimitive::Triangles;
+}
+
+void IndirectDrawLayout::Update(const FramePacket& packet) {
+	frameCount++;
+	for (DrawGroup& group : groups) {
+		group.objectCount = 0;
+	}
+	for (const RenderItem& item : packet.items) {
+		AddItem(item);
+	}
+	for (const RenderItem& item : packet.staticItems) {
+		AddItem(item);
+	}
+	//Anything not seen this time has left the world, or can't be drawn this way any more
+	for (uint32_t slot = 0; slot < objects.size(); ++slot) {
+		if (slotOwners[slot].IsValid() && slotFrames[slot] != frameCount) {
+			FreeSlot(slot);
+		}
+	}
+	BuildCommands();
+	BuildDirtyRanges();
+}
+
+void IndirectDrawLayout::AddItem(const RenderItem& item) {
+	if (!CanDraw(item)) {
+		return;
+	}
+	auto i = slotIndices.find(item.source);
+	if (i == slotIndices.end()) {
+		i = slotIndices.insert({ item.source, AllocateSlot(item.source) }).first;
+	}
+	uint32_t slot		= i->second;
+	slotFrames[slot]	= frameCount;
+
+	DrawGroup& group = groups[GetGroup(item)];
+	group.objectCount++;
+
+	ObjectRecord record;
+	record.modelMatrix	= item.modelMatrix;
+	record.colour		= item.colour;
+	record.boundsCentre	= Vector4(item.boundsCentre, 0.0f);
+	record.boundsHalf	= Vector4(item.boundsHalf, 0.0f);
+	record.firstCommand	= group.firstCommand;
+	record.commandCount	= group.commandCount;
+
+	if (memcmp(&objects[slot], &record, sizeof(ObjectRecord)) != 0) {
+		objects[slot]		= record;
+		dirtySlots[slot]	= 1;
+	}
+}
+
+/*
+A new group gets its commands added to the end of the list, so that no
+existing object's first command ever moves. The sorted order is only for
+the renderer to keep its state changes down when it walks the groups.
+*/
+uint32_t IndirectDrawLayout::GetGroup(const RenderItem& item) {
+	GroupKey key = { item.shader, item.texture, item.mesh };
+	auto i = groupIndices.find(key);
+	if (i != groupIndices.end()) {
+		return i->second;
+	}
+	DrawGroup group;
+	group.mesh			= item.mesh;
+	group.shader		= item.shader;
+	group.texture		= item.texture;
+	group.firstCommand	= (uint32_t)commands.size();
+	group.commandCount	= (uint32_t)std::max(item.mesh->GetSubMeshCount(), (size_t)1);
+	group.objectCount	= 0;
+
+	//The same ranges of the index buffer as OGLRenderer::DrawBoundMesh draws
+	for (uint32_t s = 0; s < group.commandCount; ++s) {
+		DrawCommand command = { (uint32_t)item.mesh->GetIndexCount(), 0, 0, 0, 0 };
+		if (s < item.mesh->GetSubMeshCount()) {
+			command.count		= item.mesh->GetSubMesh(s)->count;
+			command.firstIndex	= item.mesh->GetSubMesh(s)->start;
+		}
+		commands.emplace_back(command);
+	}
+
+	uint32_t index = (uint32_t)groups.size();
+	groups.emplace_back(group);
+	groupIndices.insert({ key, index });
+
+	groupOrder.clear();
+	for (const auto& [groupKey, groupIndex] : groupIndices) {
+		groupOrder.emplace_back(groupIndex);
+	}
+	return index;
+}
+
+uint32_t IndirectDrawLayout::AllocateSlot(GameObjectHandle owner) {
+	uint32_t slot;
+	if (freeSlots.empty()) {
+		slot = (uint32_t)objects.size();
+		objects.emplace_back();
+		slotOwners.emplace_back();
+		slotFrames.emplace_back(0);
+		dirtySlots.emplace_back(1);
+	}
+	else {
+		slot = freeSlots.back();
+		freeSlots.pop_back();
+	}
+	slotOwners[slot] = owner;
+	return slot;
+}
+
+void IndirectDrawLayout::FreeSlot(uint32_t slot) {
+	slotIndices.erase(slotOwners[slot]);
+	slotOwners[slot]	= GameObjectHandle();
+	objects[slot]		= ObjectRecord();
+	dirtySlots[slot]	= 1;
+	freeSlots.emplace_back(slot);
+}
+
+//Each group's instances start where the previous group's end, with room for every object in it
+void IndirectDrawLayout::BuildCommands() {
+	instanceCapacity = 0;
+	for (const DrawGroup& group : groups) {
+		for (uint32_t c = 0; c < group.commandCount; ++c) {
+			commands[group.firstCommand + c].instanceCount	= 0;
+			commands[group.firstCommand + c].baseInstance	= instanceCapacity;
+		}
+		instanceCapacity += group.objectCount;
+	}
+}
+
+void IndirectDrawLayout::BuildDirtyRanges() {
+	dirtyRanges.clear();
+	for (uint32_t slot = 0; slot < dirtySlots.size(); ++slot) {
+		if (!dirtySlots[slot]) {
+			continue;
+		}
+		if (!dirtyRanges.empty() && dirtyRanges.back().first + dirtyRanges.back().second == slot) {
+			dirtyRanges.back().second++;
+		}
+		else {
+			dirtyRanges.emplace_back(slot, 1);
+		}
+		dirtySlots[slot] = 0;
+	}
+}
+
+/*
+The box test is written the same way as in FrustumCuller::Cull, so the two
+agree exactly on which objects are visible. The order instances end up in
+within a group differs from the GPU's, which depends on how its threads run.
+*/
+void IndirectDrawLayout::Cull(const Frustum& frustum, std::vector<DrawCommand>& outCommands, std::vector<uint32_t>& outInstances) const {
+	outCommands = commands;
+	outInstances.assign(instanceCapacity, ~0u);
+
+	for (uint32_t slot = 0; slot < objects.size(); ++slot) {
+		const ObjectRecord& o = objects[slot];
+		if (o.commandCount == 0) {
+			continue;
+		}
+		bool inside = true;
+		for (int p = 0; p < 6; ++p) {
+			const Plane& plane	= frustum.GetPlane(p);
+			const Vector3 n		= plane.GetNormal();
+
+			float distance	= o.boundsCentre.x * n.x + o.boundsCentre.y * n.y + o.boundsCentre.z * n.z + plane.GetDistance();
+			float radius	= o.boundsHalf.x * std::abs(n.x) + o.boundsHalf.y * std::abs(n.y) + o.boundsHalf.z * std::abs(n.z);
+			inside &= (distance > -radius);
+		}
+		if (!inside) {
+			continue;
+		}
+		uint32_t instance = outCommands[o.firstCommand].instanceCount;
+		for (uint32_t c = 0; c < o.commandCount; ++c) {
+			outCommands[o.firstCommand + c].instanceCount++;
+		}
+		outInstances[outCommands[o.firstCommand].baseInstance + instance] = slot;
+	}
+}
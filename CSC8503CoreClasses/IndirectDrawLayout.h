@@ -0,0 +1,144 @@
+#pragma once
+#include "GameObjectHandle.h"
+
+namespace NCL {
+	namespace Maths {
+		class Frustum;
+	}
+	namespace Rendering {
+		class Mesh;
+		class Shader;
+		class Texture;
+	}
+	using namespace NCL::Rendering;
+	using namespace NCL::Maths;
+
+	namespace CSC8503 {
+		struct RenderItem;
+		struct FramePacket;
+
+		/*
+		The CPU's half of drawing with the GPU doing the culling, kept free of any
+		graphics API so that it can be checked without a window.
+
+		Every object that can be drawn this way keeps the same slot in an object
+		array from frame to frame, so only the slots whose matrix, colour or
+		bounds have actually changed need uploading again. Objects sharing a
+		mesh, shader and texture form a group, which gets one indirect draw
+		command per sub mesh and a range of the visible instance array to write
+		into. A cull shader then goes over every slot, and for each one that's
+		in the frustum bumps its group's instance counts and copies it into the
+		group's range, leaving the CPU with one multi draw call per group no
+		matter how many objects it has.
+
+		Cull does the same thing as cullObjects.comp, one object at a time, to
+		check against the visible set of the CPU path. Only opaque, indexed
+		triangle meshes are handled; anything else, such as transparent objects
+		that need sorting, is left for the usual render queue.
+		*/
+		class IndirectDrawLayout {
+		public:
+			//Matches DrawElementsIndirectCommand, and DrawCommand in cullObjects.comp
+			struct DrawCommand {
+				uint32_t	count;
+				uint32_t	instanceCount;
+				uint32_t	firstIndex;
+				int32_t		baseVertex;
+				uint32_t	baseInstance;
+			};
+
+			//Laid out to match ObjectData in cullObjects.comp under std430 rules
+			struct ObjectRecord {
+				Matrix4		modelMatrix;
+				Vector4		colour;
+				Vector4		boundsCentre;	//w is unused
+				Vector4		boundsHalf;
+				uint32_t	firstCommand	= 0;
+				uint32_t	commandCount	= 0;	//0 marks an empty slot
+				uint32_t	padding[2]		= { 0, 0 };
+			};
+
+			struct DrawGroup {
+				Mesh*		mesh;
+				Shader*		shader;
+				Texture*	texture;
+				uint32_t	firstCommand;
+				uint32_t	commandCount;	//one per sub mesh
+				uint32_t	objectCount;	//how many slots use the group this frame
+			};
+
+			IndirectDrawLayout();
+			~IndirectDrawLayout();
+
+			//Whether an item can be drawn this way, rather than through a render queue
+			static bool CanDraw(const RenderItem& item);
+
+			//Brings the slots, groups and commands up to date with a frame packet's items and static items
+			void Update(const FramePacket& packet);
+
+			const std::vector<ObjectRecord>& GetObjects() const {
+				return objects;
+			}
+			//With every instance count at 0, ready for the cull to fill in
+			const std::vector<DrawCommand>& GetCommands() const {
+				return commands;
+			}
+			const std::vector<DrawGroup>& GetGroups() const {
+				return groups;
+			}
+			//Group indices, sorted by shader, then texture, then mesh
+			const std::vector<uint32_t>& GetGroupOrder() const {
+				return groupOrder;
+			}
+			//Runs of object slots changed by the last Update, as first slot and count
+			const std::vector<std::pair<uint32_t, uint32_t>>& GetDirtyRanges() const {
+				return dirtyRanges;
+			}
+			//How many entries the visible instance array needs
+			uint32_t GetInstanceCapacity() const {
+				return instanceCapacity;
+			}
+			GameObjectHandle GetSlotOwner(uint32_t slot) const {
+				return slotOwners[slot];
+			}
+
+			//Fills in the instance counts and the object slot of each visible instance, as the cull shader would
+			void Cull(const Frustum& frustum, std::vector<DrawCommand>& outCommands, std::vector<uint32_t>& outInstances) const;
+
+		protected:
+			struct GroupKey {
+				const Shader*	shader;
+				const Texture*	texture;
+				const Mesh*		mesh;
+
+				bool operator<(const GroupKey& other) const {
+					return std::tie(shader, texture, mesh) < std::tie(other.shader, other.texture, other.mesh);
+				}
+			};
+
+			void		AddItem(const RenderItem& item);
+			uint32_t	GetGroup(const RenderItem& item);
+			uint32_t	AllocateSlot(GameObjectHandle owner);
+			void		FreeSlot(uint32_t slot);
+			void		BuildCommands();
+			void		BuildDirtyRanges();
+
+			std::vector<ObjectRecord>			objects;
+			std::vector<GameObjectHandle>		slotOwners;
+			std::vector<uint64_t>				slotFrames;	//when each slot was last seen in a packet
+			std::vector<uint8_t>				dirtySlots;
+			std::vector<uint32_t>				freeSlots;
+			std::unordered_map<GameObjectHandle, uint32_t> slotIndices;
+
+			std::vector<DrawCommand>		commands;
+			std::vector<DrawGroup>			groups;
+			std::vector<uint32_t>			groupOrder;
+			std::map<GroupKey, uint32_t>	groupIndices;
+
+			std::vector<std::pair<uint32_t, uint32_t>> dirtyRanges;
+
+			uint32_t	instanceCapacity;
+			uint64_t	frameCount;
+		};
+	}
+}
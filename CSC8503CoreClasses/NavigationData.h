@@ -0,0 +1,54 @@
+#pragma once
+#include "CookedData.h"
+
+namespace NCL {
+	namespace CSC8503 {
+		/*
+		On-disk layout of cooked navigation data. The text formats stay as the
+		source input, and are turned into these files offline by AssetCooker (or
+		by NavigationGrid::Cook / NavigationMesh::Cook). Every section starts on a
+		16 byte boundary, and holds exactly the arrays the runtime searches over,
+		so a cooked file can be memory mapped and used without any parsing.
+		*/
+		namespace NavigationData {
+			const uint32_t GridMagic	= 0x4452474E; //'NGRD'
+			const uint32_t MeshMagic	= 0x48534D4E; //'NMSH'
+			const uint32_t Version		= 1;
+
+			using CookedData::CookedExtension;
+			using CookedData::FileHeader;
+			using CookedData::AlignOffset;
+			using CookedData::CookedFileIsCurrent;
+
+			struct GridHeader {
+				FileHeader file;
+				int32_t nodeSize;
+				int32_t gridWidth;
+				int32_t gridHeight;
+				int32_t regionCount;
+				uint64_t nodesOffset;	//gridWidth * gridHeight GridNodes
+				uint64_t padding;
+			};
+
+			struct MeshHeader {
+				FileHeader file;
+				int32_t numVerts;
+				int32_t numTris;
+				int32_t gridCellsX;
+				int32_t gridCellsZ;
+				float	gridMin[3];
+				float	gridCellSize;
+				int32_t numGridTris;
+				int32_t padding;
+				uint64_t vertsOffset;		//numVerts Vector3s
+				uint64_t trisOffset;		//numTris NavTris
+				uint64_t cellStartOffset;	//gridCellsX * gridCellsZ + 1 ints
+				uint64_t gridTrisOffset;	//numGridTris ints
+			};
+
+			inline bool HeaderIsValid(const FileHeader* header, uint32_t magic, size_t headerSize, size_t mappedSize) {
+				return CookedData::HeaderIsValid(header, magic, Version, headerSize, mappedSize);
+			}
+		}
+	}
+}
@@ -1,7 +1,10 @@
 #include "NavigationGrid.h"
+#include "NavigationData.h"
 #include "Assets.h"
 
 #include <fstream>
+#include <queue>
+#include <climits>
 
 using namespace NCL;
 using namespace CSC8503;
@@ -14,67 +17,219 @@ const int BOTTOM_NODE	= 3;
 const char WALL_NODE	= 'x';
 const char FLOOR_NODE	= '.';
 
+const char NODE_UNSEEN	= 0;
+const char NODE_OPEN	= 1;
+const char NODE_CLOSED	= 2;
+
+const int PATH_CACHE_BLOCK_SIZE	= 8;	//in grid cells
+const int PATH_CACHE_MAX_SIZE	= 4096;
+
+static_assert(std::is_trivially_copyable_v<GridNode>, "GridNodes are read straight out of cooked files!");
+
 NavigationGrid::NavigationGrid()	{
 	nodeSize	= 0;
 	gridWidth	= 0;
 	gridHeight	= 0;
-	allNodes	= nullptr;
+	regionCount = 0;
+	blocksWide	= 0;
+	openEpoch	= 0;
 }
 
 NavigationGrid::NavigationGrid(const std::string&filename, Vector3 startPoint) : NavigationGrid() {
-	std::ifstream infile(Assets::DATADIR + filename);
+	origin = startPoint;
+
+	std::string sourceFile = Assets::DATADIR + filename;
+	std::string cookedFile = sourceFile + NavigationData::CookedExtension;
+
+	if (!NavigationData::CookedFileIsCurrent(sourceFile, cookedFile) || !LoadCooked(cookedFile)) {
+		LoadText(sourceFile);
+	}
+
+	nodeF.resize(allNodes.size());
+	nodeG.resize(allNodes.size());
+	nodeParent.resize(allNodes.size());
+	nodeState.resize(allNodes.size());
+
+	blocksWide = (gridWidth + PATH_CACHE_BLOCK_SIZE - 1) / PATH_CACHE_BLOCK_SIZE;
+	int blocksHigh = (gridHeight + PATH_CACHE_BLOCK_SIZE - 1) / PATH_CACHE_BLOCK_SIZE;
+	blockGenerations.resize(blocksWide * blocksHigh, 0);
+}
+
+NavigationGrid::~NavigationGrid()	{
+}
+
+bool NavigationGrid::LoadText(const std::string& filename) {
+	std::ifstream infile(filename);
+	if (!infile) {
+		return false;
+	}
 
 	infile >> nodeSize;
 	infile >> gridWidth;
 	infile >> gridHeight;
 
-	allNodes = new GridNode[gridWidth * gridHeight];
+	ownedNodes.resize(gridWidth * gridHeight);
 
 	float halfNodeSize = 0.5f * nodeSize;
 
 	for (int y = 0; y < gridHeight; ++y) {
 		for (int x = 0; x < gridWidth; ++x) {
-			GridNode&n = allNodes[(gridWidth * y) + x];
+			GridNode&n = ownedNodes[(gridWidth * y) + x];
 			char type = 0;
 			infile >> type;
 			n.type = type;
-			n.position = startPoint + Vector3((float)(x * nodeSize + halfNodeSize), 0, (float)(y * nodeSize + halfNodeSize));
+			n.position = Vector3((float)(x * nodeSize + halfNodeSize), 0, (float)(y * nodeSize + halfNodeSize));
 		}
 	}
-	
-	//now to build the connectivity between the nodes
-	for (int y = 0; y < gridHeight; ++y) {
-		for (int x = 0; x < gridWidth; ++x) {
-			GridNode&n = allNodes[(gridWidth * y) + x];		
+	BuildConnectivity(ownedNodes);
+	regionCount = BuildRegions(ownedNodes);
 
-			if (y > 0) { //get the above node
-				n.connected[0] = &allNodes[(gridWidth * (y - 1)) + x];
-			}
-			if (y < gridHeight - 1) { //get the below node
-				n.connected[1] = &allNodes[(gridWidth * (y + 1)) + x];
-			}
-			if (x > 0) { //get left node
-				n.connected[2] = &allNodes[(gridWidth * (y)) + (x - 1)];
+	allNodes = ownedNodes;
+	return true;
+}
+
+void NavigationGrid::BuildConnectivity(std::vector<GridNode>& nodes) const {
+	for (int i = 0; i < nodes.size(); ++i) {
+		UpdateNodeConnectivity(nodes, i);
+	}
+}
+
+void NavigationGrid::UpdateNodeConnectivity(std::vector<GridNode>& nodes, int index) const {
+	int x = index % gridWidth;
+	int y = index / gridWidth;
+
+	GridNode&n = nodes[index];
+	for (int i = 0; i < 4; ++i) {
+		n.connected[i]	= -1;
+		n.costs[i]		= 0;
+	}
+
+	if (y > 0) { //get the above node
+		n.connected[0] = (gridWidth * (y - 1)) + x;
+	}
+	if (y < gridHeight - 1) { //get the below node
+		n.connected[1] = (gridWidth * (y + 1)) + x;
+	}
+	if (x > 0) { //get left node
+		n.connected[2] = (gridWidth * (y)) + (x - 1);
+	}
+	if (x < gridWidth - 1) { //get right node
+		n.connected[3] = (gridWidth * (y)) + (x + 1);
+	}
+	for (int i = 0; i < 4; ++i) {
+		if (n.connected[i] != -1) {
+			if (nodes[n.connected[i]].type == FLOOR_NODE) {
+				n.costs[i]		= 1;
 			}
-			if (x < gridWidth - 1) { //get right node
-				n.connected[3] = &allNodes[(gridWidth * (y)) + (x + 1)];
+			if (nodes[n.connected[i]].type == WALL_NODE) {
+				n.connected[i] = -1; //actually a wall, disconnect!
 			}
-			for (int i = 0; i < 4; ++i) {
-				if (n.connected[i]) {
-					if (n.connected[i]->type == '.') {
-						n.costs[i]		= 1;
-					}
-					if (n.connected[i]->type == 'x') {
-						n.connected[i] = nullptr; //actually a wall, disconnect!
-					}
+		}
+	}
+}
+
+/*
+Flood fills the walkable nodes into connected regions, so that searches between
+two regions can be rejected without exploring the whole of the start region.
+Wall nodes can still step out onto the floor, so they're left as region -1.
+*/
+int NavigationGrid::BuildRegions(std::vector<GridNode>& nodes) const {
+	for (GridNode& n : nodes) {
+		n.region = -1;
+	}
+	int regions = 0;
+	std::queue<int> toVisit;
+	for (int i = 0; i < nodes.size(); ++i) {
+		if (nodes[i].type == WALL_NODE || nodes[i].region != -1) {
+			continue;
+		}
+		nodes[i].region = regions;
+		toVisit.push(i);
+		while (!toVisit.empty()) {
+			GridNode& n = nodes[toVisit.front()];
+			toVisit.pop();
+			for (int j = 0; j < 4; ++j) {
+				int neighbour = n.connected[j];
+				if (neighbour != -1 && nodes[neighbour].region == -1) {
+					nodes[neighbour].region = regions;
+					toVisit.push(neighbour);
 				}
 			}
-		}	
+		}
+		regions++;
 	}
+	return regions;
 }
 
-NavigationGrid::~NavigationGrid()	{
-	delete[] allNodes;
+//Pathfinding indexes straight into the nodes with these, so a bad file mustn't get past here
+static bool NeighboursAreValid(std::span<const GridNode> nodes) {
+	for (const GridNode& n : nodes) {
+		for (int i = 0; i < 4; ++i) {
+			if (n.connected[i] < -1 || n.connected[i] >= (int)nodes.size()) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+bool NavigationGrid::LoadCooked(const std::string& filename) {
+	if (!cookedFile.Open(filename)) {
+		return false;
+	}
+	const NavigationData::GridHeader* header = cookedFile.GetAt<NavigationData::GridHeader>(0);
+	if (!header || !NavigationData::HeaderIsValid(&header->file, NavigationData::GridMagic, sizeof(NavigationData::GridHeader), cookedFile.GetSize())) {
+		cookedFile.Close();
+		return false;
+	}
+	//Node indices are ints, so the grid has to have a size that one can count up to
+	if (header->gridWidth <= 0 || header->gridHeight <= 0 || (int64_t)header->gridWidth * header->gridHeight > INT_MAX) {
+		cookedFile.Close();
+		return false;
+	}
+	size_t nodeCount = (size_t)header->gridWidth * header->gridHeight;
+	const GridNode* nodes = cookedFile.GetAt<GridNode>(header->nodesOffset, nodeCount);
+	if (!nodes || !NeighboursAreValid(std::span<const GridNode>(nodes, nodeCount))) {
+		cookedFile.Close();
+		return false;
+	}
+	nodeSize	= header->nodeSize;
+	gridWidth	= header->gridWidth;
+	gridHeight	= header->gridHeight;
+	regionCount = header->regionCount;
+	allNodes	= std::span<const GridNode>(nodes, nodeCount);
+	return true;
+}
+
+bool NavigationGrid::SaveCooked(const std::string& filename) const {
+	std::ofstream outfile(filename, std::ios::binary);
+	if (!outfile) {
+		return false;
+	}
+	NavigationData::GridHeader header = {};
+	header.file.magic		= NavigationData::GridMagic;
+	header.file.version		= NavigationData::Version;
+	header.file.headerSize	= sizeof(NavigationData::GridHeader);
+	header.nodeSize		= nodeSize;
+	header.gridWidth	= gridWidth;
+	header.gridHeight	= gridHeight;
+	header.regionCount	= regionCount;
+	header.nodesOffset	= NavigationData::AlignOffset(sizeof(NavigationData::GridHeader));
+	header.file.fileSize = (uint32_t)(header.nodesOffset + allNodes.size_bytes());
+
+	outfile.write((const char*)&header, sizeof(header));
+	std::vector<char> padding(header.nodesOffset - sizeof(header), 0);
+	outfile.write(padding.data(), padding.size());
+	outfile.write((const char*)allNodes.data(), allNodes.size_bytes());
+	return outfile.good();
+}
+
+bool NavigationGrid::Cook(const std::string& filename, const std::string& cookedFilename) {
+	NavigationGrid grid;
+	if (!grid.LoadText(Assets::DATADIR + filename)) {
+		return false;
+	}
+	return grid.SaveCooked(cookedFilename);
 }
 
 bool NavigationGrid::FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) {
@@ -95,75 +250,195 @@ bool NavigationGrid::FindPath(const Vector3& from, const Vector3& to, Navigation
 		return false; //outside of map region!
 	}
 
-	GridNode* startNode = &allNodes[(fromZ * gridWidth) + fromX];
-	GridNode* endNode	= &allNodes[(toZ * gridWidth) + toX];
+	int startNode	= (fromZ * gridWidth) + fromX;
+	int endNode		= (toZ * gridWidth) + toX;
 
-	std::vector<GridNode*>  openList;
-	std::vector<GridNode*>  closedList;
+	uint64_t key = ((uint64_t)startNode << 32) | (uint32_t)endNode;
 
-	openList.push_back(startNode);
+	auto cached = pathCache.find(key);
+	if (cached != pathCache.end()) {
+		if (CachedPathIsValid(cached->second)) {
+			cacheStats.hits++;
+			pathCacheLRU.splice(pathCacheLRU.begin(), pathCacheLRU, cached->second.lruEntry);
+			for (int node : cached->second.nodes) {
+				outPath.PushWaypoint(origin + allNodes[node].position);
+			}
+			return cached->second.found;
+		}
+		cacheStats.invalidations++;
+		EraseCachedPath(cached);
+	}
+	cacheStats.misses++;
+
+	CachedPath entry;
+	entry.found		= SearchPath(startNode, endNode, entry.nodes);
+	entry.openEpoch = openEpoch;
+
+	int lastBlock = -1;
+	for (int node : entry.nodes) {
+		int block = BlockForNode(node);
+		if (block != lastBlock) {
+			entry.blockGens.emplace_back(block, blockGenerations[block]);
+			lastBlock = block;
+		}
+	}
+	for (int node : entry.nodes) {
+		outPath.PushWaypoint(origin + allNodes[node].position);
+	}
+	if (pathCache.size() >= PATH_CACHE_MAX_SIZE) {
+		cacheStats.evictions++;
+		EraseCachedPath(pathCache.find(pathCacheLRU.back()));
+	}
+	bool found = entry.found;
+	pathCacheLRU.push_front(key);
+	entry.lruEntry = pathCacheLRU.begin();
+	pathCache.emplace(key, std::move(entry));
+	return found;
+}
 
-	startNode->f = 0;
-	startNode->g = 0;
-	startNode->parent = nullptr;
+bool NavigationGrid::SearchPath(int startNode, int endNode, std::vector<int>& outNodes) {
+	int startRegion = allNodes[startNode].region;
+	int endRegion	= allNodes[endNode].region;
+	if (startRegion != -1 && endRegion != -1 && startRegion != endRegion) {
+		return false; //can't get there from here!
+	}
 
-	GridNode* currentBestNode = nullptr;
+	std::fill(nodeState.begin(), nodeState.end(), NODE_UNSEEN);
+
+	std::vector<int>  openList;
+
+	openList.push_back(startNode);
+	nodeState[startNode]	= NODE_OPEN;
+	nodeF[startNode]		= 0;
+	nodeG[startNode]		= 0;
+	nodeParent[startNode]	= -1;
+
+	int currentBestNode = -1;
 
 	while (!openList.empty()) {
 		currentBestNode = RemoveBestNode(openList);
 
 		if (currentBestNode == endNode) {			//we've found the path!
-			GridNode* node = endNode;
-			while (node != nullptr) {
-				outPath.PushWaypoint(node->position);
-				node = node->parent;
+			int node = endNode;
+			while (node != -1) {
+				outNodes.emplace_back(node);
+				node = nodeParent[node];
 			}
 			return true;
 		}
 		else {
+			const GridNode& current = allNodes[currentBestNode];
 			for (int i = 0; i < 4; ++i) {
-				GridNode* neighbour = currentBestNode->connected[i];
-				if (!neighbour) { //might not be connected...
+				int neighbour = current.connected[i];
+				if (neighbour == -1) { //might not be connected...
 					continue;
 				}	
-				bool inClosed	= NodeInList(neighbour, closedList);
-				if (inClosed) {
+				if (nodeState[neighbour] == NODE_CLOSED) {
 					continue; //already discarded this neighbour...
 				}
 
 				float h = Heuristic(neighbour, endNode);				
-				float g = currentBestNode->g + currentBestNode->costs[i];
+				float g = nodeG[currentBestNode] + current.costs[i];
 				float f = h + g;
 
-				bool inOpen		= NodeInList(neighbour, openList);
+				bool inOpen		= nodeState[neighbour] == NODE_OPEN;
 
 				if (!inOpen) { //first time we've seen this neighbour
 					openList.emplace_back(neighbour);
+					nodeState[neighbour] = NODE_OPEN;
 				}
-				if (!inOpen || f < neighbour->f) {//might be a better route to this neighbour
-					neighbour->parent = currentBestNode;
-					neighbour->f = f;
-					neighbour->g = g;
+				if (!inOpen || f < nodeF[neighbour]) {//might be a better route to this neighbour
+					nodeParent[neighbour]	= currentBestNode;
+					nodeF[neighbour]		= f;
+					nodeG[neighbour]		= g;
 				}
 			}
-			closedList.emplace_back(currentBestNode);
+			nodeState[currentBestNode] = NODE_CLOSED;
 		}
 	}
 	return false; //open list emptied out with no path!
 }
 
-bool NavigationGrid::NodeInList(GridNode* n, std::vector<GridNode*>& list) const {
-	std::vector<GridNode*>::iterator i = std::find(list.begin(), list.end(), n);
-	return i == list.end() ? false : true;
+bool NavigationGrid::CachedPathIsValid(const CachedPath& entry) const {
+	if (entry.openEpoch != openEpoch) {
+		return false; //a newly opened cell might connect us up, or give us a shorter route
+	}
+	for (const auto& [block, generation] : entry.blockGens) {
+		if (blockGenerations[block] != generation) {
+			return false;
+		}
+	}
+	return true;
+}
+
+int NavigationGrid::BlockForNode(int node) const {
+	int x = (node % gridWidth) / PATH_CACHE_BLOCK_SIZE;
+	int y = (node / gridWidth) / PATH_CACHE_BLOCK_SIZE;
+	return (y * blocksWide) + x;
+}
+
+void NavigationGrid::EraseCachedPath(std::unordered_map<uint64_t, CachedPath>::iterator i) {
+	pathCacheLRU.erase(i->second.lruEntry);
+	pathCache.erase(i);
+}
+
+/*
+Blocking a cell can only break paths that went through its block. Opening one
+up could give a path anywhere a shorter route, however far away it is, so
+that invalidates every cached path.
+*/
+void NavigationGrid::SetNodeType(int x, int y, char type) {
+	if (x < 0 || x >= gridWidth || y < 0 || y >= gridHeight) {
+		return;
+	}
+	int index = (gridWidth * y) + x;
+	if (allNodes[index].type == type) {
+		return;
+	}
+	if (ownedNodes.empty()) { //copy out of the read-only cooked data on first write
+		ownedNodes.assign(allNodes.begin(), allNodes.end());
+		allNodes = ownedNodes;
+		cookedFile.Close();
+	}
+	bool opening = type != WALL_NODE;
+	ownedNodes[index].type = type;
+
+	//Neighbours need their links to this node updating too
+	UpdateNodeConnectivity(ownedNodes, index);
+	if (y > 0) {
+		UpdateNodeConnectivity(ownedNodes, index - gridWidth);
+	}
+	if (y < gridHeight - 1) {
+		UpdateNodeConnectivity(ownedNodes, index + gridWidth);
+	}
+	if (x > 0) {
+		UpdateNodeConnectivity(ownedNodes, index - 1);
+	}
+	if (x < gridWidth - 1) {
+		UpdateNodeConnectivity(ownedNodes, index + 1);
+	}
+	regionCount = BuildRegions(ownedNodes);
+
+	if (opening) {
+		openEpoch++;
+	}
+	else {
+		blockGenerations[((y / PATH_CACHE_BLOCK_SIZE) * blocksWide) + (x / PATH_CACHE_BLOCK_SIZE)]++;
+	}
 }
 
-GridNode*  NavigationGrid::RemoveBestNode(std::vector<GridNode*>& list) const {
-	std::vector<GridNode*>::iterator bestI = list.begin();
+void NavigationGrid::ClearPathCache() {
+	pathCache.clear();
+	pathCacheLRU.clear();
+}
 
-	GridNode* bestNode = *list.begin();
+int NavigationGrid::RemoveBestNode(std::vector<int>& list) const {
+	std::vector<int>::iterator bestI = list.begin();
+
+	int bestNode = *list.begin();
 
 	for (auto i = list.begin(); i != list.end(); ++i) {	
-		if ((*i)->f < bestNode->f) {
+		if (nodeF[*i] < nodeF[bestNode]) {
 			bestNode	= (*i);
 			bestI		= i;
 		}
@@ -173,6 +448,6 @@ GridNode*  NavigationGrid::RemoveBestNode(std::vector<GridNode*>& list) const {
 	return bestNode;
 }
 
-float NavigationGrid::Heuristic(GridNode* hNode, GridNode* endNode) const {
-	return (hNode->position - endNode->position).Length();
-}
\ No newline at end of file
+float NavigationGrid::Heuristic(int hNode, int endNode) const {
+	return (allNodes[hNode].position - allNodes[endNode].position).Length();
+}
@@ -1,32 +1,38 @@
 #pragma once
 #include "NavigationMap.h"
+#include "MappedFile.h"
 #include <string>
+#include <span>
+#include <unordered_map>
+#include <list>
 namespace NCL {
 	namespace CSC8503 {
+		/*
+		Nodes refer to each other by index rather than pointer, and keep no search
+		state, so that a cooked grid can be used straight from a mapped file.
+		*/
 		struct GridNode {
-			GridNode* parent;
-
-			GridNode* connected[4];
-			int		  costs[4];
-
-			Vector3		position;
-
-			float f;
-			float g;
-
-			int type;
+			Vector3	position;		//relative to the grid's start point
+			int		connected[4];	//-1 if there's no walkable neighbour that way
+			int		costs[4];
+			int		type;
+			int		region;			//nodes in different regions can never reach each other
 
 			GridNode() {
 				for (int i = 0; i < 4; ++i) {
-					connected[i] = nullptr;
+					connected[i] = -1;
 					costs[i] = 0;
 				}
-				f = 0;
-				g = 0;
-				type = 0;
-				parent = nullptr;
+				type	= 0;
+				region	= -1;
 			}
-			~GridNode() {	}
+		};
+
+		struct PathCacheStats {
+			int hits			= 0;
+			int misses			= 0;
+			int invalidations	= 0;	//cached paths thrown away because the grid changed under them
+			int evictions		= 0;	//cached paths thrown away to stay under the size limit
 		};
 
 		class NavigationGrid : public NavigationMap	{
@@ -35,19 +41,86 @@ namespace NCL {
 			NavigationGrid(const std::string&filename, Vector3 startPoint);
 			~NavigationGrid();
 
+			NavigationGrid(const NavigationGrid&) = delete;	//the path cache's LRU iterators point into this grid
+			NavigationGrid& operator=(const NavigationGrid&) = delete;
+
 			bool FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) override;
+
+			int GetNodeSize()	const { return nodeSize; }
+			int GetGridWidth()	const { return gridWidth; }
+			int GetGridHeight() const { return gridHeight; }
+
+			int GetNodeType(int x, int y) const {
+				return allNodes[(gridWidth * y) + x].type;
+			}
+
+			//Changes walkability at runtime, invalidating any cached paths it could affect
+			void SetNodeType(int x, int y, char type);
+
+			const PathCacheStats& GetPathCacheStats() const { return cacheStats; }
+			size_t GetPathCacheSize() const { return pathCache.size(); }
+			void ResetPathCacheStats() { cacheStats = PathCacheStats(); }
+			void ClearPathCache();
+
+			//Turns a text grid from the data directory into a cooked binary grid
+			static bool Cook(const std::string& filename, const std::string& cookedFilename);
 				
 		protected:
-			bool		NodeInList(GridNode* n, std::vector<GridNode*>& list) const;
-			GridNode*	RemoveBestNode(std::vector<GridNode*>& list) const;
-			float		Heuristic(GridNode* hNode, GridNode* endNode) const;
+			/*
+			Paths are cached per (start cell, goal cell) pair. The grid is split into
+			blocks of cells, each with a generation count that's bumped when a cell
+			in it is walled off; a cached path remembers the generation of every block
+			it crosses, and is only reused if none of them have moved on since.
+			Opening a cell up could give any path a shorter route, or connect up a
+			failed one, so that moves on a generation every cached path checks.
+			Once the cache is full, the least recently used path makes way.
+			*/
+			struct CachedPath {
+				std::vector<int>					nodes;			//end node first, as FindPath pushes them
+				std::vector<std::pair<int, int>>	blockGens;		//(block, generation) for every block touched
+				int									openEpoch;
+				bool								found;
+				std::list<uint64_t>::iterator		lruEntry;
+			};
+
+			bool		SearchPath(int startNode, int endNode, std::vector<int>& outNodes);
+			bool		CachedPathIsValid(const CachedPath& entry) const;
+			void		EraseCachedPath(std::unordered_map<uint64_t, CachedPath>::iterator i);
+			int			BlockForNode(int node) const;
+			void		UpdateNodeConnectivity(std::vector<GridNode>& nodes, int index) const;
+
+			bool		LoadText(const std::string& filename);
+			bool		LoadCooked(const std::string& filename);
+			void		BuildConnectivity(std::vector<GridNode>& nodes) const;
+			int			BuildRegions(std::vector<GridNode>& nodes) const;
+			bool		SaveCooked(const std::string& filename) const;
+
+			int			RemoveBestNode(std::vector<int>& list) const;
+			float		Heuristic(int hNode, int endNode) const;
 
 			int nodeSize;
 			int gridWidth;
 			int gridHeight;
+			int regionCount;
+
+			Vector3 origin;
+
+			std::span<const GridNode>	allNodes;	//either ownedNodes, or the mapped cooked file
+			std::vector<GridNode>		ownedNodes;
+			MappedFile					cookedFile;
 
-			GridNode* allNodes;
+			//per-search scratch data, kept around to avoid reallocating it every query
+			std::vector<float>	nodeF;
+			std::vector<float>	nodeG;
+			std::vector<int>	nodeParent;
+			std::vector<char>	nodeState;
+
+			std::unordered_map<uint64_t, CachedPath>	pathCache;
+			std::list<uint64_t>							pathCacheLRU;	//keys, most recently used first
+			std::vector<int>							blockGenerations;
+			int											blocksWide;
+			int											openEpoch;	//bumped whenever a cell becomes walkable
+			PathCacheStats								cacheStats;
 		};
 	}
 }
-
@@ -1,18 +1,36 @@
 #include "NavigationMesh.h"
+#include "NavigationData.h"
 #include "Assets.h"
 #include "Maths.h"
 #include <fstream>
+#include <queue>
+#include <climits>
 using namespace NCL;
 using namespace CSC8503;
 using namespace std;
 
 NavigationMesh::NavigationMesh()
 {
+	gridCellSize	= 1.0f;
+	gridCellsX		= 0;
+	gridCellsZ		= 0;
 }
 
-NavigationMesh::NavigationMesh(const std::string&filename)
+NavigationMesh::NavigationMesh(const std::string&filename) : NavigationMesh()
 {
-	ifstream file(Assets::DATADIR + filename);
+	std::string sourceFile = Assets::DATADIR + filename;
+	std::string cookedFile = sourceFile + NavigationData::CookedExtension;
+
+	if (!NavigationData::CookedFileIsCurrent(sourceFile, cookedFile) || !LoadCooked(cookedFile)) {
+		LoadText(sourceFile);
+	}
+}
+
+bool NavigationMesh::LoadText(const std::string& filename) {
+	ifstream file(filename);
+	if (!file) {
+		return false;
+	}
 
 	int numVertices = 0;
 	int numIndices	= 0;
@@ -26,71 +44,460 @@ NavigationMesh::NavigationMesh(const std::string&filename)
 		file >> vert.y;
 		file >> vert.z;
 
-		allVerts.emplace_back(vert);
+		ownedVerts.emplace_back(vert);
 	}
 
-	allTris.resize(numIndices / 3);
+	ownedTris.resize(numIndices / 3);
 
-	for (int i = 0; i < allTris.size(); ++i) {
-		NavTri* tri = &allTris[i];
+	for (int i = 0; i < ownedTris.size(); ++i) {
+		NavTri* tri = &ownedTris[i];
 		file >> tri->indices[0];
 		file >> tri->indices[1];
 		file >> tri->indices[2];
 
-		tri->centroid = allVerts[tri->indices[0]] +
-			allVerts[tri->indices[1]] +
-			allVerts[tri->indices[2]];
+		tri->centroid = ownedVerts[tri->indices[0]] +
+			ownedVerts[tri->indices[1]] +
+			ownedVerts[tri->indices[2]];
 
-		tri->centroid = allTris[i].centroid / 3.0f;
+		tri->centroid = ownedTris[i].centroid / 3.0f;
 
-		tri->triPlane = Plane::PlaneFromTri(allVerts[tri->indices[0]],
-			allVerts[tri->indices[1]],
-			allVerts[tri->indices[2]]);
+		tri->triPlane = Plane::PlaneFromTri(ownedVerts[tri->indices[0]],
+			ownedVerts[tri->indices[1]],
+			ownedVerts[tri->indices[2]]);
 
-		tri->area = Maths::AreaofTri3D(allVerts[tri->indices[0]], allVerts[tri->indices[1]], allVerts[tri->indices[2]]);
+		tri->area = Maths::AreaofTri3D(ownedVerts[tri->indices[0]], ownedVerts[tri->indices[1]], ownedVerts[tri->indices[2]]);
 	}
-	for (int i = 0; i < allTris.size(); ++i) {
-		NavTri* tri = &allTris[i];
+	for (int i = 0; i < ownedTris.size(); ++i) {
+		NavTri* tri = &ownedTris[i];
 		for (int j = 0; j < 3; ++j) {
-			int index = 0;
-			file >> index;
-			if (index != -1) {
-				tri->neighbours[j] = &allTris[index];
+			file >> tri->neighbours[j];
+		}
+	}
+	allVerts	= ownedVerts;
+	allTris		= ownedTris;
+	BuildTriGrid();
+	return true;
+}
+
+//Every index in the file is used without further checks, so all of them have to be in range
+bool NavigationMesh::CookedIndicesAreValid(std::span<const NavTri> tris, int numVerts, std::span<const int> cellStart, std::span<const int> cellTris) {
+	for (const NavTri& t : tris) {
+		for (int i = 0; i < 3; ++i) {
+			if (t.indices[i] < 0 || t.indices[i] >= numVerts || t.neighbours[i] < -1 || t.neighbours[i] >= (int)tris.size()) {
+				return false;
 			}
 		}
 	}
+	int previous = 0;
+	for (int start : cellStart) {
+		if (start < previous || start > (int)cellTris.size()) {
+			return false;
+		}
+		previous = start;
+	}
+	for (int tri : cellTris) {
+		if (tri < 0 || tri >= (int)tris.size()) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool NavigationMesh::LoadCooked(const std::string& filename) {
+	if (!cookedFile.Open(filename)) {
+		return false;
+	}
+	const NavigationData::MeshHeader* header = cookedFile.GetAt<NavigationData::MeshHeader>(0);
+	if (!header || !NavigationData::HeaderIsValid(&header->file, NavigationData::MeshMagic, sizeof(NavigationData::MeshHeader), cookedFile.GetSize())) {
+		cookedFile.Close();
+		return false;
+	}
+	if (header->numVerts < 0 || header->numTris < 0 || header->numGridTris < 0 ||
+		header->gridCellsX <= 0 || header->gridCellsZ <= 0 || (int64_t)header->gridCellsX * header->gridCellsZ >= INT_MAX) {
+		cookedFile.Close();
+		return false;
+	}
+	size_t numCells = (size_t)header->gridCellsX * header->gridCellsZ + 1;
+
+	const Vector3*	verts		= cookedFile.GetAt<Vector3>(header->vertsOffset, header->numVerts);
+	const NavTri*	tris		= cookedFile.GetAt<NavTri>(header->trisOffset, header->numTris);
+	const int*		cellStart	= cookedFile.GetAt<int>(header->cellStartOffset, numCells);
+	const int*		cellTris	= cookedFile.GetAt<int>(header->gridTrisOffset, header->numGridTris);
+
+	if (!verts || !tris || !cellStart || !cellTris ||
+		!CookedIndicesAreValid(std::span<const NavTri>(tris, header->numTris), header->numVerts,
+			std::span<const int>(cellStart, numCells), std::span<const int>(cellTris, header->numGridTris))) {
+		cookedFile.Close();
+		return false;
+	}
+	allVerts		= std::span<const Vector3>(verts, header->numVerts);
+	allTris			= std::span<const NavTri>(tris, header->numTris);
+	gridCellStart	= std::span<const int>(cellStart, numCells);
+	gridTris		= std::span<const int>(cellTris, header->numGridTris);
+
+	gridMin			= Vector3(header->gridMin[0], header->gridMin[1], header->gridMin[2]);
+	gridCellSize	= header->gridCellSize;
+	gridCellsX		= header->gridCellsX;
+	gridCellsZ		= header->gridCellsZ;
+	return true;
+}
+
+bool NavigationMesh::SaveCooked(const std::string& filename) const {
+	std::ofstream outfile(filename, std::ios::binary);
+	if (!outfile) {
+		return false;
+	}
+	NavigationData::MeshHeader header = {};
+	header.file.magic		= NavigationData::MeshMagic;
+	header.file.version		= NavigationData::Version;
+	header.file.headerSize	= sizeof(NavigationData::MeshHeader);
+	header.numVerts			= (int32_t)allVerts.size();
+	header.numTris			= (int32_t)allTris.size();
+	header.gridCellsX		= gridCellsX;
+	header.gridCellsZ		= gridCellsZ;
+	header.gridMin[0]		= gridMin.x;
+	header.gridMin[1]		= gridMin.y;
+	header.gridMin[2]		= gridMin.z;
+	header.gridCellSize		= gridCellSize;
+	header.numGridTris		= (int32_t)gridTris.size();
+
+	header.vertsOffset		= NavigationData::AlignOffset(sizeof(header));
+	header.trisOffset		= NavigationData::AlignOffset(header.vertsOffset		+ allVerts.size_bytes());
+	header.cellStartOffset	= NavigationData::AlignOffset(header.trisOffset			+ allTris.size_bytes());
+	header.gridTrisOffset	= NavigationData::AlignOffset(header.cellStartOffset	+ gridCellStart.size_bytes());
+	header.file.fileSize	= (uint32_t)(header.gridTrisOffset + gridTris.size_bytes());
+
+	auto WriteSection = [&](uint64_t offset, const void* data, size_t size) {
+		std::vector<char> padding(offset - (uint64_t)outfile.tellp(), 0);
+		outfile.write(padding.data(), padding.size());
+		outfile.write((const char*)data, size);
+	};
+	outfile.write((const char*)&header, sizeof(header));
+	WriteSection(header.vertsOffset		, allVerts.data()		, allVerts.size_bytes());
+	WriteSection(header.trisOffset		, allTris.data()		, allTris.size_bytes());
+	WriteSection(header.cellStartOffset	, gridCellStart.data()	, gridCellStart.size_bytes());
+	WriteSection(header.gridTrisOffset	, gridTris.data()		, gridTris.size_bytes());
+	return outfile.good();
+}
+
+bool NavigationMesh::Cook(const std::string& filename, const std::string& cookedFilename) {
+	NavigationMesh mesh;
+	if (!mesh.LoadText(Assets::DATADIR + filename)) {
+		return false;
+	}
+	return mesh.SaveCooked(cookedFilename);
 }
 
 NavigationMesh::~NavigationMesh()
 {
 }
 
+void NavigationMesh::BuildTriGrid() {
+	ownedCellStart.clear();
+	ownedGridTris.clear();
+	gridCellStart	= ownedCellStart;
+	gridTris		= ownedGridTris;
+	if (allTris.empty()) {
+		gridCellsX = 0;
+		gridCellsZ = 0;
+		return;
+	}
+	gridMin			= allVerts[0];
+	Vector3 gridMax = allVerts[0];
+	for (const Vector3& v : allVerts) {
+		gridMin.x = std::min(gridMin.x, v.x);
+		gridMin.z = std::min(gridMin.z, v.z);
+		gridMax.x = std::max(gridMax.x, v.x);
+		gridMax.z = std::max(gridMax.z, v.z);
+	}
+	float width = std::max(gridMax.x - gridMin.x, 0.001f);
+	float depth = std::max(gridMax.z - gridMin.z, 0.001f);
+
+	//Aim for roughly one triangle per cell
+	gridCellSize	= std::max(std::sqrt((width * depth) / allTris.size()), 0.001f);
+	gridCellsX		= std::max(1, (int)std::ceil(width / gridCellSize));
+	gridCellsZ		= std::max(1, (int)std::ceil(depth / gridCellSize));
+
+	auto CellRange = [&](const NavTri& t, int& minX, int& minZ, int& maxX, int& maxZ) {
+		float loX = allVerts[t.indices[0]].x, hiX = loX;
+		float loZ = allVerts[t.indices[0]].z, hiZ = loZ;
+		for (int j = 1; j < 3; ++j) {
+			loX = std::min(loX, allVerts[t.indices[j]].x);
+			hiX = std::max(hiX, allVerts[t.indices[j]].x);
+			loZ = std::min(loZ, allVerts[t.indices[j]].z);
+			hiZ = std::max(hiZ, allVerts[t.indices[j]].z);
+		}
+		minX = std::clamp((int)((loX - gridMin.x) / gridCellSize), 0, gridCellsX - 1);
+		maxX = std::clamp((int)((hiX - gridMin.x) / gridCellSize), 0, gridCellsX - 1);
+		minZ = std::clamp((int)((loZ - gridMin.z) / gridCellSize), 0, gridCellsZ - 1);
+		maxZ = std::clamp((int)((hiZ - gridMin.z) / gridCellSize), 0, gridCellsZ - 1);
+	};
+	//Two passes - count then fill - so the cells end up packed into one array
+	ownedCellStart.resize(gridCellsX * gridCellsZ + 1, 0);
+	for (const NavTri& t : allTris) {
+		int minX, minZ, maxX, maxZ;
+		CellRange(t, minX, minZ, maxX, maxZ);
+		for (int z = minZ; z <= maxZ; ++z) {
+			for (int x = minX; x <= maxX; ++x) {
+				ownedCellStart[(z * gridCellsX) + x + 1]++;
+			}
+		}
+	}
+	for (int i = 1; i < ownedCellStart.size(); ++i) {
+		ownedCellStart[i] += ownedCellStart[i - 1];
+	}
+	ownedGridTris.resize(ownedCellStart.back());
+	vector<int> fillPoint(ownedCellStart.begin(), ownedCellStart.end() - 1);
+	for (int i = 0; i < allTris.size(); ++i) {
+		int minX, minZ, maxX, maxZ;
+		CellRange(allTris[i], minX, minZ, maxX, maxZ);
+		for (int z = minZ; z <= maxZ; ++z) {
+			for (int x = minX; x <= maxX; ++x) {
+				ownedGridTris[fillPoint[(z * gridCellsX) + x]++] = i;
+			}
+		}
+	}
+	gridCellStart	= ownedCellStart;
+	gridTris		= ownedGridTris;
+}
+
 bool NavigationMesh::FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) {
 	const NavTri* start	= GetTriForPosition(from);
 	const NavTri* end	= GetTriForPosition(to);
 
-	return false;
+	if (!start || !end) {
+		return false; //off the mesh!
+	}
+
+	struct OpenEntry {
+		float f;
+		int	  tri;
+		bool operator<(const OpenEntry& o) const { return f > o.f; } //min-heap
+	};
+
+	int startIndex	= (int)(start - allTris.data());
+	int endIndex	= (int)(end   - allTris.data());
+
+	vector<float>	g(allTris.size(), FLT_MAX);
+	vector<int>		parent(allTris.size(), -1);
+	vector<char>	closed(allTris.size(), 0);
+
+	std::priority_queue<OpenEntry> openList;
+	g[startIndex] = 0.0f;
+	openList.push({ (end->centroid - from).Length(), startIndex });
+
+	bool found = false;
+	while (!openList.empty()) {
+		int current = openList.top().tri;
+		openList.pop();
+		if (closed[current]) {
+			continue; //stale entry, a cheaper route was already expanded
+		}
+		if (current == endIndex) {
+			found = true;
+			break;
+		}
+		closed[current] = 1;
+
+		const NavTri& t = allTris[current];
+		Vector3 currentPos = current == startIndex ? from : t.centroid;
+		for (int i = 0; i < 3; ++i) {
+			int n = t.neighbours[i];
+			if (n == -1) {
+				continue;
+			}
+			if (closed[n]) {
+				continue;
+			}
+			Vector3 nPos	= n == endIndex ? to : allTris[n].centroid;
+			float newG		= g[current] + (nPos - currentPos).Length();
+			if (newG < g[n]) {
+				g[n]		= newG;
+				parent[n]	= current;
+				openList.push({ newG + (to - nPos).Length(), n });
+			}
+		}
+	}
+	if (!found) {
+		return false;
+	}
+
+	vector<const NavTri*> corridor;
+	for (int i = endIndex; i != -1; i = parent[i]) {
+		corridor.emplace_back(&allTris[i]);
+	}
+	std::reverse(corridor.begin(), corridor.end());
+
+	vector<Vector3> points;
+	StringPull(corridor, from, to, points);
+
+	//NavigationPath pops from the back, so push the destination first
+	for (auto i = points.rbegin(); i != points.rend(); ++i) {
+		outPath.PushWaypoint(*i);
+	}
+	return true;
+}
+
+bool NavigationMesh::GetSharedEdge(const NavTri& from, const NavTri& to, Vector3& left, Vector3& right) const {
+	int shared[2];
+	int count = 0;
+	for (int i = 0; i < 3 && count < 2; ++i) {
+		for (int j = 0; j < 3; ++j) {
+			if (from.indices[i] == to.indices[j]) {
+				shared[count++] = from.indices[i];
+				break;
+			}
+		}
+	}
+	if (count != 2) {
+		return false;
+	}
+	left	= allVerts[shared[0]];
+	right	= allVerts[shared[1]];
+	//Orient the portal as seen walking out of 'from'
+	float ax = left.x  - from.centroid.x;
+	float az = left.z  - from.centroid.z;
+	float bx = right.x - from.centroid.x;
+	float bz = right.z - from.centroid.z;
+	if (bx * az - ax * bz < 0.0f) {
+		std::swap(left, right);
+	}
+	return true;
 }
 
 /*
-If you have triangles on top of triangles in a full 3D environment, you'll need to change this slightly,
-as it is currently ignoring height. You might find tri/plane raycasting is handy.
+The 'simple stupid funnel' string pulling algorithm, working on the XZ plane. The
+funnel is narrowed portal by portal, and whenever one side crosses over the other,
+that corner becomes a waypoint and the funnel restarts from it.
 */
+void NavigationMesh::StringPull(const std::vector<const NavTri*>& tris, const Vector3& from, const Vector3& to, std::vector<Vector3>& outPoints) const {
+	auto TriArea2 = [](const Vector3& a, const Vector3& b, const Vector3& c) {
+		float ax = b.x - a.x;
+		float az = b.z - a.z;
+		float bx = c.x - a.x;
+		float bz = c.z - a.z;
+		return bx * az - ax * bz;
+	};
+	auto SamePoint = [](const Vector3& a, const Vector3& b) {
+		return (a - b).LengthSquared() < 0.000001f;
+	};
 
-const NavigationMesh::NavTri* NavigationMesh::GetTriForPosition(const Vector3& pos) const {
-	for (const NavTri& t : allTris) {
-		Vector3 planePoint = t.triPlane.ProjectPointOntoPlane(pos);
+	vector<Vector3> lefts;
+	vector<Vector3> rights;
+	lefts.emplace_back(from);
+	rights.emplace_back(from);
+	for (int i = 0; i + 1 < tris.size(); ++i) {
+		Vector3 l, r;
+		if (GetSharedEdge(*tris[i], *tris[i + 1], l, r)) {
+			lefts.emplace_back(l);
+			rights.emplace_back(r);
+		}
+	}
+	lefts.emplace_back(to);
+	rights.emplace_back(to);
 
-		float ta = Maths::AreaofTri3D(allVerts[t.indices[0]], allVerts[t.indices[1]], planePoint);
-		float tb = Maths::AreaofTri3D(allVerts[t.indices[1]], allVerts[t.indices[2]], planePoint);
-		float tc = Maths::AreaofTri3D(allVerts[t.indices[2]], allVerts[t.indices[0]], planePoint);
+	outPoints.emplace_back(from);
 
-		float areaSum = ta + tb + tc;
+	Vector3 apex		= from;
+	Vector3 portalLeft	= from;
+	Vector3 portalRight = from;
+	int apexIndex	= 0;
+	int leftIndex	= 0;
+	int rightIndex	= 0;
 
-		if (abs(areaSum - t.area)  > 0.001f) { //floating points are annoying! Are we more or less inside the triangle?
+	for (int i = 1; i < lefts.size(); ++i) {
+		const Vector3& left		= lefts[i];
+		const Vector3& right	= rights[i];
+
+		if (TriArea2(apex, portalRight, right) <= 0.0f) {
+			if (SamePoint(apex, portalRight) || TriArea2(apex, portalLeft, right) > 0.0f) {
+				portalRight = right;
+				rightIndex	= i;
+			}
+			else { //right crossed over left, so the left corner is on the path
+				apex		= portalLeft;
+				apexIndex	= leftIndex;
+				outPoints.emplace_back(apex);
+				portalLeft	= apex;
+				portalRight = apex;
+				leftIndex	= apexIndex;
+				rightIndex	= apexIndex;
+				i = apexIndex;
+				continue;
+			}
+		}
+		if (TriArea2(apex, portalLeft, left) >= 0.0f) {
+			if (SamePoint(apex, portalLeft) || TriArea2(apex, portalRight, left) < 0.0f) {
+				portalLeft	= left;
+				leftIndex	= i;
+			}
+			else {
+				apex		= portalRight;
+				apexIndex	= rightIndex;
+				outPoints.emplace_back(apex);
+				portalLeft	= apex;
+				portalRight = apex;
+				leftIndex	= apexIndex;
+				rightIndex	= apexIndex;
+				i = apexIndex;
+				continue;
+			}
+		}
+	}
+	if (!SamePoint(outPoints.back(), to)) {
+		outPoints.emplace_back(to);
+	}
+}
+
+/*
+Triangles are looked up through the uniform grid, and tested with a 2D point in
+triangle check on the XZ plane. If triangles are stacked on top of each other,
+the one whose plane is vertically closest to the point wins.
+*/
+
+const NavigationMesh::NavTri* NavigationMesh::GetTriForPosition(const Vector3& pos) const {
+	if (gridCellStart.empty()) {
+		return nullptr;
+	}
+	int x = (int)std::floor((pos.x - gridMin.x) / gridCellSize);
+	int z = (int)std::floor((pos.z - gridMin.z) / gridCellSize);
+	if (x < 0 || x >= gridCellsX || z < 0 || z >= gridCellsZ) {
+		return nullptr;
+	}
+	int cell = (z * gridCellsX) + x;
+
+	const NavTri* best	= nullptr;
+	float bestHeight	= FLT_MAX;
+	for (int i = gridCellStart[cell]; i < gridCellStart[cell + 1]; ++i) {
+		const NavTri& t = allTris[gridTris[i]];
+		if (!PointInTriXZ(t, pos)) {
 			continue;
 		}
-		return &t;
+		float height = abs(t.triPlane.DistanceFromPlane(pos));
+		if (height < bestHeight) {
+			best		= &t;
+			bestHeight	= height;
+		}
 	}
-	return nullptr;
-}
\ No newline at end of file
+	return best;
+}
+
+bool NavigationMesh::PointInTriXZ(const NavTri& t, const Vector3& pos) const {
+	const Vector3& a = allVerts[t.indices[0]];
+	const Vector3& b = allVerts[t.indices[1]];
+	const Vector3& c = allVerts[t.indices[2]];
+
+	float triArea2 = (b.x - a.x) * (c.z - a.z) - (b.z - a.z) * (c.x - a.x);
+	if (abs(triArea2) < 0.000001f) {
+		return false; //vertical triangle, can't be stood on
+	}
+
+	float d0 = (b.x - a.x) * (pos.z - a.z) - (b.z - a.z) * (pos.x - a.x);
+	float d1 = (c.x - b.x) * (pos.z - b.z) - (c.z - b.z) * (pos.x - b.x);
+	float d2 = (a.x - c.x) * (pos.z - c.z) - (a.z - c.z) * (pos.x - c.x);
+
+	const float epsilon = 0.001f; //floating points are annoying! Allow points right on an edge
+	bool hasNeg = d0 < -epsilon || d1 < -epsilon || d2 < -epsilon;
+	bool hasPos = d0 >  epsilon || d1 >  epsilon || d2 >  epsilon;
+	return !(hasNeg && hasPos);
+}
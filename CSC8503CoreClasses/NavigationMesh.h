@@ -1,8 +1,10 @@
 #pragma once
 #include "NavigationMap.h"
 #include "Plane.h"
+#include "MappedFile.h"
 #include <string>
 #include <vector>
+#include <span>
 namespace NCL {
 	namespace CSC8503 {
 		class NavigationMesh : public NavigationMap	{
@@ -12,21 +14,24 @@ namespace NCL {
 			~NavigationMesh();
 
 			bool FindPath(const Vector3& from, const Vector3& to, NavigationPath& outPath) override;
+
+			//Turns a text navmesh from the data directory into a cooked binary navmesh
+			static bool Cook(const std::string& filename, const std::string& cookedFilename);
 		
 		protected:
 			struct NavTri {
 				Plane   triPlane;
 				Vector3 centroid;
 				float	area;
-				NavTri* neighbours[3];
+				int		neighbours[3]; //-1 if this edge is on the boundary
 
 				int indices[3];
 
 				NavTri() {
 					area = 0.0f;
-					neighbours[0] = nullptr;
-					neighbours[1] = nullptr;
-					neighbours[2] = nullptr;
+					neighbours[0] = -1;
+					neighbours[1] = -1;
+					neighbours[2] = -1;
 
 					indices[0] = -1;
 					indices[1] = -1;
@@ -34,10 +39,37 @@ namespace NCL {
 				}
 			};
 
+			bool LoadText(const std::string& filename);
+			bool LoadCooked(const std::string& filename);
+			static bool CookedIndicesAreValid(std::span<const NavTri> tris, int numVerts, std::span<const int> cellStart, std::span<const int> cellTris);
+			bool SaveCooked(const std::string& filename) const;
+
 			const NavTri* GetTriForPosition(const Vector3& pos) const;
+			bool PointInTriXZ(const NavTri& t, const Vector3& pos) const;
+
+			//Uniform grid over the XZ bounds of the mesh, so point queries only test
+			//the handful of triangles that overlap the cell the point lands in
+			void BuildTriGrid();
+
+			bool GetSharedEdge(const NavTri& from, const NavTri& to, Vector3& left, Vector3& right) const;
+			void StringPull(const std::vector<const NavTri*>& tris, const Vector3& from, const Vector3& to, std::vector<Vector3>& outPoints) const;
+
+			//These all view either the owned vectors below, or the mapped cooked file
+			std::span<const NavTri>		allTris;
+			std::span<const Vector3>	allVerts;
+			std::span<const int>		gridCellStart;	//gridCellsX * gridCellsZ + 1 offsets into gridTris
+			std::span<const int>		gridTris;
+
+			Vector3 gridMin;
+			float	gridCellSize;
+			int		gridCellsX;
+			int		gridCellsZ;
 
-			std::vector<NavTri>		allTris;
-			std::vector<Vector3>	allVerts;
+			std::vector<NavTri>		ownedTris;
+			std::vector<Vector3>	ownedVerts;
+			std::vector<int>		ownedCellStart;
+			std::vector<int>		ownedGridTris;
+			MappedFile				cookedFile;
 		};
 	}
 }
\ No newline at end of file
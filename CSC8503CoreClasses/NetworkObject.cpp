@@ -15,6 +15,11 @@ NetworkObject::NetworkObject(GameObject& o, int id) : object(o)	{
 NetworkObject::~NetworkObject()	{
 }
 
+MemoryPool& NetworkObject::GetPool() {
+	static MemoryPool pool("NetworkObject", sizeof(NetworkObject), MemoryPool::ArenaUse::Never, 64);
+	return pool;
+}
+
 bool NetworkObject::ReadPacket(GamePacket& p) 
 {
 	if (p.type == Delta_State)
@@ -142,6 +147,16 @@ bool NetworkObject::GetNetworkState(int stateID, NetworkState& state)
 	return false;
 }
 
+void NetworkObject::Reset(int newID)
+{
+	networkID	= newID;
+	deltaErrors = 0;
+	fullErrors	= 0;
+	lastFullState.position		= object.GetTransform().GetPosition();
+	lastFullState.orientation	= object.GetTransform().GetOrientation();
+	stateHistory.clear();
+}
+
 void NetworkObject::UpdateStateHistory(int minID)
 {
 	for (auto i = stateHistory.begin(); i < stateHistory.end(); )
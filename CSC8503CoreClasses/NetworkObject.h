@@ -97,17 +97,23 @@ namespace NCL::CSC8503 {
 		}
 	};
 
-	class NetworkObject		{
+	class NetworkObject : public PooledObject<NetworkObject>	{
 	public:
 		NetworkObject(GameObject& o, int id);
 		virtual ~NetworkObject();
 
+		static MemoryPool& GetPool();
+
 		//Called by clients
 		virtual bool ReadPacket(GamePacket& p);
 		//Called by servers
 		virtual bool WritePacket(GamePacket** p, bool deltaFrame, int stateID);
 
 		void UpdateStateHistory(int minID);
+
+		//Gives a reused object a new ID, and forgets the states it was sent with under the old one.
+		//State IDs carry on from before, so packets from its last use still look old.
+		void Reset(int newID);
 		NetworkState& GetLatestNetworkState();
 
 		int getNetWorkID()const { return networkID; }
@@ -2,14 +2,13 @@
 #include "CollisionVolume.h"
 
 namespace NCL {
-	class OBBVolume : CollisionVolume
+	class OBBVolume : public CollisionVolume
 	{
 	public:
 		OBBVolume(const Maths::Vector3& halfDims) {
 			type		= VolumeType::OBB;
 			halfSizes	= halfDims;
 		}
-		~OBBVolume() {}
 
 		Maths::Vector3 GetHalfDimensions() const {
 			return halfSizes;
@@ -13,8 +13,9 @@ PhysicsObject::PhysicsObject(Transform* parentTransform, const CollisionVolume*
 	friction	= 0.8f;
 }
 
-PhysicsObject::~PhysicsObject()	{
-
+MemoryPool& PhysicsObject::GetPool() {
+	static MemoryPool pool("PhysicsObject", sizeof(PhysicsObject), MemoryPool::ArenaUse::WhenCurrent);
+	return pool;
 }
 
 void PhysicsObject::ApplyAngularImpulse(const Vector3& force) {
@@ -1,4 +1,6 @@
 #pragma once
+#include "MemoryPool.h"
+
 using namespace NCL::Maths;
 
 namespace NCL {
@@ -7,10 +9,11 @@ namespace NCL {
 	namespace CSC8503 {
 		class Transform;
 
-		class PhysicsObject	{
+		class PhysicsObject : public PooledObject<PhysicsObject>	{
 		public:
 			PhysicsObject(Transform* parentTransform, const CollisionVolume* parentVolume);
-			~PhysicsObject();
+
+			static MemoryPool& GetPool();
 
 			Vector3 GetLinearVelocity() const {
 				return linearVelocity;
@@ -29,12 +29,11 @@ void PhysicsSystem::SetGravity(const Vector3& g) {
 
 /*
 
-If the 'game' is ever reset, the PhysicsSystem must be
+If the 'game' is ever reset, the PhysicsSystem should be
 'cleared' to remove any old collisions that might still
-be hanging around in the collision list. If your engine
-is expanded to allow objects to be removed from the world,
-you'll need to iterate through this collisions list to remove
-any collisions they are in.
+be hanging around in the collision list. Collisions with
+objects removed from the world while it's running are
+dropped by UpdateCollisionList, as their handles go stale.
 
 */
 void PhysicsSystem::Clear() {
@@ -153,15 +152,25 @@ The frame they are to be removed, we tell them they're no longer colliding.
 From this simple mechanism, we we build up gameplay interactions inside the
 OnCollisionBegin / OnCollisionEnd functions (removing health when hit by a 
 rocket launcher, gaining a point when the player hits the gold coin, and so on).
+
+If either object has been removed from the world since, its handle no longer
+resolves, and the collision is dropped without telling either of them.
 */
 void PhysicsSystem::UpdateCollisionList() {
 	for (std::set<CollisionDetection::CollisionInfo>::iterator i = allCollisions.begin(); i != allCollisions.end(); ) {
+		CollisionDetection::CollisionInfo& in = const_cast<CollisionDetection::CollisionInfo&>(*i);
+		in.a = gameWorld.GetGameObject(in.handleA);
+		in.b = gameWorld.GetGameObject(in.handleB);
+		if (!in.a || !in.b) {
+			i = allCollisions.erase(i);
+			continue;
+		}
+
 		if ((*i).framesLeft == numCollisionFrames) {
 			i->a->OnCollisionBegin(i->b);
 			i->b->OnCollisionBegin(i->a);
 		}
 
-		CollisionDetection::CollisionInfo& in = const_cast<CollisionDetection::CollisionInfo&>(*i);
 		in.framesLeft--;
 
 		if ((*i).framesLeft < 0) {
@@ -207,13 +216,13 @@ void PhysicsSystem::BasicCollisionDetection()
 
 	for (auto i = first; i != last; ++i)
 	{
-		if ((*i)->GetPhysicsObject() == nullptr)
+		if ((*i)->GetPhysicsObject() == nullptr || !(*i)->IsActive())
 		{
 			continue;
 		}
 		for (auto j = i + 1; j != last; ++j)
 		{
-			if ((*i)->GetPhysicsObject() == nullptr)
+			if ((*j)->GetPhysicsObject() == nullptr || !(*j)->IsActive())
 			{
 				continue;
 			}
@@ -226,6 +235,16 @@ void PhysicsSystem::BasicCollisionDetection()
 				allCollisions.insert(info);
 			}
 		}
+		for (GameObject* j : gameWorld.GetStaticObjects().GetObjects())
+		{
+			CollisionDetection::CollisionInfo info;
+			if (CollisionDetection::ObjectIntersection(*i, j, info))
+			{
+				ImpulseResolveCollision(*info.a, *info.b, info.point);
+				info.framesLeft = numCollisionFrames;
+				allCollisions.insert(info);
+			}
+		}
 	}
 }
 
@@ -309,12 +328,21 @@ void PhysicsSystem::BroadPhase()
 	for (auto i = first; i != last; ++i)
 	{
 		Vector3 halfSizes;
-		if (!(*i)->GetBroadphaseAABB(halfSizes))
+		if (!(*i)->IsActive() || !(*i)->GetBroadphaseAABB(halfSizes))
 		{
 			continue;
 		}
 		Vector3 pos = (*i)->GetTransform().GetPosition();
 		tree.Insert(*i, pos, halfSizes);
+
+		//Statics never go in the tree, they're already binned in their own grid
+		gameWorld.GetStaticObjects().Query(pos, halfSizes, staticOverlaps);
+		for (GameObject* s : staticOverlaps)
+		{
+			CollisionDetection::CollisionInfo info;
+			info.SetObjects(std::min(*i, s), std::max(*i, s));
+			broadphaseCollisions.insert(info);
+		}
 	}
 
 	tree.OperateOnContents(
@@ -327,8 +355,7 @@ void PhysicsSystem::BroadPhase()
 				{
 					// is this pair of items already in the collision set -
 					// if the same pair is in another quadtree node together etc
-					info.a = std::min((*i).object, (*j).object);
-					info.b = std::max((*i).object, (*j).object);
+					info.SetObjects(std::min((*i).object, (*j).object), std::max((*i).object, (*j).object));
 					broadphaseCollisions.insert(info);
 				}
 			}
@@ -373,9 +400,9 @@ void PhysicsSystem::IntegrateAccel(float dt)
 	for (auto i = first; i != last; ++i)
 	{
 		PhysicsObject* object = (*i)->GetPhysicsObject();
-		if (object == nullptr)
+		if (object == nullptr || !(*i)->IsActive())
 		{
-			continue; //No physics object for this GameObject!
+			continue; //No physics object for this GameObject, or it's switched off
 		}
 		float inverseMass = object->GetInverseMass();
 
@@ -418,9 +445,9 @@ void PhysicsSystem::IntegrateVelocity(float dt)
 	for (auto i = first; i != last; ++i)
 	{
 		PhysicsObject* object = (*i)->GetPhysicsObject();
-		if (object == nullptr)
+		if (object == nullptr || !(*i)->IsActive())
 		{
-			continue; //No physics object for this GameObject!
+			continue; //No physics object for this GameObject, or it's switched off
 		}
 		Transform& transform = (*i)->GetTransform();
 		//Position Stuff
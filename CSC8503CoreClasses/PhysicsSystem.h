@@ -48,6 +48,7 @@ namespace NCL {
 			std::set<CollisionDetection::CollisionInfo> allCollisions;
 			std::set<CollisionDetection::CollisionInfo> broadphaseCollisions;
 			std::vector<CollisionDetection::CollisionInfo> broadphaseCollisionsVec;
+			std::vector<GameObject*> staticOverlaps;
 			bool useBroadPhase		= true;
 			int numCollisionFrames	= 5;
 		};
@@ -6,6 +6,8 @@ using namespace NCL::CSC8503;
 PushdownMachine::PushdownMachine(PushdownState* initialState)
 {
 	this->initialState = initialState;
+	activeState	= nullptr;
+	game		= nullptr;
 }
 
 PushdownMachine::~PushdownMachine() 
@@ -4,17 +4,20 @@
 using namespace NCL::CSC8503;
 using namespace NCL;
 
-RenderObject::RenderObject(Transform* parentTransform, Mesh* mesh, Texture* tex, Shader* shader) {
-	if (!tex) {
-		bool a = true;
-	}
+RenderObject::RenderObject(Transform* parentTransform, const MeshHandle& mesh, const TextureHandle& tex, const ShaderHandle& shader) {
 	this->transform	= parentTransform;
 	this->mesh		= mesh;
 	this->texture	= tex;
 	this->shader	= shader;
 	this->colour	= Vector4(1.0f, 1.0f, 1.0f, 1.0f);
+	this->isStatic	= false;
 }
 
 RenderObject::~RenderObject() {
 
+}
+
+MemoryPool& RenderObject::GetPool() {
+	static MemoryPool pool("RenderObject", sizeof(RenderObject));
+	return pool;
 }
\ No newline at end of file
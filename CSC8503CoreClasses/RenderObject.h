@@ -2,6 +2,8 @@
 #include "Texture.h"
 #include "Shader.h"
 #include "Mesh.h"
+#include "AssetHandle.h"
+#include "MemoryPool.h"
 
 namespace NCL {
 	using namespace NCL::Rendering;
@@ -10,21 +12,32 @@ namespace NCL {
 		class Transform;
 		using namespace Maths;
 
-		class RenderObject
+		class RenderObject : public PooledObject<RenderObject>
 		{
 		public:
-			RenderObject(Transform* parentTransform, Mesh* mesh, Texture* tex, Shader* shader);
+			//The mesh and texture can still be loading, in which case their placeholders are drawn until they're ready
+			RenderObject(Transform* parentTransform, const MeshHandle& mesh, const TextureHandle& tex, const ShaderHandle& shader);
 			~RenderObject();
 
-			void SetDefaultTexture(Texture* t) {
+			static MemoryPool& GetPool();
+
+			void SetDefaultTexture(const TextureHandle& t) {
 				texture = t;
 			}
 
 			Texture* GetDefaultTexture() const {
+				return texture.Get();
+			}
+
+			const TextureHandle& GetTextureHandle() const {
 				return texture;
 			}
 
 			Mesh*	GetMesh() const {
+				return mesh.Get();
+			}
+
+			const MeshHandle& GetMeshHandle() const {
 				return mesh;
 			}
 
@@ -33,6 +46,10 @@ namespace NCL {
 			}
 
 			Shader*		GetShader() const {
+				return shader.Get();
+			}
+
+			const ShaderHandle& GetShaderHandle() const {
 				return shader;
 			}
 
@@ -44,12 +61,22 @@ namespace NCL {
 				return colour;
 			}
 
+			//Static objects promise never to move, or change how they look, once added to the world
+			void SetStatic(bool state) {
+				isStatic = state;
+			}
+
+			bool IsStatic() const {
+				return isStatic;
+			}
+
 		protected:
-			Mesh*		mesh;
-			Texture*	texture;
-			Shader*		shader;
+			MeshHandle		mesh;
+			TextureHandle	texture;
+			ShaderHandle	shader;
 			Transform*	transform;
 			Vector4		colour;
+			bool		isStatic;
 		};
 	}
 }
@@ -0,0 +1,161 @@
+#include "RenderQueue.h"
+#include "FramePacket.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+const int SHADER_BITS	= 12;
+const int TEXTURE_BITS	= 14;
+const int MESH_BITS		= 14;
+const int DEPTH_BITS	= 20;
+
+const uint32_t MAX_SHADER_ID	= (1 << SHADER_BITS) - 1;
+const uint32_t MAX_TEXTURE_ID	= (1 << TEXTURE_BITS) - 1;
+const uint32_t MAX_MESH_ID		= (1 << MESH_BITS) - 1;
+const uint32_t MAX_DEPTH		= (1 << DEPTH_BITS) - 1;
+
+RenderQueue::RenderQueue() {
+	shaderChanges	= 0;
+	textureChanges	= 0;
+	meshChanges		= 0;
+}
+
+RenderQueue::~RenderQueue() {
+}
+
+void RenderQueue::Clear() {
+	objects.clear();
+	entries.clear();
+	commands.clear();
+}
+
+/*
+Positive floats sort the same way as their bit patterns do, so the top bits
+of the float (less the sign bit) make a depth that keeps its precision close
+to the camera, where it matters most.
+*/
+uint32_t RenderQueue::QuantiseDepth(float viewDepth) {
+	viewDepth = std::max(viewDepth, 0.0f);
+	uint32_t bits;
+	memcpy(&bits, &viewDepth, sizeof(float));
+	return bits >> (31 - DEPTH_BITS);
+}
+
+uint64_t RenderQueue::BuildKey(RenderPass pass, uint32_t shaderID, uint32_t textureID, uint32_t meshID, float viewDepth) {
+	uint64_t depth = QuantiseDepth(viewDepth);
+	uint64_t key = (uint64_t)pass << 60;
+
+	if (pass == RenderPass::Transparent) {
+		key |= (MAX_DEPTH - depth)		<< (SHADER_BITS + TEXTURE_BITS + MESH_BITS);
+		key |= (uint64_t)shaderID		<< (TEXTURE_BITS + MESH_BITS);
+		key |= (uint64_t)textureID		<< (MESH_BITS);
+		key |= (uint64_t)meshID;
+	}
+	else {
+		key |= (uint64_t)shaderID		<< (TEXTURE_BITS + MESH_BITS + DEPTH_BITS);
+		key |= (uint64_t)textureID		<< (MESH_BITS + DEPTH_BITS);
+		key |= (uint64_t)meshID			<< (DEPTH_BITS);
+		key |= depth;
+	}
+	return key;
+}
+
+uint32_t RenderQueue::GetID(std::unordered_map<const void*, uint32_t>& ids, const void* p, uint32_t maxID) {
+	if (!p) {
+		return 0;
+	}
+	auto i = ids.find(p);
+	if (i == ids.end()) {
+		i = ids.insert({ p, (uint32_t)ids.size() + 1 }).first;
+	}
+	return std::min(i->second, maxID);
+}
+
+void RenderQueue::Add(const RenderItem* o, float viewDepth) {
+	RenderPass pass = o->colour.w < 1.0f ? RenderPass::Transparent : RenderPass::Opaque;
+
+	uint32_t shaderID	= GetID(shaderIDs	, o->shader		, MAX_SHADER_ID);
+	uint32_t textureID	= GetID(textureIDs	, o->texture	, MAX_TEXTURE_ID);
+	uint32_t meshID		= GetID(meshIDs		, o->mesh		, MAX_MESH_ID);
+
+	entries.push_back({ BuildKey(pass, shaderID, textureID, meshID, viewDepth), (uint32_t)objects.size() });
+	objects.push_back(o);
+}
+
+void RenderQueue::Sort() {
+	RadixSort();
+	BuildCommands();
+}
+
+/*
+Least significant digit first, a byte at a time. Most frames only use a few
+ids, so any byte that's the same across every key is spotted from its counts
+and that pass skipped entirely.
+*/
+void RenderQueue::RadixSort() {
+	const size_t count = entries.size();
+	if (count < 2) {
+		return;
+	}
+	sortScratch.resize(count);
+
+	Entry* src = entries.data();
+	Entry* dst = sortScratch.data();
+
+	for (int shift = 0; shift < 64; shift += 8) {
+		size_t offsets[256] = { 0 };
+		for (size_t i = 0; i < count; ++i) {
+			offsets[(src[i].key >> shift) & 0xFF]++;
+		}
+		if (offsets[(src[0].key >> shift) & 0xFF] == count) {
+			continue;
+		}
+		size_t total = 0;
+		for (int b = 0; b < 256; ++b) {
+			size_t bucketSize = offsets[b];
+			offsets[b] = total;
+			total += bucketSize;
+		}
+		for (size_t i = 0; i < count; ++i) {
+			dst[offsets[(src[i].key >> shift) & 0xFF]++] = src[i];
+		}
+		std::swap(src, dst);
+	}
+	if (src != entries.data()) {
+		entries.swap(sortScratch);
+	}
+}
+
+void RenderQueue::BuildCommands() {
+	commands.resize(entries.size());
+
+	shaderChanges	= 0;
+	textureChanges	= 0;
+	meshChanges		= 0;
+
+	const Shader*	lastShader	= nullptr;
+	const Texture*	lastTexture = nullptr;
+	const Mesh*		lastMesh	= nullptr;
+
+	for (size_t i = 0; i < entries.size(); ++i) {
+		const RenderItem* o = objects[entries[i].object];
+		uint8_t changes = 0;
+
+		if (i == 0 || o->shader != lastShader) {
+			changes |= ShaderChange;
+			lastShader = o->shader;
+			shaderChanges++;
+		}
+		if (i == 0 || o->texture != lastTexture) {
+			changes |= TextureChange;
+			lastTexture = o->texture;
+			textureChanges++;
+		}
+		if (i == 0 || o->mesh != lastMesh) {
+			changes |= MeshChange;
+			lastMesh = o->mesh;
+			meshChanges++;
+		}
+		commands[i] = { o, changes };
+	}
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+namespace NCL {
+	namespace Rendering {
+		class Mesh;
+		class Shader;
+		class Texture;
+	}
+	namespace CSC8503 {
+		struct RenderItem;
+
+		enum class RenderPass : uint8_t {
+			Opaque		= 0,
+			Transparent = 1
+		};
+
+		struct RenderCommand {
+			const RenderItem*	object;
+			uint8_t				changes;	//RenderQueue::StateChange bits - what needs binding before drawing
+		};
+
+		/*
+		Orders a frame's visible objects to keep state changes to a minimum, without
+		touching the graphics API, so a renderer only has to walk the commands and
+		bind whatever each one says has changed.
+
+		Every object gets a 64 bit key, sorted with an LSD radix sort. Opaque objects
+		come first, grouped by shader, then texture, then mesh, then nearest first.
+		Transparent objects come afterwards, furthest first, as blending needs them
+		in that order more than it needs them grouped:
+
+		opaque		| pass:4 | shader:12 | texture:14 | mesh:14 | depth:20 |
+		transparent	| pass:4 | ~depth:20 | shader:12 | texture:14 | mesh:14 |
+
+		Shaders, textures and meshes are given small ids the first time the queue
+		sees them. If there are ever more than a field can hold they just share the
+		last id, which makes the sort a little less effective but never wrong, as
+		state changes are worked out from the real pointers.
+		*/
+		class RenderQueue {
+		public:
+			enum StateChange : uint8_t {
+				ShaderChange	= 1,
+				TextureChange	= 2,
+				MeshChange		= 4
+			};
+
+			RenderQueue();
+			~RenderQueue();
+
+			void Clear();
+			//viewDepth can be any value that grows with distance from the camera
+			void Add(const RenderItem* o, float viewDepth);
+			//Sorts everything added since the last Clear, and fills in the command list
+			void Sort();
+
+			const std::vector<RenderCommand>& GetCommands() const {
+				return commands;
+			}
+
+			int GetShaderChangeCount()	const { return shaderChanges; }
+			int GetTextureChangeCount()	const { return textureChanges; }
+			int GetMeshChangeCount()	const { return meshChanges; }
+
+			static uint64_t BuildKey(RenderPass pass, uint32_t shaderID, uint32_t textureID, uint32_t meshID, float viewDepth);
+
+		protected:
+			struct Entry {
+				uint64_t	key;
+				uint32_t	object;
+			};
+
+			static uint32_t QuantiseDepth(float viewDepth);
+			uint32_t		GetID(std::unordered_map<const void*, uint32_t>& ids, const void* p, uint32_t maxID);
+
+			void RadixSort();
+			void BuildCommands();
+
+			std::vector<const RenderItem*>		objects;
+			std::vector<Entry>					entries;
+			std::vector<Entry>					sortScratch;
+			std::vector<RenderCommand>			commands;
+
+			std::unordered_map<const void*, uint32_t> shaderIDs;
+			std::unordered_map<const void*, uint32_t> textureIDs;
+			std::unordered_map<const void*, uint32_t> meshIDs;
+
+			int shaderChanges;
+			int textureChanges;
+			int meshChanges;
+		};
+	}
+}
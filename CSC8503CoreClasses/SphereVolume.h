@@ -2,14 +2,13 @@
 #include "CollisionVolume.h"
 
 namespace NCL {
-	class SphereVolume : CollisionVolume
+	class SphereVolume : public CollisionVolume
 	{
 	public:
 		SphereVolume(float sphereRadius = 1.0f) {
 			type	= VolumeType::Sphere;
 			radius	= sphereRadius;
 		}
-		~SphereVolume() {}
 
 		float GetRadius() const {
 			return radius;
@@ -0,0 +1,118 @@
+#include "StaticBatcher.h"
+#include "RenderObject.h"
+#include "Transform.h"
+#include "Mesh.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+StaticBatcher::StaticBatcher(float chunkSize) {
+	this->chunkSize = chunkSize;
+}
+
+StaticBatcher::~StaticBatcher() {
+}
+
+bool StaticBatcher::Add(const RenderObject* o) {
+	const Mesh* mesh = o->GetMesh();
+	if (!mesh || !o->GetMeshHandle().IsReady() || mesh->GetPrimitiveType() != GeometryPrimitive::Triangles || mesh->GetPositionData().empty()) {
+		return false;
+	}
+	Vector3 pos = o->GetTransform()->GetPosition();
+	int chunkX	= (int)floor(pos.x / chunkSize);
+	int chunkZ	= (int)floor(pos.z / chunkSize);
+
+	Vector4 colour = o->GetColour();
+	for (StaticBatch& b : batches) {
+		if (b.shader == o->GetShaderHandle() && b.texture == o->GetTextureHandle() && b.colour == colour &&
+			b.chunkX == chunkX && b.chunkZ == chunkZ) {
+			b.objects.emplace_back(o);
+			return true;
+		}
+	}
+	batches.push_back({ o->GetShaderHandle(), o->GetTextureHandle(), colour, chunkX, chunkZ, { o } });
+	return true;
+}
+
+/*
+Each source mesh is drawn the same way DrawBoundMesh would - by submesh if it
+has any, otherwise as a whole - and its indices offset to where its vertices
+ended up. Vertex colours and texture coordinates are only kept if some mesh in
+the batch has them, with anything missing them padded out with defaults.
+*/
+void StaticBatcher::BuildMesh(const StaticBatch& batch, Mesh& mesh) {
+	bool hasColours		= false;
+	bool hasTexCoords	= false;
+	bool hasNormals		= false;
+	for (const RenderObject* o : batch.objects) {
+		hasColours		|= !o->GetMesh()->GetColourData().empty();
+		hasTexCoords	|= !o->GetMesh()->GetTextureCoordData().empty();
+		hasNormals		|= !o->GetMesh()->GetNormalData().empty();
+	}
+
+	std::vector<Vector3>		positions;
+	std::vector<Vector4>		colours;
+	std::vector<Vector2>		texCoords;
+	std::vector<Vector3>		normals;
+	std::vector<unsigned int>	indices;
+
+	for (const RenderObject* o : batch.objects) {
+		const Mesh* m			= o->GetMesh();
+		Matrix4 modelMatrix		= o->GetTransform()->GetMatrix();
+		Matrix3 normalMatrix	= Matrix3(modelMatrix.Inverse().Transposed());
+
+		unsigned int firstVertex = (unsigned int)positions.size();
+		size_t vertexCount		 = m->GetVertexCount();
+
+		for (const Vector3& p : m->GetPositionData()) {
+			positions.emplace_back(modelMatrix * p);
+		}
+		if (hasColours) {
+			const std::vector<Vector4>& c = m->GetColourData();
+			for (size_t i = 0; i < vertexCount; ++i) {
+				colours.emplace_back(c.empty() ? Vector4(1, 1, 1, 1) : c[i]);
+			}
+		}
+		if (hasTexCoords) {
+			const std::vector<Vector2>& t = m->GetTextureCoordData();
+			for (size_t i = 0; i < vertexCount; ++i) {
+				texCoords.emplace_back(t.empty() ? Vector2(0, 0) : t[i]);
+			}
+		}
+		if (hasNormals) {
+			const std::vector<Vector3>& n = m->GetNormalData();
+			for (size_t i = 0; i < vertexCount; ++i) {
+				normals.emplace_back(n.empty() ? Vector3(0, 1, 0) : (normalMatrix * n[i]).Normalised());
+			}
+		}
+
+		const std::vector<unsigned int>& sourceIndices = m->GetIndexData();
+		auto AddRange = [&](int start, int count, int base) {
+			for (int i = start; i < start + count; ++i) {
+				unsigned int index = sourceIndices.empty() ? (unsigned int)i : sourceIndices[i];
+				indices.emplace_back(firstVertex + base + index);
+			}
+		};
+		if (m->GetSubMeshCount() == 0) {
+			AddRange(0, (int)(sourceIndices.empty() ? vertexCount : sourceIndices.size()), 0);
+		}
+		for (unsigned int i = 0; i < m->GetSubMeshCount(); ++i) {
+			const SubMesh* s = m->GetSubMesh(i);
+			AddRange(s->start, s->count, s->base);
+		}
+	}
+
+	mesh.SetPrimitiveType(GeometryPrimitive::Triangles);
+	mesh.SetVertexPositions(positions);
+	if (hasColours) {
+		mesh.SetVertexColours(colours);
+	}
+	if (hasTexCoords) {
+		mesh.SetVertexTextureCoords(texCoords);
+	}
+	if (hasNormals) {
+		mesh.SetVertexNormals(normals);
+	}
+	mesh.SetVertexIndices(indices);
+	mesh.AddSubMesh(0, (int)indices.size(), 0);
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include "AssetHandle.h"
+
+namespace NCL {
+	namespace Rendering {
+		class Mesh;
+		class Shader;
+		class Texture;
+	}
+	using namespace NCL::Rendering;
+	using namespace NCL::Maths;
+
+	namespace CSC8503 {
+		class RenderObject;
+
+		struct StaticBatch {
+			ShaderHandle	shader;
+			TextureHandle	texture;
+			Vector4		colour;
+			int			chunkX;
+			int			chunkZ;
+			std::vector<const RenderObject*> objects;
+		};
+
+		/*
+		Merges the render objects of level geometry that never moves into a
+		handful of combined meshes at load time, so hundreds of wall segments
+		become a few draws. Objects are grouped by everything that would need a
+		state change or a different instance value - shader, texture and colour -
+		and by which chunk of the level they're in, so that each combined mesh
+		still covers a small enough area to be frustum culled.
+
+		Only triangle meshes that have finished loading can be merged. The combined geometry is baked into
+		world space, so the batch should be drawn with an identity transform.
+		*/
+		class StaticBatcher {
+		public:
+			StaticBatcher(float chunkSize = 100.0f);
+			~StaticBatcher();
+
+			//Returns false if the object can't be merged, and so should still be drawn by itself
+			bool Add(const RenderObject* o);
+
+			const std::vector<StaticBatch>& GetBatches() const {
+				return batches;
+			}
+
+			//Fills an empty mesh with the world space geometry of every object in the batch
+			static void BuildMesh(const StaticBatch& batch, Mesh& mesh);
+
+		protected:
+			float chunkSize;
+			std::vector<StaticBatch> batches;
+		};
+	}
+}
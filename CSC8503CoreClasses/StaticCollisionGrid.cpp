@@ -0,0 +1,142 @@
+#include "StaticCollisionGrid.h"
+#include "GameObject.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+StaticCollisionGrid::StaticCollisionGrid(float cellSize) {
+	this->cellSize	= cellSize;
+	cellsWide		= 0;
+	cellsHigh		= 0;
+	currentStamp	= 0;
+}
+
+StaticCollisionGrid::~StaticCollisionGrid() {
+}
+
+void StaticCollisionGrid::Add(GameObject* o) {
+	objects.emplace_back(o);
+}
+
+void StaticCollisionGrid::Clear(bool andDelete) {
+	if (andDelete) {
+		for (GameObject* o : objects) {
+			delete o;
+		}
+	}
+	objects.clear();
+	boundsMin.clear();
+	boundsMax.clear();
+	cellStart.clear();
+	cellObjects.clear();
+	objectStamps.clear();
+	cellsWide = 0;
+	cellsHigh = 0;
+}
+
+void StaticCollisionGrid::GetCell(float x, float z, int& cellX, int& cellZ) const {
+	cellX = std::clamp((int)floor((x - gridMin.x) / cellSize), 0, cellsWide - 1);
+	cellZ = std::clamp((int)floor((z - gridMin.y) / cellSize), 0, cellsHigh - 1);
+}
+
+/*
+The grid is sized to just fit the objects it holds, so every static is inside
+it, and a query poking out past the edge only needs clamping onto the grid.
+*/
+void StaticCollisionGrid::Build() {
+	boundsMin.clear();
+	boundsMax.clear();
+
+	Vector2 worldMin(FLT_MAX, FLT_MAX);
+	Vector2 worldMax(-FLT_MAX, -FLT_MAX);
+
+	for (GameObject* o : objects) {
+		o->UpdateBroadphaseAABB();
+		Vector3 halfSize;
+		o->GetBroadphaseAABB(halfSize);
+		Vector3 pos = o->GetTransform().GetPosition();
+
+		boundsMin.emplace_back(pos - halfSize);
+		boundsMax.emplace_back(pos + halfSize);
+
+		worldMin.x = std::min(worldMin.x, pos.x - halfSize.x);
+		worldMin.y = std::min(worldMin.y, pos.z - halfSize.z);
+		worldMax.x = std::max(worldMax.x, pos.x + halfSize.x);
+		worldMax.y = std::max(worldMax.y, pos.z + halfSize.z);
+	}
+	if (objects.empty()) {
+		worldMin = Vector2(0, 0);
+		worldMax = Vector2(0, 0);
+	}
+	gridMin		= worldMin;
+	cellsWide	= std::max(1, (int)ceil((worldMax.x - worldMin.x) / cellSize));
+	cellsHigh	= std::max(1, (int)ceil((worldMax.y - worldMin.y) / cellSize));
+
+	cellStart.assign(cellsWide * cellsHigh + 1, 0);
+
+	//Count how many objects land in each cell, then pack them in
+	for (int pass = 0; pass < 2; ++pass) {
+		for (int i = 0; i < objects.size(); ++i) {
+			int minX, minZ, maxX, maxZ;
+			GetCell(boundsMin[i].x, boundsMin[i].z, minX, minZ);
+			GetCell(boundsMax[i].x, boundsMax[i].z, maxX, maxZ);
+			for (int z = minZ; z <= maxZ; ++z) {
+				for (int x = minX; x <= maxX; ++x) {
+					if (pass == 0) {
+						cellStart[(z * cellsWide) + x + 1]++;
+					}
+					else {
+						cellObjects[cellStart[(z * cellsWide) + x]++] = i;
+					}
+				}
+			}
+		}
+		if (pass == 0) {
+			for (int i = 1; i < cellStart.size(); ++i) {
+				cellStart[i] += cellStart[i - 1];
+			}
+			cellObjects.resize(cellStart.back());
+		}
+	}
+	//Packing moved each cell's start along to its end, so shift them back
+	for (int i = (int)cellStart.size() - 1; i > 0; --i) {
+		cellStart[i] = cellStart[i - 1];
+	}
+	cellStart[0] = 0;
+
+	objectStamps.assign(objects.size(), -1);
+	currentStamp = 0;
+}
+
+void StaticCollisionGrid::Query(const Vector3& position, const Vector3& halfSize, std::vector<GameObject*>& out) const {
+	out.clear();
+	if (cellStart.empty()) {
+		return;
+	}
+	Vector3 queryMin = position - halfSize;
+	Vector3 queryMax = position + halfSize;
+
+	int minX, minZ, maxX, maxZ;
+	GetCell(queryMin.x, queryMin.z, minX, minZ);
+	GetCell(queryMax.x, queryMax.z, maxX, maxZ);
+
+	currentStamp++;
+	for (int z = minZ; z <= maxZ; ++z) {
+		for (int x = minX; x <= maxX; ++x) {
+			int cell = (z * cellsWide) + x;
+			for (int c = cellStart[cell]; c < cellStart[cell + 1]; ++c) {
+				int i = cellObjects[c];
+				if (objectStamps[i] == currentStamp) {
+					continue;
+				}
+				objectStamps[i] = currentStamp;
+
+				if (queryMin.x <= boundsMax[i].x && queryMax.x >= boundsMin[i].x &&
+					queryMin.y <= boundsMax[i].y && queryMax.y >= boundsMin[i].y &&
+					queryMin.z <= boundsMax[i].z && queryMax.z >= boundsMin[i].z) {
+					out.emplace_back(objects[i]);
+				}
+			}
+		}
+	}
+}
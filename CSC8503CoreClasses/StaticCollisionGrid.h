@@ -0,0 +1,54 @@
+#pragma once
+
+namespace NCL {
+	using namespace NCL::Maths;
+	namespace CSC8503 {
+		class GameObject;
+
+		/*
+		Holds the objects in a level that will never move, such as the map walls,
+		so that they can be kept out of the world's per frame object list. They
+		are binned once into a uniform grid on the XZ plane when Build is called,
+		and after that the physics just asks the grid which statics a moving
+		object's AABB overlaps, rather than reinserting them into the broadphase
+		every frame.
+
+		The grid owns its objects, and deletes them in Clear if asked to.
+		*/
+		class StaticCollisionGrid {
+		public:
+			StaticCollisionGrid(float cellSize = 16.0f);
+			~StaticCollisionGrid();
+
+			//Objects added aren't collided against until the next Build
+			void Add(GameObject* o);
+			void Build();
+			void Clear(bool andDelete = false);
+
+			const std::vector<GameObject*>& GetObjects() const {
+				return objects;
+			}
+
+			//Fills out with every static whose AABB overlaps the given one, each only once
+			void Query(const Vector3& position, const Vector3& halfSize, std::vector<GameObject*>& out) const;
+
+		protected:
+			void GetCell(float x, float z, int& cellX, int& cellZ) const;
+
+			float cellSize;
+			Vector2 gridMin;
+			int	cellsWide;
+			int cellsHigh;
+
+			std::vector<GameObject*>	objects;
+			std::vector<Vector3>		boundsMin;	//world space AABB per object, from the last Build
+			std::vector<Vector3>		boundsMax;
+
+			std::vector<int>	cellStart;		//cellObjects offsets, one past the end for each cell
+			std::vector<int>	cellObjects;	//object indices, packed cell by cell
+
+			mutable std::vector<int>	objectStamps;	//so objects spanning several cells are only reported once
+			mutable int					currentStamp;
+		};
+	}
+}
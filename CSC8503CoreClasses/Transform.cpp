@@ -3,34 +3,33 @@
 using namespace NCL::CSC8503;
 
 Transform::Transform()	{
-	scale = Vector3(1, 1, 1);
+	scale		= Vector3(1, 1, 1);
+	matrixDirty = false;	//the identity matrix is already right for the default position, orientation and scale
 }
 
 Transform::~Transform()	{
 
 }
 
-void Transform::UpdateMatrix() {
-	matrix =
-		Matrix4::Translation(position) *
-		Matrix4(orientation) *
-		Matrix4::Scale(scale);
+void Transform::UpdateMatrix() const {
+	matrix		= Matrix4::TRS(position, orientation, scale);
+	matrixDirty = false;
 }
 
 Transform& Transform::SetPosition(const Vector3& worldPos) {
 	position = worldPos;
-	UpdateMatrix();
+	matrixDirty = true;
 	return *this;
 }
 
 Transform& Transform::SetScale(const Vector3& worldScale) {
 	scale = worldScale;
-	UpdateMatrix();
+	matrixDirty = true;
 	return *this;
 }
 
 Transform& Transform::SetOrientation(const Quaternion& worldOrientation) {
 	orientation = worldOrientation;
-	UpdateMatrix();
+	matrixDirty = true;
 	return *this;
 }
\ No newline at end of file
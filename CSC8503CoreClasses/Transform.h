@@ -28,12 +28,22 @@ namespace NCL {
 				return orientation;
 			}
 
+			/*
+			The matrix is only rebuilt when it's asked for, rather than by every
+			setter, as physics moves things several times a frame and only the
+			renderer reads it. As that writes to the transform, only one thread
+			should ask for any one transform's matrix at a time.
+			*/
 			Matrix4 GetMatrix() const {
+				if (matrixDirty) {
+					UpdateMatrix();
+				}
 				return matrix;
 			}
-			void UpdateMatrix();
+			void UpdateMatrix() const;
 		protected:
-			Matrix4		matrix;
+			mutable Matrix4	matrix;
+			mutable bool	matrixDirty;
 			Quaternion	orientation;
 			Vector3		position;
 
@@ -0,0 +1,239 @@
+#include "VisibilityGrid.h"
+#include "GameWorld.h"
+#include "GameObject.h"
+#include "CollisionDetection.h"
+#include "Maths.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+VisibilityGrid::VisibilityGrid(Vector2 worldMin, Vector2 worldSize, float cellSize) {
+	this->gridMin	= worldMin;
+	this->cellSize	= cellSize;
+	cellsWide		= std::max(1, (int)ceil(worldSize.x / cellSize));
+	cellsHigh		= std::max(1, (int)ceil(worldSize.y / cellSize));
+	cellStart.resize(cellsWide * cellsHigh + 1, 0);
+	currentStamp	= 0;
+}
+
+VisibilityGrid::~VisibilityGrid() {
+}
+
+bool VisibilityGrid::GetCellForPosition(float x, float z, int& cellX, int& cellZ) const {
+	cellX = (int)floor((x - gridMin.x) / cellSize);
+	cellZ = (int)floor((z - gridMin.y) / cellSize);
+
+	bool inside = cellX >= 0 && cellX < cellsWide && cellZ >= 0 && cellZ < cellsHigh;
+
+	cellX = std::clamp(cellX, 0, cellsWide - 1);
+	cellZ = std::clamp(cellZ, 0, cellsHigh - 1);
+	return inside;
+}
+
+/*
+Objects go into every cell their broadphase AABB overlaps. The cell lists are
+packed into one array, sized by a counting pass first, so a rebuild does no
+allocation once the vectors have grown to fit the level. Anything poking out
+past the edge of the grid is also kept on a separate list, for rays that leave
+the grid to check against.
+*/
+void VisibilityGrid::Rebuild(const GameWorld& world) {
+	objects.clear();
+
+	GameObjectIterator first;
+	GameObjectIterator last;
+	world.GetObjectIterators(first, last);
+
+	for (auto i = first; i != last; ++i) {
+		if ((*i)->GetBoundingVolume() && (*i)->IsActive()) {
+			objects.emplace_back(*i);
+		}
+	}
+	for (GameObject* o : world.GetStaticObjects().GetObjects()) {
+		if (o->GetBoundingVolume() && o->IsActive()) {
+			objects.emplace_back(o);
+		}
+	}
+	objectStamps.assign(objects.size(), -1);
+	currentStamp = 0;
+
+	objectCells.resize(objects.size() * 4);
+	outsideObjects.clear();
+
+	std::fill(cellStart.begin(), cellStart.end(), 0);
+	for (int i = 0; i < objects.size(); ++i) {
+		Vector3 halfSize;
+		objects[i]->GetBroadphaseAABB(halfSize);
+		Vector3 pos = objects[i]->GetTransform().GetPosition();
+
+		int* cells = &objectCells[i * 4];
+		bool minInside = GetCellForPosition(pos.x - halfSize.x, pos.z - halfSize.z, cells[0], cells[1]);
+		bool maxInside = GetCellForPosition(pos.x + halfSize.x, pos.z + halfSize.z, cells[2], cells[3]);
+		if (!minInside || !maxInside) {
+			outsideObjects.emplace_back(i);
+		}
+
+		for (int z = cells[1]; z <= cells[3]; ++z) {
+			for (int x = cells[0]; x <= cells[2]; ++x) {
+				cellStart[(z * cellsWide) + x + 1]++;
+			}
+		}
+	}
+	for (int i = 1; i < cellStart.size(); ++i) {
+		cellStart[i] += cellStart[i - 1];
+	}
+	cellObjects.resize(cellStart.back());
+
+	cellFill.assign(cellStart.begin(), cellStart.end() - 1);
+	for (int i = 0; i < objects.size(); ++i) {
+		const int* cells = &objectCells[i * 4];
+		for (int z = cells[1]; z <= cells[3]; ++z) {
+			for (int x = cells[0]; x <= cells[2]; ++x) {
+				cellObjects[cellFill[(z * cellsWide) + x]++] = i;
+			}
+		}
+	}
+}
+
+int VisibilityGrid::AddRay(const Vector3& from, const Vector3& direction, float maxDistance, const GameObject* ignore) {
+	queries.push_back({ from, direction.Normalised(), maxDistance, ignore });
+	return (int)queries.size() - 1;
+}
+
+int VisibilityGrid::AddTargetRay(const Vector3& from, GameObject& target, const GameObject* ignore) {
+	Vector3 offset = target.GetTransform().GetPosition() - from;
+	//A little over the distance to the target's centre, so it's sure to reach its surface
+	return AddRay(from, offset, offset.Length() + 1.0f, ignore);
+}
+
+int VisibilityGrid::AddCone(const Vector3& from, const Vector3& forward, float halfAngle, float range, int rayCount, const GameObject* ignore) {
+	int firstIndex = (int)queries.size();
+	float step		= rayCount > 1 ? (2.0f * halfAngle) / (rayCount - 1) : 0.0f;
+	float angle		= rayCount > 1 ? -halfAngle : 0.0f;
+
+	for (int i = 0; i < rayCount; ++i) {
+		float radians	= Maths::DegreesToRadians(angle);
+		float s			= sin(radians);
+		float c			= cos(radians);
+		Vector3 dir(forward.x * c + forward.z * s, forward.y, forward.z * c - forward.x * s);
+		AddRay(from, dir, range, ignore);
+		angle += step;
+	}
+	return firstIndex;
+}
+
+void VisibilityGrid::Execute() {
+	results.resize(queries.size());
+	for (int i = 0; i < queries.size(); ++i) {
+		results[i] = CastRay(queries[i]);
+	}
+}
+
+void VisibilityGrid::ClearQueries() {
+	queries.clear();
+	results.clear();
+}
+
+/*
+Walks the ray through the grid a cell at a time (a 2D DDA on the XZ plane).
+Each object is only tested once per ray, even if it spans several cells, and
+the walk stops as soon as the closest hit so far is nearer than the far side
+of the current cell, as nothing in a later cell can beat it.
+*/
+SightResult VisibilityGrid::CastRay(const SightQuery& query) {
+	int stamp = currentStamp++;
+	SightResult result = { nullptr, query.maxDistance };
+
+	const float gridMaxX = gridMin.x + cellsWide * cellSize;
+	const float gridMaxZ = gridMin.y + cellsHigh * cellSize;
+
+	Ray ray(query.from, query.direction);
+
+	//Clip the ray down to the part that's over the grid
+	float tStart	= 0.0f;
+	float tEnd		= query.maxDistance;
+
+	float origin[2]		= { query.from.x, query.from.z };
+	float dir[2]		= { query.direction.x, query.direction.z };
+	float boundsMin[2]	= { gridMin.x, gridMin.y };
+	float boundsMax[2]	= { gridMaxX, gridMaxZ };
+
+	for (int axis = 0; axis < 2; ++axis) {
+		if (std::abs(dir[axis]) < 1e-6f) {
+			if (origin[axis] < boundsMin[axis] || origin[axis] > boundsMax[axis]) {
+				return result;
+			}
+			continue;
+		}
+		float t0 = (boundsMin[axis] - origin[axis]) / dir[axis];
+		float t1 = (boundsMax[axis] - origin[axis]) / dir[axis];
+		if (t0 > t1) {
+			std::swap(t0, t1);
+		}
+		tStart	= std::max(tStart, t0);
+		tEnd	= std::min(tEnd, t1);
+	}
+	if (tStart > 0.0f || tEnd < query.maxDistance) {
+		for (int objectIndex : outsideObjects) {
+			TestObject(ray, query, objectIndex, stamp, result);
+		}
+	}
+	if (tStart > tEnd) {
+		return result;
+	}
+
+	int cellX, cellZ;
+	GetCellForPosition(origin[0] + dir[0] * tStart, origin[1] + dir[1] * tStart, cellX, cellZ);
+
+	int stepX = dir[0] >= 0.0f ? 1 : -1;
+	int stepZ = dir[1] >= 0.0f ? 1 : -1;
+
+	float tDeltaX = std::abs(dir[0]) < 1e-6f ? FLT_MAX : cellSize / std::abs(dir[0]);
+	float tDeltaZ = std::abs(dir[1]) < 1e-6f ? FLT_MAX : cellSize / std::abs(dir[1]);
+
+	float tNextX = std::abs(dir[0]) < 1e-6f ? FLT_MAX : (gridMin.x + (cellX + (stepX > 0 ? 1 : 0)) * cellSize - origin[0]) / dir[0];
+	float tNextZ = std::abs(dir[1]) < 1e-6f ? FLT_MAX : (gridMin.y + (cellZ + (stepZ > 0 ? 1 : 0)) * cellSize - origin[1]) / dir[1];
+
+	while (true) {
+		int cell = (cellZ * cellsWide) + cellX;
+		for (int i = cellStart[cell]; i < cellStart[cell + 1]; ++i) {
+			TestObject(ray, query, cellObjects[i], stamp, result);
+		}
+		float tExit = std::min(tNextX, tNextZ);
+		if (result.hitObject && result.distance <= tExit) {
+			break;
+		}
+		if (tExit > tEnd) {
+			break;
+		}
+		if (tNextX < tNextZ) {
+			cellX	+= stepX;
+			tNextX	+= tDeltaX;
+		}
+		else {
+			cellZ	+= stepZ;
+			tNextZ	+= tDeltaZ;
+		}
+		if (cellX < 0 || cellX >= cellsWide || cellZ < 0 || cellZ >= cellsHigh) {
+			break;
+		}
+	}
+	return result;
+}
+
+void VisibilityGrid::TestObject(const Ray& ray, const SightQuery& query, int objectIndex, int stamp, SightResult& result) {
+	if (objectStamps[objectIndex] == stamp) {
+		return;
+	}
+	objectStamps[objectIndex] = stamp;
+
+	GameObject* object = objects[objectIndex];
+	if (object == query.ignore) {
+		return;
+	}
+	RayCollision collision;
+	if (CollisionDetection::RayIntersection(ray, *object, collision) && collision.rayDistance < result.distance) {
+		result.hitObject	= object;
+		result.distance		= collision.rayDistance;
+	}
+}
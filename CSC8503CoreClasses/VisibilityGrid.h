@@ -0,0 +1,86 @@
+#pragma once
+#include "Ray.h"
+
+namespace NCL {
+	using namespace NCL::Maths;
+	namespace CSC8503 {
+		class GameObject;
+		class GameWorld;
+
+		struct SightQuery {
+			Vector3				from;
+			Vector3				direction;	//normalised
+			float				maxDistance;
+			const GameObject*	ignore;		//usually the object doing the looking
+		};
+
+		struct SightResult {
+			GameObject* hitObject;	//nullptr if nothing was hit within range
+			float		distance;
+		};
+
+		/*
+		Batches up line of sight queries for the AI so they can all be answered
+		against one shared spatial structure, rather than each one testing every
+		object in the world.
+
+		The world is binned into a uniform grid of cells on the XZ plane, and each
+		ray walks through only the cells it passes over. Rebuild is cheap enough to
+		call every tick, so anything that moves is still an occluder for that tick's
+		queries. The grid should cover the play area - objects outside of it still
+		work, but are tested against every ray that leaves the grid.
+
+		Usage each tick is Rebuild, add queries, Execute, then read the results
+		back using the indices the Add functions returned.
+		*/
+		class VisibilityGrid {
+		public:
+			VisibilityGrid(Vector2 worldMin, Vector2 worldSize, float cellSize);
+			~VisibilityGrid();
+
+			void Rebuild(const GameWorld& world);
+
+			int AddRay(const Vector3& from, const Vector3& direction, float maxDistance, const GameObject* ignore = nullptr);
+			int AddTargetRay(const Vector3& from, GameObject& target, const GameObject* ignore = nullptr);
+			//Fans rayCount rays across the view cone on the XZ plane, returning the index of the first
+			int AddCone(const Vector3& from, const Vector3& forward, float halfAngle, float range, int rayCount, const GameObject* ignore = nullptr);
+
+			void Execute();
+			void ClearQueries();
+
+			const SightResult& GetResult(int index) const {
+				return results[index];
+			}
+
+			const std::vector<SightResult>& GetResults() const {
+				return results;
+			}
+
+			size_t GetQueryCount() const {
+				return queries.size();
+			}
+
+		protected:
+			SightResult	CastRay(const SightQuery& query);
+			void		TestObject(const Ray& ray, const SightQuery& query, int objectIndex, int stamp, SightResult& result);
+			bool		GetCellForPosition(float x, float z, int& cellX, int& cellZ) const;
+
+			Vector2	gridMin;
+			float	cellSize;
+			int		cellsWide;
+			int		cellsHigh;
+
+			std::vector<GameObject*>	objects;
+			std::vector<int>			objectStamps;	//last ray each object was tested against
+			int							currentStamp;
+			std::vector<int>			cellStart;		//cellsWide * cellsHigh + 1 offsets into cellObjects
+			std::vector<int>			cellObjects;
+			std::vector<int>			objectCells;	//min x, min z, max x, max z cell of each object
+			std::vector<int>			cellFill;
+			std::vector<int>			outsideObjects;	//overlap the edge of the grid
+
+			std::vector<SightQuery>		queries;
+			std::vector<SightResult>	results;
+		};
+	}
+}
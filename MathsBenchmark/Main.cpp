@@ -0,0 +1,367 @@
+/*
+Times the core maths operations against the plain scalar versions they
+replaced, and the NewVector and NewMatrix templates against the existing
+maths classes, and checks each pair give the same answers.
+
+Usage: MathsBenchmark [iterations]
+Each operation is run over the same set of random inputs, iterations times
+(1000 by default), and the fastest pass of each version is reported in
+nanoseconds per operation, along with the largest difference between the
+two versions' results. Anything other than an exact match is a failure,
+apart from building matrices from a position, orientation and scale, which
+is only expected to be within rounding of doing the full multiplies.
+The templates' compile time maths is checked by the static_asserts below.
+
+Build with optimisations on, or the numbers won't mean much.
+*/
+#include "Matrix3.h"
+#include "Matrix4.h"
+#include "Quaternion.h"
+#include "Vector3.h"
+#include "Vector4.h"
+#include "NewVector.h"
+#include "NewMatrix.h"
+
+using namespace NCL;
+using namespace Maths;
+
+namespace {
+	const size_t	INPUT_COUNT			= 1024;
+	const int		DEFAULT_ITERATIONS	= 1000;
+	const float		TRS_TOLERANCE		= 1e-5f;
+	const size_t	PAGE_BYTES			= 4096;
+	const size_t	OUTPUT_OFFSET		= PAGE_BYTES / 2;
+
+	/*
+	Loads and stores a multiple of 4KB apart can be mistaken for each other,
+	so how far each output happens to be from its inputs can cost the inner
+	loops a third of their time. Every buffer starts on a page, and outputs
+	start half a page into theirs, so both versions see the same distances.
+	*/
+	template<typename T>
+	struct PageAllocator {
+		using value_type = T;
+
+		PageAllocator() = default;
+		template<typename U>
+		PageAllocator(const PageAllocator<U>&) {}
+
+		T* allocate(size_t n) {
+			return (T*)::operator new(n * sizeof(T), std::align_val_t(PAGE_BYTES));
+		}
+		void deallocate(T* p, size_t) {
+			::operator delete(p, std::align_val_t(PAGE_BYTES));
+		}
+		bool operator==(const PageAllocator&) const {
+			return true;
+		}
+	};
+
+	template<typename T>
+	using PageVector = std::vector<T, PageAllocator<T>>;
+
+	using Clock = std::chrono::high_resolution_clock;
+
+	static_assert(Dot(NewVector3(1, 2, 3), NewVector3(4, 5, 6)) == 32.0f);
+	static_assert(Cross(NewVector3(1, 0, 0), NewVector3(0, 1, 0)) == NewVector3(0, 0, 1));
+	static_assert(NewVector4(1, 2, 3, 4) + NewVector4(4, 3, 2, 1) == NewVector4(5, 5, 5, 5));
+	static_assert(NewVector4(2, 4, 6, 8) / 2.0f == NewVector4(1, 2, 3, 4));
+	static_assert(Clamp(NewVector3i(-5, 5, 15), NewVector3i(0, 0, 0), NewVector3i(10, 10, 10)) == NewVector3i(0, 5, 10));
+	static_assert(Translation(NewVector3d(1, 2, 3)) * NewVector4d(1, 1, 1, 1) == NewVector4d(2, 3, 4, 1));
+	static_assert(Scale(NewVector3(2, 3, 4)) * Translation(NewVector3(1, 1, 1)) * NewVector4(1, 1, 1, 1) == NewVector4(4, 6, 8, 1));
+	static_assert(Transpose(Translation(NewVector3(1, 2, 3))).GetRow(3) == NewVector4(1, 2, 3, 1));
+	static_assert(Transpose(NewMatrix<int, 2, 3>()).GetColumn(1) == NewVector3i(0, 1, 0));
+
+	//The scalar maths, as it was written before it used SIMD::Float4
+	namespace Scalar {
+		Matrix4 Multiply(const Matrix4& a, const Matrix4& b) {
+			Matrix4 out;
+			for (unsigned int c = 0; c < 4; ++c) {
+				for (unsigned int r = 0; r < 4; ++r) {
+					out.array[c][r] = 0.0f;
+					for (unsigned int i = 0; i < 4; ++i) {
+						out.array[c][r] += a.array[i][r] * b.array[c][i];
+					}
+				}
+			}
+			return out;
+		}
+
+		Matrix3 Multiply(const Matrix3& a, const Matrix3& b) {
+			Matrix3 out;
+			for (unsigned int c = 0; c < 3; ++c) {
+				for (unsigned int r = 0; r < 3; ++r) {
+					out.array[c][r] = 0.0f;
+					for (unsigned int i = 0; i < 3; ++i) {
+						out.array[c][r] += a.array[i][r] * b.array[c][i];
+					}
+				}
+			}
+			return out;
+		}
+
+		Vector4 Multiply(const Matrix4& m, const Vector4& v) {
+			return Vector4(
+				v.x * m.array[0][0] + v.y * m.array[1][0] + v.z * m.array[2][0] + v.w * m.array[3][0],
+				v.x * m.array[0][1] + v.y * m.array[1][1] + v.z * m.array[2][1] + v.w * m.array[3][1],
+				v.x * m.array[0][2] + v.y * m.array[1][2] + v.z * m.array[2][2] + v.w * m.array[3][2],
+				v.x * m.array[0][3] + v.y * m.array[1][3] + v.z * m.array[2][3] + v.w * m.array[3][3]
+			);
+		}
+
+		Vector3 Multiply(const Matrix4& m, const Vector3& v) {
+			Vector3 vec;
+			vec.x = v.x * m.array[0][0] + v.y * m.array[1][0] + v.z * m.array[2][0] + m.array[3][0];
+			vec.y = v.x * m.array[0][1] + v.y * m.array[1][1] + v.z * m.array[2][1] + m.array[3][1];
+			vec.z = v.x * m.array[0][2] + v.y * m.array[1][2] + v.z * m.array[2][2] + m.array[3][2];
+			float temp = v.x * m.array[0][3] + v.y * m.array[1][3] + v.z * m.array[2][3] + m.array[3][3];
+			return vec / temp;
+		}
+
+		Vector3 Multiply(const Matrix3& m, const Vector3& v) {
+			Vector3 vec;
+			vec.x = v.x * m.array[0][0] + v.y * m.array[1][0] + v.z * m.array[2][0];
+			vec.y = v.x * m.array[0][1] + v.y * m.array[1][1] + v.z * m.array[2][1];
+			vec.z = v.x * m.array[0][2] + v.y * m.array[1][2] + v.z * m.array[2][2];
+			return vec;
+		}
+
+		Quaternion Multiply(const Quaternion& a, const Quaternion& b) {
+			return Quaternion(
+				(a.x * b.w) + (a.w * b.x) + (a.y * b.z) - (a.z * b.y),
+				(a.y * b.w) + (a.w * b.y) + (a.z * b.x) - (a.x * b.z),
+				(a.z * b.w) + (a.w * b.z) + (a.x * b.y) - (a.y * b.x),
+				(a.w * b.w) - (a.x * b.x) - (a.y * b.y) - (a.z * b.z)
+			);
+		}
+
+		Quaternion Normalised(const Quaternion& q) {
+			Quaternion out = q;
+			float magnitude = sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+			if (magnitude > 0.0f) {
+				float t = 1.0f / magnitude;
+				out.x *= t;
+				out.y *= t;
+				out.z *= t;
+				out.w *= t;
+			}
+			return out;
+		}
+
+		Vector4 Add(const Vector4& a, const Vector4& b) {
+			return Vector4(a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w);
+		}
+
+		Vector4 Multiply(const Vector4& a, const Vector4& b) {
+			return Vector4(a.x * b.x, a.y * b.y, a.z * b.z, a.w * b.w);
+		}
+
+		Vector4 Divide(const Vector4& a, float f) {
+			return Vector4(a.x / f, a.y / f, a.z / f, a.w / f);
+		}
+
+		Matrix4 TRS(const Vector3& position, const Quaternion& orientation, const Vector3& scale) {
+			return Multiply(Multiply(Matrix4::Translation(position), Matrix4(orientation)), Matrix4::Scale(scale));
+		}
+	}
+
+	struct Inputs {
+		PageVector<Matrix4>			matrix4s;
+		PageVector<Matrix3>			matrix3s;
+		PageVector<Quaternion>		quaternions;
+		PageVector<Vector4>			vector4s;
+		PageVector<Vector3>			vector3s;
+		PageVector<float>			floats;
+
+		PageVector<NewMatrix4>		newMatrix4s;
+		PageVector<NewMatrix3>		newMatrix3s;
+		PageVector<NewVector4>		newVector4s;
+		PageVector<NewVector3>		newVector3s;
+	};
+
+	Inputs MakeInputs(size_t count) {
+		std::mt19937 generator(8503);
+		std::uniform_real_distribution<float> value(-10.0f, 10.0f);
+		std::uniform_real_distribution<float> angle(-180.0f, 180.0f);
+
+		auto randomVector = [&]() { return Vector3(value(generator), value(generator), value(generator)); };
+
+		Inputs in;
+		for (size_t i = 0; i < count; ++i) {
+			Quaternion q = Quaternion::EulerAnglesToQuaternion(angle(generator), angle(generator), angle(generator));
+			Vector3 scale = randomVector();
+
+			Matrix4 m4 = Scalar::TRS(randomVector(), q, scale);
+			m4.array[0][3] = value(generator);	//so the bottom row isn't just 0,0,0,1
+			m4.array[2][3] = value(generator);
+
+			in.matrix4s.emplace_back(m4);
+			in.matrix3s.emplace_back(Matrix3(m4));
+			in.quaternions.emplace_back(q * value(generator));
+			in.vector4s.emplace_back(value(generator), value(generator), value(generator), value(generator));
+			in.vector3s.emplace_back(scale);
+			in.floats.emplace_back(value(generator) + 20.0f);	//never 0, for dividing by
+
+			in.newMatrix4s.emplace_back(ToNewMatrix(in.matrix4s.back()));
+			in.newMatrix3s.emplace_back(ToNewMatrix(in.matrix3s.back()));
+			in.newVector4s.emplace_back(ToNewVector(in.vector4s.back()));
+			in.newVector3s.emplace_back(ToNewVector(in.vector3s.back()));
+		}
+		return in;
+	}
+
+	//Everything being compared is just floats, so can be compared float by float, even if they're different types
+	template<typename A, typename B>
+	float MaxDifference(const A& a, const B& b) {
+		static_assert(sizeof(A) == sizeof(B));
+		const float* fa = (const float*)&a;
+		const float* fb = (const float*)&b;
+		float diff = 0.0f;
+		for (size_t i = 0; i < sizeof(A) / sizeof(float); ++i) {
+			diff = std::max(diff, std::abs(fa[i] - fb[i]));
+		}
+		return diff;
+	}
+
+	float TimePass(Clock::time_point start, size_t count) {
+		return std::chrono::duration<float, std::nano>(Clock::now() - start).count() / count;
+	}
+
+	//Passes over the inputs alternate between the two versions, so both see the same conditions
+	template<typename T, typename U = T, typename ScalarOp, typename Op>
+	bool Benchmark(const char* name, int iterations, float tolerance, ScalarOp scalarOp, Op op) {
+		PageVector<T> scalarBuffer(INPUT_COUNT + OUTPUT_OFFSET / sizeof(T));
+		PageVector<U> buffer(INPUT_COUNT + OUTPUT_OFFSET / sizeof(U));
+		T* scalarOut	= scalarBuffer.data() + OUTPUT_OFFSET / sizeof(T);
+		U* out			= buffer.data() + OUTPUT_OFFSET / sizeof(U);
+
+		float scalarNS	= FLT_MAX;
+		float ns		= FLT_MAX;
+		for (int pass = 0; pass < iterations; ++pass) {
+			auto start = Clock::now();
+			for (size_t i = 0; i < INPUT_COUNT; ++i) {
+				scalarOut[i] = scalarOp(i);
+			}
+			scalarNS = std::min(scalarNS, TimePass(start, INPUT_COUNT));
+
+			start = Clock::now();
+			for (size_t i = 0; i < INPUT_COUNT; ++i) {
+				out[i] = op(i);
+			}
+			ns = std::min(ns, TimePass(start, INPUT_COUNT));
+		}
+
+		float diff = 0.0f;
+		for (size_t i = 0; i < INPUT_COUNT; ++i) {
+			diff = std::max(diff, MaxDifference(scalarOut[i], out[i]));
+		}
+		bool passed = diff <= tolerance;
+		std::cout << name << "\t" << scalarNS << "\t" << ns << "\t" << (scalarNS / ns) << "x\t" << diff << (passed ? "" : "\tFAILED") << "\n";
+		return passed;
+	}
+}
+
+int main(int argc, char** argv) {
+	int iterations = DEFAULT_ITERATIONS;
+	if (argc == 2) {
+		iterations = std::max(1, atoi(argv[1]));
+	}
+	const Inputs in = MakeInputs(INPUT_COUNT);
+	const size_t last = INPUT_COUNT - 1;
+
+	std::cout << "Operation\tScalar ns\tSIMD ns\tSpeedup\tMax difference\n";
+	int failures = 0;
+
+	auto run = [&](bool passed) {
+		if (!passed) {
+			failures++;
+		}
+	};
+	run(Benchmark<Matrix4>("Matrix4 * Matrix4", iterations, 0.0f,
+		[&](size_t i) { return Scalar::Multiply(in.matrix4s[i], in.matrix4s[last - i]); },
+		[&](size_t i) { return in.matrix4s[i] * in.matrix4s[last - i]; }));
+
+	run(Benchmark<Vector4>("Matrix4 * Vector4", iterations, 0.0f,
+		[&](size_t i) { return Scalar::Multiply(in.matrix4s[i], in.vector4s[i]); },
+		[&](size_t i) { return in.matrix4s[i] * in.vector4s[i]; }));
+
+	run(Benchmark<Vector3>("Matrix4 * Vector3", iterations, 0.0f,
+		[&](size_t i) { return Scalar::Multiply(in.matrix4s[i], in.vector3s[i]); },
+		[&](size_t i) { return in.matrix4s[i] * in.vector3s[i]; }));
+
+	run(Benchmark<Matrix3>("Matrix3 * Matrix3", iterations, 0.0f,
+		[&](size_t i) { return Scalar::Multiply(in.matrix3s[i], in.matrix3s[last - i]); },
+		[&](size_t i) { return in.matrix3s[i] * in.matrix3s[last - i]; }));
+
+	run(Benchmark<Vector3>("Matrix3 * Vector3", iterations, 0.0f,
+		[&](size_t i) { return Scalar::Multiply(in.matrix3s[i], in.vector3s[i]); },
+		[&](size_t i) { return in.matrix3s[i] * in.vector3s[i]; }));
+
+	run(Benchmark<Quaternion>("Quaternion * Quaternion", iterations, 0.0f,
+		[&](size_t i) { return Scalar::Multiply(in.quaternions[i], in.quaternions[last - i]); },
+		[&](size_t i) { return in.quaternions[i] * in.quaternions[last - i]; }));
+
+	run(Benchmark<Quaternion>("Quaternion::Normalised", iterations, 0.0f,
+		[&](size_t i) { return Scalar::Normalised(in.quaternions[i]); },
+		[&](size_t i) { return in.quaternions[i].Normalised(); }));
+
+	run(Benchmark<Vector4>("Vector4 + Vector4", iterations, 0.0f,
+		[&](size_t i) { return Scalar::Add(in.vector4s[i], in.vector4s[last - i]); },
+		[&](size_t i) { return in.vector4s[i] + in.vector4s[last - i]; }));
+
+	run(Benchmark<Vector4>("Vector4 * Vector4", iterations, 0.0f,
+		[&](size_t i) { return Scalar::Multiply(in.vector4s[i], in.vector4s[last - i]); },
+		[&](size_t i) { return in.vector4s[i] * in.vector4s[last - i]; }));
+
+	run(Benchmark<Vector4>("Vector4 / float", iterations, 0.0f,
+		[&](size_t i) { return Scalar::Divide(in.vector4s[i], in.floats[i]); },
+		[&](size_t i) { return in.vector4s[i] / in.floats[i]; }));
+
+	run(Benchmark<Matrix4>("Matrix4::TRS", iterations, TRS_TOLERANCE,
+		[&](size_t i) { return Scalar::TRS(in.vector3s[i], in.quaternions[i], in.vector3s[last - i]); },
+		[&](size_t i) { return Matrix4::TRS(in.vector3s[i], in.quaternions[i], in.vector3s[last - i]); }));
+
+	std::cout << "\nOperation\tLegacy ns\tNew ns\tSpeedup\tMax difference\n";
+
+	run(Benchmark<Matrix4, NewMatrix4>("NewMatrix4 * NewMatrix4", iterations, 0.0f,
+		[&](size_t i) { return in.matrix4s[i] * in.matrix4s[last - i]; },
+		[&](size_t i) { return in.newMatrix4s[i] * in.newMatrix4s[last - i]; }));
+
+	run(Benchmark<Vector4, NewVector4>("NewMatrix4 * NewVector4", iterations, 0.0f,
+		[&](size_t i) { return in.matrix4s[i] * in.vector4s[i]; },
+		[&](size_t i) { return in.newMatrix4s[i] * in.newVector4s[i]; }));
+
+	run(Benchmark<Matrix3, NewMatrix3>("NewMatrix3 * NewMatrix3", iterations, 0.0f,
+		[&](size_t i) { return in.matrix3s[i] * in.matrix3s[last - i]; },
+		[&](size_t i) { return in.newMatrix3s[i] * in.newMatrix3s[last - i]; }));
+
+	run(Benchmark<Vector3, NewVector3>("NewMatrix3 * NewVector3", iterations, 0.0f,
+		[&](size_t i) { return in.matrix3s[i] * in.vector3s[i]; },
+		[&](size_t i) { return in.newMatrix3s[i] * in.newVector3s[i]; }));
+
+	run(Benchmark<Vector4, NewVector4>("NewVector4 + NewVector4", iterations, 0.0f,
+		[&](size_t i) { return in.vector4s[i] + in.vector4s[last - i]; },
+		[&](size_t i) { return in.newVector4s[i] + in.newVector4s[last - i]; }));
+
+	run(Benchmark<Vector4, NewVector4>("NewVector4 * float", iterations, 0.0f,
+		[&](size_t i) { return in.vector4s[i] * in.floats[i]; },
+		[&](size_t i) { return in.newVector4s[i] * in.floats[i]; }));
+
+	run(Benchmark<Vector3, NewVector3>("NewVector3 + NewVector3", iterations, 0.0f,
+		[&](size_t i) { return in.vector3s[i] + in.vector3s[last - i]; },
+		[&](size_t i) { return in.newVector3s[i] + in.newVector3s[last - i]; }));
+
+	run(Benchmark<float>("Dot(NewVector3)", iterations, 0.0f,
+		[&](size_t i) { return Vector3::Dot(in.vector3s[i], in.vector3s[last - i]); },
+		[&](size_t i) { return Dot(in.newVector3s[i], in.newVector3s[last - i]); }));
+
+	run(Benchmark<Vector3, NewVector3>("Cross(NewVector3)", iterations, 0.0f,
+		[&](size_t i) { return Vector3::Cross(in.vector3s[i], in.vector3s[last - i]); },
+		[&](size_t i) { return Cross(in.newVector3s[i], in.newVector3s[last - i]); }));
+
+	run(Benchmark<Vector3, NewVector3>("Normalise(NewVector3)", iterations, 0.0f,
+		[&](size_t i) { return in.vector3s[i].Normalised(); },
+		[&](size_t i) { return Normalise(in.newVector3s[i]); }));
+
+	return failures == 0 ? 0 : 1;
+}
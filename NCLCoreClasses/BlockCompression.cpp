@@ -0,0 +1,313 @@
+/*
+Part of Newcastle University's Game Engineering source code.
+
+Use as you see fit!
+
+Comments and queries to: richard-gordon.davison AT ncl.ac.uk
+https://research.ncl.ac.uk/game/
+*/
+#include "BlockCompression.h"
+#include <climits>
+
+using namespace NCL;
+using namespace Rendering;
+
+namespace {
+	const int BLOCK_TEXELS = 16;
+
+	uint16_t To565(const float* c) {
+		int r = std::clamp((int)std::lround(c[0] * 31.0f / 255.0f), 0, 31);
+		int g = std::clamp((int)std::lround(c[1] * 63.0f / 255.0f), 0, 63);
+		int b = std::clamp((int)std::lround(c[2] * 31.0f / 255.0f), 0, 31);
+		return (uint16_t)((r << 11) | (g << 5) | b);
+	}
+
+	void From565(uint16_t c, int* rgb) {
+		int r = (c >> 11) & 31;
+		int g = (c >> 5) & 63;
+		int b = c & 31;
+		rgb[0] = (r << 3) | (r >> 2);
+		rgb[1] = (g << 2) | (g >> 4);
+		rgb[2] = (b << 3) | (b >> 2);
+	}
+
+	//BC3 blocks always use the 4 colour palette, whichever way round the endpoints are
+	void ColourPalette(uint16_t c0, uint16_t c1, bool allowThreeColour, int palette[4][4]) {
+		From565(c0, palette[0]);
+		From565(c1, palette[1]);
+		palette[0][3] = palette[1][3] = palette[2][3] = palette[3][3] = 255;
+
+		for (int i = 0; i < 3; ++i) {
+			if (c0 > c1 || !allowThreeColour) {
+				palette[2][i] = (2 * palette[0][i] + palette[1][i]) / 3;
+				palette[3][i] = (palette[0][i] + 2 * palette[1][i]) / 3;
+			}
+			else {
+				palette[2][i] = (palette[0][i] + palette[1][i]) / 2;
+				palette[3][i] = 0;
+			}
+		}
+	}
+
+	/*
+	The endpoints are where the block's colours start and end along the line
+	that best fits them, found by a few power iterations on their covariance.
+	The iterations start from the channel that varies most, as a fixed start
+	like (1,1,1) can be at right angles to the line - a red/green checker's
+	is (1,-1,0) - and would never turn towards it. Only a block with no
+	variance at all is treated as one colour.
+	Each texel then gets whichever of the 4 palette colours is nearest.
+	*/
+	void EncodeColours(const uint8_t* rgba, uint8_t* block) {
+		float mean[3] = { 0, 0, 0 };
+		for (int t = 0; t < BLOCK_TEXELS; ++t) {
+			for (int i = 0; i < 3; ++i) {
+				mean[i] += rgba[t * 4 + i];
+			}
+		}
+		for (int i = 0; i < 3; ++i) {
+			mean[i] /= BLOCK_TEXELS;
+		}
+
+		float covariance[3][3] = {};
+		for (int t = 0; t < BLOCK_TEXELS; ++t) {
+			float d[3] = { rgba[t * 4] - mean[0], rgba[t * 4 + 1] - mean[1], rgba[t * 4 + 2] - mean[2] };
+			for (int i = 0; i < 3; ++i) {
+				for (int j = 0; j < 3; ++j) {
+					covariance[i][j] += d[i] * d[j];
+				}
+			}
+		}
+
+		float axis[3] = { 0.0f, 0.0f, 0.0f };
+		int widest = 0;
+		for (int i = 1; i < 3; ++i) {
+			if (covariance[i][i] > covariance[widest][widest]) {
+				widest = i;
+			}
+		}
+		axis[widest] = 1.0f;
+
+		float trace = covariance[0][0] + covariance[1][1] + covariance[2][2];
+		if (trace > FLT_EPSILON) {	//otherwise every texel is the same colour, so any axis will do
+			for (int iteration = 0; iteration < 8; ++iteration) {
+				float next[3];
+				for (int i = 0; i < 3; ++i) {
+					next[i] = covariance[i][0] * axis[0] + covariance[i][1] * axis[1] + covariance[i][2] * axis[2];
+				}
+				float length = std::max({ std::abs(next[0]), std::abs(next[1]), std::abs(next[2]) });
+				for (int i = 0; i < 3; ++i) {
+					axis[i] = next[i] / length;
+				}
+			}
+		}
+
+		float minT = FLT_MAX;
+		float maxT = -FLT_MAX;
+		for (int t = 0; t < BLOCK_TEXELS; ++t) {
+			float projected = (rgba[t * 4] - mean[0]) * axis[0] + (rgba[t * 4 + 1] - mean[1]) * axis[1] + (rgba[t * 4 + 2] - mean[2]) * axis[2];
+			minT = std::min(minT, projected);
+			maxT = std::max(maxT, projected);
+		}
+		float axisLengthSq = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+		float maxColour[3];
+		float minColour[3];
+		for (int i = 0; i < 3; ++i) {
+			maxColour[i] = mean[i] + axis[i] * maxT / axisLengthSq;
+			minColour[i] = mean[i] + axis[i] * minT / axisLengthSq;
+		}
+
+		uint16_t c0 = To565(maxColour);
+		uint16_t c1 = To565(minColour);
+		if (c0 < c1) {
+			std::swap(c0, c1);
+		}
+		int palette[4][4];
+		ColourPalette(c0, c1, false, palette);
+
+		uint32_t indices = 0;
+		if (c0 != c1) {
+			for (int t = 0; t < BLOCK_TEXELS; ++t) {
+				int best		= 0;
+				int bestError	= INT_MAX;
+				for (int p = 0; p < 4; ++p) {
+					int dr = rgba[t * 4]		- palette[p][0];
+					int dg = rgba[t * 4 + 1]	- palette[p][1];
+					int db = rgba[t * 4 + 2]	- palette[p][2];
+					int error = dr * dr + dg * dg + db * db;
+					if (error < bestError) {
+						best		= p;
+						bestError	= error;
+					}
+				}
+				indices |= (uint32_t)best << (t * 2);
+			}
+		}
+		block[0] = (uint8_t)(c0 & 0xFF);
+		block[1] = (uint8_t)(c0 >> 8);
+		block[2] = (uint8_t)(c1 & 0xFF);
+		block[3] = (uint8_t)(c1 >> 8);
+		for (int i = 0; i < 4; ++i) {
+			block[4 + i] = (uint8_t)(indices >> (i * 8));
+		}
+	}
+
+	void DecodeColours(const uint8_t* block, bool allowThreeColour, uint8_t* rgba) {
+		uint16_t c0 = (uint16_t)(block[0] | (block[1] << 8));
+		uint16_t c1 = (uint16_t)(block[2] | (block[3] << 8));
+		int palette[4][4];
+		ColourPalette(c0, c1, allowThreeColour, palette);
+
+		uint32_t indices = block[4] | (block[5] << 8) | (block[6] << 16) | ((uint32_t)block[7] << 24);
+		for (int t = 0; t < BLOCK_TEXELS; ++t) {
+			int p = (indices >> (t * 2)) & 3;
+			for (int i = 0; i < 4; ++i) {
+				rgba[t * 4 + i] = (uint8_t)palette[p][i];
+			}
+		}
+	}
+
+	void AlphaPalette(int a0, int a1, int palette[8]) {
+		palette[0] = a0;
+		palette[1] = a1;
+		if (a0 > a1) {
+			for (int i = 1; i < 7; ++i) {
+				palette[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+			}
+		}
+		else {
+			for (int i = 1; i < 5; ++i) {
+				palette[i + 1] = ((5 - i) * a0 + i * a1) / 5;
+			}
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+	}
+
+	//The alpha endpoints are just the block's highest and lowest alpha, using the 8 value palette
+	void EncodeAlpha(const uint8_t* rgba, uint8_t* block) {
+		int a0 = 0;
+		int a1 = 255;
+		for (int t = 0; t < BLOCK_TEXELS; ++t) {
+			a0 = std::max(a0, (int)rgba[t * 4 + 3]);
+			a1 = std::min(a1, (int)rgba[t * 4 + 3]);
+		}
+		int palette[8];
+		AlphaPalette(a0, a1, palette);
+
+		uint64_t indices = 0;
+		if (a0 != a1) {
+			for (int t = 0; t < BLOCK_TEXELS; ++t) {
+				int best		= 0;
+				int bestError	= INT_MAX;
+				for (int p = 0; p < 8; ++p) {
+					int error = std::abs(rgba[t * 4 + 3] - palette[p]);
+					if (error < bestError) {
+						best		= p;
+						bestError	= error;
+					}
+				}
+				indices |= (uint64_t)best << (t * 3);
+			}
+		}
+		block[0] = (uint8_t)a0;
+		block[1] = (uint8_t)a1;
+		for (int i = 0; i < 6; ++i) {
+			block[2 + i] = (uint8_t)(indices >> (i * 8));
+		}
+	}
+
+	void DecodeAlpha(const uint8_t* block, uint8_t* rgba) {
+		int palette[8];
+		AlphaPalette(block[0], block[1], palette);
+
+		uint64_t indices = 0;
+		for (int i = 0; i < 6; ++i) {
+			indices |= (uint64_t)block[2 + i] << (i * 8);
+		}
+		for (int t = 0; t < BLOCK_TEXELS; ++t) {
+			rgba[t * 4 + 3] = (uint8_t)palette[(indices >> (t * 3)) & 7];
+		}
+	}
+
+	size_t BlockSize(TextureData::Format format) {
+		return format == TextureData::BC1 ? 8 : 16;
+	}
+}
+
+void BlockCompression::EncodeBC1Block(const uint8_t* rgba, uint8_t* block) {
+	EncodeColours(rgba, block);
+}
+
+void BlockCompression::EncodeBC3Block(const uint8_t* rgba, uint8_t* block) {
+	EncodeAlpha(rgba, block);
+	EncodeColours(rgba, block + 8);
+}
+
+void BlockCompression::DecodeBC1Block(const uint8_t* block, uint8_t* rgba) {
+	DecodeColours(block, true, rgba);
+}
+
+void BlockCompression::DecodeBC3Block(const uint8_t* block, uint8_t* rgba) {
+	DecodeColours(block + 8, false, rgba);
+	DecodeAlpha(block, rgba);
+}
+
+void BlockCompression::Compress(const char* rgba, uint32_t width, uint32_t height, TextureData::Format format, char* blocks) {
+	const uint8_t* source	= (const uint8_t*)rgba;
+	uint8_t* dest			= (uint8_t*)blocks;
+
+	uint8_t texels[BLOCK_TEXELS * 4];
+	for (uint32_t by = 0; by < height; by += 4) {
+		for (uint32_t bx = 0; bx < width; bx += 4) {
+			for (uint32_t y = 0; y < 4; ++y) {
+				for (uint32_t x = 0; x < 4; ++x) {
+					uint32_t sx = std::min(bx + x, width - 1);
+					uint32_t sy = std::min(by + y, height - 1);
+					memcpy(&texels[(y * 4 + x) * 4], &source[(sy * width + sx) * 4], 4);
+				}
+			}
+			if (format == TextureData::BC1) {
+				EncodeBC1Block(texels, dest);
+			}
+			else {
+				EncodeBC3Block(texels, dest);
+			}
+			dest += BlockSize(format);
+		}
+	}
+}
+
+void BlockCompression::Decompress(const char* blocks, uint32_t width, uint32_t height, TextureData::Format format, char* rgba) {
+	const uint8_t* source	= (const uint8_t*)blocks;
+	uint8_t* dest			= (uint8_t*)rgba;
+
+	uint8_t texels[BLOCK_TEXELS * 4];
+	for (uint32_t by = 0; by < height; by += 4) {
+		for (uint32_t bx = 0; bx < width; bx += 4) {
+			if (format == TextureData::BC1) {
+				DecodeBC1Block(source, texels);
+			}
+			else {
+				DecodeBC3Block(source, texels);
+			}
+			source += BlockSize(format);
+
+			for (uint32_t y = 0; y < 4 && by + y < height; ++y) {
+				for (uint32_t x = 0; x < 4 && bx + x < width; ++x) {
+					memcpy(&dest[((by + y) * width + bx + x) * 4], &texels[(y * 4 + x) * 4], 4);
+				}
+			}
+		}
+	}
+}
+
+TextureData::Format BlockCompression::ChooseFormat(const char* rgba, uint32_t width, uint32_t height) {
+	const uint8_t* texels = (const uint8_t*)rgba;
+	for (size_t i = 0; i < (size_t)width * height; ++i) {
+		if (texels[i * 4 + 3] != 255) {
+			return TextureData::BC3;
+		}
+	}
+	return TextureData::BC1;
+}
@@ -0,0 +1,36 @@
+/*
+Part of Newcastle University's Game Engineering source code.
+
+Use as you see fit!
+
+Comments and queries to: richard-gordon.davison AT ncl.ac.uk
+https://research.ncl.ac.uk/game/
+*/
+#pragma once
+#include "TextureData.h"
+
+namespace NCL::Rendering {
+	/*
+	CPU encoding and decoding of the BC1 and BC3 block compressed formats
+	(also known as DXT1 and DXT5). Images are RGBA8, 4 bytes a texel, in rows.
+	Encoding fits each block's colours to a line through them, so is meant
+	for cooking textures offline rather than anything done per frame.
+	Decoding is only needed to check what the encoder made, as the GPU
+	samples the blocks directly.
+	*/
+	namespace BlockCompression {
+		//A block is 4x4 texels, so 64 bytes of RGBA8 in and out
+		void EncodeBC1Block(const uint8_t* rgba, uint8_t* block);
+		void EncodeBC3Block(const uint8_t* rgba, uint8_t* block);
+
+		void DecodeBC1Block(const uint8_t* block, uint8_t* rgba);
+		void DecodeBC3Block(const uint8_t* block, uint8_t* rgba);
+
+		//Images that aren't a multiple of 4 across have their edge texels repeated to fill the last blocks
+		void Compress(const char* rgba, uint32_t width, uint32_t height, TextureData::Format format, char* blocks);
+		void Decompress(const char* blocks, uint32_t width, uint32_t height, TextureData::Format format, char* rgba);
+
+		//BC3 if anything in the image isn't fully opaque, otherwise BC1
+		TextureData::Format ChooseFormat(const char* rgba, uint32_t width, uint32_t height);
+	}
+}
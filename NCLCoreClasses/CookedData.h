@@ -0,0 +1,55 @@
+/*
+Part of Newcastle University's Game Engineering source code.
+
+Use as you see fit!
+
+Comments and queries to: richard-gordon.davison AT ncl.ac.uk
+https://research.ncl.ac.uk/game/
+*/
+#pragma once
+#include <cstdint>
+#include <string>
+#include <filesystem>
+
+namespace NCL {
+	/*
+	What every cooked binary asset format has in common. A cooked file sits
+	next to its text source with CookedExtension added, starts with a
+	FileHeader, and has each of its sections on a 16 byte boundary, so that
+	it can be memory mapped and its arrays used as they are.
+	*/
+	namespace CookedData {
+		const std::string CookedExtension(".bin");
+
+		struct FileHeader {
+			uint32_t magic;
+			uint32_t version;
+			uint32_t headerSize;
+			uint32_t fileSize;
+		};
+
+		inline uint64_t AlignOffset(uint64_t offset) {
+			return (offset + 15) & ~uint64_t(15);
+		}
+
+		//A cooked file is only used if it's at least as new as its text source
+		inline bool CookedFileIsCurrent(const std::string& sourceFile, const std::string& cookedFile) {
+			std::error_code error;
+			if (!std::filesystem::exists(cookedFile, error)) {
+				return false;
+			}
+			if (!std::filesystem::exists(sourceFile, error)) {
+				return true;
+			}
+			return std::filesystem::last_write_time(cookedFile, error) >= std::filesystem::last_write_time(sourceFile, error);
+		}
+
+		inline bool HeaderIsValid(const FileHeader* header, uint32_t magic, uint32_t version, size_t headerSize, size_t mappedSize) {
+			return	header &&
+					header->magic		== magic &&
+					header->version		== version &&
+					header->headerSize	== headerSize &&
+					header->fileSize	== mappedSize;
+		}
+	}
+}
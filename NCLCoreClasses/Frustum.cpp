@@ -25,13 +25,13 @@ Frustum Frustum::FromViewProjMatrix(const Matrix4& viewProj, float ndcNear, floa
 	//Takes NDC coordinates, transforms them into into clip space using the inverse matrix
 	Vector4 topLeftFar		= invMatrix * Vector4(-1.0f, 1.0f, ndcFar, 1.0f);
 	Vector4 topRightFar		= invMatrix * Vector4( 1.0f, 1.0f, ndcFar, 1.0f);
-	Vector4 bottomLeftFar	= invMatrix * Vector4(-1.0f, 1.0f, ndcFar, 1.0f);
-	Vector4 bottomRightFar	= invMatrix * Vector4( 1.0f, 1.0f, ndcFar, 1.0f);
+	Vector4 bottomLeftFar	= invMatrix * Vector4(-1.0f, -1.0f, ndcFar, 1.0f);
+	Vector4 bottomRightFar	= invMatrix * Vector4( 1.0f, -1.0f, ndcFar, 1.0f);
 
 	Vector4 topLeftNear		= invMatrix * Vector4(-1.0f, 1.0f, ndcNear, 1.0f);
 	Vector4 topRightNear	= invMatrix * Vector4( 1.0f, 1.0f, ndcNear, 1.0f);
-	Vector4 bottomLeftNear	= invMatrix * Vector4(-1.0f, 1.0f, ndcNear, 1.0f);
-	Vector4 bottomRightNear = invMatrix * Vector4( 1.0f, 1.0f, ndcNear, 1.0f);
+	Vector4 bottomLeftNear	= invMatrix * Vector4(-1.0f, -1.0f, ndcNear, 1.0f);
+	Vector4 bottomRightNear = invMatrix * Vector4( 1.0f, -1.0f, ndcNear, 1.0f);
 
 	//To bring them fully into 'world' coodinates, we must divide them by their w component
 
@@ -49,14 +49,14 @@ Frustum Frustum::FromViewProjMatrix(const Matrix4& viewProj, float ndcNear, floa
 	//Note that the order is important, to make sure that the positive half space of the plane
 	//is facing 'in' to the frustum - a point positive to all 6 planes is inside the frustum
 	
-	f.planes[0] = Plane::PlaneFromTri(topLeftFar, bottomLeftFar, bottomLeftNear);	//left plane
-	f.planes[1] = Plane::PlaneFromTri(topRightFar, topRightNear, bottomRightNear);	//right plane
+	f.planes[0] = Plane::PlaneFromTri(topLeftFar, bottomLeftNear, bottomLeftFar);	//left plane
+	f.planes[1] = Plane::PlaneFromTri(topRightFar, bottomRightNear, topRightNear);	//right plane
 
 	f.planes[2] = Plane::PlaneFromTri(topLeftFar, topRightFar, topRightNear);			//top plane
-	f.planes[3] = Plane::PlaneFromTri(bottomLeftFar, bottomRightFar, bottomRightNear);	//bottom plane
+	f.planes[3] = Plane::PlaneFromTri(bottomLeftFar, bottomRightNear, bottomRightFar);	//bottom plane
 
 	f.planes[4] = Plane::PlaneFromTri(topLeftNear, topRightNear, bottomRightNear);	//near plane
-	f.planes[5] = Plane::PlaneFromTri(topLeftFar, topRightFar, bottomRightFar);		//far plane
+	f.planes[5] = Plane::PlaneFromTri(topLeftFar, bottomRightFar, topRightFar);		//far plane
 
 	return f;
 }
\ No newline at end of file
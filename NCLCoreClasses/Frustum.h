@@ -27,6 +27,10 @@ namespace NCL::Maths {
 			}
 			return true;
 		}
+
+		const Plane& GetPlane(int p) const {
+			return planes[p];
+		}
 	protected:
 		Plane planes[6];
 	};
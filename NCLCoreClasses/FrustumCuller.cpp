@@ -0,0 +1,107 @@
+/*
+Part of Newcastle University's Game Engineering source code.
+
+Use as you see fit!
+
+Comments and queries to: richard-gordon.davison AT ncl.ac.uk
+https://research.ncl.ac.uk/game/
+*/
+#include "FrustumCuller.h"
+#include "Matrix4.h"
+
+using namespace NCL;
+using namespace NCL::Maths;
+
+void FrustumCuller::Clear() {
+	centreX.clear();
+	centreY.clear();
+	centreZ.clear();
+	halfX.clear();
+	halfY.clear();
+	halfZ.clear();
+}
+
+void FrustumCuller::Reserve(size_t count) {
+	centreX.reserve(count);
+	centreY.reserve(count);
+	centreZ.reserve(count);
+	halfX.reserve(count);
+	halfY.reserve(count);
+	halfZ.reserve(count);
+}
+
+size_t FrustumCuller::AddBox(const Vector3& centre, const Vector3& halfSize) {
+	centreX.push_back(centre.x);
+	centreY.push_back(centre.y);
+	centreZ.push_back(centre.z);
+	halfX.push_back(halfSize.x);
+	halfY.push_back(halfSize.y);
+	halfZ.push_back(halfSize.z);
+	return centreX.size() - 1;
+}
+
+/*
+The transformed box's half size along each world axis is the local half size
+projected through the absolute values of the upper 3x3 of the matrix, which
+also takes care of any scaling the matrix has in it.
+*/
+void FrustumCuller::TransformBox(const Matrix4& m, const Vector3& localMin, const Vector3& localMax, Vector3& outCentre, Vector3& outHalfSize) {
+	Vector3 localCentre = (localMin + localMax) * 0.5f;
+	Vector3 localHalf	= (localMax - localMin) * 0.5f;
+
+	for (int row = 0; row < 3; ++row) {
+		outCentre[row]		= m.array[0][row] * localCentre.x + m.array[1][row] * localCentre.y + m.array[2][row] * localCentre.z + m.array[3][row];
+		outHalfSize[row]	= std::abs(m.array[0][row]) * localHalf.x + std::abs(m.array[1][row]) * localHalf.y + std::abs(m.array[2][row]) * localHalf.z;
+	}
+}
+
+size_t FrustumCuller::AddBox(const Matrix4& m, const Vector3& localMin, const Vector3& localMax) {
+	Vector3 centre;
+	Vector3 half;
+	TransformBox(m, localMin, localMax, centre, half);
+	return AddBox(centre, half);
+}
+
+/*
+A box is outside if it lies entirely behind any one plane. Working one plane
+at a time over every box keeps the inner loop free of branches, so it turns
+into SIMD code. The mask is kept as ints rather than bytes, as byte writes
+could alias the float arrays and stop the compiler vectorising the loop.
+*/
+void FrustumCuller::Cull(const Frustum& frustum, std::vector<int>& outVisible) const {
+	const size_t count = centreX.size();
+	inside.assign(count, 1);
+
+	const float* cx = centreX.data();
+	const float* cy = centreY.data();
+	const float* cz = centreZ.data();
+	const float* hx = halfX.data();
+	const float* hy = halfY.data();
+	const float* hz = halfZ.data();
+	int* in			= inside.data();
+
+	for (int p = 0; p < 6; ++p) {
+		const Plane& plane	= frustum.GetPlane(p);
+		const float nx		= plane.GetNormal().x;
+		const float ny		= plane.GetNormal().y;
+		const float nz		= plane.GetNormal().z;
+		const float d		= plane.GetDistance();
+		const float ax		= std::abs(nx);
+		const float ay		= std::abs(ny);
+		const float az		= std::abs(nz);
+
+		for (size_t i = 0; i < count; ++i) {
+			float distance	= cx[i] * nx + cy[i] * ny + cz[i] * nz + d;
+			float radius	= hx[i] * ax + hy[i] * ay + hz[i] * az;
+			in[i] &= (int)(distance > -radius);
+		}
+	}
+
+	outVisible.resize(count);
+	size_t visibleCount = 0;
+	for (size_t i = 0; i < count; ++i) {
+		outVisible[visibleCount] = (int)i;
+		visibleCount += in[i];
+	}
+	outVisible.resize(visibleCount);
+}
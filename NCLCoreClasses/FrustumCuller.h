@@ -0,0 +1,54 @@
+/*
+Part of Newcastle University's Game Engineering source code.
+
+Use as you see fit!
+
+Comments and queries to: richard-gordon.davison AT ncl.ac.uk
+https://research.ncl.ac.uk/game/
+*/
+#pragma once
+#include "Frustum.h"
+
+namespace NCL::Maths {
+	class Matrix4;
+
+	/*
+	Holds a set of world space bounding boxes, packed one array per component
+	so that testing them all against a frustum is a straight run over memory
+	that the compiler can vectorise. Each box keeps the index it was added with,
+	so the results can be mapped back onto whatever the boxes came from.
+	*/
+	class FrustumCuller {
+	public:
+		FrustumCuller() {}
+		~FrustumCuller() {}
+
+		void Clear();
+		void Reserve(size_t count);
+
+		size_t GetCount() const {
+			return centreX.size();
+		}
+
+		//Returns the index of the new box
+		size_t AddBox(const Vector3& centre, const Vector3& halfSize);
+		//Adds the box bounding a local space box once it has been transformed by the given model matrix
+		size_t AddBox(const Matrix4& modelMatrix, const Vector3& localMin, const Vector3& localMax);
+
+		//Works out the world space box bounding a local space box once transformed by the given model matrix
+		static void TransformBox(const Matrix4& modelMatrix, const Vector3& localMin, const Vector3& localMax, Vector3& outCentre, Vector3& outHalfSize);
+
+		//Fills outVisible with the indices of every box at least partly inside the frustum, in ascending order
+		void Cull(const Frustum& frustum, std::vector<int>& outVisible) const;
+
+	protected:
+		std::vector<float> centreX;
+		std::vector<float> centreY;
+		std::vector<float> centreZ;
+		std::vector<float> halfX;
+		std::vector<float> halfY;
+		std::vector<float> halfZ;
+
+		mutable std::vector<int> inside;
+	};
+}
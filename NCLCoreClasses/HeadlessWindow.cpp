@@ -0,0 +1,24 @@
+#include "HeadlessWindow.h"
+
+using namespace NCL;
+using namespace Headless;
+
+HeadlessWindow::HeadlessWindow(const std::string& title, int sizeX, int sizeY)	{
+	windowTitle	= title;
+	size		= Vector2i(sizeX, sizeY);
+	defaultSize	= size;
+	position	= Vector2i(0, 0);
+	minimised	= false;
+
+	keyboard	= new DummyKeyboard();
+	mouse		= new DummyMouse();
+
+	init		= true;
+}
+
+HeadlessWindow::~HeadlessWindow()	{
+}
+
+bool	HeadlessWindow::InternalUpdate() {
+	return true;
+}
@@ -0,0 +1,29 @@
+/*
+Part of Newcastle University's Game Engineering source code.
+
+Use as you see fit!
+
+Comments and queries to: richard-gordon.davison AT ncl.ac.uk
+https://research.ncl.ac.uk/game/
+*/
+#pragma once
+#include "Window.h"
+
+namespace NCL::Headless {
+	/*
+	A window that never appears anywhere, for running the game on machines
+	with no display, such as build and test servers. The keyboard and mouse
+	are dummies that never report anything, so the game sees no input, and
+	the window stays open until whatever is driving it decides to stop.
+	*/
+	class HeadlessWindow : public Window {
+	public:
+		friend class Window;
+
+	protected:
+		HeadlessWindow(const std::string& title, int sizeX, int sizeY);
+		virtual ~HeadlessWindow();
+
+		bool	InternalUpdate()	override;
+	};
+}
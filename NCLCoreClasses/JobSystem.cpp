@@ -0,0 +1,112 @@
+/*
+Part of Newcastle University's Game Engineering source code.
+
+Use as you see fit!
+
+Comments and queries to: richard-gordon.davison AT ncl.ac.uk
+https://research.ncl.ac.uk/game/
+*/
+#include "JobSystem.h"
+
+using namespace NCL;
+
+thread_local bool insideJob = false;
+
+JobSystem::JobSystem(unsigned int threadCount) {
+	if (threadCount == 0) {
+		threadCount = std::max(1u, std::thread::hardware_concurrency()) - 1;
+	}
+	jobFunc			= nullptr;
+	jobCount		= 0;
+	jobGrain		= 1;
+	nextChunk		= 0;
+	chunksLeft		= 0;
+	activeWorkers	= 0;
+	jobGeneration	= 0;
+	shuttingDown	= false;
+
+	for (unsigned int i = 0; i < threadCount; ++i) {
+		workers.emplace_back(&JobSystem::WorkerLoop, this);
+	}
+}
+
+JobSystem::~JobSystem() {
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+		shuttingDown = true;
+	}
+	jobStart.notify_all();
+	for (std::thread& t : workers) {
+		t.join();
+	}
+}
+
+//Claims and runs the next chunk of the current job, returning false once there are none left to claim
+bool JobSystem::RunChunk() {
+	size_t chunk = nextChunk++;
+	size_t begin = chunk * jobGrain;
+	if (begin >= jobCount) {
+		return false;
+	}
+	size_t end = std::min(begin + jobGrain, jobCount);
+
+	insideJob = true;
+	(*jobFunc)(begin, end);
+	insideJob = false;
+
+	std::lock_guard<std::mutex> lock(jobMutex);
+	if (--chunksLeft == 0) {
+		jobDone.notify_all();
+	}
+	return true;
+}
+
+void JobSystem::WorkerLoop() {
+	unsigned int seenGeneration = 0;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(jobMutex);
+			jobStart.wait(lock, [&] { return shuttingDown || jobGeneration != seenGeneration; });
+			if (shuttingDown) {
+				return;
+			}
+			seenGeneration = jobGeneration;
+			activeWorkers++;
+		}
+		while (RunChunk()) {
+		}
+		std::lock_guard<std::mutex> lock(jobMutex);
+		activeWorkers--;
+		jobDone.notify_all();
+	}
+}
+
+void JobSystem::ParallelFor(size_t count, size_t grainSize, const RangeFunc& func) {
+	if (count == 0) {
+		return;
+	}
+	grainSize = std::max<size_t>(grainSize, 1);
+	if (workers.empty() || insideJob || count <= grainSize) {
+		func(0, count);
+		return;
+	}
+	{
+		//Workers still leaving the last job may be reading its values, so wait for them first
+		std::unique_lock<std::mutex> lock(jobMutex);
+		jobDone.wait(lock, [&] { return activeWorkers == 0; });
+		jobFunc		= &func;
+		jobCount	= count;
+		jobGrain	= grainSize;
+		nextChunk	= 0;
+		chunksLeft	= (count + grainSize - 1) / grainSize;
+		jobGeneration++;
+	}
+	jobStart.notify_all();
+
+	while (RunChunk()) {
+	}
+
+	std::unique_lock<std::mutex> lock(jobMutex);
+	jobDone.wait(lock, [&] { return chunksLeft == 0; });
+	jobFunc = nullptr;
+}
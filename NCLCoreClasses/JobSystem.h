@@ -0,0 +1,59 @@
+/*
+Part of Newcastle University's Game Engineering source code.
+
+Use as you see fit!
+
+Comments and queries to: richard-gordon.davison AT ncl.ac.uk
+https://research.ncl.ac.uk/game/
+*/
+#pragma once
+#include <mutex>
+#include <condition_variable>
+
+namespace NCL {
+	/*
+	A fixed set of worker threads that split up loops between them. ParallelFor
+	cuts a range into chunks, and the calling thread works through chunks too,
+	only returning once every chunk has been run - so the function can safely
+	capture locals by reference.
+
+	Only one ParallelFor runs at a time; a call from inside a job just runs its
+	range inline rather than waiting on workers that are already busy.
+	*/
+	class JobSystem {
+	public:
+		typedef std::function<void(size_t begin, size_t end)> RangeFunc;
+
+		//threadCount of 0 picks one less than the hardware has, leaving a core for the caller
+		JobSystem(unsigned int threadCount = 0);
+		~JobSystem();
+
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+
+		void ParallelFor(size_t count, size_t grainSize, const RangeFunc& func);
+
+		unsigned int GetWorkerCount() const {
+			return (unsigned int)workers.size();
+		}
+
+	protected:
+		void WorkerLoop();
+		bool RunChunk();
+
+		std::vector<std::thread> workers;
+
+		std::mutex				jobMutex;
+		std::condition_variable	jobStart;
+		std::condition_variable	jobDone;
+
+		const RangeFunc*	jobFunc;
+		size_t				jobCount;
+		size_t				jobGrain;
+		std::atomic<size_t>	nextChunk;
+		size_t				chunksLeft;		//guarded by jobMutex
+		unsigned int		activeWorkers;	//workers that might still read the job, guarded by jobMutex
+		unsigned int		jobGeneration;
+		bool				shuttingDown;
+	};
+}
@@ -0,0 +1,65 @@
+/*
+Part of Newcastle University's Game Engineering source code.
+
+Use as you see fit!
+
+Comments and queries to: richard-gordon.davison AT ncl.ac.uk
+https://research.ncl.ac.uk/game/
+*/
+#pragma once
+#include <string>
+#include <cstdint>
+
+namespace NCL {
+	/*
+	A read-only view of a whole file, mapped into the address space by the OS.
+	Cooked binary assets are laid out so that they can be used straight out of
+	this memory, without being parsed or copied first.
+	*/
+	class MappedFile {
+	public:
+		MappedFile();
+		MappedFile(const std::string& filename);
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		bool Open(const std::string& filename);
+		void Close();
+
+		bool IsOpen() const {
+			return data != nullptr;
+		}
+
+		const char* GetData() const {
+			return data;
+		}
+
+		size_t GetSize() const {
+			return size;
+		}
+
+		//nullptr unless all count Ts fit in the file, and start suitably aligned for a T
+		template<typename T>
+		const T* GetAt(size_t offset, size_t count = 1) const {
+			if (!data || offset > size || count > (size - offset) / sizeof(T)) {
+				return nullptr;
+			}
+			if ((uintptr_t)(data + offset) % alignof(T) != 0) {
+				return nullptr;
+			}
+			return (const T*)(data + offset);
+		}
+
+	protected:
+		const char* data;
+		size_t		size;
+#ifdef _WIN32
+		void*		fileHandle;
+		void*		mappingHandle;
+#else
+		int			fileHandle;
+#endif
+	};
+}
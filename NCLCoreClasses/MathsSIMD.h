@@ -0,0 +1,142 @@
+/*
+Part of Newcastle University's Game Engineering source code.
+
+Use as you see fit!
+
+Comments and queries to: richard-gordon.davison AT ncl.ac.uk
+https://research.ncl.ac.uk/game/
+*/
+#pragma once
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NCL_MATHS_SSE
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define NCL_MATHS_NEON
+#include <arm_neon.h>
+#endif
+
+namespace NCL::Maths::SIMD {
+	/*
+	Just enough of a 4 float register to write the matrix, quaternion and
+	vector maths with, using SSE on x86, NEON on ARM, or plain floats if
+	there's neither. Loads and stores are all unaligned, so the maths
+	classes keep their existing layout.
+
+	Everything here works lane by lane, in the same order the scalar code
+	adds things up in, so the results match the scalar maths exactly.
+	*/
+#if defined(NCL_MATHS_SSE)
+	typedef __m128 Float4;
+
+	inline Float4 Load(const float* f)			{ return _mm_loadu_ps(f); }
+	inline void	Store(float* f, Float4 v)		{ _mm_storeu_ps(f, v); }
+	inline Float4 Splat(float f)				{ return _mm_set1_ps(f); }
+	inline Float4 Set(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+
+	inline Float4 Add(Float4 a, Float4 b)		{ return _mm_add_ps(a, b); }
+	inline Float4 Sub(Float4 a, Float4 b)		{ return _mm_sub_ps(a, b); }
+	inline Float4 Mul(Float4 a, Float4 b)		{ return _mm_mul_ps(a, b); }
+	inline Float4 Div(Float4 a, Float4 b)		{ return _mm_div_ps(a, b); }
+	inline Float4 Negate(Float4 v)				{ return _mm_xor_ps(v, _mm_set1_ps(-0.0f)); }
+
+	//Flips the sign of every lane that's negative in signs, which should only hold 1s and -1s
+	inline Float4 FlipSigns(Float4 v, Float4 signs) { return _mm_xor_ps(v, _mm_and_ps(signs, _mm_set1_ps(-0.0f))); }
+
+	//Lane i of the result is lane (x, y, z, w)[i] of v
+	template<int x, int y, int z, int w>
+	inline Float4 Shuffle(Float4 v)				{ return _mm_shuffle_ps(v, v, _MM_SHUFFLE(w, z, y, x)); }
+
+	template<int lane>
+	inline float GetLane(Float4 v)				{ return _mm_cvtss_f32(Shuffle<lane, lane, lane, lane>(v)); }
+
+	//Reads and writes 3 floats, for the 12 byte columns of a Matrix3 and for Vector3s.
+	//x and y go through a local double with memcpy, as the floats are only 4 byte
+	//aligned, and reading them through a double* would break aliasing rules.
+	//Compilers still turn this into a single 8 byte move.
+	inline Float4 Load3(const float* f) {
+		double xy;
+		memcpy(&xy, f, sizeof(xy));
+		return _mm_movelh_ps(_mm_castpd_ps(_mm_load_sd(&xy)), _mm_load_ss(f + 2));
+	}
+	inline void	Store3(float* f, Float4 v) {
+		double xy;
+		_mm_store_sd(&xy, _mm_castps_pd(v));
+		memcpy(f, &xy, sizeof(xy));
+		_mm_store_ss(f + 2, _mm_movehl_ps(v, v));
+	}
+#elif defined(NCL_MATHS_NEON)
+	typedef float32x4_t Float4;
+
+	inline Float4 Load(const float* f)			{ return vld1q_f32(f); }
+	inline void	Store(float* f, Float4 v)		{ vst1q_f32(f, v); }
+	inline Float4 Splat(float f)				{ return vdupq_n_f32(f); }
+	inline Float4 Set(float x, float y, float z, float w) {
+		float f[4] = { x, y, z, w };
+		return vld1q_f32(f);
+	}
+
+	inline Float4 Add(Float4 a, Float4 b)		{ return vaddq_f32(a, b); }
+	inline Float4 Sub(Float4 a, Float4 b)		{ return vsubq_f32(a, b); }
+	inline Float4 Mul(Float4 a, Float4 b)		{ return vmulq_f32(a, b); }
+	inline Float4 Div(Float4 a, Float4 b)		{ return vdivq_f32(a, b); }
+	inline Float4 Negate(Float4 v)				{ return vnegq_f32(v); }
+
+	inline Float4 FlipSigns(Float4 v, Float4 signs) {
+		uint32x4_t mask = vandq_u32(vreinterpretq_u32_f32(signs), vdupq_n_u32(0x80000000));
+		return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(v), mask));
+	}
+
+	template<int x, int y, int z, int w>
+	inline Float4 Shuffle(Float4 v) {
+		float f[4] = { vgetq_lane_f32(v, x), vgetq_lane_f32(v, y), vgetq_lane_f32(v, z), vgetq_lane_f32(v, w) };
+		return vld1q_f32(f);
+	}
+
+	template<int lane>
+	inline float GetLane(Float4 v)				{ return vgetq_lane_f32(v, lane); }
+
+	inline Float4 Load3(const float* f) {
+		return vcombine_f32(vld1_f32(f), vld1_lane_f32(f + 2, vdup_n_f32(0.0f), 0));
+	}
+	inline void	Store3(float* f, Float4 v) {
+		vst1_f32(f, vget_low_f32(v));
+		vst1q_lane_f32(f + 2, v, 2);
+	}
+#else
+	struct Float4 {
+		float v[4];
+	};
+
+	inline Float4 Load(const float* f)			{ return { f[0], f[1], f[2], f[3] }; }
+	inline void	Store(float* f, Float4 v)		{ f[0] = v.v[0]; f[1] = v.v[1]; f[2] = v.v[2]; f[3] = v.v[3]; }
+	inline Float4 Splat(float f)				{ return { f, f, f, f }; }
+	inline Float4 Set(float x, float y, float z, float w) { return { x, y, z, w }; }
+
+	inline Float4 Add(Float4 a, Float4 b)		{ return { a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] }; }
+	inline Float4 Sub(Float4 a, Float4 b)		{ return { a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3] }; }
+	inline Float4 Mul(Float4 a, Float4 b)		{ return { a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] }; }
+	inline Float4 Div(Float4 a, Float4 b)		{ return { a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3] }; }
+	inline Float4 Negate(Float4 a)				{ return { -a.v[0], -a.v[1], -a.v[2], -a.v[3] }; }
+
+	inline Float4 FlipSigns(Float4 a, Float4 signs) {
+		return {	signs.v[0] < 0.0f ? -a.v[0] : a.v[0], signs.v[1] < 0.0f ? -a.v[1] : a.v[1],
+					signs.v[2] < 0.0f ? -a.v[2] : a.v[2], signs.v[3] < 0.0f ? -a.v[3] : a.v[3] };
+	}
+
+	template<int x, int y, int z, int w>
+	inline Float4 Shuffle(Float4 a)				{ return { a.v[x], a.v[y], a.v[z], a.v[w] }; }
+
+	template<int lane>
+	inline float GetLane(Float4 a)				{ return a.v[lane]; }
+
+	inline Float4 Load3(const float* f)			{ return { f[0], f[1], f[2], 0.0f }; }
+	inline void	Store3(float* f, Float4 v)		{ f[0] = v.v[0]; f[1] = v.v[1]; f[2] = v.v[2]; }
+#endif
+
+	//a * b + c, as a multiply then an add rather than a fused multiply add, to round the same as the scalar code
+	inline Float4 MulAdd(Float4 a, Float4 b, Float4 c) {
+		return Add(c, Mul(a, b));
+	}
+}
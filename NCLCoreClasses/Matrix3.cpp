@@ -16,17 +16,7 @@ https://research.ncl.ac.uk/game/
 
 using namespace NCL;
 using namespace NCL::Maths;
-
-Matrix3::Matrix3(void)	{
-	for (int i = 0; i < 3; ++i) {
-		for (int j = 0; j < 3; ++j) {
-			array[i][j] = 0.0f;
-		}
-	}
-	array[0][0] = 1.0f;
-	array[1][1] = 1.0f;
-	array[2][2] = 1.0f;
-}
+using namespace NCL::Maths::SIMD;
 
 Matrix3::Matrix3(float elements[9]) {
 	array[0][0]  = elements[0];
@@ -261,13 +251,3 @@ void	Matrix3::SetDiagonal(const Vector3 &in) {
 	array[1][1] = in.y;
 	array[2][2] = in.z;
 }
-
-Vector3 Matrix3::operator*(const Vector3 &v) const {
-	Vector3 vec;
-
-	vec.x = v.x*array[0][0] + v.y*array[1][0] + v.z*array[2][0];
-	vec.y = v.x*array[0][1] + v.y*array[1][1] + v.z*array[2][1];
-	vec.z = v.x*array[0][2] + v.y*array[1][2] + v.z*array[2][2];
-
-	return vec;
-};
\ No newline at end of file
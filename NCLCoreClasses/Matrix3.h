@@ -7,18 +7,19 @@ Comments and queries to: richard-gordon.davison AT ncl.ac.uk
 https://research.ncl.ac.uk/game/
 */
 #pragma once
+#include "MathsSIMD.h"
+#include "Vector3.h"
 
 namespace NCL::Maths {
 	class Matrix2;
 	class Matrix4;
-	class Vector3;
 	class Quaternion;
 
 	class Matrix3	{
 	public:
 		float array[3][3];
 	public:
-		Matrix3(void);
+		Matrix3(void) : array{ {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f} } {}
 		Matrix3(float elements[9]);
 		Matrix3(const Matrix2 &m4);
 		Matrix3(const Matrix4 &m4);
@@ -74,8 +75,20 @@ namespace NCL::Maths {
 			array[0][1] = tempValues[2];
 		}
 
-		Vector3 operator*(const Vector3 &v) const;
+		inline Vector3 operator*(const Vector3 &v) const {
+			using namespace SIMD;
+			Float4 in		= Load3(&v.x);
+			Float4 result	= Mul(Load(array[0]), Shuffle<0, 0, 0, 0>(in));
+			result = MulAdd(Load(array[1]), Shuffle<1, 1, 1, 1>(in), result);
+			result = MulAdd(Load3(array[2]), Shuffle<2, 2, 2, 2>(in), result);
 
+			Vector3 vec;
+			Store3(&vec.x, result);
+			return vec;
+		}
+
+		//Left as plain loops, which compilers vectorise well. Writing 12 byte
+		//columns from SIMD registers stalls on reading the matrix straight back
 		inline Matrix3 operator*(const Matrix3 &a) const {
 			Matrix3 out;
 			for (unsigned int c = 0; c < 3; ++c) {
@@ -15,13 +15,7 @@ https://research.ncl.ac.uk/game/
 
 using namespace NCL;
 using namespace NCL::Maths;
-Matrix4::Matrix4(void)	{
-	ToZero();
-	array[0][0] = 1.0f;
-	array[1][1] = 1.0f;
-	array[2][2] = 1.0f;
-	array[3][3] = 1.0f;
-}
+using namespace NCL::Maths::SIMD;
 
 Matrix4::Matrix4( float elements[16] )	{
 	memcpy(this->array,elements,16*sizeof(float));
@@ -198,6 +192,42 @@ Matrix4 Matrix4::Translation( const Vector3 &translation )	{
 	return m;
 }
 
+//Each rotation column comes out of the quaternion already multiplied by its scale,
+//all written once, as reading back the scalar stores to scale them 4 at a time stalls
+Matrix4 Matrix4::TRS(const Vector3& translation, const Quaternion& rotation, const Vector3& scale) {
+	float yy = rotation.y * rotation.y;
+	float zz = rotation.z * rotation.z;
+	float xy = rotation.x * rotation.y;
+	float zw = rotation.z * rotation.w;
+	float xz = rotation.x * rotation.z;
+	float yw = rotation.y * rotation.w;
+	float xx = rotation.x * rotation.x;
+	float yz = rotation.y * rotation.z;
+	float xw = rotation.x * rotation.w;
+
+	Matrix4 m;
+	m.array[0][0] = (1 - 2 * yy - 2 * zz) * scale.x;
+	m.array[0][1] = (2 * xy + 2 * zw) * scale.x;
+	m.array[0][2] = (2 * xz - 2 * yw) * scale.x;
+	m.array[0][3] = 0.0f;
+
+	m.array[1][0] = (2 * xy - 2 * zw) * scale.y;
+	m.array[1][1] = (1 - 2 * xx - 2 * zz) * scale.y;
+	m.array[1][2] = (2 * yz + 2 * xw) * scale.y;
+	m.array[1][3] = 0.0f;
+
+	m.array[2][0] = (2 * xz + 2 * yw) * scale.z;
+	m.array[2][1] = (2 * yz - 2 * xw) * scale.z;
+	m.array[2][2] = (1 - 2 * xx - 2 * yy) * scale.z;
+	m.array[2][3] = 0.0f;
+
+	m.array[3][0] = translation.x;
+	m.array[3][1] = translation.y;
+	m.array[3][2] = translation.z;
+	m.array[3][3] = 1.0f;
+	return m;
+}
+
 //Yoinked from the Open Source Doom 3 release - all credit goes to id software!
 void    Matrix4::Invert() {
 	float det, invDet;
@@ -315,29 +345,3 @@ Vector4 Matrix4::GetColumn(unsigned int column) const {
 	return out;
 }
 
-Vector3 Matrix4::operator*(const Vector3 &v) const {
-	Vector3 vec;
-
-	float temp;
-
-	vec.x = v.x*array[0][0] + v.y*array[1][0] + v.z*array[2][0] + array[3][0] ;
-	vec.y = v.x*array[0][1] + v.y*array[1][1] + v.z*array[2][1]  + array[3][1] ;
-	vec.z = v.x*array[0][2] + v.y*array[1][2] + v.z*array[2][2]  + array[3][2] ;
-
-	temp = v.x*array[0][3] + v.y*array[1][3] + v.z*array[2][3]  + array[3][3] ;
-
-	vec.x = vec.x / temp;
-	vec.y = vec.y / temp;
-	vec.z = vec.z / temp;
-
-	return vec;
-}
-
-Vector4 Matrix4::operator*(const Vector4 &v) const {
-	return Vector4(
-		v.x*array[0][0] + v.y*array[1][0] + v.z*array[2][0] + v.w * array[3][0] ,
-		v.x*array[0][1] + v.y*array[1][1] + v.z*array[2][1]  + v.w * array[3][1] ,
-		v.x*array[0][2] + v.y*array[1][2] + v.z*array[2][2]  + v.w * array[3][2] ,
-		v.x*array[0][3] + v.y*array[1][3] + v.z*array[2][3]  + v.w * array[3][3] 
-	);
-}
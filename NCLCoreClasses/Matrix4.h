@@ -8,10 +8,11 @@ https://research.ncl.ac.uk/game/
 */
 #pragma once
 #include "Maths.h"
+#include "MathsSIMD.h"
+#include "Vector3.h"
+#include "Vector4.h"
 
 namespace NCL::Maths {
-	class Vector3;
-	class Vector4;
 	class Matrix3;
 	class Quaternion;
 
@@ -19,7 +20,8 @@ namespace NCL::Maths {
 	public:
 		float	array[4][4];
 	public:
-		Matrix4(void);
+		//Inline, so that anything overwriting every element can drop the identity stores
+		Matrix4(void) : array{ {1.0f, 0.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 0.0f, 1.0f} } {}
 		Matrix4(float elements[16]);
 		Matrix4(const Matrix3& m3);
 		Matrix4(const Quaternion& quat);
@@ -50,6 +52,10 @@ namespace NCL::Maths {
 		//floats 12, 13, and 14. Analogous to glTranslatef
 		static Matrix4 Translation(const Vector3& translation);
 
+		//Builds Translation(translation) * Matrix4(rotation) * Scale(scale) directly,
+		//scaling the rotation's columns rather than doing two full multiplies
+		static Matrix4 TRS(const Vector3& translation, const Quaternion& rotation, const Vector3& scale);
+
 		//Creates a perspective matrix, with 'znear' and 'zfar' as the near and 
 		//far planes, using 'aspect' and 'fov' as the aspect ratio and vertical
 		//field of vision, respectively.
@@ -76,20 +82,48 @@ namespace NCL::Maths {
 
 		//Multiplies 'this' matrix by matrix 'a'. Performs the multiplication in 'OpenGL' order (ie, backwards)
 		inline Matrix4 operator*(const Matrix4& a) const {
+			using namespace SIMD;
+			Float4 c0 = Load(array[0]);
+			Float4 c1 = Load(array[1]);
+			Float4 c2 = Load(array[2]);
+			Float4 c3 = Load(array[3]);
+
 			Matrix4 out;
 			for (unsigned int c = 0; c < 4; ++c) {
-				for (unsigned int r = 0; r < 4; ++r) {
-					out.array[c][r] = 0.0f;
-					for (unsigned int i = 0; i < 4; ++i) {
-						out.array[c][r] += this->array[i][r] * a.array[c][i];
-					}
-				}
+				Float4 b	= Load(a.array[c]);
+				Float4 col	= Mul(c0, Shuffle<0, 0, 0, 0>(b));
+				col = MulAdd(c1, Shuffle<1, 1, 1, 1>(b), col);
+				col = MulAdd(c2, Shuffle<2, 2, 2, 2>(b), col);
+				col = MulAdd(c3, Shuffle<3, 3, 3, 3>(b), col);
+				Store(out.array[c], col);
 			}
 			return out;
 		}
 
-		Vector3 operator*(const Vector3& v) const;
-		Vector4 operator*(const Vector4& v) const;
+		inline Vector3 operator*(const Vector3& v) const {
+			using namespace SIMD;
+			Float4 in		= Load3(&v.x);
+			Float4 result	= Mul(Load(array[0]), Shuffle<0, 0, 0, 0>(in));
+			result = MulAdd(Load(array[1]), Shuffle<1, 1, 1, 1>(in), result);
+			result = MulAdd(Load(array[2]), Shuffle<2, 2, 2, 2>(in), result);
+			result = Add(result, Load(array[3]));
+
+			result = Div(result, Shuffle<3, 3, 3, 3>(result));
+
+			Vector3 vec;
+			Store3(&vec.x, result);
+			return vec;
+		}
+
+		inline Vector4 operator*(const Vector4& v) const {
+			using namespace SIMD;
+			Float4 in		= v.ToSIMD();
+			Float4 result	= Mul(Load(array[0]), Shuffle<0, 0, 0, 0>(in));
+			result = MulAdd(Load(array[1]), Shuffle<1, 1, 1, 1>(in), result);
+			result = MulAdd(Load(array[2]), Shuffle<2, 2, 2, 2>(in), result);
+			result = MulAdd(Load(array[3]), Shuffle<3, 3, 3, 3>(in), result);
+			return Vector4::FromSIMD(result);
+		}
 
 		//Handy string output for the matrix. Can get a bit messy, but better than nothing!
 		inline friend std::ostream& operator<<(std::ostream& o, const Matrix4& m) {
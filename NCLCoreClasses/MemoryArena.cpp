@@ -0,0 +1,65 @@
+/*
+Part of Newcastle University's Game Engineering source code.
+
+Use as you see fit!
+
+Comments and queries to: richard-gordon.davison AT ncl.ac.uk
+https://research.ncl.ac.uk/game/
+*/
+#include "MemoryArena.h"
+
+using namespace NCL;
+
+thread_local MemoryArena* currentArena = nullptr;
+
+MemoryArena::MemoryArena(size_t inBlockSize) {
+	blockSize		= inBlockSize;
+	currentBlock	= 0;
+	offset			= 0;
+	bytesUsed		= 0;
+	peakBytesUsed	= 0;
+}
+
+MemoryArena::~MemoryArena() {
+	for (Block& b : blocks) {
+		::operator delete(b.memory, std::align_val_t(BlockAlignment));
+	}
+}
+
+void* MemoryArena::Allocate(size_t size, size_t alignment) {
+	while (currentBlock < blocks.size()) {
+		Block& b = blocks[currentBlock];
+		size_t start = (offset + alignment - 1) & ~(alignment - 1);
+		if (start + size <= b.size) {
+			offset		= start + size;
+			bytesUsed	+= size;
+			peakBytesUsed = std::max(peakBytesUsed, bytesUsed);
+			return b.memory + start;
+		}
+		//Blocks kept from before a Reset get used again before any new ones are made
+		currentBlock++;
+		offset = 0;
+	}
+	size_t newSize = std::max(blockSize, size + alignment);
+	blocks.push_back({ (char*)::operator new(newSize, std::align_val_t(BlockAlignment)), newSize });
+	return Allocate(size, alignment);
+}
+
+void MemoryArena::Reset() {
+	currentBlock	= 0;
+	offset			= 0;
+	bytesUsed		= 0;
+}
+
+MemoryArena* MemoryArena::GetCurrent() {
+	return currentArena;
+}
+
+MemoryArena::Scope::Scope(MemoryArena& arena) {
+	previous		= currentArena;
+	currentArena	= &arena;
+}
+
+MemoryArena::Scope::~Scope() {
+	currentArena = previous;
+}
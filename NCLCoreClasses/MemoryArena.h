@@ -0,0 +1,74 @@
+/*
+Part of Newcastle University's Game Engineering source code.
+
+Use as you see fit!
+
+Comments and queries to: richard-gordon.davison AT ncl.ac.uk
+https://research.ncl.ac.uk/game/
+*/
+#pragma once
+
+namespace NCL {
+	/*
+	Hands out memory by moving a pointer along a list of large blocks, for
+	things that all go away together, like everything built for a level.
+	Nothing is freed on its own - Reset makes all of it available again in
+	one go, keeping the blocks around for the next level. No destructors are
+	run, so nothing that needs one should be put in an arena.
+
+	While a Scope is alive, classes using a MemoryPool that allows it take
+	their memory from its arena instead of the pool's slots.
+	*/
+	class MemoryArena {
+	public:
+		MemoryArena(size_t blockSize = 256 * 1024);
+		~MemoryArena();
+
+		MemoryArena(const MemoryArena&) = delete;
+		MemoryArena& operator=(const MemoryArena&) = delete;
+
+		//Alignments can be up to BlockAlignment
+		void* Allocate(size_t size, size_t alignment);
+		void Reset();
+
+		size_t GetBytesUsed() const {
+			return bytesUsed;
+		}
+
+		size_t GetPeakBytesUsed() const {
+			return peakBytesUsed;
+		}
+
+		size_t GetBlockCount() const {
+			return blocks.size();
+		}
+
+		static MemoryArena* GetCurrent();
+
+		class Scope {
+		public:
+			Scope(MemoryArena& arena);
+			~Scope();
+
+			Scope(const Scope&) = delete;
+			Scope& operator=(const Scope&) = delete;
+		protected:
+			MemoryArena* previous;
+		};
+
+		static const size_t BlockAlignment = 16;
+
+	protected:
+		struct Block {
+			char*	memory;
+			size_t	size;
+		};
+		std::vector<Block>	blocks;
+		size_t				blockSize;
+		size_t				currentBlock;
+		size_t				offset;
+
+		size_t bytesUsed;
+		size_t peakBytesUsed;
+	};
+}
@@ -0,0 +1,111 @@
+/*
+Part of Newcastle University's Game Engineering source code.
+
+Use as you see fit!
+
+Comments and queries to: richard-gordon.davison AT ncl.ac.uk
+https://research.ncl.ac.uk/game/
+*/
+#include "MemoryPool.h"
+#include "MemoryArena.h"
+
+using namespace NCL;
+
+static std::vector<MemoryPool*>& AllPools() {
+	static std::vector<MemoryPool*> pools;
+	return pools;
+}
+
+MemoryPool::MemoryPool(const std::string& inName, size_t slotSize, ArenaUse inArenaUse, uint32_t inSlotsPerChunk) {
+	name			= inName;
+	slotStride		= (HeaderSize + slotSize + HeaderSize - 1) & ~(HeaderSize - 1);
+	slotsPerChunk	= inSlotsPerChunk;
+	arenaUse		= inArenaUse;
+	AllPools().push_back(this);
+}
+
+MemoryPool::~MemoryPool() {
+	for (char* c : chunks) {
+		::operator delete(c, std::align_val_t(HeaderSize));
+	}
+	std::vector<MemoryPool*>& pools = AllPools();
+	pools.erase(std::remove(pools.begin(), pools.end(), this), pools.end());
+}
+
+void* MemoryPool::Allocate(size_t size) {
+	MemoryArena* arena = arenaUse == ArenaUse::WhenCurrent ? MemoryArena::GetCurrent() : nullptr;
+	if (arena) {
+		Header* h = (Header*)arena->Allocate(HeaderSize + size, HeaderSize);
+		h->pool		= this;
+		h->index	= ArenaIndex;
+		stats.arena++;
+		return (char*)h + HeaderSize;
+	}
+	Header* h = nullptr;
+	if (HeaderSize + size <= slotStride) {
+		if (freeSlots.empty()) {
+			AddChunk();
+		}
+		h = GetSlot(freeSlots.back());
+		freeSlots.pop_back();
+		stats.pooled++;
+	}
+	else {
+		h = (Header*)::operator new(HeaderSize + size, std::align_val_t(HeaderSize));
+		h->index	= HeapIndex;
+		stats.heap++;
+	}
+	h->pool = this;
+
+	stats.live++;
+	stats.peak = std::max(stats.peak, stats.live);
+	return (char*)h + HeaderSize;
+}
+
+void MemoryPool::Release(void* memory) {
+	if (!memory) {
+		return;
+	}
+	Header* h = (Header*)((char*)memory - HeaderSize);
+	if (h->index == ArenaIndex) {
+		return; //only given back when the arena is reset
+	}
+	MemoryPool* pool = h->pool;
+	pool->stats.live--;
+	pool->stats.freed++;
+
+	if (h->index == HeapIndex) {
+		::operator delete(h, std::align_val_t(HeaderSize));
+	}
+	else {
+		pool->freeSlots.push_back(h->index);
+	}
+}
+
+MemoryPool::Header* MemoryPool::GetSlot(uint32_t index) const {
+	return (Header*)(chunks[index / slotsPerChunk] + (index % slotsPerChunk) * slotStride);
+}
+
+void MemoryPool::AddChunk() {
+	uint32_t first = (uint32_t)stats.slots;
+	chunks.push_back((char*)::operator new(slotStride * slotsPerChunk, std::align_val_t(HeaderSize)));
+	stats.slots += slotsPerChunk;
+	stats.heap++;
+
+	//Pushed in reverse, so that the lowest slots get used first
+	for (uint32_t i = slotsPerChunk; i-- > 0; ) {
+		Header* h = GetSlot(first + i);
+		h->pool		= this;
+		h->index	= first + i;
+		freeSlots.push_back(first + i);
+	}
+}
+
+void MemoryPool::PrintStats() {
+	std::cout << "Pools\tLive\tPeak\tSlots\tPooled\tArena\tHeap\tFreed\n";
+	for (const MemoryPool* p : AllPools()) {
+		const Stats& s = p->stats;
+		std::cout << p->name << "\t" << s.live << "\t" << s.peak << "\t" << s.slots << "\t"
+			<< s.pooled << "\t" << s.arena << "\t" << s.heap << "\t" << s.freed << "\n";
+	}
+}
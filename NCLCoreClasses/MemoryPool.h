@@ -0,0 +1,105 @@
+/*
+Part of Newcastle University's Game Engineering source code.
+
+Use as you see fit!
+
+Comments and queries to: richard-gordon.davison AT ncl.ac.uk
+https://research.ncl.ac.uk/game/
+*/
+#pragma once
+
+namespace NCL {
+	class MemoryArena;
+
+	/*
+	Fixed size slots handed out from chunks that are never moved or freed
+	until the pool is, so allocating and freeing are O(1), addresses stay
+	stable, and objects of one type sit next to each other.
+
+	Every allocation has a small header in front of it saying where it came
+	from, so Release can free anything the pool handed out: a slot, memory
+	from the current MemoryArena, or - for anything bigger than a slot - the
+	heap. Arena memory is only used by pools that ask for it, as it's reset
+	without any destructors being run, so only types whose destructors have
+	nothing to do should. Releasing arena memory does nothing at all.
+
+	Pools aren't thread safe, and should only be used from the main thread.
+	*/
+	class MemoryPool {
+	public:
+		struct Stats {
+			size_t live			= 0;	//not counting arena allocations, which are never released
+			size_t peak			= 0;
+			size_t slots		= 0;
+			size_t pooled		= 0;	//allocations served from a slot
+			size_t arena		= 0;	//allocations served from a MemoryArena
+			size_t heap			= 0;	//allocations that went to the heap, including new chunks
+			size_t freed		= 0;
+		};
+
+		enum class ArenaUse {
+			Never,
+			WhenCurrent,	//whenever a MemoryArena::Scope is alive
+		};
+
+		MemoryPool(const std::string& name, size_t slotSize, ArenaUse arenaUse = ArenaUse::Never, uint32_t slotsPerChunk = 128);
+		~MemoryPool();
+
+		MemoryPool(const MemoryPool&) = delete;
+		MemoryPool& operator=(const MemoryPool&) = delete;
+
+		void* Allocate(size_t size);
+		static void Release(void* memory);
+
+		const std::string& GetName() const {
+			return name;
+		}
+
+		const Stats& GetStats() const {
+			return stats;
+		}
+
+		static void PrintStats();
+
+	protected:
+		struct Header {
+			MemoryPool*	pool;
+			uint32_t	index;
+		};
+		static_assert(sizeof(Header) <= 16);
+		static const size_t HeaderSize = 16;
+
+		static const uint32_t ArenaIndex	= ~0u;
+		static const uint32_t HeapIndex		= ~0u - 1;
+
+		Header* GetSlot(uint32_t index) const;
+		void	AddChunk();
+
+		std::string				name;
+		size_t					slotStride;
+		uint32_t				slotsPerChunk;
+		ArenaUse				arenaUse;
+		std::vector<char*>		chunks;
+		std::vector<uint32_t>	freeSlots;
+
+		Stats stats;
+	};
+
+	/*
+	Inherit from this to have new and delete use T's pool, which T provides
+	with a static GetPool method. Classes derived from T share its pool, and
+	fall back to the heap if they don't fit in its slots, unless they declare
+	a new and delete of their own using a pool of their own.
+	*/
+	template <typename T>
+	class PooledObject {
+	public:
+		static void* operator new(size_t size) {
+			return T::GetPool().Allocate(size);
+		}
+
+		static void operator delete(void* memory) {
+			MemoryPool::Release(memory);
+		}
+	};
+}
@@ -91,6 +91,13 @@ int Mesh::GetIndexForJoint(const std::string& name) const {
 
 void Mesh::SetVertexPositions(const std::vector<Vector3>& newVerts) {
 	positions = newVerts;
+
+	boundsMin = positions.empty() ? Vector3() : positions[0];
+	boundsMax = boundsMin;
+	for (const Vector3& p : positions) {
+		boundsMin = Vector3(std::min(boundsMin.x, p.x), std::min(boundsMin.y, p.y), std::min(boundsMin.z, p.z));
+		boundsMax = Vector3(std::max(boundsMax.x, p.x), std::max(boundsMax.y, p.y), std::max(boundsMax.z, p.z));
+	}
 }
 
 void Mesh::SetVertexTextureCoords(const std::vector<Vector2>& newTex) {
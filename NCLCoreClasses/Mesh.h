@@ -8,6 +8,7 @@ https://research.ncl.ac.uk/game/
 */
 #pragma once
 #include <cstdint>
+#include "Vector3.h"
 
 
 namespace NCL::Maths {
@@ -66,6 +67,7 @@ namespace NCL::Rendering {
 
 	class Mesh	{
 	public:		
+		friend class MshLoader;	//fills in a cooked mesh's data directly
 		virtual ~Mesh();
 
 		GeometryPrimitive::Type GetPrimitiveType() const {
@@ -183,6 +185,10 @@ namespace NCL::Rendering {
 
 		const std::vector<unsigned int>& GetIndexData()			const { return indices;		}
 
+		//Local space bounding box of the vertex positions, kept up to date by SetVertexPositions
+		const Vector3& GetBoundsMin() const { return boundsMin; }
+		const Vector3& GetBoundsMax() const { return boundsMax; }
+
 		void SetVertexPositions(const std::vector<Vector3>& newVerts);
 		void SetVertexTextureCoords(const std::vector<Vector2>& newTex);
 
@@ -215,6 +221,9 @@ namespace NCL::Rendering {
 		std::string					debugName;
 		uint32_t					assetID;
 
+		Vector3						boundsMin;
+		Vector3						boundsMax;
+
 		std::vector<Vector3>		positions;
 		std::vector<Vector2>		texCoords;
 		std::vector<Vector4>		colours;
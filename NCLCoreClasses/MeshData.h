@@ -0,0 +1,56 @@
+/*
+Part of Newcastle University's Game Engineering source code.
+
+Use as you see fit!
+
+Comments and queries to: richard-gordon.davison AT ncl.ac.uk
+https://research.ncl.ac.uk/game/
+*/
+#pragma once
+#include "CookedData.h"
+
+namespace NCL::Rendering {
+	/*
+	On-disk layout of a cooked mesh, made from a .msh file by AssetCooker or
+	MshLoader::Cook. Each vertex attribute gets its own stream, laid out just
+	as Mesh keeps it (and so as each of a mesh's vertex buffers wants it),
+	so loading one is a single copy per stream rather than parsing every
+	number in the text version.
+	*/
+	namespace MeshData {
+		const uint32_t Magic	= 0x424D534E; //'NSMB'
+		const uint32_t Version	= 1;
+
+		enum Streams : uint32_t {
+			Positions,			//Vector3s
+			Colours,			//Vector4s
+			TexCoords,			//Vector2s
+			Normals,			//Vector3s
+			Tangents,			//Vector4s
+			SkinWeights,		//Vector4s
+			SkinIndices,		//Vector4is
+			Indices,			//unsigned ints
+			SubMeshes,			//SubMeshes
+			SubMeshNames,		//null terminated strings, one after another
+			JointNames,			//null terminated strings, one after another
+			JointParents,		//ints
+			BindPose,			//Matrix4s
+			InverseBindPose,	//Matrix4s
+			MAX_STREAMS
+		};
+
+		struct Stream {
+			uint64_t offset;	//from the start of the file
+			uint64_t size;		//in bytes, 0 if the mesh doesn't have it
+		};
+
+		struct Header {
+			CookedData::FileHeader file;
+			uint32_t	primitiveType;
+			uint32_t	padding[3];
+			float		boundsMin[4];	//w is unused
+			float		boundsMax[4];
+			Stream		streams[MAX_STREAMS];
+		};
+	}
+}
@@ -13,13 +13,201 @@
 #include "Maths.h"
 
 #include "Mesh.h"
+#include "MeshData.h"
+#include "MappedFile.h"
 
 using namespace NCL;
 using namespace Rendering;
 using namespace Maths;
 
+namespace {
+	//Only ever holds a mesh on its way to being cooked
+	class CookingMesh : public Mesh {
+	public:
+		void UploadToGPU(Rendering::RendererBase* renderer) override {}
+	};
+
+	bool StreamIsValid(const MappedFile& file, const MeshData::Stream& stream, size_t elementSize) {
+		return stream.size % elementSize == 0 && file.GetAt<char>(stream.offset, stream.size) != nullptr;
+	}
+
+	//Every string has to end inside the stream, or reading the last would run off the end of it
+	bool StringsAreValid(const MappedFile& file, const MeshData::Stream& stream) {
+		const char* data = file.GetAt<char>(stream.offset, stream.size);
+		return stream.size == 0 || data[stream.size - 1] == '\0';
+	}
+
+	//Indices have to point at vertices the mesh has, and sub meshes at indices (or vertices) it has
+	bool RangesAreValid(const MappedFile& file, const MeshData::Stream* streams) {
+		size_t vertexCount	= streams[MeshData::Positions].size / sizeof(Vector3);
+		size_t indexCount	= streams[MeshData::Indices].size / sizeof(unsigned int);
+		size_t subMeshCount	= streams[MeshData::SubMeshes].size / sizeof(SubMesh);
+
+		const unsigned int* indices = file.GetAt<unsigned int>(streams[MeshData::Indices].offset, indexCount);
+		for (size_t i = 0; i < indexCount; ++i) {
+			if (indices[i] >= vertexCount) {
+				return false;
+			}
+		}
+		size_t entryCount = indexCount ? indexCount : vertexCount;
+
+		const SubMesh* subMeshes = file.GetAt<SubMesh>(streams[MeshData::SubMeshes].offset, subMeshCount);
+		for (size_t i = 0; i < subMeshCount; ++i) {
+			const SubMesh& m = subMeshes[i];
+			if (m.start < 0 || m.count < 0 || m.base < 0 ||
+				(size_t)m.start + (size_t)m.count > entryCount || (m.base > 0 && (size_t)m.base >= vertexCount)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	template<typename T>
+	void ReadStream(const MappedFile& file, const MeshData::Stream& stream, std::vector<T>& into) {
+		const T* data = file.GetAt<T>(stream.offset, stream.size / sizeof(T));
+		into.assign(data, data + stream.size / sizeof(T));
+	}
+
+	void ReadStrings(const MappedFile& file, const MeshData::Stream& stream, std::vector<std::string>& into) {
+		const char* data	= file.GetAt<char>(stream.offset, stream.size);
+		const char* end		= data + stream.size;
+		into.clear();
+		while (data < end) {
+			const char* terminator = (const char*)memchr(data, '\0', end - data);
+			into.emplace_back(data, terminator);
+			data = terminator + 1;
+		}
+	}
+
+	template<typename T>
+	void AddStream(std::vector<char>& file, MeshData::Header& header, MeshData::Streams stream, const std::vector<T>& data) {
+		header.streams[stream].offset	= file.size();
+		header.streams[stream].size		= data.size() * sizeof(T);
+		file.insert(file.end(), (const char*)data.data(), (const char*)(data.data() + data.size()));
+		file.resize(CookedData::AlignOffset(file.size()), 0);
+	}
+
+	void AddStrings(std::vector<char>& file, MeshData::Header& header, MeshData::Streams stream, const std::vector<std::string>& strings) {
+		std::vector<char> data;
+		for (const std::string& s : strings) {
+			data.insert(data.end(), s.c_str(), s.c_str() + s.size() + 1);
+		}
+		AddStream(file, header, stream, data);
+	}
+}
+
 bool MshLoader::LoadMesh(const std::string& filename, Mesh& destinationMesh) {
-	std::ifstream file(Assets::MESHDIR + filename);
+	std::string sourceFile = Assets::MESHDIR + filename;
+	std::string cookedFile = sourceFile + CookedData::CookedExtension;
+
+	if (CookedData::CookedFileIsCurrent(sourceFile, cookedFile) && LoadCooked(cookedFile, destinationMesh)) {
+		return true;
+	}
+	return LoadText(sourceFile, destinationMesh);
+}
+
+/*
+Every stream is checked before any are copied - its size, that its strings
+end, and that its indices and sub meshes stay in range - so that a bad file
+leaves the mesh as it was, ready for the text version to be loaded instead.
+*/
+bool MshLoader::LoadCooked(const std::string& filepath, Mesh& destinationMesh) {
+	MappedFile file;
+	if (!file.Open(filepath)) {
+		return false;
+	}
+	const MeshData::Header* header = file.GetAt<MeshData::Header>(0);
+	if (!header || !CookedData::HeaderIsValid(&header->file, MeshData::Magic, MeshData::Version, sizeof(MeshData::Header), file.GetSize())) {
+		return false;
+	}
+	const MeshData::Stream* streams = header->streams;
+
+	const size_t elementSizes[MeshData::MAX_STREAMS] = {
+		sizeof(Vector3), sizeof(Vector4), sizeof(Vector2), sizeof(Vector3), sizeof(Vector4), sizeof(Vector4), sizeof(Vector4i),
+		sizeof(unsigned int), sizeof(SubMesh), 1, 1, sizeof(int), sizeof(Matrix4), sizeof(Matrix4)
+	};
+	for (uint32_t i = 0; i < MeshData::MAX_STREAMS; ++i) {
+		if (!StreamIsValid(file, streams[i], elementSizes[i])) {
+			return false;
+		}
+	}
+	if (!StringsAreValid(file, streams[MeshData::SubMeshNames]) || !StringsAreValid(file, streams[MeshData::JointNames])) {
+		return false;
+	}
+	if (!RangesAreValid(file, streams)) {
+		return false;
+	}
+
+	ReadStream(file, streams[MeshData::Positions],		destinationMesh.positions);
+	ReadStream(file, streams[MeshData::Colours],		destinationMesh.colours);
+	ReadStream(file, streams[MeshData::TexCoords],		destinationMesh.texCoords);
+	ReadStream(file, streams[MeshData::Normals],		destinationMesh.normals);
+	ReadStream(file, streams[MeshData::Tangents],		destinationMesh.tangents);
+	ReadStream(file, streams[MeshData::SkinWeights],	destinationMesh.skinWeights);
+	ReadStream(file, streams[MeshData::SkinIndices],	destinationMesh.skinIndices);
+	ReadStream(file, streams[MeshData::Indices],		destinationMesh.indices);
+	ReadStream(file, streams[MeshData::SubMeshes],		destinationMesh.subMeshes);
+	ReadStream(file, streams[MeshData::JointParents],	destinationMesh.jointParents);
+	ReadStream(file, streams[MeshData::BindPose],		destinationMesh.bindPose);
+	ReadStream(file, streams[MeshData::InverseBindPose],destinationMesh.inverseBindPose);
+
+	ReadStrings(file, streams[MeshData::SubMeshNames],	destinationMesh.subMeshNames);
+	ReadStrings(file, streams[MeshData::JointNames],	destinationMesh.jointNames);
+
+	destinationMesh.boundsMin = Vector3(header->boundsMin[0], header->boundsMin[1], header->boundsMin[2]);
+	destinationMesh.boundsMax = Vector3(header->boundsMax[0], header->boundsMax[1], header->boundsMax[2]);
+	destinationMesh.SetPrimitiveType((GeometryPrimitive::Type)header->primitiveType);
+	return true;
+}
+
+bool MshLoader::SaveCooked(const Mesh& mesh, const std::string& filepath) {
+	std::ofstream outfile(filepath, std::ios::binary);
+	if (!outfile) {
+		return false;
+	}
+	MeshData::Header header = {};
+	header.file.magic		= MeshData::Magic;
+	header.file.version		= MeshData::Version;
+	header.file.headerSize	= sizeof(MeshData::Header);
+	header.primitiveType	= mesh.GetPrimitiveType();
+	for (int i = 0; i < 3; ++i) {
+		header.boundsMin[i] = mesh.boundsMin[i];
+		header.boundsMax[i] = mesh.boundsMax[i];
+	}
+
+	std::vector<char> file(CookedData::AlignOffset(sizeof(MeshData::Header)), 0);
+	AddStream(file, header, MeshData::Positions,		mesh.positions);
+	AddStream(file, header, MeshData::Colours,			mesh.colours);
+	AddStream(file, header, MeshData::TexCoords,		mesh.texCoords);
+	AddStream(file, header, MeshData::Normals,			mesh.normals);
+	AddStream(file, header, MeshData::Tangents,			mesh.tangents);
+	AddStream(file, header, MeshData::SkinWeights,		mesh.skinWeights);
+	AddStream(file, header, MeshData::SkinIndices,		mesh.skinIndices);
+	AddStream(file, header, MeshData::Indices,			mesh.indices);
+	AddStream(file, header, MeshData::SubMeshes,		mesh.subMeshes);
+	AddStrings(file, header, MeshData::SubMeshNames,	mesh.subMeshNames);
+	AddStrings(file, header, MeshData::JointNames,		mesh.jointNames);
+	AddStream(file, header, MeshData::JointParents,		mesh.jointParents);
+	AddStream(file, header, MeshData::BindPose,			mesh.bindPose);
+	AddStream(file, header, MeshData::InverseBindPose,	mesh.inverseBindPose);
+
+	header.file.fileSize = (uint32_t)file.size();
+	memcpy(file.data(), &header, sizeof(header));
+
+	outfile.write(file.data(), file.size());
+	return outfile.good();
+}
+
+bool MshLoader::Cook(const std::string& filename, const std::string& cookedFilepath) {
+	CookingMesh mesh;
+	if (!LoadText(Assets::MESHDIR + filename, mesh)) {
+		return false;
+	}
+	return SaveCooked(mesh, cookedFilepath);
+}
+
+bool MshLoader::LoadText(const std::string& filepath, Mesh& destinationMesh) {
+	std::ifstream file(filepath);
 
 	std::string filetype;
 	int fileVersion;
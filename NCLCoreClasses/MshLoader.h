@@ -53,8 +53,16 @@ namespace NCL::Rendering {
 	};
 
 	public:		
+		//Loads from the mesh directory, using the cooked version of the file if there's an up to date one
 		static bool LoadMesh(const std::string& filename, Mesh& destinationMesh);
 
+		static bool LoadText(const std::string& filepath, Mesh& destinationMesh);
+		static bool LoadCooked(const std::string& filepath, Mesh& destinationMesh);
+		static bool SaveCooked(const Mesh& mesh, const std::string& filepath);
+
+		//Turns a .msh file in the mesh directory into the cooked format
+		static bool Cook(const std::string& filename, const std::string& cookedFilepath);
+
 	protected:
 		static void* ReadVertexData(GeometryChunkData dataType, GeometryChunkTypes chunkType, int numVertices);
 		static void ReadTextInts(std::ifstream& file, vector<Maths::Vector2i>& element, int numVertices);
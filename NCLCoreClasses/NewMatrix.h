@@ -7,20 +7,44 @@ Comments and queries to: richard-gordon.davison AT ncl.ac.uk
 https://research.ncl.ac.uk/game/
 */
 #pragma once
+#include "Maths.h"
+#include "NewVector.h"
+#include "Matrix3.h"
+#include "Matrix4.h"
 
 namespace NCL::Maths {
-
+    /*
+    Column major matrices of r rows and c columns, laid out the same as the
+    Matrix3 and Matrix4 classes, so array[column][row]. Like NewVector, it's
+    all constexpr apart from building rotations. At runtime, 4x4 float
+    matrices, and 3x3 ones multiplying vectors, use SIMD::Float4, giving
+    exactly the same answers as Matrix3 and Matrix4.
+    */
     template <typename T, uint32_t r, uint32_t c>
     struct NewMatrix    {
         T array[c][r];
 
-        NewMatrix() {
-            for (int i = 0; i < c; ++i) {
-                for (int j = 0; j < r; ++j) {
-                    T a = (i == j) ? T(1) : T(0);
-                    array[i][j] = a;
-                }
+        //The identity matrix, or as close as it gets if it's not square
+        constexpr NewMatrix() : array{} {
+            for (uint32_t i = 0; i < c && i < r; ++i) {
+                array[i][i] = T(1);
+            }
+        }
+
+        constexpr NewVector<T, r> GetColumn(uint32_t column) const {
+            NewVector<T, r> v;
+            for (uint32_t i = 0; i < r; ++i) {
+                v[i] = array[column][i];
+            }
+            return v;
+        }
+
+        constexpr NewVector<T, c> GetRow(uint32_t row) const {
+            NewVector<T, c> v;
+            for (uint32_t i = 0; i < c; ++i) {
+                v[i] = array[i][row];
             }
+            return v;
         }
     };
 
@@ -28,28 +52,130 @@ namespace NCL::Maths {
     using NewMatrix3 = NewMatrix<float, 3, 3>;
     using NewMatrix4 = NewMatrix<float, 4, 4>;
 
-    template <typename T, uint32_t r, uint32_t c>
-    constexpr NewMatrix<T,r,c> operator*(const NewMatrix<T, r, c>& a, const NewMatrix<T, r, c>& b) {
+    using NewMatrix2d = NewMatrix<double, 2, 2>;
+    using NewMatrix3d = NewMatrix<double, 3, 3>;
+    using NewMatrix4d = NewMatrix<double, 4, 4>;
+
+    namespace MatrixKernels {
+        inline NewMatrix4 Multiply(const NewMatrix4& a, const NewMatrix4& b) {
+            using namespace SIMD;
+            Float4 c0 = Load(a.array[0]);
+            Float4 c1 = Load(a.array[1]);
+            Float4 c2 = Load(a.array[2]);
+            Float4 c3 = Load(a.array[3]);
+
+            NewMatrix4 out;
+            for (uint32_t c = 0; c < 4; ++c) {
+                Float4 column = Load(b.array[c]);
+                Float4 result = Mul(c0, Shuffle<0, 0, 0, 0>(column));
+                result = MulAdd(c1, Shuffle<1, 1, 1, 1>(column), result);
+                result = MulAdd(c2, Shuffle<2, 2, 2, 2>(column), result);
+                result = MulAdd(c3, Shuffle<3, 3, 3, 3>(column), result);
+                Store(out.array[c], result);
+            }
+            return out;
+        }
+
+        inline NewVector4 Multiply(const NewMatrix4& m, const NewVector4& v) {
+            using namespace SIMD;
+            Float4 in = VectorKernels::Load(v);
+            Float4 result = Mul(Load(m.array[0]), Shuffle<0, 0, 0, 0>(in));
+            result = MulAdd(Load(m.array[1]), Shuffle<1, 1, 1, 1>(in), result);
+            result = MulAdd(Load(m.array[2]), Shuffle<2, 2, 2, 2>(in), result);
+            result = MulAdd(Load(m.array[3]), Shuffle<3, 3, 3, 3>(in), result);
+            return VectorKernels::Store(result);
+        }
+
+        //The last column is read as 3 floats, as reading 4 would go past the end of the matrix.
+        //It, and v, are only 4 byte aligned in an array, which Load3 and Store3 allow for
+        inline NewVector3 Multiply(const NewMatrix3& m, const NewVector3& v) {
+            using namespace SIMD;
+            Float4 in = Load3(&v.x);
+            Float4 result = Mul(Load(m.array[0]), Shuffle<0, 0, 0, 0>(in));
+            result = MulAdd(Load(m.array[1]), Shuffle<1, 1, 1, 1>(in), result);
+            result = MulAdd(Load3(m.array[2]), Shuffle<2, 2, 2, 2>(in), result);
+
+            NewVector3 out;
+            Store3(&out.x, result);
+            return out;
+        }
+    }
+
+    //An r x k matrix multiplied by a k x c matrix, in the same 'OpenGL' order as Matrix4
+    template <typename T, uint32_t r, uint32_t k, uint32_t c>
+    constexpr NewMatrix<T, r, c> operator*(const NewMatrix<T, r, k>& a, const NewMatrix<T, k, c>& b) {
+        if constexpr (std::is_same_v<T, float> && r == 4 && k == 4 && c == 4) {
+            if (!std::is_constant_evaluated()) {
+                return MatrixKernels::Multiply(a, b);
+            }
+        }
         NewMatrix<T, r, c> out;
-        for (unsigned int cc = 0; cc < c; ++cc) {
-            for (unsigned int rr = 0; rr < r; ++rr) {
-                out.array[cc][rr] = T(0);
-                for (unsigned int i = 0; i < r; ++i) {
-                    out.array[cc][rr] += a.array[i][rr] * b.array[cc][i];
+        for (uint32_t cc = 0; cc < c; ++cc) {
+            for (uint32_t rr = 0; rr < r; ++rr) {
+                T sum = a.array[0][rr] * b.array[cc][0];
+                for (uint32_t i = 1; i < k; ++i) {
+                    sum += a.array[i][rr] * b.array[cc][i];
                 }
+                out.array[cc][rr] = sum;
+            }
+        }
+        return out;
+    }
+
+    template <typename T, uint32_t r, uint32_t c>
+    constexpr NewVector<T, r> operator*(const NewMatrix<T, r, c>& m, const NewVector<T, c>& v) {
+        if constexpr (std::is_same_v<T, float> && r == c && (c == 3 || c == 4)) {
+            if (!std::is_constant_evaluated()) {
+                return MatrixKernels::Multiply(m, v);
+            }
+        }
+        NewVector<T, r> out;
+        for (uint32_t rr = 0; rr < r; ++rr) {
+            T sum = v[0] * m.array[0][rr];
+            for (uint32_t i = 1; i < c; ++i) {
+                sum += v[i] * m.array[i][rr];
+            }
+            out[rr] = sum;
+        }
+        return out;
+    }
+
+    template <typename T, uint32_t r, uint32_t c>
+    constexpr NewMatrix<T, c, r> Transpose(const NewMatrix<T, r, c>& m) {
+        NewMatrix<T, c, r> out;
+        for (uint32_t cc = 0; cc < c; ++cc) {
+            for (uint32_t rr = 0; rr < r; ++rr) {
+                out.array[rr][cc] = m.array[cc][rr];
             }
         }
         return out;
     }
 
+    template <typename T, uint32_t r, uint32_t c>
+    constexpr bool operator==(const NewMatrix<T, r, c>& a, const NewMatrix<T, r, c>& b) {
+        for (uint32_t cc = 0; cc < c; ++cc) {
+            for (uint32_t rr = 0; rr < r; ++rr) {
+                if (a.array[cc][rr] != b.array[cc][rr]) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    template <typename T, uint32_t r, uint32_t c>
+    constexpr bool operator!=(const NewMatrix<T, r, c>& a, const NewMatrix<T, r, c>& b) {
+        return !(a == b);
+    }
+
     //Matrix4 Specialisations
     template <typename T>
     constexpr NewMatrix<T, 4, 4> Translation(const NewVector<T, 3>& v) {
         NewMatrix<T, 4, 4> mat;
 
-        mat.array[3][0] = T(v.x);
-        mat.array[3][1] = T(v.y);
-        mat.array[3][2] = T(v.z);
+        mat.array[3][0] = v.x;
+        mat.array[3][1] = v.y;
+        mat.array[3][2] = v.z;
 
         return mat;
     }
@@ -58,35 +184,61 @@ namespace NCL::Maths {
     constexpr NewMatrix<T, 4, 4> Scale(const NewVector<T, 3>& v) {
         NewMatrix<T, 4, 4> mat;
 
-        mat.array[0][0] = T(v.x);
-        mat.array[1][1] = T(v.y);
-        mat.array[2][2] = T(v.z);
-        mat.array[2][3] = T(1);
+        mat.array[0][0] = v.x;
+        mat.array[1][1] = v.y;
+        mat.array[2][2] = v.z;
 
         return mat;
     }
 
+    //Not constexpr, as there's no compile time sin and cos
     template <typename T>
-    constexpr NewMatrix<T, 4, 4> Rotation(T degrees, const NewVector<T, 3>& inAxis) {
+    NewMatrix<T, 4, 4> Rotation(T degrees, const NewVector<T, 3>& inAxis) {
         NewMatrix<T, 4, 4> mat;
 
         const NewVector<T, 3> axis = Maths::Normalise(inAxis);
-       
-        float c = cos((float)Maths::DegreesToRadians(degrees));
-        float s = sin((float)Maths::DegreesToRadians(degrees));
-
-        mat.array[0][0] = (axis.x * axis.x) * (1.0f - c) + c;
-        mat.array[0][1] = (axis.y * axis.x) * (1.0f - c) + (axis.z * s);
-        mat.array[0][2] = (axis.z * axis.x) * (1.0f - c) - (axis.y * s);
-        
-        mat.array[1][0] = (axis.x * axis.y) * (1.0f - c) - (axis.z * s);
-        mat.array[1][1] = (axis.y * axis.y) * (1.0f - c) + c;
-        mat.array[1][2] = (axis.z * axis.y) * (1.0f - c) + (axis.x * s);
-        
-        mat.array[2][0] = (axis.x * axis.z) * (1.0f - c) + (axis.y * s);
-        mat.array[2][1] = (axis.y * axis.z) * (1.0f - c) - (axis.x * s);
-        mat.array[2][2] = (axis.z * axis.z) * (1.0f - c) + c;
+
+        T radians = degrees * T(PI) / T(180);
+        T c = std::cos(radians);
+        T s = std::sin(radians);
+
+        mat.array[0][0] = (axis.x * axis.x) * (T(1) - c) + c;
+        mat.array[0][1] = (axis.y * axis.x) * (T(1) - c) + (axis.z * s);
+        mat.array[0][2] = (axis.z * axis.x) * (T(1) - c) - (axis.y * s);
+
+        mat.array[1][0] = (axis.x * axis.y) * (T(1) - c) - (axis.z * s);
+        mat.array[1][1] = (axis.y * axis.y) * (T(1) - c) + c;
+        mat.array[1][2] = (axis.z * axis.y) * (T(1) - c) + (axis.x * s);
+
+        mat.array[2][0] = (axis.x * axis.z) * (T(1) - c) + (axis.y * s);
+        mat.array[2][1] = (axis.y * axis.z) * (T(1) - c) - (axis.x * s);
+        mat.array[2][2] = (axis.z * axis.z) * (T(1) - c) + c;
 
         return mat;
     }
-}
\ No newline at end of file
+
+    //Conversions to and from the existing matrix classes, for code moving over a bit at a time
+    inline NewMatrix3 ToNewMatrix(const Matrix3& m) {
+        NewMatrix3 out;
+        memcpy(out.array, m.array, sizeof(out.array));
+        return out;
+    }
+
+    inline NewMatrix4 ToNewMatrix(const Matrix4& m) {
+        NewMatrix4 out;
+        memcpy(out.array, m.array, sizeof(out.array));
+        return out;
+    }
+
+    inline Matrix3 ToMatrix3(const NewMatrix3& m) {
+        Matrix3 out;
+        memcpy(out.array, m.array, sizeof(out.array));
+        return out;
+    }
+
+    inline Matrix4 ToMatrix4(const NewMatrix4& m) {
+        Matrix4 out;
+        memcpy(out.array, m.array, sizeof(out.array));
+        return out;
+    }
+}
@@ -7,23 +7,34 @@ Comments and queries to: richard-gordon.davison AT ncl.ac.uk
 https://research.ncl.ac.uk/game/
 */
 #pragma once
+#include "MathsSIMD.h"
+#include "Vector2.h"
+#include "Vector3.h"
+#include "Vector4.h"
 
 namespace NCL::Maths {
-
+    /*
+    Fixed size vectors of any type and length. Everything apart from the
+    lengths and normalising, which need a square root, is constexpr, so can
+    be worked out at compile time. At runtime, vectors of 4 floats use
+    SIMD::Float4, adding things up in the same order as the scalar code, so
+    give exactly the same answers as the Vector2/3/4 classes do.
+
+    The 2, 3 and 4 long vectors have x, y, z and w members rather than an
+    array. A union of the two can't be used in constant expressions, as
+    only one of its members can be read, so indexing them picks a member.
+    */
     template <typename T, uint32_t n>
     struct NewVector    {
-        T array[n];
+        T array[n] = {};
 
-        template <typename T, uint32_t n>
-        inline T operator[](int i) {
-            return ((T*)this)[i];
+        constexpr T operator[](int i) const {
+            return array[i];
         }
 
-        template <typename T, uint32_t n>
-        inline T& operator[](int i) {
-            return ((T*)this)[i];
+        constexpr T& operator[](int i) {
+            return array[i];
         }
-
     };
 
     using NewVector2 = NewVector<float, 2>;
@@ -40,122 +51,134 @@ namespace NCL::Maths {
 
     template <typename T>
     struct NewVector<T, 2> {
-        union {
-            T array[2];
-            struct {
-                T x;
-                T y;
-            };
-        };
-
-        NewVector<T, 2>() : x(0),y(0) {
+        T x;
+        T y;
+
+        constexpr NewVector() : x(0), y(0) {
         }
 
-        NewVector<T, 2>(T inX, T inY) {
-            x = inX;
-            y = inY;
+        constexpr NewVector(T inX, T inY) : x(inX), y(inY) {
         }
 
-        T operator[](int i) const {
-            return ((T*)this)[i];
+        constexpr T operator[](int i) const {
+            return i == 0 ? x : y;
         }
-        T& operator[](int i) {
-            return ((T*)this)[i];
+
+        constexpr T& operator[](int i) {
+            return i == 0 ? x : y;
         }
     };
 
     template <typename T>
     struct NewVector<T, 3> {
-        union {
-            T array[3];
-            struct {
-                T x;
-                T y;
-                T z;
-            };
-        };
-
-        NewVector<T, 3>() : x(0), y(0), z(0) {
-        }
+        T x;
+        T y;
+        T z;
 
-        NewVector<T, 3>(T inX, T inY, T inZ) {
-            x = inX;
-            y = inY;
-            z = inZ;
+        constexpr NewVector() : x(0), y(0), z(0) {
         }
 
-        NewVector<T, 3>(NewVector<T, 2> v, T inZ) {
-            x = v.array[0];
-            y = v.array[1];
-            z = inZ;
+        constexpr NewVector(T inX, T inY, T inZ) : x(inX), y(inY), z(inZ) {
         }
 
+        constexpr NewVector(const NewVector<T, 2>& v, T inZ) : x(v.x), y(v.y), z(inZ) {
+        }
 
-        T operator[](int i) const {
-            return ((T*)this)[i];
+        constexpr T operator[](int i) const {
+            return i == 0 ? x : (i == 1 ? y : z);
         }
-        T& operator[](int i) {
-            return ((T*)this)[i];
+
+        constexpr T& operator[](int i) {
+            return i == 0 ? x : (i == 1 ? y : z);
         }
     };
 
     template <typename T>
     struct NewVector<T, 4> {
-        union {
-            T array[4];
-            struct {
-                T x;
-                T y;
-                T z;
-                T w;
-            };
-        };
-
-        NewVector<T, 4>() : x(0), y(0), z(0), w(0) {
+        T x;
+        T y;
+        T z;
+        T w;
+
+        constexpr NewVector() : x(0), y(0), z(0), w(0) {
         }
 
-        NewVector<T, 4>(T inX, T inY, T inZ, T inW) {
-            x = inX;
-            y = inY;
-            z = inZ;
-            w = inW;
+        constexpr NewVector(T inX, T inY, T inZ, T inW) : x(inX), y(inY), z(inZ), w(inW) {
         }
 
-        NewVector<T, 4>(NewVector<T, 2> v, T inZ, T inW) {
-            x = v.array[0];
-            y = v.array[1];
-            z = inZ;
-            w = inW;
+        constexpr NewVector(const NewVector<T, 2>& v, T inZ, T inW) : x(v.x), y(v.y), z(inZ), w(inW) {
         }
 
-        NewVector<T, 4>(NewVector<T, 3> v, T inW) {
-            x = v.array[0];
-            y = v.array[1];
-            z = v.array[2];
-            w = inW;
+        constexpr NewVector(const NewVector<T, 3>& v, T inW) : x(v.x), y(v.y), z(v.z), w(inW) {
         }
 
-        T operator[](int i) const {
-            return ((T*)this)[i];
+        constexpr T operator[](int i) const {
+            return i == 0 ? x : (i == 1 ? y : (i == 2 ? z : w));
         }
-        T& operator[](int i) {
-            return ((T*)this)[i];
+
+        constexpr T& operator[](int i) {
+            return i == 0 ? x : (i == 1 ? y : (i == 2 ? z : w));
         }
     };
 
+    namespace VectorKernels {
+        template <typename T, uint32_t n>
+        constexpr bool IsFloat4 = std::is_same_v<T, float> && n == 4;
+
+        inline SIMD::Float4 Load(const NewVector<float, 4>& v) {
+            return SIMD::Load(&v.x);
+        }
+
+        inline NewVector<float, 4> Store(SIMD::Float4 f) {
+            NewVector<float, 4> v;
+            SIMD::Store(&v.x, f);
+            return v;
+        }
+
+        //Runs op on each pair of elements, or simdOp on all 4 floats at once when not in a constant expression
+        template <typename T, uint32_t n, typename Op, typename SIMDOp>
+        constexpr NewVector<T, n> Apply(const NewVector<T, n>& a, const NewVector<T, n>& b, Op op, SIMDOp simdOp) {
+            if constexpr (IsFloat4<T, n>) {
+                if (!std::is_constant_evaluated()) {
+                    return Store(simdOp(Load(a), Load(b)));
+                }
+            }
+            NewVector<T, n> answer;
+            for (uint32_t i = 0; i < n; ++i) {
+                answer[i] = op(a[i], b[i]);
+            }
+            return answer;
+        }
+
+        //As Apply, but with the same scalar for every element of b, splatted straight into a Float4
+        template <typename T, uint32_t n, typename Op, typename SIMDOp>
+        constexpr NewVector<T, n> ApplyScalar(const NewVector<T, n>& a, T b, Op op, SIMDOp simdOp) {
+            if constexpr (IsFloat4<T, n>) {
+                if (!std::is_constant_evaluated()) {
+                    return Store(simdOp(Load(a), SIMD::Splat(b)));
+                }
+            }
+            NewVector<T, n> answer;
+            for (uint32_t i = 0; i < n; ++i) {
+                answer[i] = op(a[i], b);
+            }
+            return answer;
+        }
+    }
+
     template <typename T>
-    NewVector<T, 3> Cross(const NewVector<T, 3>& a, const NewVector<T, 3>& b) {
-        NewVector<T, 3> result;
-        result.x = (a.y * b.z) - (a.z * b.y);
-        result.y = (a.z * b.x) - (a.x * b.z);
-        result.z = (a.x * b.y) - (a.y * b.x);
-        return result;
+    constexpr NewVector<T, 3> Cross(const NewVector<T, 3>& a, const NewVector<T, 3>& b) {
+        return NewVector<T, 3>(
+            (a.y * b.z) - (a.z * b.y),
+            (a.z * b.x) - (a.x * b.z),
+            (a.x * b.y) - (a.y * b.x)
+        );
     }
 
     template <typename T, uint32_t n>
-    T Dot(const NewVector<T,n>& a, const NewVector<T,n>& b)   {
-        T result(0);
-        for (int i = 0; i < n; ++i) {
+    constexpr T Dot(const NewVector<T, n>& a, const NewVector<T, n>& b) {
+        T result = a[0] * b[0];
+        for (uint32_t i = 1; i < n; ++i) {
             result += a[i] * b[i];
         }
         return result;
@@ -163,175 +186,176 @@ namespace NCL::Maths {
 
     template <typename T, uint32_t n>
     constexpr T LengthSquared(const NewVector<T, n>& a)  {
-        T result(0);
-        for (int i = 0; i < n; ++i) {
-            result += a[i] * a[i];
-        }
-        return result;
+        return Dot(a, a);
     }
 
     template <typename T, uint32_t n>
-    constexpr NewVector<T, n> Normalise(const NewVector<T, n>& a) {
-        NewVector<T, n> result;
-        T l = Length(a);
-        if (l > 0.0f) {
-            T r = T(1.0) / l;
-            for (int i = 0; i < n; ++i) {
-                result.array[i] = a.array[i] * r;
-            }
-        }
-        return result;
+    inline T Length(const NewVector<T, n>& a) {
+        return std::sqrt(LengthSquared(a));
     }
 
     template <typename T, uint32_t n>
-    T Length(const NewVector<T, n>& a) {
-        return std::sqrt(LengthSquared(a));
+    inline NewVector<T, n> Normalise(const NewVector<T, n>& a) {
+        T l = Length(a);
+        if (l != T(0)) {
+            return a * (T(1) / l);
+        }
+        return a;
     }
 
     template <typename T, uint32_t n>
-    constexpr T		GetMinElement(const NewVector<T, n>& a) {
-        float v = a.array[0];
-        for (int i = 1; i < n; ++i) {
-            v = std::min(v, a.array[i]);
+    constexpr T GetMinElement(const NewVector<T, n>& a) {
+        T v = a[0];
+        for (uint32_t i = 1; i < n; ++i) {
+            v = std::min(v, a[i]);
         }
         return v;
     }
 
     template <typename T, uint32_t n>
-    constexpr T		GetMaxElement(const NewVector<T, n>& a)  {
-        float v = a.array[0];
-        for (int i = 1; i < n; ++i) {
-            v = std::max(v, a.array[i]);
+    constexpr T GetMaxElement(const NewVector<T, n>& a)  {
+        T v = a[0];
+        for (uint32_t i = 1; i < n; ++i) {
+            v = std::max(v, a[i]);
         }
         return v;
     }
 
     template <typename T, uint32_t n>
-    constexpr T		GetAbsMaxElement(const NewVector<T, n>& a) {
-        float v = std::abs(a.array[0]);
-        for (int i = 1; i < n; ++i) {
-            v = std::max(v, std::abs(a.array[i]));
+    constexpr T GetAbsMaxElement(const NewVector<T, n>& a) {
+        T v = a[0] < T(0) ? -a[0] : a[0];
+        for (uint32_t i = 1; i < n; ++i) {
+            v = std::max(v, a[i] < T(0) ? -a[i] : a[i]);
         }
         return v;
     }
 
     template <typename T, uint32_t n>
-    constexpr NewVector<T, n>		Clamp(NewVector<T, n>& input, NewVector<T, n>& mins, NewVector<T, n>& maxs) {
+    constexpr NewVector<T, n> Clamp(const NewVector<T, n>& input, const NewVector<T, n>& mins, const NewVector<T, n>& maxs) {
         NewVector<T, n> output;
-        for (int i = 1; i < n; ++i) {
-            output.array[i] = std::clamp(input.array[i], mins.array[i], maxs.array[i]);
+        for (uint32_t i = 0; i < n; ++i) {
+            output[i] = std::clamp(input[i], mins[i], maxs[i]);
         }
         return output;
     }
 
     template <typename T, uint32_t n>
-    inline NewVector<T, n>  operator+(const NewVector<T, n>& a, const NewVector<T, n>& b) {
-        NewVector<T, n> answer;
-        for (int i = 0; i < n; ++i) {
-            answer[i] = a[i] + b[i];
-        }
-        return answer;
+    constexpr NewVector<T, n> Lerp(const NewVector<T, n>& a, const NewVector<T, n>& b, T by) {
+        return a + (b - a) * by;
     }
 
     template <typename T, uint32_t n>
-    inline NewVector<T, n>  operator-(const NewVector<T, n>& a, const NewVector<T, n>& b) {
-        NewVector<T, n> answer;
-        for (int i = 0; i < n; ++i) {
-            answer[i] = a[i] - b[i];
-        }
-        return answer;
+    constexpr NewVector<T, n> operator+(const NewVector<T, n>& a, const NewVector<T, n>& b) {
+        return VectorKernels::Apply(a, b, [](T x, T y) { return x + y; }, [](auto x, auto y) { return SIMD::Add(x, y); });
+    }
+
+    template <typename T, uint32_t n>
+    constexpr NewVector<T, n> operator-(const NewVector<T, n>& a, const NewVector<T, n>& b) {
+        return VectorKernels::Apply(a, b, [](T x, T y) { return x - y; }, [](auto x, auto y) { return SIMD::Sub(x, y); });
     }
 
     template <typename T, uint32_t n>
-    inline NewVector<T, n>  operator-(const NewVector<T, n>& a) {
+    constexpr NewVector<T, n> operator-(const NewVector<T, n>& a) {
         NewVector<T, n> answer;
-        for (int i = 0; i < n; ++i) {
+        for (uint32_t i = 0; i < n; ++i) {
             answer[i] = -a[i];
         }
         return answer;
     }
 
     template <typename T, uint32_t n>
-    inline NewVector<T, n>  operator*(const NewVector<T, n>& a, const NewVector<T, n>& b) {
-        NewVector<T, n> answer;
-        for (int i = 0; i < n; ++i) {
-            answer[i] = a[i] * b[i];
-        }
-        return answer;
+    constexpr NewVector<T, n> operator*(const NewVector<T, n>& a, const NewVector<T, n>& b) {
+        return VectorKernels::Apply(a, b, [](T x, T y) { return x * y; }, [](auto x, auto y) { return SIMD::Mul(x, y); });
     }
 
     template <typename T, uint32_t n>
-    inline NewVector<T, n>  operator/(const NewVector<T, n>& a, const NewVector<T, n>& b) {
-        NewVector<T, n> answer;
-        for (int i = 0; i < n; ++i) {
-            answer[i] = a[i] / b[i];
-        }
-        return answer;
+    constexpr NewVector<T, n> operator/(const NewVector<T, n>& a, const NewVector<T, n>& b) {
+        return VectorKernels::Apply(a, b, [](T x, T y) { return x / y; }, [](auto x, auto y) { return SIMD::Div(x, y); });
     }
 
     template <typename T, uint32_t n>
-    inline NewVector<T, n>  operator*(const NewVector<T, n>& a, const T& b) {
-        NewVector<T, n> answer;
-        for (int i = 0; i < n; ++i) {
-            answer[i] = a[i] * b[i];
-        }
-        return answer;
+    constexpr NewVector<T, n> operator*(const NewVector<T, n>& a, const T& b) {
+        return VectorKernels::ApplyScalar(a, b, [](T x, T y) { return x * y; }, [](auto x, auto y) { return SIMD::Mul(x, y); });
     }
 
     template <typename T, uint32_t n>
-    inline NewVector<T, n>  operator/(const NewVector<T, n>& a, const T& b) {
-        NewVector<T, n> answer;
-        for (int i = 0; i < n; ++i) {
-            answer[i] = a[i] / b[i];
-        }
-        return answer;
+    constexpr NewVector<T, n> operator/(const NewVector<T, n>& a, const T& b) {
+        return VectorKernels::ApplyScalar(a, b, [](T x, T y) { return x / y; }, [](auto x, auto y) { return SIMD::Div(x, y); });
     }
 
     template <typename T, uint32_t n>
-    inline NewVector<T, n>&  operator+=(NewVector<T, n>& a, const NewVector<T, n>& b) {
-        for (int i = 0; i < n; ++i) {
-            a[i] = a[i] + b[i];
-        }
+    constexpr NewVector<T, n>& operator+=(NewVector<T, n>& a, const NewVector<T, n>& b) {
+        a = a + b;
         return a;
     }
 
     template <typename T, uint32_t n>
-    inline NewVector<T, n>& operator-=(NewVector<T, n>& a, const NewVector<T, n>& b) {
-        for (int i = 0; i < n; ++i) {
-            a[i] = a[i] - b[i];
-        }
+    constexpr NewVector<T, n>& operator-=(NewVector<T, n>& a, const NewVector<T, n>& b) {
+        a = a - b;
         return a;
     }
 
     template <typename T, uint32_t n>
-    inline NewVector<T, n>& operator*=(NewVector<T, n>& a, const NewVector<T, n>& b) {
-        for (int i = 0; i < n; ++i) {
-            a[i] = a[i] * b[i];
-        }
+    constexpr NewVector<T, n>& operator*=(NewVector<T, n>& a, const NewVector<T, n>& b) {
+        a = a * b;
         return a;
     }
 
     template <typename T, uint32_t n>
-    inline NewVector<T, n>& operator/=(NewVector<T, n>& a, const NewVector<T, n>& b) {
-        for (int i = 0; i < n; ++i) {
-            a[i] = a[i] / b[i];
-        }
+    constexpr NewVector<T, n>& operator/=(NewVector<T, n>& a, const NewVector<T, n>& b) {
+        a = a / b;
         return a;
     }
 
     template <typename T, uint32_t n>
-    inline NewVector<T, n>& operator*=(NewVector<T, n>& a, const T& b) {
-        for (int i = 0; i < n; ++i) {
-            a[i] = a[i] * b;
-        }
+    constexpr NewVector<T, n>& operator*=(NewVector<T, n>& a, const T& b) {
+        a = a * b;
         return a;
     }
 
     template <typename T, uint32_t n>
-    inline NewVector<T, n>& operator/=(NewVector<T, n>& a, const T& b) {
-        for (int i = 0; i < n; ++i) {
-            a[i] = a[i] / b;
-        }
+    constexpr NewVector<T, n>& operator/=(NewVector<T, n>& a, const T& b) {
+        a = a / b;
         return a;
     }
-}
\ No newline at end of file
+
+    template <typename T, uint32_t n>
+    constexpr bool operator==(const NewVector<T, n>& a, const NewVector<T, n>& b) {
+        for (uint32_t i = 0; i < n; ++i) {
+            if (a[i] != b[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename T, uint32_t n>
+    constexpr bool operator!=(const NewVector<T, n>& a, const NewVector<T, n>& b) {
+        return !(a == b);
+    }
+
+    //Conversions to and from the existing vector classes, for code moving over a bit at a time
+    constexpr NewVector2 ToNewVector(const Vector2& v) {
+        return NewVector2(v.x, v.y);
+    }
+
+    constexpr NewVector3 ToNewVector(const Vector3& v) {
+        return NewVector3(v.x, v.y, v.z);
+    }
+
+    constexpr NewVector4 ToNewVector(const Vector4& v) {
+        return NewVector4(v.x, v.y, v.z, v.w);
+    }
+
+    constexpr Vector2 ToVector2(const NewVector2& v) {
+        return Vector2(v.x, v.y);
+    }
+
+    constexpr Vector3 ToVector3(const NewVector3& v) {
+        return Vector3(v.x, v.y, v.z);
+    }
+
+    constexpr Vector4 ToVector4(const NewVector4& v) {
+        return Vector4(v.x, v.y, v.z, v.w);
+    }
+}
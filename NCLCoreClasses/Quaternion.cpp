@@ -15,20 +15,6 @@ https://research.ncl.ac.uk/game/
 using namespace NCL;
 using namespace NCL::Maths;
 
-Quaternion::Quaternion(void)
-{
-	x = y = z = 0.0f;
-	w = 1.0f;
-}
-
-Quaternion::Quaternion(float x, float y, float z, float w)
-{
-	this->x = x;
-	this->y = y;
-	this->z = z;
-	this->w = w;
-}
-
 Quaternion::Quaternion(double x, double y, double z, double w)
 {
 	this->x = (float)x;
@@ -81,25 +67,6 @@ float Quaternion::Dot(const Quaternion &a,const Quaternion &b){
 	return (a.x * b.x) + (a.y * b.y) + (a.z * b.z) + (a.w * b.w);
 }
 
-void Quaternion::Normalise(){
-	float magnitude = sqrt(x*x + y*y + z*z + w*w);
-
-	if(magnitude > 0.0f){
-		float t = 1.0f / magnitude;
-
-		x *= t;
-		y *= t;
-		z *= t;
-		w *= t;
-	}
-}
-
-Quaternion Quaternion::Normalised() const {
-	Quaternion temp(*this);
-	temp.Normalise();
-	return temp;
-}
-
 void Quaternion::CalculateW()	{
 	w = 1.0f - (x*x)-(y*y)-(z*z);
 	if(w < 0.0f) {
@@ -7,6 +7,7 @@ Comments and queries to: richard-gordon.davison AT ncl.ac.uk
 https://research.ncl.ac.uk/game/
 */
 #pragma once
+#include "MathsSIMD.h"
 
 namespace NCL::Maths {
 	class Matrix3;
@@ -21,8 +22,8 @@ namespace NCL::Maths {
 		float w;
 
 	public:
-		Quaternion(void);
-		Quaternion(float x, float y, float z, float w);
+		Quaternion(void) : x(0.0f), y(0.0f), z(0.0f), w(1.0f) {}
+		Quaternion(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
 		Quaternion(double x, double y, double z, double w);
 		Quaternion(const Vector3& vector, float w);
 
@@ -31,8 +32,26 @@ namespace NCL::Maths {
 
 		~Quaternion(void) = default;
 
-		void		Normalise(); 
-		Quaternion	Normalised() const;
+		//The squares are summed one lane at a time, in the same order as x*x + y*y + z*z + w*w
+		inline void	Normalise() {
+			using namespace SIMD;
+			Float4 q		= Load(&x);
+			Float4 squares	= Mul(q, q);
+			Float4 sum		= Add(squares, Shuffle<1, 1, 1, 1>(squares));
+			sum = Add(sum, Shuffle<2, 2, 2, 2>(squares));
+			sum = Add(sum, Shuffle<3, 3, 3, 3>(squares));
+
+			float magnitude = std::sqrt(GetLane<0>(sum));
+			if (magnitude > 0.0f) {
+				Store(&x, Mul(q, Splat(1.0f / magnitude)));
+			}
+		}
+
+		inline Quaternion Normalised() const {
+			Quaternion temp(*this);
+			temp.Normalise();
+			return temp;
+		}
 
 			
 		static float Dot(const Quaternion &a, const Quaternion &b);
@@ -61,13 +80,28 @@ namespace NCL::Maths {
 			return false;
 		}
 
+		/*
+		Each lane works out one of
+			x = (x * b.w) + (w * b.x) + (y * b.z) - (z * b.y)
+			y = (y * b.w) + (w * b.y) + (z * b.x) - (x * b.z)
+			z = (z * b.w) + (w * b.z) + (x * b.y) - (y * b.x)
+			w = (w * b.w) - (x * b.x) - (y * b.y) - (z * b.z)
+		with the w lane's signs flipped where it subtracts instead.
+		*/
 		inline Quaternion  operator *(const Quaternion &b)	const {
-			return Quaternion(
-				(x * b.w) + (w * b.x) + (y * b.z) - (z * b.y),
-				(y * b.w) + (w * b.y) + (z * b.x) - (x * b.z),
-				(z * b.w) + (w * b.z) + (x * b.y) - (y * b.x),
-				(w * b.w) - (x * b.x) - (y * b.y) - (z * b.z)
-			);
+			using namespace SIMD;
+			Float4 qa	= Load(&x);
+			Float4 qb	= Load(&b.x);
+			Float4 signs = Set(1.0f, 1.0f, 1.0f, -1.0f);
+
+			Float4 result = Mul(qa, Shuffle<3, 3, 3, 3>(qb));
+			result = Add(result, FlipSigns(Mul(Shuffle<3, 3, 3, 0>(qa), Shuffle<0, 1, 2, 0>(qb)), signs));
+			result = Add(result, FlipSigns(Mul(Shuffle<1, 2, 0, 1>(qa), Shuffle<2, 0, 1, 1>(qb)), signs));
+			result = Sub(result, Mul(Shuffle<2, 0, 1, 2>(qa), Shuffle<1, 2, 0, 2>(qb)));
+
+			Quaternion out;
+			Store(&out.x, result);
+			return out;
 		}
 
 		Vector3		operator *(const Vector3 &a)	const;
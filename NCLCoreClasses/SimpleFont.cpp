@@ -52,77 +52,22 @@ SimpleFont::~SimpleFont()	{
 	delete[]	allCharData;
 }
 
-int SimpleFont::GetVertexCountForString(const std::string& text) {
+int SimpleFont::GetVertexCountForString(std::string_view text) {
 	return 6 * text.size();
 }
 
-void SimpleFont::BuildVerticesForString(const std::string& text, const Vector2& startPos, const Vector4& colour, float size, std::vector<Vector3>& positions, std::vector<Vector2>& texCoords, std::vector<Vector4>& colours) {
-	int endChar = startChar + numChars;
-
-	float currentX = 0.0f;
-
-	positions.reserve(positions.size() + (text.length() * 6));
-	colours.reserve(colours.size() + (text.length() * 6));
-	texCoords.reserve(texCoords.size() + (text.length() * 6));
-
-	for (size_t i = 0; i < text.length(); ++i) {
-		int charIndex = (int)text[i];
-
-		if (charIndex < startChar) {
-			continue;
-		}
-		if (charIndex > endChar) {
-			continue;
-		}
-		FontChar& charData = allCharData[charIndex - startChar];
-
-		float scale = size;
-		//For basic vertex buffers, we're assuming we should add 6 vertices
-
-		float charWidth = (float)((charData.x1 - charData.x0) / texWidth) * scale;
-		float charHeight = (float)(charData.y1 - charData.y0);
-
-		float xStart = ((charData.xOff + currentX) * texWidthRecip) * scale;
-		float yStart = startPos.y;
-		float yHeight = (charHeight * texHeightRecip) * scale;
-		float yOff = ((charHeight + charData.yOff) * texHeightRecip) * scale;
-
-		positions.emplace_back(Vector3(startPos.x + xStart, yStart + yOff, 0));
-		positions.emplace_back(Vector3(startPos.x + xStart, yStart + yOff - yHeight, 0));
-		positions.emplace_back(Vector3(startPos.x + xStart + charWidth, yStart + yOff - yHeight, 0));
-
-		positions.emplace_back(Vector3(startPos.x + xStart + charWidth, yStart + yOff - yHeight, 0));
-		positions.emplace_back(Vector3(startPos.x + xStart + charWidth, yStart + yOff, 0));
-		positions.emplace_back(Vector3(startPos.x + xStart, yStart + yOff, 0));
-
-		colours.emplace_back(colour);
-		colours.emplace_back(colour);
-		colours.emplace_back(colour);
-
-		colours.emplace_back(colour);
-		colours.emplace_back(colour);
-		colours.emplace_back(colour);
-
-		texCoords.emplace_back(Vector2(charData.x0 * texWidthRecip, charData.y1 * texHeightRecip));
-		texCoords.emplace_back(Vector2(charData.x0 * texWidthRecip, charData.y0 * texHeightRecip));
-		texCoords.emplace_back(Vector2(charData.x1 * texWidthRecip, charData.y0 * texHeightRecip));
-
-		texCoords.emplace_back(Vector2(charData.x1 * texWidthRecip, charData.y0 * texHeightRecip));
-		texCoords.emplace_back(Vector2(charData.x1 * texWidthRecip, charData.y1 * texHeightRecip));
-		texCoords.emplace_back(Vector2(charData.x0 * texWidthRecip, charData.y1 * texHeightRecip));
-
-		currentX += charData.xAdvance;
-	}
-}
-
-void SimpleFont::BuildInterleavedVerticesForString(const std::string& text, const Maths::Vector2& startPos, const Maths::Vector4& colour, float size, std::vector<InterleavedTextVertex>& vertices) {
+/*
+Writes 6 vertices per character straight into the given memory, which
+GetVertexCountForString says how much of to have ready. Characters the font
+doesn't have are skipped, so the returned count of vertices actually written
+can be less than that.
+*/
+int SimpleFont::BuildVerticesForString(std::string_view text, const Vector2& startPos, const Vector4& colour, float size, InterleavedTextVertex* vertices) {
 	int endChar = startChar + numChars;
 
 	float currentX = 0.0f;
 
-	vertices.reserve(text.length() * 6);
-
-	InterleavedTextVertex verts[6];
+	InterleavedTextVertex* verts = vertices;
 
 	for (size_t i = 0; i < text.length(); ++i) {
 		int charIndex = (int)text[i];
@@ -136,7 +81,6 @@ void SimpleFont::BuildInterleavedVerticesForString(const std::string& text, cons
 		FontChar& charData = allCharData[charIndex - startChar];
 
 		float scale = size;
-		//For basic vertex buffers, we're assuming we should add 6 vertices
 
 		float charWidth = (float)((charData.x1 - charData.x0) / texWidth) * scale;
 		float charHeight = (float)(charData.y1 - charData.y0);
@@ -146,21 +90,13 @@ void SimpleFont::BuildInterleavedVerticesForString(const std::string& text, cons
 		float yHeight = (charHeight * texHeightRecip) * scale;
 		float yOff = ((charHeight + charData.yOff) * texHeightRecip) * scale;
 
-		verts[0].pos = Vector3(startPos.x + xStart, yStart + yOff, 0);
-		verts[1].pos = Vector3(startPos.x + xStart, yStart + yOff - yHeight, 0);
-		verts[2].pos = Vector3(startPos.x + xStart + charWidth, yStart + yOff - yHeight, 0);
+		verts[0].pos = Vector2(startPos.x + xStart, yStart + yOff);
+		verts[1].pos = Vector2(startPos.x + xStart, yStart + yOff - yHeight);
+		verts[2].pos = Vector2(startPos.x + xStart + charWidth, yStart + yOff - yHeight);
 
-		verts[3].pos = (Vector3(startPos.x + xStart + charWidth, yStart + yOff - yHeight, 0));
-		verts[4].pos = Vector3(startPos.x + xStart + charWidth, yStart + yOff, 0);
-		verts[5].pos = Vector3(startPos.x + xStart, yStart + yOff, 0);
-
-		verts[0].colour = colour;
-		verts[1].colour = colour;
-		verts[2].colour = colour;
-
-		verts[3].colour = colour;
-		verts[4].colour = colour;
-		verts[5].colour = colour;
+		verts[3].pos = Vector2(startPos.x + xStart + charWidth, yStart + yOff - yHeight);
+		verts[4].pos = Vector2(startPos.x + xStart + charWidth, yStart + yOff);
+		verts[5].pos = Vector2(startPos.x + xStart, yStart + yOff);
 
 		verts[0].texCoord = Vector2(charData.x0 * texWidthRecip, charData.y1 * texHeightRecip);
 		verts[1].texCoord = Vector2(charData.x0 * texWidthRecip, charData.y0 * texHeightRecip);
@@ -170,14 +106,12 @@ void SimpleFont::BuildInterleavedVerticesForString(const std::string& text, cons
 		verts[4].texCoord = Vector2(charData.x1 * texWidthRecip, charData.y1 * texHeightRecip);
 		verts[5].texCoord = Vector2(charData.x0 * texWidthRecip, charData.y1 * texHeightRecip);
 
-		vertices.emplace_back(verts[0]);
-		vertices.emplace_back(verts[1]);
-		vertices.emplace_back(verts[2]);
-
-		vertices.emplace_back(verts[3]);
-		vertices.emplace_back(verts[4]);
-		vertices.emplace_back(verts[5]);
+		for (int v = 0; v < 6; ++v) {
+			verts[v].colour = colour;
+		}
+		verts += 6;
 
 		currentX += charData.xAdvance;
 	}
-}
\ No newline at end of file
+	return (int)(verts - vertices);
+}
@@ -30,9 +30,9 @@ namespace NCL {
 				NCL::Maths::Vector4 colour;
 			};
 
-			int  GetVertexCountForString(const std::string& text);
-			void BuildVerticesForString(const std::string& text, const Maths::Vector2& startPos, const Maths::Vector4& colour, float size, std::vector<Maths::Vector3>& positions, std::vector<Maths::Vector2>& texCoords, std::vector<Maths::Vector4>& colours);
-			void BuildInterleavedVerticesForString(const std::string& text, const Maths::Vector2& startPos, const Maths::Vector4& colour, float size, std::vector<InterleavedTextVertex>& vertices);
+			int  GetVertexCountForString(std::string_view text);
+			//Returns how many vertices were written, which is at most GetVertexCountForString
+			int  BuildVerticesForString(std::string_view text, const Maths::Vector2& startPos, const Maths::Vector4& colour, float size, InterleavedTextVertex* vertices);
 			
 			const Texture* GetTexture() const {
 				return &texture;
@@ -0,0 +1,76 @@
+/*
+Part of Newcastle University's Game Engineering source code.
+
+Use as you see fit!
+
+Comments and queries to: richard-gordon.davison AT ncl.ac.uk
+https://research.ncl.ac.uk/game/
+*/
+#pragma once
+#include "CookedData.h"
+#include <vector>
+
+namespace NCL::Rendering {
+	/*
+	On-disk layout of a cooked texture, made from an image file by AssetCooker
+	or TextureLoader::Cook. It holds every mip level, already in the format
+	the GPU samples from, so loading one is a copy per level rather than
+	decoding the image and building its mips.
+	*/
+	namespace TextureData {
+		const uint32_t Magic	= 0x5854534E; //'NSTX'
+		const uint32_t Version	= 1;
+
+		const uint32_t MaxLevels = 16;
+
+		enum Format : uint32_t {
+			RGBA8,	//4 bytes a texel
+			BC1,	//8 bytes per 4x4 block of texels, no alpha
+			BC3,	//16 bytes per 4x4 block of texels, BC1 colour plus interpolated alpha
+			MAX_FORMATS
+		};
+
+		struct Level {
+			uint64_t offset;	//from the start of the file
+			uint64_t size;		//in bytes
+			uint32_t width;
+			uint32_t height;
+		};
+
+		struct Header {
+			CookedData::FileHeader file;
+			uint32_t	format;
+			uint32_t	width;
+			uint32_t	height;
+			uint32_t	levelCount;
+			Level		levels[MaxLevels];
+		};
+
+		inline bool IsCompressed(Format f) {
+			return f == BC1 || f == BC3;
+		}
+
+		inline uint64_t LevelSize(Format f, uint32_t width, uint32_t height) {
+			uint64_t blocks = uint64_t((width + 3) / 4) * ((height + 3) / 4);
+			switch (f) {
+				case RGBA8: return uint64_t(width) * height * 4;
+				case BC1:	return blocks * 8;
+				case BC3:	return blocks * 16;
+				default:	return 0;
+			}
+		}
+
+		//The same as a cooked file holds, but in memory, with each level's offset being into data
+		struct MipChain {
+			Format				format	= RGBA8;
+			uint32_t			width	= 0;
+			uint32_t			height	= 0;
+			std::vector<Level>	levels;
+			std::vector<char>	data;
+
+			const char* GetLevelData(size_t level) const {
+				return data.data() + levels[level].offset;
+			}
+		};
+	}
+}
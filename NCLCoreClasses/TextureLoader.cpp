@@ -12,12 +12,67 @@ https://research.ncl.ac.uk/game/
 #include "./stb/stb_image.h"
 
 #include "Assets.h"
+#include "BlockCompression.h"
+#include "MappedFile.h"
 
 using namespace NCL;
 using namespace Rendering;
 
 std::map<std::string, TextureLoadFunction> TextureLoader::fileHandlers;
 
+namespace {
+	bool LevelIsValid(const MappedFile& file, const TextureData::Level& level, TextureData::Format format, uint32_t width, uint32_t height) {
+		return	level.width		== width &&
+				level.height	== height &&
+				level.size		== TextureData::LevelSize(format, width, height) &&
+				file.GetAt<char>(level.offset, level.size) != nullptr;
+	}
+
+	//Each texel is the average of the (up to) 4 it covers in the level above
+	void Downsample(const uint8_t* source, uint32_t width, uint32_t height, uint8_t* dest, uint32_t destWidth, uint32_t destHeight) {
+		for (uint32_t y = 0; y < destHeight; ++y) {
+			uint32_t y0 = std::min(y * 2, height - 1);
+			uint32_t y1 = std::min(y * 2 + 1, height - 1);
+			for (uint32_t x = 0; x < destWidth; ++x) {
+				uint32_t x0 = std::min(x * 2, width - 1);
+				uint32_t x1 = std::min(x * 2 + 1, width - 1);
+				for (uint32_t c = 0; c < 4; ++c) {
+					uint32_t sum =	source[(y0 * width + x0) * 4 + c] + source[(y0 * width + x1) * 4 + c] +
+									source[(y1 * width + x0) * 4 + c] + source[(y1 * width + x1) * 4 + c];
+					dest[(y * destWidth + x) * 4 + c] = (uint8_t)((sum + 2) / 4);
+				}
+			}
+		}
+	}
+
+	//Custom file handlers don't have to give back 4 channels, so anything else gets expanded out
+	bool LoadRGBA(const std::string& filename, std::vector<char>& rgba, uint32_t& width, uint32_t& height) {
+		char* data		= nullptr;
+		int w			= 0;
+		int h			= 0;
+		int channels	= 0;
+		int flags		= 0;
+		if (!TextureLoader::LoadTexture(filename, data, w, h, channels, flags) || channels < 1 || channels > 4) {
+			return false;
+		}
+		width	= (uint32_t)w;
+		height	= (uint32_t)h;
+		if (channels == 4) {
+			rgba.assign(data, data + (size_t)w * h * 4);
+		}
+		else {
+			rgba.assign((size_t)w * h * 4, (char)255);
+			for (size_t i = 0; i < (size_t)w * h; ++i) {
+				for (int c = 0; c < channels; ++c) {
+					rgba[i * 4 + c] = data[i * channels + c];
+				}
+			}
+		}
+		TextureLoader::DeleteTextureData(data);
+		return true;
+	}
+}
+
 bool TextureLoader::LoadTexture(const std::string& filename, char*& outData, int& width, int &height, int &channels, int&flags) {
 	if (filename.empty()) {
 		return false;
@@ -27,11 +82,9 @@ bool TextureLoader::LoadTexture(const std::string& filename, char*& outData, int
 	
 	std::string extension = path.extension().string();
 
-	bool isAbsolute = path.is_absolute();
-
 	auto it = fileHandlers.find(extension);
 
-	std::string realPath = isAbsolute ? filename : Assets::TEXTUREDIR + filename;
+	std::string realPath = GetTexturePath(filename);
 
 	if (it != fileHandlers.end()) {
 		//There's a custom handler function for this, just use that
@@ -64,4 +117,162 @@ std::string TextureLoader::GetFileExtension(const std::string& fileExtension) {
 
 void TextureLoader::DeleteTextureData(char* data) {
 	free(data);
-}
\ No newline at end of file
+}
+
+std::string TextureLoader::GetTexturePath(const std::string& filename) {
+	return std::filesystem::path(filename).is_absolute() ? filename : Assets::TEXTUREDIR + filename;
+}
+
+bool TextureLoader::LoadCookedTexture(const std::string& filename, TextureData::MipChain& chain) {
+	std::string sourceFile = GetTexturePath(filename);
+	std::string cookedFile = sourceFile + CookedData::CookedExtension;
+
+	return CookedData::CookedFileIsCurrent(sourceFile, cookedFile) && LoadCooked(cookedFile, chain);
+}
+
+bool TextureLoader::LoadMipChain(const std::string& filename, TextureData::MipChain& chain) {
+	if (LoadCookedTexture(filename, chain)) {
+		return true;
+	}
+	std::vector<char> rgba;
+	uint32_t width	= 0;
+	uint32_t height	= 0;
+	if (!LoadRGBA(filename, rgba, width, height)) {
+		return false;
+	}
+	BuildMipChain(rgba.data(), width, height, TextureData::RGBA8, chain);
+	return true;
+}
+
+//As with meshes, every level is checked before any are copied
+bool TextureLoader::LoadCooked(const std::string& filepath, TextureData::MipChain& chain) {
+	MappedFile file;
+	if (!file.Open(filepath)) {
+		return false;
+	}
+	const TextureData::Header* header = file.GetAt<TextureData::Header>(0);
+	if (!header || !CookedData::HeaderIsValid(&header->file, TextureData::Magic, TextureData::Version, sizeof(TextureData::Header), file.GetSize())) {
+		return false;
+	}
+	if (header->format >= TextureData::MAX_FORMATS || header->levelCount == 0 || header->levelCount > TextureData::MaxLevels) {
+		return false;
+	}
+	TextureData::Format format = (TextureData::Format)header->format;
+
+	uint32_t width	= header->width;
+	uint32_t height	= header->height;
+	size_t dataSize	= 0;
+	for (uint32_t i = 0; i < header->levelCount; ++i) {
+		if (!LevelIsValid(file, header->levels[i], format, width, height)) {
+			return false;
+		}
+		dataSize	+= header->levels[i].size;
+		width		= std::max(width / 2, 1u);
+		height		= std::max(height / 2, 1u);
+	}
+
+	chain.format	= format;
+	chain.width		= header->width;
+	chain.height	= header->height;
+	chain.levels.clear();
+	chain.data.clear();
+	chain.data.reserve(dataSize);
+	for (uint32_t i = 0; i < header->levelCount; ++i) {
+		TextureData::Level level = header->levels[i];
+		const char* data = file.GetAt<char>(level.offset, level.size);
+
+		level.offset = chain.data.size();
+		chain.data.insert(chain.data.end(), data, data + level.size);
+		chain.levels.emplace_back(level);
+	}
+	return true;
+}
+
+bool TextureLoader::SaveCooked(const TextureData::MipChain& chain, const std::string& filepath) {
+	if (chain.levels.empty() || chain.levels.size() > TextureData::MaxLevels) {
+		return false;
+	}
+	std::ofstream outfile(filepath, std::ios::binary);
+	if (!outfile) {
+		return false;
+	}
+	TextureData::Header header = {};
+	header.file.magic		= TextureData::Magic;
+	header.file.version		= TextureData::Version;
+	header.file.headerSize	= sizeof(TextureData::Header);
+	header.format			= chain.format;
+	header.width			= chain.width;
+	header.height			= chain.height;
+	header.levelCount		= (uint32_t)chain.levels.size();
+
+	std::vector<char> file(CookedData::AlignOffset(sizeof(TextureData::Header)), 0);
+	for (size_t i = 0; i < chain.levels.size(); ++i) {
+		const char* data = chain.GetLevelData(i);
+
+		header.levels[i]		= chain.levels[i];
+		header.levels[i].offset	= file.size();
+		file.insert(file.end(), data, data + chain.levels[i].size);
+		file.resize(CookedData::AlignOffset(file.size()), 0);
+	}
+	header.file.fileSize = (uint32_t)file.size();
+	memcpy(file.data(), &header, sizeof(header));
+
+	outfile.write(file.data(), file.size());
+	return outfile.good();
+}
+
+void TextureLoader::BuildMipChain(const char* rgba, uint32_t width, uint32_t height, TextureData::Format format, TextureData::MipChain& chain) {
+	chain.format	= format;
+	chain.width		= width;
+	chain.height	= height;
+	chain.levels.clear();
+	chain.data.clear();
+	chain.data.reserve(TextureData::LevelSize(format, width, height) * 4 / 3 + 64);
+
+	std::vector<char> buffers[2];
+	const char* source = rgba;
+	while (true) {
+		TextureData::Level level;
+		level.offset	= chain.data.size();
+		level.size		= TextureData::LevelSize(format, width, height);
+		level.width		= width;
+		level.height	= height;
+		chain.data.resize(chain.data.size() + level.size);
+
+		if (format == TextureData::RGBA8) {
+			memcpy(chain.data.data() + level.offset, source, level.size);
+		}
+		else {
+			BlockCompression::Compress(source, width, height, format, chain.data.data() + level.offset);
+		}
+		chain.levels.emplace_back(level);
+
+		if ((width == 1 && height == 1) || chain.levels.size() == TextureData::MaxLevels) {
+			break;
+		}
+		uint32_t nextWidth	= std::max(width / 2, 1u);
+		uint32_t nextHeight	= std::max(height / 2, 1u);
+
+		std::vector<char>& next = buffers[chain.levels.size() % 2];
+		next.resize((size_t)nextWidth * nextHeight * 4);
+		Downsample((const uint8_t*)source, width, height, (uint8_t*)next.data(), nextWidth, nextHeight);
+
+		source	= next.data();
+		width	= nextWidth;
+		height	= nextHeight;
+	}
+}
+
+bool TextureLoader::Cook(const std::string& filename, const std::string& cookedFilepath, bool compress) {
+	std::vector<char> rgba;
+	uint32_t width	= 0;
+	uint32_t height	= 0;
+	if (!LoadRGBA(filename, rgba, width, height)) {
+		return false;
+	}
+	TextureData::Format format = compress ? BlockCompression::ChooseFormat(rgba.data(), width, height) : TextureData::RGBA8;
+
+	TextureData::MipChain chain;
+	BuildMipChain(rgba.data(), width, height, format, chain);
+	return SaveCooked(chain, cookedFilepath);
+}
@@ -9,6 +9,7 @@ https://research.ncl.ac.uk/game/
 #pragma once
 #include <map>
 #include <functional>
+#include "TextureData.h"
 
 
 namespace NCL {
@@ -27,7 +28,23 @@ namespace NCL {
 		static void RegisterTextureLoadFunction(TextureLoadFunction f, const std::string&fileExtension);
 
 		static void DeleteTextureData(char* data);
+
+		//Loads from the texture directory, only if there's an up to date cooked version of the file
+		static bool LoadCookedTexture(const std::string& filename, Rendering::TextureData::MipChain& chain);
+
+		//Uses the cooked version of the file if there's an up to date one, otherwise builds RGBA8 mips from the image
+		static bool LoadMipChain(const std::string& filename, Rendering::TextureData::MipChain& chain);
+
+		static bool LoadCooked(const std::string& filepath, Rendering::TextureData::MipChain& chain);
+		static bool SaveCooked(const Rendering::TextureData::MipChain& chain, const std::string& filepath);
+
+		//Every level down to 1x1, each a box filtered half of the one before, stored in the given format
+		static void BuildMipChain(const char* rgba, uint32_t width, uint32_t height, Rendering::TextureData::Format format, Rendering::TextureData::MipChain& chain);
+
+		//Turns an image in the texture directory into the cooked format, block compressing it unless told to use RGBA8
+		static bool Cook(const std::string& filename, const std::string& cookedFilepath, bool compress = true);
 	protected:
+		static std::string GetTexturePath(const std::string& filename);
 
 		static std::string GetFileExtension(const std::string& fileExtension);
 
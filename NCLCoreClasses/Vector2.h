@@ -125,11 +125,11 @@ namespace NCL::Maths {
 			y /= f;
 		}
 
-		inline constexpr float operator[](int i) const {
+		inline float operator[](int i) const {
 			return ((float*)this)[i];
 		}
 
-		inline constexpr float& operator[](int i) {
+		inline float& operator[](int i) {
 			return ((float*)this)[i];
 		}
 
@@ -7,6 +7,7 @@ Comments and queries to: richard-gordon.davison AT ncl.ac.uk
 https://research.ncl.ac.uk/game/
 */
 #pragma once
+#include "MathsSIMD.h"
 
 namespace NCL::Maths {
 	class Vector3;
@@ -79,6 +80,16 @@ namespace NCL::Maths {
 			return v;
 		}
 
+		SIMD::Float4 ToSIMD() const {
+			return SIMD::Load(&x);
+		}
+
+		static Vector4 FromSIMD(SIMD::Float4 v) {
+			Vector4 out;
+			SIMD::Store(&out.x, v);
+			return out;
+		}
+
 		static constexpr Vector4 Clamp(const Vector4& input, const Vector4& mins, const Vector4& maxs);
 
 		static constexpr float	Dot(const Vector4 &a, const Vector4 &b) {
@@ -86,31 +97,31 @@ namespace NCL::Maths {
 		}
 
 		inline Vector4  operator+(const Vector4  &a) const {
-			return Vector4(x + a.x, y + a.y, z + a.z, w + a.w);
+			return FromSIMD(SIMD::Add(ToSIMD(), a.ToSIMD()));
 		}
 
 		inline Vector4  operator-(const Vector4  &a) const {
-			return Vector4(x - a.x, y - a.y, z - a.z, w - a.w);
+			return FromSIMD(SIMD::Sub(ToSIMD(), a.ToSIMD()));
 		}
 
 		inline Vector4  operator-() const {
-			return Vector4(-x, -y, -z, -w);
+			return FromSIMD(SIMD::Negate(ToSIMD()));
 		}
 
 		inline Vector4  operator*(float a)	const {
-			return Vector4(x * a, y * a, z * a, w * a);
+			return FromSIMD(SIMD::Mul(ToSIMD(), SIMD::Splat(a)));
 		}
 
 		inline Vector4  operator*(const Vector4  &a) const {
-			return Vector4(x * a.x, y * a.y, z * a.z, w * a.w);
+			return FromSIMD(SIMD::Mul(ToSIMD(), a.ToSIMD()));
 		}
 
 		inline Vector4  operator/(const Vector4  &a) const {
-			return Vector4(x / a.x, y / a.y, z / a.z, w / a.w);
+			return FromSIMD(SIMD::Div(ToSIMD(), a.ToSIMD()));
 		};
 
 		inline Vector4  operator/(float v) const {
-			return Vector4(x / v, y / v, z / v, w / v);
+			return FromSIMD(SIMD::Div(ToSIMD(), SIMD::Splat(v)));
 		};
 
 		inline constexpr void operator+=(const Vector4  &a) {
@@ -121,38 +132,23 @@ namespace NCL::Maths {
 		}
 
 		inline void operator-=(const Vector4  &a) {
-			x -= a.x;
-			y -= a.y;
-			z -= a.z;
-			w -= a.w;
+			*this = *this - a;
 		}
 
 		inline void operator*=(const Vector4  &a) {
-			x *= a.x;
-			y *= a.y;
-			z *= a.z;
-			w *= a.w;
+			*this = *this * a;
 		}
 
 		inline void operator/=(const Vector4  &a) {
-			x /= a.x;
-			y /= a.y;
-			z /= a.z;
-			w /= a.w;
+			*this = *this / a;
 		}
 
 		inline void operator*=(float f) {
-			x *= f;
-			y *= f;
-			z *= f;
-			w *= f;
+			*this = *this * f;
 		}
 
 		inline void operator/=(float f) {
-			x /= f;
-			y /= f;
-			z /= f;
-			w /= f;
+			*this = *this / f;
 		}
 
 		inline float operator[](int i) const {
@@ -1,6 +1,8 @@
 #include "Window.h"
 
-#ifdef _WIN32
+#ifdef USEHEADLESS
+#include "HeadlessWindow.h"
+#elif defined(_WIN32)
 #include "Win32Window.h"
 #endif
 
@@ -34,7 +36,9 @@ Window* Window::CreateGameWindow(std::string title, int sizeX, int sizeY, bool f
 	if (window) {
 		return nullptr;
 	}
-#ifdef _WIN32
+#ifdef USEHEADLESS
+	return new Headless::HeadlessWindow(title, sizeX, sizeY);
+#elif defined(_WIN32)
 	return new Win32Code::Win32Window(title, sizeX, sizeY, fullScreen, offsetX, offsetY);
 #endif
 #ifdef __ORBIS__
@@ -218,7 +218,7 @@ void OGLRenderer::InitWithWin32(Window& w) {
 		return;
 	}
 	//Now we have a temporary context, we can find out if we support OGL 4.x
-	char* ver = (char*)glGetString(GL_VERSION); // ver must equal "4.1.0" (or greater!)
+	char* ver = (char*)glGetString(GL_VERSION); // ver must equal "4.3.0" (or greater!)
 	int major = ver[0] - '0';		//casts the 'correct' major version integer from our version string
 	int minor = ver[2] - '0';		//casts the 'correct' minor version integer from our version string
 
@@ -228,8 +228,9 @@ void OGLRenderer::InitWithWin32(Window& w) {
 		return;
 	}
 
-	if (major == 4 && minor < 1) {	//Graphics hardware does not support ENOUGH of OGL 4! Erk...
-		std::cout << __FUNCTION__ << " Device does not support at least OpenGL 4.1!\n";
+	//Meshes and the debug/instance streams use separate vertex formats (glVertexAttribFormat / glBindVertexBuffer), core in 4.3
+	if (major == 4 && minor < 3) {	//Graphics hardware does not support ENOUGH of OGL 4! Erk...
+		std::cout << __FUNCTION__ << " Device does not support at least OpenGL 4.3!\n";
 		wglDeleteContext(tempContext);
 		return;
 	}
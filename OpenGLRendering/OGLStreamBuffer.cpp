@@ -0,0 +1,109 @@
+/******************************************************************************
+This file is part of the Newcastle OpenGL Tutorial Series
+
+Author:Rich Davison
+Contact:richgdavison@gmail.com
+License: MIT (see LICENSE file at the top of the source tree)
+*/////////////////////////////////////////////////////////////////////////////
+#include "OGLStreamBuffer.h"
+
+using namespace NCL;
+using namespace Rendering;
+
+//Keeps every section start suitably aligned for any use of the buffer
+const size_t SECTION_ALIGNMENT = 256;
+
+const GLbitfield STREAM_MAP_FLAGS = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+//The section was orphaned along with the rest of the buffer, so nothing can still be reading it
+const GLbitfield ORPHAN_MAP_FLAGS = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+
+OGLStreamBuffer::OGLStreamBuffer(size_t sectionSize, int sectionCount) {
+	this->sectionCount	= sectionCount;
+	currentSection		= 0;
+	persistent			= GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage;
+	fences.resize(sectionCount, nullptr);
+	Create(sectionSize);
+}
+
+OGLStreamBuffer::~OGLStreamBuffer() {
+	Destroy();
+}
+
+void OGLStreamBuffer::Create(size_t newSectionSize) {
+	sectionSize = (newSectionSize + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+
+	glGenBuffers(1, &bufferID);
+	glBindBuffer(GL_ARRAY_BUFFER, bufferID);
+	if (persistent) {
+		glBufferStorage(GL_ARRAY_BUFFER, sectionSize * sectionCount, nullptr, STREAM_MAP_FLAGS);
+		mappedData = (char*)glMapBufferRange(GL_ARRAY_BUFFER, 0, sectionSize * sectionCount, STREAM_MAP_FLAGS);
+	}
+	else {
+		glBufferData(GL_ARRAY_BUFFER, sectionSize * sectionCount, nullptr, GL_STREAM_DRAW);
+		mappedData = nullptr;
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void OGLStreamBuffer::Destroy() {
+	for (int i = 0; i < sectionCount; ++i) {
+		WaitForSection(i);
+	}
+	if (persistent) {
+		glBindBuffer(GL_ARRAY_BUFFER, bufferID);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+	glDeleteBuffers(1, &bufferID);
+
+	bufferID	= 0;
+	mappedData	= nullptr;
+}
+
+void OGLStreamBuffer::WaitForSection(int section) {
+	GLsync& fence = fences[section];
+	if (!fence) {
+		return;
+	}
+	GLenum result = GL_TIMEOUT_EXPIRED;
+	while (result == GL_TIMEOUT_EXPIRED) {
+		result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+	}
+	glDeleteSync(fence);
+	fence = nullptr;
+}
+
+void* OGLStreamBuffer::Begin(size_t size) {
+	if (size > sectionSize) {
+		Destroy();
+		Create(std::max(size, sectionSize * 2));
+	}
+	if (persistent) {
+		WaitForSection(currentSection);
+		return mappedData + GetOffset();
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, bufferID);
+	if (currentSection == 0) {
+		glBufferData(GL_ARRAY_BUFFER, sectionSize * sectionCount, nullptr, GL_STREAM_DRAW);
+	}
+	mappedData = (char*)glMapBufferRange(GL_ARRAY_BUFFER, GetOffset(), sectionSize, ORPHAN_MAP_FLAGS);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	return mappedData;
+}
+
+void OGLStreamBuffer::Flush() {
+	if (persistent) {
+		return;
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, bufferID);
+	glUnmapBuffer(GL_ARRAY_BUFFER);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	mappedData = nullptr;
+}
+
+void OGLStreamBuffer::End() {
+	if (persistent) {
+		fences[currentSection] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+	currentSection = (currentSection + 1) % sectionCount;
+}
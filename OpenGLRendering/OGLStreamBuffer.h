@@ -0,0 +1,62 @@
+/******************************************************************************
+This file is part of the Newcastle OpenGL Tutorial Series
+
+Author:Rich Davison
+Contact:richgdavison@gmail.com
+License: MIT (see LICENSE file at the top of the source tree)
+*/////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "glad\gl.h"
+
+namespace NCL::Rendering {
+	/*
+	For data that's rewritten every frame, such as debug geometry and instance
+	values. The buffer is mapped once, persistently, and split into sections
+	used round robin, so the CPU writes one frame's data straight into the
+	buffer while the GPU may still be reading the previous frames'. A fence is
+	placed after each frame's draws, and only waited on when that section
+	comes round again - with three sections, that's almost never.
+
+	If a frame asks for more than a section holds, the buffer is recreated
+	larger, so the section size should be picked to cover the usual case.
+
+	Without GL 4.4 / ARB_buffer_storage, the buffer can't stay mapped while
+	drawing. Instead each section is mapped in Begin and unmapped in Flush,
+	and the whole buffer is orphaned whenever the sections wrap around, so
+	the driver hands back fresh storage rather than stalling on the old.
+	*/
+	class OGLStreamBuffer	{
+	public:
+		OGLStreamBuffer(size_t sectionSize, int sectionCount = 3);
+		~OGLStreamBuffer();
+
+		//Waits until the GPU is done with the next section, and returns where to write up to size bytes
+		void*	Begin(size_t size);
+		//Call once the data is written, before any draw reads from the section
+		void	Flush();
+		//Call once every draw reading from the section has been issued
+		void	End();
+
+		GLuint	GetBufferID() const {
+			return bufferID;
+		}
+		//Where the section being written starts, to add to any offsets when binding the buffer
+		size_t	GetOffset() const {
+			return currentSection * sectionSize;
+		}
+
+	protected:
+		void Create(size_t newSectionSize);
+		void Destroy();
+		void WaitForSection(int section);
+
+		GLuint	bufferID;
+		char*	mappedData;
+		size_t	sectionSize;
+		int		sectionCount;
+		int		currentSection;
+		bool	persistent;
+
+		std::vector<GLsync> fences;
+	};
+}
@@ -54,7 +54,42 @@ UniqueOGLTexture OGLTexture::TextureFromData(char* data, int width, int height,
 	return tex;
 }
 
+UniqueOGLTexture OGLTexture::TextureFromMipChain(const TextureData::MipChain& chain) {
+	UniqueOGLTexture tex = std::make_unique<OGLTexture>();
+	tex->dimensions = { (int)chain.width, (int)chain.height };
+
+	glBindTexture(GL_TEXTURE_2D, tex->texID);
+
+	for (size_t i = 0; i < chain.levels.size(); ++i) {
+		const TextureData::Level& level = chain.levels[i];
+		const char* data = chain.GetLevelData(i);
+
+		switch (chain.format) {
+			case TextureData::BC1:
+				glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)i, GL_COMPRESSED_RGB_S3TC_DXT1_EXT, level.width, level.height, 0, (GLsizei)level.size, data);
+				break;
+			case TextureData::BC3:
+				glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)i, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, level.width, level.height, 0, (GLsizei)level.size, data);
+				break;
+			default:
+				glTexImage2D(GL_TEXTURE_2D, (GLint)i, GL_RGBA, level.width, level.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+				break;
+		}
+	}
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)chain.levels.size() - 1);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	return tex;
+}
+
 UniqueOGLTexture OGLTexture::TextureFromFile(const std::string&name) {
+	TextureData::MipChain chain;
+	if (TextureLoader::LoadCookedTexture(name, chain)) {
+		return TextureFromMipChain(chain);
+	}
 	char* texData	= nullptr;
 	int width		= 0;
 	int height		= 0;
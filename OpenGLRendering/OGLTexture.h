@@ -7,6 +7,7 @@ License: MIT (see LICENSE file at the top of the source tree)
 */////////////////////////////////////////////////////////////////////////////
 #pragma once
 #include "Texture.h"
+#include "TextureData.h"
 #include "glad\gl.h"
 
 namespace NCL::Rendering {		
@@ -21,6 +22,10 @@ namespace NCL::Rendering {
 
 		static UniqueOGLTexture TextureFromData(char* data, int width, int height, int channels);
 
+		//Every level is uploaded as it is, rather than being generated on the GPU
+		static UniqueOGLTexture TextureFromMipChain(const TextureData::MipChain& chain);
+
+		//Uses the cooked version of the file if there's an up to date one
 		static UniqueOGLTexture TextureFromFile(const std::string&name);
 
 		static UniqueOGLTexture LoadCubemap(
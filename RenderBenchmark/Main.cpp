@@ -0,0 +1,995 @@
+/*
+Checks and times the parts of rendering, and of handling static level
+geometry, that don't need a window or a graphics API, against simple brute
+force versions of the same thing.
+
+Usage: RenderBenchmark [iterations]
+Frustum::FromViewProjMatrix is checked by testing random points against its
+planes and against the clip space the matrix takes them into. FrustumCuller
+is checked by culling random boxes and comparing the results with testing
+all 8 corners of each box against each plane. Anything within rounding of
+a plane is left out of the comparisons, as either answer is right for it.
+The culls are then repeated iterations times (100 by default), and the
+fastest pass of each is reported in milliseconds.
+
+RenderQueue is checked by sorting random objects, and comparing its commands
+with sorting the same keys with std::stable_sort, and with the order the
+keys are meant to give. The shaders, textures and meshes are never used,
+so the objects just point at bytes of a buffer to give them identities.
+
+StaticCollisionGrid is checked by querying random boxes against random walls,
+and comparing what it finds with testing every wall. StaticBatcher is checked
+by making sure every triangle of every batched wall ends up in its batch's
+mesh in the same place its transform would put it, and that it refuses walls
+whose mesh hasn't loaded yet.
+
+IndirectDrawLayout is checked by packing random objects into it, running its
+copy of the test cullObjects.comp does, and comparing the instances and the
+per mesh draw counts that gives with what FrustumCuller finds visible, over
+two frames so that freed and reused slots are covered too.
+
+RenderExtractor is checked by extracting a world of moving objects, some
+static and some inactive, with and without a JobSystem, and making sure the
+two give byte for byte the same packets, frame after frame.
+
+Debug drawing is checked by drawing lines and strings from every JobSystem
+worker at once, and making sure Flush gathers each of them exactly once, that
+anything over a thread's limits is counted as dropped rather than lost, that
+timed lines expire on time, and that threads coming and going reuse each
+other's buffers. It's worth building this one with -fsanitize=thread too.
+
+Build with optimisations on, or the numbers won't mean much.
+*/
+#include "Frustum.h"
+#include "FrustumCuller.h"
+#include "Matrix4.h"
+#include "Vector4.h"
+#include "FramePacket.h"
+#include "RenderQueue.h"
+#include "GameObject.h"
+#include "AABBVolume.h"
+#include "RenderObject.h"
+#include "StaticCollisionGrid.h"
+#include "StaticBatcher.h"
+#include "IndirectDrawLayout.h"
+#include "Mesh.h"
+#include "Debug.h"
+#include "JobSystem.h"
+#include "GameWorld.h"
+
+using namespace NCL;
+using namespace Maths;
+using namespace CSC8503;
+
+namespace {
+	const size_t	BOX_COUNT			= 100000;
+	const size_t	POINT_COUNT			= 100000;
+	const int		DEFAULT_ITERATIONS	= 100;
+	const float		SCENE_SIZE			= 600.0f;
+	const float		EDGE_TOLERANCE		= 1e-2f;	//in world units
+
+	const size_t	QUEUE_OBJECT_COUNT	= 20000;
+	const int		QUEUE_SHADERS		= 8;
+	const int		QUEUE_TEXTURES		= 64;
+	const int		QUEUE_MESHES		= 32;
+	const float		DEPTH_PRECISION		= 1.0f / 2048.0f;	//how much two depths can differ and still share a key
+
+	const size_t	WALL_COUNT			= 500;
+	const size_t	WALL_QUERY_COUNT	= 20000;
+	const float		WALL_AREA			= 200.0f;
+
+	const size_t	INDIRECT_OBJECT_COUNT	= 20000;
+	const int		INDIRECT_SHADERS		= 4;
+	const int		INDIRECT_TEXTURES		= 16;
+
+	const size_t	EXTRACT_OBJECT_COUNT	= 20000;
+	const int		EXTRACT_FRAMES			= 4;
+	const int		EXTRACT_STATIC_EVERY	= 10;
+	const int		EXTRACT_THREADS			= 4;
+
+	const size_t	DEBUG_LINE_COUNT		= 20000;
+	const size_t	DEBUG_OVERFLOW_COUNT	= 1 << 19;	//more than every thread can hold between them
+	const size_t	DEBUG_STRING_EVERY		= 50;	//few enough for one thread to hold them all
+	const size_t	DEBUG_TIMED_EVERY		= 100;
+	const float		DEBUG_LINE_TIME			= 0.5f;
+	const int		DEBUG_THREAD_ROUNDS		= 10;
+	const int		DEBUG_THREADS			= 4;
+
+	using Clock = std::chrono::high_resolution_clock;
+
+	struct TestView {
+		const char* name;
+		Matrix4		viewProj;
+	};
+
+	std::vector<TestView> MakeViews() {
+		return {
+			{ "Perspective", Matrix4::Perspective(1.0f, 1000.0f, 16.0f / 9.0f, 45.0f)
+				* Matrix4::BuildViewMatrix(Vector3(0, 20, 0), Vector3(100, 0, -300), Vector3(0, 1, 0)) },
+			{ "Orthographic", Matrix4::Orthographic(-200.0f, 200.0f, -150.0f, 150.0f, 0.0f, 800.0f)
+				* Matrix4::BuildViewMatrix(Vector3(300, 300, 300), Vector3(0, 0, 0), Vector3(0, 1, 0)) },
+		};
+	}
+
+	struct Box {
+		Vector3 centre;
+		Vector3 half;
+	};
+
+	std::vector<Box> MakeBoxes(size_t count) {
+		std::mt19937 generator(8503);
+		std::uniform_real_distribution<float> position(-SCENE_SIZE, SCENE_SIZE);
+		std::uniform_real_distribution<float> size(0.1f, 10.0f);
+
+		std::vector<Box> boxes;
+		for (size_t i = 0; i < count; ++i) {
+			boxes.push_back({ Vector3(position(generator), position(generator), position(generator)),
+							  Vector3(size(generator), size(generator), size(generator)) });
+		}
+		return boxes;
+	}
+
+	bool InClipSpace(const Matrix4& viewProj, const Vector3& p) {
+		Vector4 clip = viewProj * Vector4(p.x, p.y, p.z, 1.0f);
+		return clip.w > 0.0f && std::abs(clip.x) <= clip.w && std::abs(clip.y) <= clip.w && std::abs(clip.z) <= clip.w;
+	}
+
+	//1 if a point is clearly inside the clip volume, 0 if it's clearly outside, and -1 if it's
+	//too close to the edge to say. Depth isn't linear in clip space, so the test is done on the
+	//corners of a tiny world space cube around the point, rather than by how close to w it is.
+	int ClassifyPoint(const Matrix4& viewProj, const Vector3& p) {
+		int inside = 0;
+		for (int corner = 0; corner < 8; ++corner) {
+			Vector3 offset(
+				(corner & 1) ? EDGE_TOLERANCE : -EDGE_TOLERANCE,
+				(corner & 2) ? EDGE_TOLERANCE : -EDGE_TOLERANCE,
+				(corner & 4) ? EDGE_TOLERANCE : -EDGE_TOLERANCE);
+			inside += InClipSpace(viewProj, p + offset);
+		}
+		return inside == 8 ? 1 : (inside == 0 ? 0 : -1);
+	}
+
+	bool CheckFrustum(const TestView& view) {
+		std::mt19937 generator(8503);
+		std::uniform_real_distribution<float> position(-SCENE_SIZE, SCENE_SIZE);
+		Frustum frustum = Frustum::FromViewProjMatrix(view.viewProj);
+
+		size_t inside		= 0;
+		size_t mismatches	= 0;
+		for (size_t i = 0; i < POINT_COUNT; ++i) {
+			Vector3 p(position(generator), position(generator), position(generator));
+			int expected = ClassifyPoint(view.viewProj, p);
+			if (expected < 0) {
+				continue;
+			}
+			bool inPlanes = true;
+			for (int j = 0; j < 6; ++j) {
+				inPlanes &= frustum.GetPlane(j).DistanceFromPlane(p) >= 0.0f;
+			}
+			inside		+= expected;
+			mismatches	+= inPlanes != (expected == 1);
+		}
+		bool passed = mismatches == 0 && inside > 0;
+		std::cout << "Frustum points\t" << view.name << "\t" << POINT_COUNT << "\t" << inside << "\t" << mismatches << (passed ? "" : "\tFAILED") << "\n";
+		return passed;
+	}
+
+	//The furthest distance any of the box's corners is in front of the plane
+	float FurthestCorner(const Plane& plane, const Box& b) {
+		float furthest = -FLT_MAX;
+		for (int corner = 0; corner < 8; ++corner) {
+			Vector3 p = b.centre + Vector3(
+				(corner & 1) ? b.half.x : -b.half.x,
+				(corner & 2) ? b.half.y : -b.half.y,
+				(corner & 4) ? b.half.z : -b.half.z);
+			furthest = std::max(furthest, plane.DistanceFromPlane(p));
+		}
+		return furthest;
+	}
+
+	void BruteForceCull(const Frustum& frustum, const std::vector<Box>& boxes, std::vector<int>& outVisible) {
+		outVisible.clear();
+		for (size_t i = 0; i < boxes.size(); ++i) {
+			bool visible = true;
+			for (int p = 0; p < 6 && visible; ++p) {
+				visible = FurthestCorner(frustum.GetPlane(p), boxes[i]) > 0.0f;
+			}
+			if (visible) {
+				outVisible.push_back((int)i);
+			}
+		}
+	}
+
+	bool CheckCuller(const TestView& view, const std::vector<Box>& boxes, int iterations) {
+		Frustum frustum = Frustum::FromViewProjMatrix(view.viewProj);
+
+		FrustumCuller culler;
+		culler.Reserve(boxes.size());
+		for (const Box& b : boxes) {
+			culler.AddBox(b.centre, b.half);
+		}
+
+		std::vector<int> visible;
+		std::vector<int> bruteVisible;
+		float ms		= FLT_MAX;
+		float bruteMS	= FLT_MAX;
+		for (int pass = 0; pass < iterations; ++pass) {
+			auto start = Clock::now();
+			BruteForceCull(frustum, boxes, bruteVisible);
+			bruteMS = std::min(bruteMS, std::chrono::duration<float, std::milli>(Clock::now() - start).count());
+
+			start = Clock::now();
+			culler.Cull(frustum, visible);
+			ms = std::min(ms, std::chrono::duration<float, std::milli>(Clock::now() - start).count());
+		}
+
+		//Only boxes clearly in or clearly out are compared
+		std::vector<uint8_t> culled(boxes.size(), 1);
+		for (int i : visible) {
+			culled[i] = 0;
+		}
+		size_t mismatches = 0;
+		for (size_t i = 0; i < boxes.size(); ++i) {
+			bool clearlyIn	= true;
+			bool clearlyOut	= false;
+			for (int p = 0; p < 6; ++p) {
+				float furthest = FurthestCorner(frustum.GetPlane(p), boxes[i]);
+				clearlyIn	&= furthest > EDGE_TOLERANCE;
+				clearlyOut	|= furthest < -EDGE_TOLERANCE;
+			}
+			if ((clearlyIn && culled[i]) || (clearlyOut && !culled[i])) {
+				mismatches++;
+			}
+			//A box with its centre in clip space can never be culled, whatever the planes say
+			if (culled[i] && ClassifyPoint(view.viewProj, boxes[i].centre) == 1) {
+				mismatches++;
+			}
+		}
+		bool passed = mismatches == 0 && !visible.empty();
+		std::cout << "Box culling\t" << view.name << "\t" << boxes.size() << "\t" << visible.size() << "\t" << mismatches
+			<< "\t" << bruteMS << "\t" << ms << "\t" << (bruteMS / ms) << "x" << (passed ? "" : "\tFAILED") << "\n";
+		return passed;
+	}
+
+	struct QueueInputs {
+		std::vector<RenderItem>	items;
+		std::vector<float>		depths;
+		std::vector<char>		identities;
+	};
+
+	QueueInputs MakeQueueInputs(size_t count) {
+		std::mt19937 generator(8503);
+		std::uniform_int_distribution<int>		shader(0, QUEUE_SHADERS - 1);
+		std::uniform_int_distribution<int>		texture(0, QUEUE_TEXTURES);	//the top one means no texture
+		std::uniform_int_distribution<int>		mesh(0, QUEUE_MESHES - 1);
+		std::uniform_real_distribution<float>	depth(0.0f, 1000.0f);
+		std::uniform_real_distribution<float>	chance(0.0f, 1.0f);
+
+		QueueInputs in;
+		in.identities.resize(QUEUE_SHADERS + QUEUE_TEXTURES + QUEUE_MESHES);
+		char* base = in.identities.data();
+
+		in.items.resize(count);
+		for (RenderItem& item : in.items) {
+			int t = texture(generator);
+			item.shader		= (Shader*)(base + shader(generator));
+			item.texture	= t == QUEUE_TEXTURES ? nullptr : (Texture*)(base + QUEUE_SHADERS + t);
+			item.mesh		= (Mesh*)(base + QUEUE_SHADERS + QUEUE_TEXTURES + mesh(generator));
+			item.colour		= Vector4(1, 1, 1, chance(generator) < 0.1f ? 0.5f : 1.0f);
+			in.depths.emplace_back(depth(generator));
+		}
+		return in;
+	}
+
+	//Builds the same keys as the queue, but sorts them with std::stable_sort
+	void ReferenceSort(const QueueInputs& in, std::vector<const RenderItem*>& outOrder) {
+		std::unordered_map<const void*, uint32_t> ids[3];
+		auto GetID = [&](int type, const void* p, uint32_t maxID) {
+			if (!p) {
+				return 0u;
+			}
+			auto i = ids[type].insert({ p, (uint32_t)ids[type].size() + 1 }).first;
+			return std::min(i->second, maxID);
+		};
+		std::vector<std::pair<uint64_t, const RenderItem*>> keys;
+		for (size_t i = 0; i < in.items.size(); ++i) {
+			const RenderItem& o = in.items[i];
+			RenderPass pass = o.colour.w < 1.0f ? RenderPass::Transparent : RenderPass::Opaque;
+			//Capped the same as the queue's 12, 14 and 14 bit fields
+			uint32_t shaderID	= GetID(0, o.shader, 4095);
+			uint32_t textureID	= GetID(1, o.texture, 16383);
+			uint32_t meshID		= GetID(2, o.mesh, 16383);
+			keys.push_back({ RenderQueue::BuildKey(pass, shaderID, textureID, meshID, in.depths[i]), &o });
+		}
+		std::stable_sort(keys.begin(), keys.end(),
+			[](const auto& a, const auto& b) { return a.first < b.first; }
+		);
+		outOrder.clear();
+		for (const auto& k : keys) {
+			outOrder.push_back(k.second);
+		}
+	}
+
+	//Opaque objects grouped by shader, texture then mesh, nearest first, then transparent ones furthest first
+	bool InQueueOrder(const QueueInputs& in, const RenderItem* a, const RenderItem* b) {
+		bool aTransparent = a->colour.w < 1.0f;
+		bool bTransparent = b->colour.w < 1.0f;
+		if (aTransparent != bTransparent) {
+			return !aTransparent;
+		}
+		float aDepth = in.depths[a - in.items.data()];
+		float bDepth = in.depths[b - in.items.data()];
+		if (aTransparent) {
+			return aDepth * (1.0f + DEPTH_PRECISION) >= bDepth;
+		}
+		//Ids are given out in the order things are first seen, so groups can only be checked for being contiguous here
+		if (a->shader != b->shader || a->texture != b->texture || a->mesh != b->mesh) {
+			return true;
+		}
+		return aDepth <= bDepth * (1.0f + DEPTH_PRECISION);
+	}
+
+	bool CheckRenderQueue(int iterations) {
+		const QueueInputs in = MakeQueueInputs(QUEUE_OBJECT_COUNT);
+
+		RenderQueue queue;
+		std::vector<const RenderItem*> reference;
+		float ms			= FLT_MAX;
+		float referenceMS	= FLT_MAX;
+		for (int pass = 0; pass < iterations; ++pass) {
+			auto start = Clock::now();
+			ReferenceSort(in, reference);
+			referenceMS = std::min(referenceMS, std::chrono::duration<float, std::milli>(Clock::now() - start).count());
+
+			start = Clock::now();
+			queue.Clear();
+			for (size_t i = 0; i < in.items.size(); ++i) {
+				queue.Add(&in.items[i], in.depths[i]);
+			}
+			queue.Sort();
+			ms = std::min(ms, std::chrono::duration<float, std::milli>(Clock::now() - start).count());
+		}
+
+		const std::vector<RenderCommand>& commands = queue.GetCommands();
+		size_t mismatches = commands.size() == reference.size() ? 0 : 1;
+		std::set<std::tuple<const Shader*, const Texture*, const Mesh*>> groupsSeen;
+		for (size_t i = 0; i < commands.size() && i < reference.size(); ++i) {
+			const RenderItem* o		= commands[i].object;
+			const RenderItem* last	= i > 0 ? commands[i - 1].object : nullptr;
+			uint8_t changes = 0;
+			if (!last || o->shader != last->shader) {
+				changes |= RenderQueue::ShaderChange;
+			}
+			if (!last || o->texture != last->texture) {
+				changes |= RenderQueue::TextureChange;
+			}
+			if (!last || o->mesh != last->mesh) {
+				changes |= RenderQueue::MeshChange;
+			}
+			bool newGroup = !last || (changes != 0) || (last->colour.w < 1.0f) != (o->colour.w < 1.0f);
+			//An opaque group must never be started twice
+			bool repeatGroup = newGroup && o->colour.w >= 1.0f && !groupsSeen.insert({ o->shader, o->texture, o->mesh }).second;
+
+			if (o != reference[i] || commands[i].changes != changes || repeatGroup || (last && !InQueueOrder(in, last, o))) {
+				mismatches++;
+			}
+		}
+		bool passed = mismatches == 0;
+		std::cout << "Render queue\t" << commands.size() << "\t" << mismatches << "\t" << queue.GetShaderChangeCount() << "\t"
+			<< queue.GetTextureChangeCount() << "\t" << queue.GetMeshChangeCount() << "\t" << referenceMS << "\t" << ms << "\t"
+			<< (referenceMS / ms) << "x" << (passed ? "" : "\tFAILED") << "\n";
+		return passed;
+	}
+
+	//Never drawn, so there's nothing to upload
+	class TestMesh : public Mesh {
+	public:
+		void UploadToGPU(Rendering::RendererBase* renderer) override {
+		}
+	};
+
+	TestMesh* MakeCubeMesh() {
+		TestMesh* m = new TestMesh();
+		std::vector<Vector3> positions;
+		for (int corner = 0; corner < 8; ++corner) {
+			positions.emplace_back((corner & 1) ? 0.5f : -0.5f, (corner & 2) ? 0.5f : -0.5f, (corner & 4) ? 0.5f : -0.5f);
+		}
+		m->SetPrimitiveType(GeometryPrimitive::Triangles);
+		m->SetVertexPositions(positions);
+		m->SetVertexIndices({
+			0, 2, 1, 1, 2, 3,	4, 5, 6, 5, 7, 6,
+			0, 1, 4, 1, 5, 4,	2, 6, 3, 3, 6, 7,
+			0, 4, 2, 2, 4, 6,	1, 3, 5, 3, 7, 5
+		});
+		return m;
+	}
+
+	//Walls as TutorialGame::AddWallToWorld makes them, in a few colours so there's more than one batch per chunk
+	std::vector<GameObject*> MakeWalls(size_t count, Mesh* mesh) {
+		std::mt19937 generator(8503);
+		std::uniform_real_distribution<float>	position(-WALL_AREA, WALL_AREA);
+		std::uniform_real_distribution<float>	size(0.5f, 20.0f);
+		std::uniform_int_distribution<int>		colour(0, 2);
+
+		std::vector<GameObject*> walls;
+		for (size_t i = 0; i < count; ++i) {
+			Vector3 halfSize(size(generator), size(generator) * 0.25f, size(generator));
+			GameObject* wall = new GameObject();
+			wall->SetBoundingVolume(new AABBVolume(halfSize));
+			wall->GetTransform()
+				.SetScale(halfSize * 2)
+				.SetPosition(Vector3(position(generator), 0, position(generator)));
+			wall->SetRenderObject(new RenderObject(&wall->GetTransform(), mesh, nullptr, nullptr));
+			wall->GetRenderObject()->SetColour(Vector4((float)colour(generator), 0, 0, 1));
+			walls.emplace_back(wall);
+		}
+		return walls;
+	}
+
+	bool Overlaps(GameObject* wall, const Vector3& position, const Vector3& halfSize) {
+		Vector3 wallPos		= wall->GetTransform().GetPosition();
+		Vector3 wallHalf	= ((AABBVolume*)wall->GetBoundingVolume())->GetHalfDimensions();
+		for (int axis = 0; axis < 3; ++axis) {
+			if (std::abs(wallPos[axis] - position[axis]) > wallHalf[axis] + halfSize[axis]) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool CheckStaticGrid(const std::vector<GameObject*>& walls, int iterations) {
+		StaticCollisionGrid grid;
+		for (GameObject* w : walls) {
+			grid.Add(w);
+		}
+		grid.Build();
+
+		std::mt19937 generator(8503);
+		std::uniform_real_distribution<float> position(-WALL_AREA * 1.2f, WALL_AREA * 1.2f);
+		std::uniform_real_distribution<float> size(0.5f, 10.0f);
+		std::vector<std::pair<Vector3, Vector3>> queries;
+		for (size_t i = 0; i < WALL_QUERY_COUNT; ++i) {
+			queries.push_back({ Vector3(position(generator), position(generator) * 0.05f, position(generator)),
+								Vector3(size(generator), size(generator), size(generator)) });
+		}
+
+		std::vector<GameObject*> found;
+		size_t hits			= 0;
+		size_t mismatches	= 0;
+		for (const auto& [pos, half] : queries) {
+			grid.Query(pos, half, found);
+			std::set<GameObject*> unique(found.begin(), found.end());
+			size_t expected = 0;
+			for (GameObject* w : walls) {
+				bool overlaps = Overlaps(w, pos, half);
+				expected	+= overlaps;
+				mismatches	+= overlaps != (unique.count(w) > 0);
+			}
+			mismatches	+= unique.size() != found.size();	//everything should only be found once
+			hits		+= expected;
+		}
+
+		//Both timed loops count their hits, and each pass must agree with the
+		//checked count above, so neither loop can be optimised away
+		float ms		= FLT_MAX;
+		float bruteMS	= FLT_MAX;
+		for (int pass = 0; pass < std::max(1, iterations / 10); ++pass) {
+			size_t bruteHits	= 0;
+			size_t gridHits		= 0;
+			auto start = Clock::now();
+			for (const auto& [pos, half] : queries) {
+				for (GameObject* w : walls) {
+					bruteHits += Overlaps(w, pos, half);
+				}
+			}
+			bruteMS = std::min(bruteMS, std::chrono::duration<float, std::milli>(Clock::now() - start).count());
+
+			start = Clock::now();
+			for (const auto& [pos, half] : queries) {
+				grid.Query(pos, half, found);
+				gridHits += found.size();
+			}
+			ms = std::min(ms, std::chrono::duration<float, std::milli>(Clock::now() - start).count());
+
+			mismatches += (bruteHits != hits) + (gridHits != hits);
+		}
+		bool passed = mismatches == 0 && hits > 0;
+		std::cout << "Static grid\t" << queries.size() << "\t" << hits << "\t" << mismatches << "\t" << bruteMS << "\t" << ms << "\t"
+			<< (bruteMS / ms) << "x" << (passed ? "" : "\tFAILED") << "\n";
+		return passed;
+	}
+
+	bool CheckStaticBatcher(const std::vector<GameObject*>& walls) {
+		StaticBatcher batcher;
+		size_t rejected = 0;
+		for (GameObject* w : walls) {
+			rejected += !batcher.Add(w->GetRenderObject());
+		}
+
+		size_t triangles	= 0;
+		size_t mismatches	= rejected;
+		std::set<const RenderObject*> batched;
+		for (const StaticBatch& b : batcher.GetBatches()) {
+			TestMesh mesh;
+			StaticBatcher::BuildMesh(b, mesh);
+			const std::vector<Vector3>&			positions	= mesh.GetPositionData();
+			const std::vector<unsigned int>&	indices		= mesh.GetIndexData();
+
+			//Objects are baked in the order they're in the batch, so their indices follow on from each other
+			size_t nextIndex = 0;
+			for (const RenderObject* o : b.objects) {
+				batched.insert(o);
+				Matrix4 modelMatrix = o->GetTransform()->GetMatrix();
+				const Mesh* source	= o->GetMesh();
+				for (unsigned int index : source->GetIndexData()) {
+					if (nextIndex >= indices.size()) {
+						mismatches++;
+						break;
+					}
+					Vector3 expected	= modelMatrix * source->GetPositionData()[index];
+					Vector3 baked		= positions[indices[nextIndex++]];
+					mismatches += (expected - baked).Length() > 0.0f;
+				}
+				triangles += source->GetIndexData().size() / 3;
+			}
+			mismatches += nextIndex != indices.size();
+		}
+		mismatches += batched.size() != walls.size();
+
+		//A wall whose mesh is still loading has to be refused, so it can be drawn by itself
+		auto loadingSlot = std::make_shared<AssetSlot<Mesh>>();
+		loadingSlot->placeholder = walls[0]->GetRenderObject()->GetMesh();
+		RenderObject loadingWall(&walls[0]->GetTransform(), MeshHandle(loadingSlot), nullptr, nullptr);
+		mismatches += batcher.Add(&loadingWall);
+
+		bool passed = mismatches == 0;
+		std::cout << "Static batches\t" << walls.size() << "\t" << batcher.GetBatches().size() << "\t" << triangles << "\t" << mismatches
+			<< (passed ? "" : "\tFAILED") << "\n";
+		return passed;
+	}
+
+	/*
+	Objects for the indirect draw layout, over a few meshes: a cube drawn in
+	one go, a cube split into two sub meshes, and a line mesh that the layout
+	has to leave for the render queue. Some objects are see through, which it
+	has to leave alone too. The shaders and textures are never used, so they
+	just point at bytes of a buffer to give them identities.
+	*/
+	struct IndirectInputs {
+		std::vector<TestMesh*>	meshes;
+		std::vector<char>		identities;
+		std::vector<RenderItem>	items;
+	};
+
+	RenderItem MakeIndirectItem(IndirectInputs& in, const Box& box, std::mt19937& generator) {
+		std::uniform_int_distribution<int>		shader(0, INDIRECT_SHADERS - 1);
+		std::uniform_int_distribution<int>		texture(0, INDIRECT_TEXTURES);	//the top one means no texture
+		std::uniform_int_distribution<size_t>	mesh(0, in.meshes.size() - 1);
+		std::uniform_real_distribution<float>	chance(0.0f, 1.0f);
+
+		int t = texture(generator);
+		RenderItem item;
+		item.modelMatrix	= Matrix4::Translation(box.centre) * Matrix4::Scale(box.half * 2);
+		item.colour			= Vector4(1, 1, 1, chance(generator) < 0.1f ? 0.5f : 1.0f);
+		item.boundsCentre	= box.centre;
+		item.boundsHalf		= box.half;
+		item.mesh			= in.meshes[mesh(generator)];
+		item.shader			= (Shader*)(in.identities.data() + shader(generator));
+		item.texture		= t == INDIRECT_TEXTURES ? nullptr : (Texture*)(in.identities.data() + INDIRECT_SHADERS + t);
+		return item;
+	}
+
+	IndirectInputs MakeIndirectInputs(const std::vector<Box>& boxes) {
+		IndirectInputs in;
+		in.meshes.emplace_back(MakeCubeMesh());
+		in.meshes.emplace_back(MakeCubeMesh());
+		in.meshes.back()->AddSubMesh(0, 18, 0);
+		in.meshes.back()->AddSubMesh(18, 18, 0);
+		in.meshes.emplace_back(MakeCubeMesh());
+		in.meshes.back()->SetPrimitiveType(GeometryPrimitive::Lines);
+		in.identities.resize(INDIRECT_SHADERS + INDIRECT_TEXTURES);
+
+		std::mt19937 generator(8503);
+		for (size_t i = 0; i < INDIRECT_OBJECT_COUNT; ++i) {
+			in.items.emplace_back(MakeIndirectItem(in, boxes[i], generator));
+			in.items.back().source = { (uint32_t)i, 1 };
+		}
+		return in;
+	}
+
+	/*
+	Runs the layout's copy of cullObjects.comp over a packet, and checks that
+	it draws exactly what FrustumCuller finds visible, of what the layout can
+	draw: every command of a group must have one instance per visible object
+	in the group, and the group's range of the instance array must hold each
+	of those objects' slots once.
+	*/
+	size_t CheckIndirectFrame(const IndirectDrawLayout& layout, const FramePacket& packet, const Frustum& frustum, size_t& outVisible) {
+		std::vector<const RenderItem*> items;
+		FrustumCuller culler;
+		for (const std::vector<RenderItem>* list : { &packet.items, &packet.staticItems }) {
+			for (const RenderItem& item : *list) {
+				items.emplace_back(&item);
+				culler.AddBox(item.boundsCentre, item.boundsHalf);
+			}
+		}
+		std::vector<int> visible;
+		culler.Cull(frustum, visible);
+
+		std::unordered_map<GameObjectHandle, const RenderItem*> sources;
+		for (const RenderItem* item : items) {
+			sources.insert({ item->source, item });
+		}
+		std::set<const RenderItem*> expected;
+		for (int i : visible) {
+			if (IndirectDrawLayout::CanDraw(*items[i])) {
+				expected.insert(items[i]);
+			}
+		}
+
+		std::vector<IndirectDrawLayout::DrawCommand>	commands;
+		std::vector<uint32_t>							instances;
+		layout.Cull(frustum, commands, instances);
+
+		const std::vector<IndirectDrawLayout::DrawGroup>& groups = layout.GetGroups();
+		size_t mismatches = 0;
+		std::set<const RenderItem*> drawn;
+		for (const IndirectDrawLayout::DrawGroup& group : groups) {
+			size_t groupVisible = 0;
+			for (const RenderItem* item : expected) {
+				groupVisible += item->mesh == group.mesh && item->shader == group.shader && item->texture == group.texture;
+			}
+			for (uint32_t c = 0; c < group.commandCount; ++c) {
+				mismatches += commands[group.firstCommand + c].instanceCount != groupVisible;
+			}
+			const IndirectDrawLayout::DrawCommand& first = commands[group.firstCommand];
+			for (uint32_t i = 0; i < first.instanceCount && first.baseInstance + i < instances.size(); ++i) {
+				uint32_t slot = instances[first.baseInstance + i];
+				auto source = slot < layout.GetObjects().size() ? sources.find(layout.GetSlotOwner(slot)) : sources.end();
+				if (source == sources.end()) {
+					mismatches++;
+					continue;
+				}
+				const RenderItem* item = source->second;
+				bool inGroup = item->mesh == group.mesh && item->shader == group.shader && item->texture == group.texture;
+				mismatches += !inGroup || !expected.count(item) || !drawn.insert(item).second;
+			}
+		}
+		mismatches += drawn.size() != expected.size();
+		outVisible = drawn.size();
+		return mismatches;
+	}
+
+	/*
+	A second frame drops some of the objects, moves others, and brings in new
+	ones, some of which reuse a dropped object's index with a new generation,
+	so the slots that get freed and handed out again are checked as well.
+	*/
+	bool CheckIndirectLayout(const TestView& view, const std::vector<Box>& boxes) {
+		Frustum frustum = Frustum::FromViewProjMatrix(view.viewProj);
+		IndirectInputs in = MakeIndirectInputs(boxes);
+
+		FramePacket packet;
+		for (size_t i = 0; i < in.items.size(); ++i) {
+			(i % 4 == 0 ? packet.staticItems : packet.items).emplace_back(in.items[i]);
+		}
+		IndirectDrawLayout layout;
+		layout.Update(packet);
+
+		size_t visible		= 0;
+		size_t mismatches	= CheckIndirectFrame(layout, packet, frustum, visible);
+
+		std::mt19937 generator(8504);
+		std::uniform_real_distribution<float> offset(-50.0f, 50.0f);
+		FramePacket nextPacket;
+		nextPacket.staticItems = packet.staticItems;
+		for (size_t i = 0; i < packet.items.size(); ++i) {
+			RenderItem item = packet.items[i];
+			if (i % 7 == 0) {
+				if (i % 14 == 0) {
+					item = MakeIndirectItem(in, boxes[INDIRECT_OBJECT_COUNT + i], generator);
+					item.source = { packet.items[i].source.index, 2 };
+					nextPacket.items.emplace_back(item);
+				}
+				continue;
+			}
+			if (i % 3 == 0) {
+				Vector3 move(offset(generator), offset(generator), offset(generator));
+				item.boundsCentre += move;
+				item.modelMatrix = Matrix4::Translation(move) * item.modelMatrix;
+			}
+			nextPacket.items.emplace_back(item);
+		}
+		for (size_t i = 0; i < INDIRECT_OBJECT_COUNT / 10; ++i) {
+			RenderItem item = MakeIndirectItem(in, boxes[INDIRECT_OBJECT_COUNT * 2 + i], generator);
+			item.source = { (uint32_t)(INDIRECT_OBJECT_COUNT + i), 1 };
+			nextPacket.items.emplace_back(item);
+		}
+		layout.Update(nextPacket);
+
+		size_t nextVisible = 0;
+		mismatches += CheckIndirectFrame(layout, nextPacket, frustum, nextVisible);
+
+		bool passed = mismatches == 0 && visible > 0 && nextVisible > 0;
+		std::cout << "Indirect draws\t" << view.name << "\t" << in.items.size() << "\t" << visible << "\t" << nextVisible << "\t"
+			<< layout.GetGroups().size() << "\t" << mismatches << (passed ? "" : "\tFAILED") << "\n";
+
+		for (TestMesh* m : in.meshes) {
+			delete m;
+		}
+		return passed;
+	}
+
+	template <typename T>
+	bool SameBytes(const T& a, const T& b) {
+		return memcmp(&a, &b, sizeof(T)) == 0;
+	}
+
+	//Field by field, as the bytes padding out a RenderItem could be anything
+	bool SameItem(const RenderItem& a, const RenderItem& b) {
+		return SameBytes(a.modelMatrix, b.modelMatrix) && SameBytes(a.colour, b.colour) &&
+			SameBytes(a.boundsCentre, b.boundsCentre) && SameBytes(a.boundsHalf, b.boundsHalf) &&
+			a.mesh == b.mesh && a.texture == b.texture && a.shader == b.shader && SameBytes(a.source, b.source);
+	}
+
+	size_t ComparePackets(const FramePacket& a, const FramePacket& b) {
+		size_t mismatches = 0;
+		mismatches += a.items.size() != b.items.size();
+		mismatches += a.staticItems.size() != b.staticItems.size();
+		for (size_t i = 0; i < std::min(a.items.size(), b.items.size()); ++i) {
+			mismatches += !SameItem(a.items[i], b.items[i]);
+		}
+		for (size_t i = 0; i < std::min(a.staticItems.size(), b.staticItems.size()); ++i) {
+			mismatches += !SameItem(a.staticItems[i], b.staticItems[i]);
+		}
+		mismatches += a.frameID != b.frameID;
+		mismatches += a.staticVersion != b.staticVersion;
+		mismatches += !SameBytes(a.camera.BuildViewMatrix(), b.camera.BuildViewMatrix());
+		return mismatches;
+	}
+
+	void RandomiseTransform(GameObject* o, std::mt19937& generator) {
+		std::uniform_real_distribution<float>	position(-SCENE_SIZE, SCENE_SIZE);
+		std::uniform_real_distribution<float>	size(0.1f, 10.0f);
+		std::uniform_real_distribution<float>	angle(0.0f, 360.0f);
+		o->GetTransform()
+			.SetPosition(Vector3(position(generator), position(generator), position(generator)))
+			.SetScale(Vector3(size(generator), size(generator), size(generator)))
+			.SetOrientation(Quaternion::EulerAnglesToQuaternion(angle(generator), angle(generator), angle(generator)));
+	}
+
+	/*
+	Each frame moves the objects that aren't static, flips a few of them in and
+	out of being active, and every other frame swaps one static object for a
+	new one, so the static items have to be copied again too. An object is
+	removed each frame but not committed until after extraction, which mustn't
+	pick it up.
+	*/
+	bool CheckExtractorJobs(Mesh* mesh) {
+		std::mt19937 generator(8503);
+		std::uniform_real_distribution<float>	colour(0.0f, 1.0f);
+		std::uniform_int_distribution<int>		flip(0, 49);
+
+		GameWorld world;
+		world.GetMainCamera().SetPosition(Vector3(10, 20, 30)).SetYaw(30.0f).SetPitch(-15.0f);
+
+		auto AddObject = [&](bool isStatic) {
+			GameObject* o = new GameObject();
+			RandomiseTransform(o, generator);
+			o->SetRenderObject(new RenderObject(&o->GetTransform(), mesh, nullptr, nullptr));
+			o->GetRenderObject()->SetColour(Vector4(colour(generator), colour(generator), colour(generator), 1.0f));
+			o->GetRenderObject()->SetStatic(isStatic);
+			world.AddGameObject(o);
+			return o;
+		};
+		std::vector<GameObject*> objects;
+		for (size_t i = 0; i < EXTRACT_OBJECT_COUNT; ++i) {
+			objects.emplace_back(AddObject(i % EXTRACT_STATIC_EVERY == 0));
+		}
+
+		JobSystem			jobs(EXTRACT_THREADS);
+		RenderExtractor		serial;
+		RenderExtractor		parallel;
+		size_t mismatches	= 0;
+		size_t items		= 0;
+		size_t staticItems	= 0;
+		for (int frame = 0; frame < EXTRACT_FRAMES; ++frame) {
+			for (GameObject*& o : objects) {
+				if (o->GetRenderObject()->IsStatic()) {
+					continue;
+				}
+				RandomiseTransform(o, generator);
+				if (flip(generator) == 0) {
+					o->SetActive(!o->IsActive());
+				}
+			}
+			if (frame % 2 == 1) {
+				world.RemoveGameObject(objects[0], true);
+				world.CommitRemovals();
+				objects[0] = AddObject(true);
+			}
+			GameObject*& removed = objects[1 + frame];
+			GameObjectHandle removedHandle = removed->GetWorldHandle();
+			world.RemoveGameObject(removed, true);
+
+			serial.Extract(world);
+			parallel.Extract(world, &jobs);
+			mismatches += ComparePackets(serial.GetFrontPacket(), parallel.GetFrontPacket());
+			for (const RenderItem& item : parallel.GetFrontPacket().items) {
+				mismatches += item.source == removedHandle;
+			}
+			world.CommitRemovals();
+			removed = AddObject(false);
+			items		+= parallel.GetFrontPacket().items.size();
+			staticItems	+= parallel.GetFrontPacket().staticItems.size();
+		}
+		world.ClearAndErase();
+
+		bool passed = mismatches == 0 && items > 0 && staticItems > 0;
+		std::cout << "Extraction\t" << (jobs.GetWorkerCount() + 1) << "\t" << EXTRACT_OBJECT_COUNT << "\t" << EXTRACT_FRAMES << "\t"
+			<< items << "\t" << staticItems << "\t" << mismatches << (passed ? "" : "\tFAILED") << "\n";
+		return passed;
+	}
+
+	class TestDebug : public Debug {
+	public:
+		static size_t GetThreadBufferCount() {
+			return threadBuffers.size();
+		}
+	};
+
+	/*
+	Every line is drawn with its index in start.x, and every string with it in
+	position.x, so what Flush gathers can be matched back up to what was drawn.
+	*/
+	size_t CheckDebugFrame(size_t count, size_t& outTimed) {
+		size_t mismatches = 0;
+		std::vector<int> lineSeen(count, 0);
+		std::vector<int> stringSeen(count, 0);
+		for (const Debug::DebugLineEntry& line : Debug::GetDebugLines()) {
+			size_t i = (size_t)line.start.x;
+			if (i >= count || line.end.x != (float)i || (line.time > 0.0f) != (i % DEBUG_TIMED_EVERY == 0)) {
+				mismatches++;
+				continue;
+			}
+			lineSeen[i]++;
+		}
+		for (const Debug::DebugStringEntry& s : Debug::GetDebugStrings()) {
+			size_t i = (size_t)s.position.x;
+			if (i >= count || i % DEBUG_STRING_EVERY != 0 || s.data != "line " + std::to_string(i)) {
+				mismatches++;
+				continue;
+			}
+			stringSeen[i]++;
+		}
+		outTimed = 0;
+		for (size_t i = 0; i < count; ++i) {
+			mismatches += lineSeen[i] != 1;
+			mismatches += stringSeen[i] != (i % DEBUG_STRING_EVERY == 0 ? 1 : 0);
+			outTimed += i % DEBUG_TIMED_EVERY == 0;
+		}
+		return mismatches;
+	}
+
+	void DrawDebugLines(JobSystem& jobs, size_t count) {
+		jobs.ParallelFor(count, 64, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				float time = i % DEBUG_TIMED_EVERY == 0 ? DEBUG_LINE_TIME : 0.0f;
+				Debug::DrawLine(Vector3((float)i, 0, 0), Vector3((float)i, 1, 0), Debug::WHITE, time);
+				if (i % DEBUG_STRING_EVERY == 0) {
+					Debug::Print("line " + std::to_string(i), Vector2((float)i, 0));
+				}
+			}
+		});
+	}
+
+	bool CheckDebugThreads() {
+		JobSystem jobs(DEBUG_THREADS);
+		size_t mismatches = 0;
+
+		Debug::UpdateRenderables(0.0f);
+		DrawDebugLines(jobs, DEBUG_LINE_COUNT);
+		Debug::Flush();
+		size_t timed = 0;
+		mismatches += CheckDebugFrame(DEBUG_LINE_COUNT, timed);
+		mismatches += Debug::GetDroppedLineCount() + Debug::GetDroppedStringCount();
+
+		//Timed lines outlast their frame, until their time runs out
+		Debug::UpdateRenderables(DEBUG_LINE_TIME * 0.5f);
+		Debug::Flush();
+		size_t timedKept = Debug::GetDebugLines().size();
+		mismatches += timedKept != timed;
+		Debug::UpdateRenderables(DEBUG_LINE_TIME);
+		Debug::Flush();
+		mismatches += !Debug::GetDebugLines().empty();
+
+		//Whatever can't fit is dropped, but every line has to be accounted for
+		Debug::UpdateRenderables(0.0f);
+		jobs.ParallelFor(DEBUG_OVERFLOW_COUNT, 64, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				Debug::DrawLine(Vector3(), Vector3(1, 1, 1));
+			}
+		});
+		Debug::Flush();
+		size_t dropped = Debug::GetDroppedLineCount();
+		mismatches += Debug::GetDebugLines().size() + dropped != DEBUG_OVERFLOW_COUNT;
+
+		//Threads that have exited hand their buffers on, and what they drew still gets gathered
+		Debug::UpdateRenderables(0.0f);
+		size_t buffersBefore = TestDebug::GetThreadBufferCount();
+		for (int round = 0; round < DEBUG_THREAD_ROUNDS; ++round) {
+			std::vector<std::thread> threads;
+			for (int t = 0; t < DEBUG_THREADS; ++t) {
+				threads.emplace_back([] {
+					Debug::DrawLine(Vector3(), Vector3(1, 1, 1));
+				});
+			}
+			for (std::thread& t : threads) {
+				t.join();
+			}
+		}
+		Debug::Flush();
+		size_t buffersAfter = TestDebug::GetThreadBufferCount();
+		mismatches += buffersAfter > buffersBefore + DEBUG_THREADS;
+		mismatches += Debug::GetDebugLines().size() != DEBUG_THREAD_ROUNDS * DEBUG_THREADS;
+		Debug::UpdateRenderables(0.0f);
+
+		bool passed = mismatches == 0 && dropped > 0;
+		std::cout << "Debug drawing\t" << (jobs.GetWorkerCount() + 1) << "\t" << DEBUG_LINE_COUNT << "\t" << timedKept << "\t" << dropped << "\t"
+			<< buffersAfter << "\t" << mismatches << (passed ? "" : "\tFAILED") << "\n";
+		return passed;
+	}
+}
+
+int main(int argc, char** argv) {
+	int iterations = DEFAULT_ITERATIONS;
+	if (argc == 2) {
+		iterations = std::max(1, atoi(argv[1]));
+	}
+	const std::vector<TestView> views = MakeViews();
+	const std::vector<Box>		boxes = MakeBoxes(BOX_COUNT);
+
+	int failures = 0;
+	auto run = [&](bool passed) {
+		if (!passed) {
+			failures++;
+		}
+	};
+
+	std::cout << "Test\tView\tCount\tInside\tMismatches\tBrute force ms\tCuller ms\tSpeedup\n";
+	for (const TestView& view : views) {
+		run(CheckFrustum(view));
+	}
+	for (const TestView& view : views) {
+		run(CheckCuller(view, boxes, iterations));
+	}
+
+	std::cout << "\nTest\tCount\tMismatches\tShader changes\tTexture changes\tMesh changes\tstable_sort ms\tQueue ms\tSpeedup\n";
+	run(CheckRenderQueue(iterations));
+
+	TestMesh* cube = MakeCubeMesh();
+	std::vector<GameObject*> walls = MakeWalls(WALL_COUNT, cube);
+
+	std::cout << "\nTest\tQueries\tHits\tMismatches\tBrute force ms\tGrid ms\tSpeedup\n";
+	run(CheckStaticGrid(walls, iterations));
+
+	std::cout << "\nTest\tWalls\tBatches\tTriangles\tMismatches\n";
+	run(CheckStaticBatcher(walls));
+
+	std::cout << "\nTest\tView\tObjects\tVisible\tVisible after changes\tGroups\tMismatches\n";
+	for (const TestView& view : views) {
+		run(CheckIndirectLayout(view, boxes));
+	}
+
+	std::cout << "\nTest\tThreads\tObjects\tFrames\tItems\tStatic items\tMismatches\n";
+	run(CheckExtractorJobs(cube));
+
+	std::cout << "\nTest\tThreads\tLines\tTimed lines kept\tOverflow dropped\tThread buffers\tMismatches\n";
+	run(CheckDebugThreads());
+
+	for (GameObject* w : walls) {
+		delete w;
+	}
+	delete cube;
+	return failures == 0 ? 0 : 1;
+}